@@ -0,0 +1,184 @@
+#include "Surface.common.hlsli"
+#include "Environment.common.hlsli"
+
+// Shared by the bindless surface shaders, a draw only passes the index of its material and
+// object. The rest is in tables bound once per pass.
+
+// Constant normal incidence Fresnel factor for all dielectrics.
+static const float3 Fdielectric = 0.04;
+static const uint NoTexture = 0xffffffff;
+
+// Has to match GpuMaterial in MaterialTable.h
+struct Material
+{
+    float3 Color;
+    uint AlbedoTexture;
+    // ( 16 bytes )
+    float3 EmissiveColor;
+    uint NormalTexture;
+    // ( 16 bytes )
+    float Roughness;
+    float Metallic;
+    uint RoughnessTexture;
+    uint MetallicTexture;
+    // ( 16 bytes )
+};
+
+// Has to match BindlessObjectData in D3D12Renderer.h
+struct ObjectData
+{
+    matrix LocalToWorld;
+    // ( 16 bytes )
+    uint LightOffset;
+    uint LightCount;
+    uint FinestMip;
+    uint _padding;
+    // ( 16 bytes )
+};
+
+cbuffer cbDraw : register(b0)
+{
+    uint MaterialIndex;
+    uint ObjectIndex;
+};
+
+cbuffer cbPass : register(b1)
+{
+    matrix ViewProjection : packoffset(c0);
+    float3 EyePosition : packoffset(c4.x);
+    uint NumLights : packoffset(c4.w);
+};
+
+StructuredBuffer<Material> Materials : register(t0, space1);
+StructuredBuffer<ObjectData> Objects : register(t1, space1);
+// The lights of every object of the pass, an object's start at its LightOffset
+StructuredBuffer<uint> ObjectLights : register(t2, space1);
+
+// The whole resource heap, indexed by the materials
+Texture2D<float4> Textures[] : register(t0, space2);
+
+// Global
+TextureCube EnvRadianceTexture : register(t5);
+TextureCube EnvIrradianceTexture : register(t6);
+Texture2D<float2> BRDFLUT : register(t7);
+StructuredBuffer<Light> SceneLights : register(t8);
+
+SamplerState someSampler : register(s0);
+SamplerState brdfSampler : register(s1);
+
+struct PSInput
+{
+    float4 position : SV_POSITION;
+    float3 normal : NORMAL;
+    float3 WorldPosition : POSITION;
+    float2 uv : UV;
+    float3x3 TBN : TBN;
+};
+
+float4 ShadeSurface(PSInput input)
+{
+    Material material = Materials[MaterialIndex];
+    ObjectData object = Objects[ObjectIndex];
+
+    float Metalness = material.MetallicTexture != NoTexture ?
+        Textures[material.MetallicTexture].Sample(someSampler, input.uv).r : material.Metallic;
+
+    float3 Normal = normalize(input.normal);
+    if (material.NormalTexture != NoTexture)
+    {
+        float3 N = Textures[material.NormalTexture].Sample(someSampler, input.uv).rgb;
+        N = 2.0 * N - 1.0;
+        Normal = normalize(mul(N, input.TBN));
+    }
+
+    float3 FragmentToCamera = normalize(EyePosition - input.WorldPosition);
+    float cosLo = max(dot(Normal, FragmentToCamera), 0.0);
+
+    // Specular reflection vector.
+    float3 Lr = 2.0 * cosLo * Normal - FragmentToCamera;
+
+    float3 Albedo = material.AlbedoTexture != NoTexture ?
+        Textures[material.AlbedoTexture].Sample(someSampler, input.uv).rgb : material.Color;
+
+    // Fresnel reflectance at normal incidence (for metals use albedo color).
+    float3 F0 = lerp(Fdielectric, Albedo, Metalness);
+
+    float Roughness = material.RoughnessTexture != NoTexture ?
+        Textures[material.RoughnessTexture].Sample(someSampler, input.uv).r : material.Roughness;
+
+    float3 directLighting = 0.0;
+    for (uint i = 0; i < object.LightCount; i++)
+    {
+        uint index = ObjectLights[object.LightOffset + i];
+
+        float3 V = SceneLights[index].Position.xyz - input.WorldPosition;
+
+        float d = length(V);
+
+        if (d > SceneLights[index].Range) {
+            continue;
+        }
+
+        float attenuation = CalculateAttenuation(SceneLights[index].Range, d);
+
+        float shadowFactor = step(0, dot(input.normal, FragmentToCamera));
+
+        float3 Li = normalize(V);
+
+        // Half-vector between Li and Lo.
+        float3 Lh = normalize(Li + FragmentToCamera);
+
+        // Calculate angles between surface normal and various light vectors.
+        float cosLi = max(0.0, dot(Normal, Li));
+        float cosLh = max(0.0, dot(Normal, Lh));
+
+        float3 F = fresnelSchlick(F0, max(dot(Lh, FragmentToCamera), 0.0));
+
+        float D = ndfGGX(cosLh, Roughness);
+
+        float G = gaSchlickGGX(cosLi, cosLo, Roughness);
+
+        float3 kd = lerp(float3(1, 1, 1) - F, float3(0, 0, 0), Metalness);
+
+        // Lambert diffuse BRDF.
+        float3 diffuseBRDF = kd * Albedo;
+
+        // Cook-Torrance specular microfacet BRDF.
+        float3 specularBRDF = (F * D * G) / max(Epsilon, 4.0 * cosLi * cosLo);
+
+        // Total contribution for this light.
+        directLighting += (diffuseBRDF + specularBRDF) * SceneLights[index].Color * SceneLights[index].Intensity *
+                                cosLi * attenuation * shadowFactor;
+    }
+
+    // Ambient lighting (IBL).
+    float3 ambientLighting;
+    {
+        // Sample diffuse irradiance at normal direction.
+        float3 irradiance = EnvIrradianceTexture.Sample(someSampler, Normal).rgb;
+
+        // Calculate Fresnel term for ambient lighting.
+        float3 F = fresnelSchlick(F0, cosLo);
+
+        // Get diffuse contribution factor (as with direct lighting).
+        float3 kd = lerp(1.0 - F, 0.0, Metalness);
+
+        // Irradiance map contains exitant radiance assuming Lambertian BRDF, no need to scale by 1/PI here either.
+        float3 diffuseIBL = kd * Albedo * irradiance;
+
+        uint width, height, levels;
+        EnvRadianceTexture.GetDimensions(0, width, height, levels);
+
+        // Split-sum approximation factors for Cook-Torrance specular BRDF.
+        float3 specularIrradiance = EnvRadianceTexture.SampleLevel(someSampler, Lr, Roughness * levels).rgb;
+
+        float2 specularBRDF = BRDFLUT.Sample(brdfSampler, float2(cosLo, Roughness)).rg;
+        // Total specular IBL contribution.
+        float3 specularIBL = (F0 * specularBRDF.x + specularBRDF.y) * specularIrradiance;
+
+        // Total ambient lighting contribution.
+        ambientLighting = diffuseIBL + specularIBL;
+    }
+
+    return float4(directLighting + ambientLighting + material.EmissiveColor, 1);
+}
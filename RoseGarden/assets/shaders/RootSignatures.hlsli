@@ -56,6 +56,65 @@
     "filter = FILTER_MIN_MAG_MIP_LINEAR,"\
     "visibility = SHADER_VISIBILITY_PIXEL)"
 
+// Bindless surface shaders, a draw only sets the two root constants. The texture table is the
+// whole resource heap, materials index it
+#define BINDLESS_RS \
+"RootFlags ( ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT |" \
+"            DENY_DOMAIN_SHADER_ROOT_ACCESS |" \
+"            DENY_GEOMETRY_SHADER_ROOT_ACCESS |" \
+"            DENY_HULL_SHADER_ROOT_ACCESS )," \
+"RootConstants(num32BitConstants=2, b0),"\
+"CBV(b1),"\
+"SRV(t0, space = 1, visibility = SHADER_VISIBILITY_PIXEL),"\
+"SRV(t1, space = 1),"\
+"SRV(t2, space = 1, visibility = SHADER_VISIBILITY_PIXEL),"\
+"DescriptorTable ( SRV(t0, space = 2, numDescriptors = unbounded, flags = DESCRIPTORS_VOLATILE), visibility = SHADER_VISIBILITY_PIXEL ),"\
+"DescriptorTable ( SRV(t5), visibility = SHADER_VISIBILITY_PIXEL ),"\
+"DescriptorTable ( SRV(t6), visibility = SHADER_VISIBILITY_PIXEL ),"\
+"DescriptorTable ( SRV(t7), visibility = SHADER_VISIBILITY_PIXEL ),"\
+"DescriptorTable ( SRV(t8), visibility = SHADER_VISIBILITY_PIXEL ),"\
+"StaticSampler(s0," \
+    "addressU = TEXTURE_ADDRESS_WRAP," \
+    "addressV = TEXTURE_ADDRESS_WRAP," \
+    "addressW = TEXTURE_ADDRESS_WRAP," \
+    "borderColor = STATIC_BORDER_COLOR_TRANSPARENT_BLACK," \
+    "filter = FILTER_ANISOTROPIC, "\
+    "visibility = SHADER_VISIBILITY_PIXEL),"\
+"StaticSampler(s1,"\
+    "addressU = TEXTURE_ADDRESS_CLAMP," \
+    "addressV = TEXTURE_ADDRESS_CLAMP," \
+    "filter = FILTER_MIN_MAG_MIP_LINEAR,"\
+    "visibility = SHADER_VISIBILITY_PIXEL)"
+
+// BINDLESS_RS with the point sampler of PBR_RS2, for the decoupled shading
+#define BINDLESS_RS2 \
+"RootFlags ( ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT |" \
+"            DENY_DOMAIN_SHADER_ROOT_ACCESS |" \
+"            DENY_GEOMETRY_SHADER_ROOT_ACCESS |" \
+"            DENY_HULL_SHADER_ROOT_ACCESS )," \
+"RootConstants(num32BitConstants=2, b0),"\
+"CBV(b1),"\
+"SRV(t0, space = 1, visibility = SHADER_VISIBILITY_PIXEL),"\
+"SRV(t1, space = 1),"\
+"SRV(t2, space = 1, visibility = SHADER_VISIBILITY_PIXEL),"\
+"DescriptorTable ( SRV(t0, space = 2, numDescriptors = unbounded, flags = DESCRIPTORS_VOLATILE), visibility = SHADER_VISIBILITY_PIXEL ),"\
+"DescriptorTable ( SRV(t5), visibility = SHADER_VISIBILITY_PIXEL ),"\
+"DescriptorTable ( SRV(t6), visibility = SHADER_VISIBILITY_PIXEL ),"\
+"DescriptorTable ( SRV(t7), visibility = SHADER_VISIBILITY_PIXEL ),"\
+"DescriptorTable ( SRV(t8), visibility = SHADER_VISIBILITY_PIXEL ),"\
+"StaticSampler(s0," \
+    "addressU = TEXTURE_ADDRESS_WRAP," \
+    "addressV = TEXTURE_ADDRESS_WRAP," \
+    "addressW = TEXTURE_ADDRESS_WRAP," \
+    "borderColor = STATIC_BORDER_COLOR_TRANSPARENT_BLACK," \
+    "filter = FILTER_MIN_MAG_MIP_POINT, "\
+    "visibility = SHADER_VISIBILITY_PIXEL),"\
+"StaticSampler(s1,"\
+    "addressU = TEXTURE_ADDRESS_CLAMP," \
+    "addressV = TEXTURE_ADDRESS_CLAMP," \
+    "filter = FILTER_MIN_MAG_MIP_LINEAR,"\
+    "visibility = SHADER_VISIBILITY_PIXEL)"
+
 #define Skybox_RS \
 "RootFlags ( ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT |" \
 "            DENY_DOMAIN_SHADER_ROOT_ACCESS |" \
@@ -0,0 +1,31 @@
+#include "RootSignatures.hlsli"
+#include "Bindless.common.hlsli"
+
+[RootSignature(BINDLESS_RS2)]
+PSInput VS_Main(VSInput input)
+{
+    PSInput result;
+
+    matrix LocalToWorld = Objects[ObjectIndex].LocalToWorld;
+
+    // The object is rasterized in texture space
+    float2 vUv = input.uv;
+    vUv = (vUv * 2.0) - 1.0;
+
+    float3x3 TBN = float3x3(input.tangent, input.binormal, input.normal);
+
+    result.TBN = mul((float3x3)LocalToWorld, TBN);
+
+    result.position = float4(vUv, 0.0, 1.0);
+    result.normal = mul((float3x3)LocalToWorld, input.normal);
+    result.uv = float2(input.uv.x, 1.0 - input.uv.y);
+
+    result.WorldPosition = mul(LocalToWorld, float4(input.position, 1.0)).xyz;
+    return result;
+}
+
+[RootSignature(BINDLESS_RS2)]
+float4 PS_Main(PSInput input) : SV_TARGET
+{
+    return ShadeSurface(input);
+}
@@ -0,0 +1,28 @@
+#include "RootSignatures.hlsli"
+#include "Bindless.common.hlsli"
+
+[RootSignature(BINDLESS_RS)]
+PSInput VS_Main(VSInput input)
+{
+    PSInput result;
+
+    matrix LocalToWorld = Objects[ObjectIndex].LocalToWorld;
+
+    float3x3 TBN = float3x3(input.tangent, input.binormal, input.normal);
+
+    result.TBN = mul((float3x3)LocalToWorld, TBN);
+
+    matrix mvp = mul(ViewProjection, LocalToWorld);
+    result.position = mul(mvp, float4(input.position, 1.0f));
+    result.normal = mul((float3x3)LocalToWorld, input.normal);
+    result.uv = float2(input.uv.x, 1.0 - input.uv.y);
+
+    result.WorldPosition = mul(LocalToWorld, float4(input.position, 1.0)).xyz;
+    return result;
+}
+
+[RootSignature(BINDLESS_RS)]
+float4 PS_Main(PSInput input) : SV_TARGET
+{
+    return ShadeSurface(input);
+}
@@ -24,6 +24,8 @@ cbuffer cbPerObject : register(b0) {
     matrix  LocalToWorld;
     uint2   FeedbackDims;
     uint2   Mips;
+    // 0: a uint per cell, 1: four byte cells packed into every element, 2: no feedback
+    uint    FeedbackMode;
 }
 
 Texture2D ColorTexture : register(t0);
@@ -36,6 +38,27 @@ struct PSInput
     float2 uv: UV;
 };
 
+// There is no byte sized InterlockedMin, so compact cells swap in their byte with a
+// compare exchange. Most pixels of a tile ask for the mip it already holds and never
+// get past the first read.
+void WriteCompactFeedback(uint cell, uint mip)
+{
+    uint element = cell >> 2;
+    uint shift = (cell & 3) * 8;
+    uint mask = 0xFFu << shift;
+
+    uint current = FeedbackBuffer[element];
+    [allow_uav_condition]
+    while (((current & mask) >> shift) > mip)
+    {
+        uint original;
+        InterlockedCompareExchange(FeedbackBuffer[element], current, (current & ~mask) | (mip << shift), original);
+        if (original == current)
+            break;
+        current = original;
+    }
+}
+
 [RootSignature(MyRS1)]
 PSInput VS_Main(VSInput input)
 {
@@ -59,7 +82,10 @@ float4 PS_Main(PSInput input) : SV_TARGET
     uint feedbackY = (uint)((float)FeedbackDims.y * input.uv.y);
 
     uint index = feedbackY * FeedbackDims.x + feedbackX;
-    InterlockedMin(FeedbackBuffer[index], idealMipLevel);
+    if (FeedbackMode == 1)
+        WriteCompactFeedback(index, idealMipLevel);
+    else if (FeedbackMode == 0)
+        InterlockedMin(FeedbackBuffer[index], idealMipLevel);
     // uint currentMip = FeedbackBuffer[index];
     // FeedbackBuffer[index] = min(currentMip, idealMipLevel);
     uint sampleMip = min(Mips.y, min(Mips.x, idealMipLevel));
@@ -3,6 +3,7 @@
 //#include <memory>
 #include <iomanip>
 #include <ctime>
+#include <fstream>
 #include <sstream>
 #include <chrono>
 #include <filesystem>
@@ -19,6 +20,7 @@
 #include "Platform/D3D12/D3D12Renderer.h"
 #include "Platform/D3D12/D3D12ResourceBatch.h"
 #include "Platform/D3D12/D3D12Shader.h"
+#include "Platform/D3D12/D3D12TilePool.h"
 #include "Platform/D3D12/Profiler/Profiler.h"
 
 
@@ -83,7 +85,7 @@ void BenchmarkLayer::OnAttach()
     Roses::Application::Get().GetWindow().SetTitle(oss.str().c_str());
 
     Roses::D3D12Renderer::SetDecoupledUpdateRate(m_CreationOptions.UpdateRate);
-
+    Roses::D3D12Renderer::ResetMipEstimateErrorStats();
 }
 
 void BenchmarkLayer::OnDetach()
@@ -96,6 +98,20 @@ void BenchmarkLayer::OnDetach()
 
     if (m_CreationOptions.CaptureTiming)
         Roses::Profiler::SaveTimings("Frame Total", m_CaptureFolder + "timings.json");
+
+    if (m_EnableCapture || m_CreationOptions.CaptureTiming)
+        SaveMipEstimateReport(m_CaptureFolder + "mip_estimate_error.csv");
+}
+
+void BenchmarkLayer::SaveMipEstimateReport(const std::string& path)
+{
+    // How the analytic mips would have done against the feedback over the whole run
+    auto& error = Roses::D3D12Renderer::GetMipEstimateErrorStats();
+
+    std::ofstream report(path);
+    report << "scene,samples,mean_abs_error,exact,within_one,too_coarse,too_fine\n";
+    report << m_DebugName << ',' << error.Samples << ',' << error.MeanAbsoluteError() << ','
+        << error.Exact << ',' << error.WithinOne << ',' << error.TooCoarse << ',' << error.TooFine << '\n';
 }
 
 void BenchmarkLayer::OnUpdate(Roses::Timestep ts)
@@ -120,11 +136,6 @@ void BenchmarkLayer::OnRender(Roses::Timestep ts, Roses::GraphicsContext& gfxCon
 
     m_LastFrameBuffer = D3D12Renderer::ResolveFrameBuffer();
 
-    {
-        //ScopedTimer timer("Prepare Backbuffer", r->MainCommandList);
-        D3D12Renderer::PrepareBackBuffer(gfxContext, m_ClearColor);
-    }
-
     {
         //ScopedTimer timer("Begin Scene", r->MainCommandList);
         D3D12Renderer::BeginScene(m_Scene);
@@ -135,20 +146,62 @@ void BenchmarkLayer::OnRender(Roses::Timestep ts, Roses::GraphicsContext& gfxCon
         D3D12Renderer::Submit(obj);
     }
 
+    // The passes only declare what they use, the graph orders them and places the barriers.
+    // The virtual textures and their feedback maps are transitioned by the passes themselves
+    auto framebuffer = m_LastFrameBuffer;
+    auto& graph = m_RenderGraph;
+    graph.Reset();
+
+    auto backBuffer = graph.ImportResource("Back Buffer", &D3D12Renderer::Context->GetCurrentBackBuffer(),
+        RenderGraphAccess_Present, RenderGraphResourceFlags_Output);
+    auto sceneColor = graph.ImportResource("Scene Color", framebuffer->ColorResource.get());
+    auto sceneDepth = graph.ImportResource("Scene Depth", framebuffer->DepthStensilResource.get(), RenderGraphAccess_DepthWrite);
+    auto environment = graph.ImportResource("Environment Map", m_Scene.Environment.EnvironmentMap.get());
+    auto virtualTextures = graph.ImportResource("Virtual Textures", nullptr,
+        RenderGraphAccess_None, RenderGraphResourceFlags_Untracked);
+    // Read back once the frame is done
+    auto feedbackMaps = graph.ImportResource("Feedback Maps", nullptr,
+        RenderGraphAccess_None, RenderGraphResourceFlags_Untracked | RenderGraphResourceFlags_Output);
+
+    uint32_t clear = graph.AddPass("Prepare Backbuffer", [this](GraphicsContext& context) {
+        D3D12Renderer::PrepareBackBuffer(context, m_ClearColor);
+    });
+    graph.Write(clear, sceneColor, RenderGraphAccess_RenderTarget, true);
+    graph.Write(clear, sceneDepth, RenderGraphAccess_DepthWrite, true);
+    graph.Write(clear, backBuffer, RenderGraphAccess_RenderTarget, true);
+
     //if (m_CreationOptions.UpdateRate == 0 || (D3D12Renderer::GetFrameCount() % m_CreationOptions.UpdateRate) == 0)
     //{
     //}
-    D3D12Renderer::ShadeDecoupled();
-
-    D3D12Renderer::ClearVirtualMaps();
+    uint32_t shade = graph.AddPass("Decoupled Shading", [](GraphicsContext&) { D3D12Renderer::ShadeDecoupled(); },
+        RenderGraphPassFlags_Submits);
+    graph.Read(shade, feedbackMaps, RenderGraphAccess_NonPixelShaderRead);
+    graph.Read(shade, environment, RenderGraphAccess_PixelShaderRead);
+    graph.Write(shade, virtualTextures, RenderGraphAccess_RenderTarget);
+
+    uint32_t clearFeedback = graph.AddPass("Clear Feedback Maps", [](GraphicsContext&) { D3D12Renderer::ClearVirtualMaps(); },
+        RenderGraphPassFlags_Submits);
+    graph.Write(clearFeedback, feedbackMaps, RenderGraphAccess_UnorderedAccess, true);
+
+    uint32_t scene = graph.AddPass("Render Submitted", [](GraphicsContext& context) { D3D12Renderer::RenderSubmitted(context); },
+        RenderGraphPassFlags_Submits);
+    graph.Read(scene, virtualTextures, RenderGraphAccess_PixelShaderRead);
+    graph.Write(scene, feedbackMaps, RenderGraphAccess_UnorderedAccess);
+    graph.Write(scene, sceneColor, RenderGraphAccess_RenderTarget);
+    graph.Write(scene, sceneDepth, RenderGraphAccess_DepthWrite);
+
+    uint32_t skybox = graph.AddPass("Skybox", [this](GraphicsContext& context) {
+        D3D12Renderer::RenderSkybox(context, m_EnvironmentLevel);
+    });
+    graph.Read(skybox, environment, RenderGraphAccess_PixelShaderRead);
+    graph.Write(skybox, sceneColor, RenderGraphAccess_RenderTarget);
+    graph.Write(skybox, sceneDepth, RenderGraphAccess_DepthWrite);
 
-    D3D12Renderer::RenderSubmitted(gfxContext);
-    //gfxContext.FlushResourceBarriers();
+    uint32_t toneMapping = graph.AddPass("Tone Mapping", [](GraphicsContext& context) { D3D12Renderer::DoToneMapping(context); });
+    graph.Read(toneMapping, sceneColor, RenderGraphAccess_PixelShaderRead);
+    graph.Write(toneMapping, backBuffer, RenderGraphAccess_RenderTarget, true);
 
-    D3D12Renderer::RenderSkybox(gfxContext, m_EnvironmentLevel);
-    //gfxContext.FlushResourceBarriers();
-    D3D12Renderer::DoToneMapping(gfxContext);
-    //gfxContext.FlushResourceBarriers();
+    graph.Execute(gfxContext);
 
     D3D12Renderer::EndScene();
 }
@@ -203,6 +256,30 @@ void BenchmarkLayer::OnImGuiRender(Roses::GraphicsContext& uiContext)
     ImGui::Property("Updated objects per frame", objectsPerFrame, 0, entitiesInScene, ImGui::PropertyFlag::InputProperty);
     D3D12Renderer::SetPerFrameDecoupledCap(objectsPerFrame);
 
+    bool perTileResidency = D3D12Renderer::TilePool->GetResidencyMode() == TileResidencyMode::FeedbackTiles;
+    ImGui::Property("Per-tile residency", perTileResidency);
+    D3D12Renderer::TilePool->SetResidencyMode(perTileResidency ? TileResidencyMode::FeedbackTiles : TileResidencyMode::MipRange);
+
+    bool bindlessMaterials = D3D12Renderer::GetBindlessMaterials();
+    ImGui::Property("Bindless materials", bindlessMaterials);
+    D3D12Renderer::SetBindlessMaterials(bindlessMaterials);
+
+    bool parallelRecording = D3D12Renderer::GetParallelRecording();
+    ImGui::Property("Parallel recording", parallelRecording);
+    D3D12Renderer::SetParallelRecording(parallelRecording);
+
+    int residencyBorder = static_cast<int>(D3D12Renderer::TilePool->GetResidencyBorder());
+    ImGui::Property("Residency border (tiles)", residencyBorder, 0, 8);
+    D3D12Renderer::TilePool->SetResidencyBorder(static_cast<uint32_t>(residencyBorder));
+
+    uint64_t tileBudgetMB = D3D12Renderer::TilePool->GetMemoryBudget() / (1024 * 1024);
+    ImGui::Property("Tile budget (MB, 0 = unlimited)", tileBudgetMB, 0, 4096, ImGui::PropertyFlag::InputProperty);
+    D3D12Renderer::TilePool->SetMemoryBudget(tileBudgetMB * 1024 * 1024);
+
+    uint64_t compactionBudget = D3D12Renderer::TilePool->GetCompactionBudget();
+    ImGui::Property("Compaction budget (tiles/frame)", compactionBudget, 0, 512, ImGui::PropertyFlag::InputProperty);
+    D3D12Renderer::TilePool->SetCompactionBudget(static_cast<uint32_t>(compactionBudget));
+
     ImGui::Columns(1);
     ImGui::End();
 
@@ -8,6 +8,7 @@
 
 #include "Platform/D3D12/CommandContext.h"
 #include "Platform/D3D12/D3D12Buffer.h"
+#include "Platform/D3D12/D3D12RenderGraph.h"
 #include "Platform/D3D12/FrameBuffer.h"
 
 #include <future>
@@ -46,6 +47,7 @@ protected:
 	virtual void OnCapture() {}
 
 	void AppendCapturePath(std::string& suffix);
+	void SaveMipEstimateReport(const std::string& path);
 	
 	Roses::Scene m_Scene;
 	Roses::PerspectiveCameraController m_CameraController;
@@ -68,5 +70,7 @@ private:
 	glm::vec4 m_ClearColor;
 	std::string m_CaptureFolder;
 	std::atomic_uint32_t m_CapturedFrames = 0;
+	// Rebuilt every frame in OnRender
+	Roses::D3D12RenderGraph m_RenderGraph;
 };
 
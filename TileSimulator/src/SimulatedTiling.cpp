@@ -0,0 +1,35 @@
+#include "trpch.h"
+#include "SimulatedTiling.h"
+
+using namespace Roses;
+
+/// <summary>
+/// Approximates the tiling D3D12 reports for an RGBA8 texture: every mip that covers at
+/// least a full tile is a standard mip, the rest share a single packed tile.
+/// </summary>
+VirtualTextureLayout MakeLayout(uint32_t width, uint32_t height, uint32_t mipLevels)
+{
+	VirtualTextureLayout layout;
+	layout.MipLevels = mipLevels;
+
+	for (uint32_t mip = 0; mip < mipLevels; mip++)
+	{
+		uint32_t mipWidth = std::max(width >> mip, 1u);
+		uint32_t mipHeight = std::max(height >> mip, 1u);
+		if (mipWidth < TileSizeInTexels || mipHeight < TileSizeInTexels)
+			break;
+
+		layout.MipGrids.push_back({
+			(mipWidth + TileSizeInTexels - 1) / TileSizeInTexels,
+			(mipHeight + TileSizeInTexels - 1) / TileSizeInTexels
+		});
+	}
+
+	if (layout.MipGrids.size() < mipLevels)
+	{
+		layout.NumPackedTiles = 1;
+		layout.PackedSubresource = static_cast<uint32_t>(layout.MipGrids.size());
+	}
+
+	return layout;
+}
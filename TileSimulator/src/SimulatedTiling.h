@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "TitaniumRose/Renderer/VirtualTexture/TilePoolCore.h"
+
+// A 64KB tile holds 128x128 texels of RGBA8, which is what the traced textures are assumed to be
+static constexpr uint32_t TileSizeInTexels = 128;
+// Same page size as D3D12TilePool, 32MB worth of 64KB tiles
+static constexpr uint32_t TilesPerPage = 512;
+static constexpr uint64_t TileSizeInBytes = 64 * 1024;
+
+/// <summary>
+/// Records what the pool asks for instead of talking to a graphics API
+/// </summary>
+class NullMappingBackend : public Roses::TileMappingBackend
+{
+public:
+	virtual void CreatePage(uint16_t, uint32_t) override { ++PagesCreated; }
+	virtual void DestroyPage(uint16_t) override { ++PagesDestroyed; }
+
+	virtual uint32_t UpdateMappings(Roses::VirtualTextureHandle, const std::vector<Roses::TileMappingRegion>& regions) override
+	{
+		// Mirror the D3D12 backend, one call per run of regions that share a heap
+		uint32_t calls = 0;
+		for (size_t r = 0; r < regions.size(); r++)
+		{
+			if (r == 0 || regions[r].Null != regions[r - 1].Null || (!regions[r].Null && regions[r].Page != regions[r - 1].Page))
+				++calls;
+		}
+		Calls += calls;
+		return calls;
+	}
+
+	virtual void UnmapAll(Roses::VirtualTextureHandle) override { ++Calls; }
+
+	virtual void CopyTilesOut(const std::vector<Roses::TileRelocation>& tiles) override { TilesCopied += tiles.size(); }
+	virtual void CopyTilesIn(const std::vector<Roses::TileRelocation>&) override { }
+
+	uint64_t PagesCreated = 0;
+	uint64_t PagesDestroyed = 0;
+	uint64_t Calls = 0;
+	uint64_t TilesCopied = 0;
+};
+
+/// <summary>
+/// Approximates the tiling D3D12 reports for an RGBA8 texture: every mip that covers at
+/// least a full tile is a standard mip, the rest share a single packed tile.
+/// </summary>
+Roses::VirtualTextureLayout MakeLayout(uint32_t width, uint32_t height, uint32_t mipLevels);
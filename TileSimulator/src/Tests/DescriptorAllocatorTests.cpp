@@ -0,0 +1,560 @@
+#include "trpch.h"
+#include "Tests/SimulatorChecks.h"
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <list>
+#include <mutex>
+#include <random>
+#include <thread>
+
+#include "TitaniumRose/Core/ConcurrentRangeAllocator.h"
+#include "TitaniumRose/Core/RangeAllocator.h"
+
+using namespace Roses;
+
+// Same size as the renderer's resource descriptor heap
+static constexpr size_t DescriptorHeapSize = 3000;
+
+/// <summary>
+/// The first-fit free list D3D12DescriptorHeap used before RangeAllocator, kept sorted and
+/// merging both neighbours on release, as the baseline of the descriptor benchmark.
+/// </summary>
+class ListRangeAllocator
+{
+public:
+	ListRangeAllocator(size_t size) { m_Ranges.push_back({ 0, size }); }
+
+	size_t Allocate(size_t count)
+	{
+		for (auto range = m_Ranges.begin(); range != m_Ranges.end(); ++range)
+		{
+			if (range->second < count)
+				continue;
+
+			size_t offset = range->first;
+			range->first += count;
+			range->second -= count;
+			if (range->second == 0)
+				m_Ranges.erase(range);
+			return offset;
+		}
+		return RangeAllocator::InvalidOffset;
+	}
+
+	void Release(size_t offset, size_t count)
+	{
+		auto next = std::find_if(m_Ranges.begin(), m_Ranges.end(), [&](auto& range) { return range.first > offset; });
+		next = m_Ranges.insert(next, { offset, count });
+
+		auto after = std::next(next);
+		if (after != m_Ranges.end() && next->first + next->second == after->first)
+		{
+			next->second += after->second;
+			m_Ranges.erase(after);
+		}
+		if (next != m_Ranges.begin())
+		{
+			auto before = std::prev(next);
+			if (before->first + before->second == next->first)
+			{
+				before->second += next->second;
+				m_Ranges.erase(next);
+			}
+		}
+	}
+
+	size_t GetFreeCount() const
+	{
+		size_t count = 0;
+		for (auto& range : m_Ranges)
+			count += range.second;
+		return count;
+	}
+
+private:
+	std::list<std::pair<size_t, size_t>> m_Ranges;
+};
+
+// Mostly single SRVs and UAVs, with the occasional table of a material's textures
+static size_t RandomDescriptorCount(std::mt19937& random)
+{
+	uint32_t roll = random() % 100;
+	if (roll < 70)
+		return 1;
+	if (roll < 95)
+		return 2 + random() % 4;
+	return 8 + random() % 9;
+}
+
+/// <summary>
+/// Allocates and releases random ranges until the descriptor heap is thoroughly fragmented,
+/// checking after every step that no slot is handed out twice and that the free count
+/// matches. Once everything is released the heap has to be a single range again.
+/// </summary>
+static bool RunDescriptorStressTest()
+{
+	RangeAllocator allocator(DescriptorHeapSize);
+	std::vector<std::pair<size_t, size_t>> live;
+	std::vector<bool> used(DescriptorHeapSize, false);
+	size_t usedCount = 0;
+	uint64_t failedWithSpace = 0;
+	size_t peakRanges = 0;
+	std::mt19937 random(7);
+
+	const char* check = "Descriptor stress test";
+
+	for (uint32_t step = 0; step < 200000; step++)
+	{
+		// Lean towards allocating until the heap is mostly full, then churn around that level
+		bool allocate = live.empty() || random() % 100 < (usedCount < DescriptorHeapSize * 9 / 10 ? 60u : 45u);
+		if (allocate)
+		{
+			size_t count = RandomDescriptorCount(random);
+			size_t offset = allocator.Allocate(count);
+			if (offset == RangeAllocator::InvalidOffset)
+			{
+				if (allocator.GetLargestFreeRange() >= count)
+					return Fail(check, "an allocation failed although a free range was large enough");
+				if (DescriptorHeapSize - usedCount >= count)
+					++failedWithSpace;
+				continue;
+			}
+
+			for (size_t slot = offset; slot < offset + count; slot++)
+			{
+				if (slot >= DescriptorHeapSize || used[slot])
+					return Fail(check, "slot " + std::to_string(slot) + " was handed out twice");
+				used[slot] = true;
+			}
+			usedCount += count;
+			live.push_back({ offset, count });
+		}
+		else
+		{
+			size_t index = random() % live.size();
+			auto [offset, count] = live[index];
+			live[index] = live.back();
+			live.pop_back();
+
+			if (!allocator.Release(offset, count))
+				return Fail(check, "a live range was rejected on release");
+			for (size_t slot = offset; slot < offset + count; slot++)
+				used[slot] = false;
+			usedCount -= count;
+
+			if (allocator.Release(offset, count))
+				return Fail(check, "a range was released twice");
+		}
+
+		if (allocator.GetFreeCount() != DescriptorHeapSize - usedCount)
+			return Fail(check, "the free count is out of sync");
+		peakRanges = std::max(peakRanges, allocator.GetFreeRangeCount());
+	}
+
+	for (auto [offset, count] : live)
+		allocator.Release(offset, count);
+	if (allocator.GetFreeRangeCount() != 1 || allocator.GetLargestFreeRange() != DescriptorHeapSize)
+		return Fail(check, "the heap did not coalesce back into a single range");
+
+	std::cout << "Descriptor stress test passed: peak " << peakRanges << " free ranges, "
+		<< failedWithSpace << " allocations failed to fragmentation" << std::endl;
+	return true;
+}
+
+/// <summary>
+/// Times release and allocate pairs on a descriptor heap kept around 90% full, the list
+/// against RangeAllocator. The same random sequence is replayed on both.
+/// </summary>
+static void RunDescriptorBenchmark()
+{
+	static constexpr uint32_t Operations = 1000000;
+
+	auto run = [](const char* name, auto& allocator) {
+		std::vector<std::pair<size_t, size_t>> live;
+		std::mt19937 random(11);
+		size_t usedCount = 0;
+
+		// Fill up to the working level first, this is not timed
+		while (usedCount < DescriptorHeapSize * 9 / 10)
+		{
+			size_t count = RandomDescriptorCount(random);
+			size_t offset = allocator.Allocate(count);
+			if (offset == RangeAllocator::InvalidOffset)
+				break;
+			live.push_back({ offset, count });
+			usedCount += count;
+		}
+
+		uint64_t failures = 0;
+		auto start = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i < Operations; i++)
+		{
+			size_t index = random() % live.size();
+			auto [offset, count] = live[index];
+			live[index] = live.back();
+			live.pop_back();
+			allocator.Release(offset, count);
+
+			count = RandomDescriptorCount(random);
+			offset = allocator.Allocate(count);
+			if (offset == RangeAllocator::InvalidOffset)
+			{
+				++failures;
+				// Keep the live set from draining, retry with a single descriptor
+				count = 1;
+				offset = allocator.Allocate(count);
+			}
+			if (offset != RangeAllocator::InvalidOffset)
+				live.push_back({ offset, count });
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+
+		double nanoseconds = std::chrono::duration<double, std::nano>(end - start).count() / Operations;
+		std::cout << std::setw(14) << name << ": " << nanoseconds << " ns per release and allocate, "
+			<< failures << " failed allocations, " << allocator.GetFreeCount() << " free at the end" << std::endl;
+	};
+
+	std::cout << std::fixed << std::setprecision(1);
+
+	ListRangeAllocator list(DescriptorHeapSize);
+	run("list", list);
+	RangeAllocator ranges(DescriptorHeapSize);
+	run("TLSF", ranges);
+}
+
+/// <summary>
+/// RangeAllocator behind a single lock, the baseline of the threaded descriptor benchmark.
+/// </summary>
+class LockedRangeAllocator
+{
+public:
+	LockedRangeAllocator(size_t size) : m_Ranges(size) {}
+
+	size_t Allocate(size_t count)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_Ranges.Allocate(count);
+	}
+
+	bool Release(size_t offset, size_t count)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_Ranges.Release(offset, count);
+	}
+
+	void FlushThreadCache() {}
+
+private:
+	std::mutex m_Mutex;
+	RangeAllocator m_Ranges;
+};
+
+// Mostly single descriptors like texture views, with the odd table
+template<typename Random>
+static size_t RandomThreadedDescriptorCount(Random& random)
+{
+	return random() % 10 == 0 ? 2 + random() % 7 : 1;
+}
+
+/// <summary>
+/// Runs threads that allocate and release descriptors at the same time, some released by
+/// another thread than the one that allocated them. Every slot has an owner flag that is
+/// set on allocation and cleared before release, a slot handed out twice finds it set.
+/// Everything released and flushed, the allocator has to be a single free range again.
+/// </summary>
+static bool RunConcurrentDescriptorStressTest(uint32_t threadCount)
+{
+	ConcurrentRangeAllocator allocator(DescriptorHeapSize);
+	std::vector<std::atomic<uint8_t>> owned(DescriptorHeapSize);
+	std::atomic<uint64_t> doubleAllocations = 0;
+	std::atomic<uint64_t> rejectedReleases = 0;
+
+	// Allocations passed between threads
+	std::mutex handoffMutex;
+	std::vector<std::pair<size_t, size_t>> handoff;
+
+	auto worker = [&](uint32_t threadIndex) {
+		std::mt19937 random(100 + threadIndex);
+		std::vector<std::pair<size_t, size_t>> live;
+		size_t target = DescriptorHeapSize * 3 / 4 / threadCount;
+
+		auto release = [&](std::pair<size_t, size_t> allocation) {
+			for (size_t slot = allocation.first; slot < allocation.first + allocation.second; slot++)
+				owned[slot].store(0);
+			if (!allocator.Release(allocation.first, allocation.second))
+				++rejectedReleases;
+		};
+
+		for (uint32_t step = 0; step < 100000; step++)
+		{
+			size_t used = 0;
+			for (auto& allocation : live)
+				used += allocation.second;
+
+			uint32_t roll = random() % 100;
+			if (roll < 3)
+			{
+				std::lock_guard<std::mutex> lock(handoffMutex);
+				if (!handoff.empty())
+				{
+					release(handoff.back());
+					handoff.pop_back();
+				}
+			}
+			else if (live.empty() || (used < target && roll < 60) || roll < 45)
+			{
+				size_t count = RandomThreadedDescriptorCount(random);
+				size_t offset = allocator.Allocate(count);
+				if (offset == ConcurrentRangeAllocator::InvalidOffset)
+					continue;
+
+				for (size_t slot = offset; slot < offset + count; slot++)
+				{
+					if (slot >= DescriptorHeapSize || owned[slot].exchange(1) != 0)
+						++doubleAllocations;
+				}
+				live.push_back({ offset, count });
+			}
+			else
+			{
+				size_t index = random() % live.size();
+				auto allocation = live[index];
+				live[index] = live.back();
+				live.pop_back();
+
+				if (roll < 50)
+				{
+					std::lock_guard<std::mutex> lock(handoffMutex);
+					handoff.push_back(allocation);
+				}
+				else
+				{
+					release(allocation);
+				}
+			}
+		}
+
+		for (auto& allocation : live)
+			release(allocation);
+		allocator.FlushThreadCache();
+	};
+
+	std::vector<std::thread> threads;
+	for (uint32_t t = 0; t < threadCount; t++)
+		threads.emplace_back(worker, t);
+	for (auto& thread : threads)
+		thread.join();
+
+	// The handoff leftovers go back through this thread's magazine
+	for (auto& allocation : handoff)
+	{
+		for (size_t slot = allocation.first; slot < allocation.first + allocation.second; slot++)
+			owned[slot].store(0);
+		allocator.Release(allocation.first, allocation.second);
+	}
+	allocator.FlushThreadCache();
+
+	const std::string check = "Concurrent descriptor stress test with " + std::to_string(threadCount) + " threads";
+
+	if (doubleAllocations > 0)
+		return Fail(check, std::to_string(doubleAllocations.load()) + " slots were handed out twice");
+	if (rejectedReleases > 0)
+		return Fail(check, std::to_string(rejectedReleases.load()) + " live ranges were rejected on release");
+	if (allocator.GetFreeCount() != DescriptorHeapSize || allocator.GetFreeRangeCount() != 1)
+		return Fail(check, "the heap did not coalesce back into a single range");
+
+	auto stats = allocator.GetStats();
+	std::cout << "Concurrent descriptor stress test passed with " << threadCount << " threads: "
+		<< stats.MagazineHits << " thread cache hits, " << stats.LockedOperations << " locked operations" << std::endl;
+	return true;
+}
+
+/// <summary>
+/// Runs more short-lived threads, one after the other, than the allocator has magazines. Each
+/// leaves slots in its magazine without flushing it: they have to go back when the thread
+/// exits, and the last threads still have to get a magazine of their own.
+/// </summary>
+static bool RunDescriptorThreadExitTest()
+{
+	static constexpr uint32_t Threads = ConcurrentRangeAllocator::MaxThreads * 3;
+
+	const char* check = "Descriptor thread exit test";
+
+	ConcurrentRangeAllocator allocator(DescriptorHeapSize);
+	for (uint32_t t = 0; t < Threads; t++)
+	{
+		std::thread([&allocator]() {
+			size_t kept = allocator.Allocate(1);
+			size_t released = allocator.Allocate(1);
+			allocator.Release(released, 1);
+			allocator.Release(kept, 1);
+		}).join();
+	}
+
+	if (allocator.GetFreeRangeCount() != 1 || allocator.GetLargestFreeRange() != DescriptorHeapSize)
+		return Fail(check, "the magazines of exited threads were not drained");
+
+	// Every allocation and release of every thread went through a magazine
+	auto stats = allocator.GetStats();
+	if (stats.MagazineHits != uint64_t(Threads) * 4)
+		return Fail(check, "threads past the first " + std::to_string(ConcurrentRangeAllocator::MaxThreads) + " took the locked path");
+
+	std::cout << "Descriptor thread exit test passed: " << Threads << " threads, "
+		<< stats.LockedOperations << " locked operations" << std::endl;
+	return true;
+}
+
+/// <summary>
+/// Two live threads share a heap that the magazines could hold entirely: the 10 slot DSV heap,
+/// and one just large enough to use magazines. The second thread has to get every slot the
+/// first one is not using, single slots and ranges, while the first still holds its magazine.
+/// </summary>
+static bool RunDescriptorSmallHeapTest()
+{
+	const char* check = "Descriptor small heap test";
+
+	for (size_t heapSize : { size_t(10), ConcurrentRangeAllocator::MinMagazineAllocatorSize })
+	{
+		ConcurrentRangeAllocator allocator(heapSize);
+		std::atomic<int> step = 0;
+		size_t held = RangeAllocator::InvalidOffset;
+
+		// Keeps one slot, and whatever its magazine took, until the other thread is done
+		std::thread holder([&]() {
+			held = allocator.Allocate(1);
+			step = 1;
+			while (step != 2)
+				std::this_thread::yield();
+			allocator.Release(held, 1);
+		});
+		while (step != 1)
+			std::this_thread::yield();
+
+		std::string heap = std::to_string(heapSize) + " slot heap";
+		if (held == RangeAllocator::InvalidOffset)
+		{
+			step = 2;
+			holder.join();
+			return Fail(check, "the first allocation of a " + heap + " failed");
+		}
+
+		std::vector<size_t> slots;
+		for (size_t i = 0; i + 1 < heapSize; i++)
+		{
+			size_t slot = allocator.Allocate(1);
+			if (slot == RangeAllocator::InvalidOffset)
+				break;
+			slots.push_back(slot);
+		}
+		bool full = allocator.Allocate(1) == RangeAllocator::InvalidOffset;
+
+		for (size_t slot : slots)
+			allocator.Release(slot, 1);
+		size_t range = allocator.Allocate(heapSize / 2);
+		if (range != RangeAllocator::InvalidOffset)
+			allocator.Release(range, heapSize / 2);
+
+		step = 2;
+		holder.join();
+		allocator.FlushThreadCache();
+
+		if (slots.size() != heapSize - 1)
+			return Fail(check, "only " + std::to_string(slots.size()) + " slots of a " + heap + " could be allocated while another thread held one");
+		if (!full)
+			return Fail(check, "a full " + heap + " handed out another slot");
+		if (range == RangeAllocator::InvalidOffset)
+			return Fail(check, "a range of a " + heap + " failed while its slots were free");
+		if (allocator.GetFreeRangeCount() != 1 || allocator.GetLargestFreeRange() != heapSize)
+			return Fail(check, "the " + heap + " did not coalesce back into a single range");
+	}
+
+	std::cout << "Descriptor small heap test passed" << std::endl;
+	return true;
+}
+
+/// <summary>
+/// Times release and allocate pairs from 1 to MaxBenchmarkThreads threads, each keeping its
+/// share of a heap around 75% full. The single lock against the per-thread magazines.
+/// </summary>
+static void RunConcurrentDescriptorBenchmark()
+{
+	static constexpr uint32_t OperationsPerThread = 200000;
+
+	auto run = [](const char* name, auto& allocator, uint32_t threadCount) {
+		auto worker = [&](uint32_t threadIndex) {
+			std::mt19937 random(200 + threadIndex);
+			std::vector<std::pair<size_t, size_t>> live;
+			size_t target = DescriptorHeapSize * 3 / 4 / threadCount;
+			for (size_t used = 0; used < target;)
+			{
+				size_t count = RandomThreadedDescriptorCount(random);
+				size_t offset = allocator.Allocate(count);
+				if (offset == RangeAllocator::InvalidOffset)
+					break;
+				live.push_back({ offset, count });
+				used += count;
+			}
+
+			for (uint32_t i = 0; i < OperationsPerThread && !live.empty(); i++)
+			{
+				size_t index = random() % live.size();
+				auto [offset, count] = live[index];
+				live[index] = live.back();
+				live.pop_back();
+				allocator.Release(offset, count);
+
+				count = RandomThreadedDescriptorCount(random);
+				offset = allocator.Allocate(count);
+				if (offset != RangeAllocator::InvalidOffset)
+					live.push_back({ offset, count });
+			}
+
+			for (auto [offset, count] : live)
+				allocator.Release(offset, count);
+			allocator.FlushThreadCache();
+		};
+
+		auto start = std::chrono::high_resolution_clock::now();
+		std::vector<std::thread> threads;
+		for (uint32_t t = 0; t < threadCount; t++)
+			threads.emplace_back(worker, t);
+		for (auto& thread : threads)
+			thread.join();
+		auto end = std::chrono::high_resolution_clock::now();
+
+		double seconds = std::chrono::duration<double>(end - start).count();
+		double operations = double(OperationsPerThread) * threadCount;
+		std::cout << std::setw(10) << name << std::setw(4) << threadCount << " threads: "
+			<< operations / seconds / 1e+6 << " M release and allocate pairs per second" << std::endl;
+	};
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << "Hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+	for (uint32_t threadCount = 1; threadCount <= MaxBenchmarkThreads; threadCount *= 2)
+	{
+		LockedRangeAllocator locked(DescriptorHeapSize);
+		run("locked", locked, threadCount);
+		ConcurrentRangeAllocator magazines(DescriptorHeapSize);
+		run("magazines", magazines, threadCount);
+	}
+}
+
+/// <summary>
+/// Stress tests the descriptor allocators, single threaded and with every thread count,
+/// then times them.
+/// </summary>
+bool RunDescriptorAllocatorBenchmark()
+{
+	if (!RunDescriptorStressTest() || !RunDescriptorThreadExitTest() || !RunDescriptorSmallHeapTest())
+		return false;
+	for (uint32_t threadCount = 1; threadCount <= MaxBenchmarkThreads; threadCount *= 2)
+	{
+		if (!RunConcurrentDescriptorStressTest(threadCount))
+			return false;
+	}
+	RunDescriptorBenchmark();
+	RunConcurrentDescriptorBenchmark();
+	return true;
+}
@@ -0,0 +1,67 @@
+#include "trpch.h"
+#include "Tests/SimulatorChecks.h"
+
+#include <chrono>
+#include <iomanip>
+#include <random>
+
+#include "TitaniumRose/Renderer/VirtualTexture/FeedbackReduction.h"
+
+using namespace Roses;
+
+/// <summary>
+/// Times every feedback reduction kernel the CPU supports on feedback maps of the sizes
+/// the renderer uses, filled like a texture seen at a distance: most cells unsampled and
+/// the rest spread over a few mips.
+/// </summary>
+bool RunReductionBenchmark()
+{
+	static constexpr uint32_t MipLevels = 13;
+
+	std::mt19937 random(42);
+	std::cout << std::fixed << std::setprecision(3);
+
+	for (uint32_t size : { 256u, 1024u })
+	{
+		std::vector<uint32_t> feedback(size_t(size) * size);
+		for (auto& cell : feedback)
+		{
+			cell = (random() % 2 == 0) ? MipLevels : 2 + random() % 4;
+		}
+		std::vector<uint8_t> compactFeedback(feedback.begin(), feedback.end());
+
+		// Roughly the same amount of work for both sizes
+		uint32_t iterations = (1u << 28) / static_cast<uint32_t>(feedback.size());
+
+		auto run = [&](const char* format, size_t cellSize, auto reduce) {
+			for (auto kernel : { FeedbackReductionKernel::Scalar, FeedbackReductionKernel::SSE41, FeedbackReductionKernel::AVX2 })
+			{
+				if (kernel > GetBestFeedbackReductionKernel())
+					continue;
+
+				uint32_t checksum = 0;
+				auto start = std::chrono::high_resolution_clock::now();
+				for (uint32_t i = 0; i < iterations; i++)
+				{
+					FeedbackReduction reduction = reduce(kernel);
+					checksum += reduction.FinestMip + reduction.MipHistogram[3];
+				}
+				auto end = std::chrono::high_resolution_clock::now();
+
+				double milliseconds = std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+				double gigabytesPerSecond = feedback.size() * cellSize / (milliseconds * 1e6);
+
+				std::cout << size << "x" << size << " " << format << " " << std::setw(7) << GetFeedbackReductionKernelName(kernel) << ": "
+					<< milliseconds << " ms, " << gigabytesPerSecond << " GB/s (checksum " << checksum << ")" << std::endl;
+			}
+		};
+
+		run("uint32", sizeof(uint32_t), [&](FeedbackReductionKernel kernel) {
+			return ReduceFeedback(feedback.data(), feedback.size(), MipLevels, kernel);
+		});
+		run(" uint8", sizeof(uint8_t), [&](FeedbackReductionKernel kernel) {
+			return ReduceFeedback(compactFeedback.data(), compactFeedback.size(), MipLevels, kernel);
+		});
+	}
+	return true;
+}
@@ -0,0 +1,104 @@
+#include "trpch.h"
+#include "Tests/SimulatorChecks.h"
+
+#include <random>
+
+#include "TitaniumRose/Renderer/VirtualTexture/FeedbackReduction.h"
+
+using namespace Roses;
+
+static bool operator==(const FeedbackReduction& a, const FeedbackReduction& b)
+{
+	return a.FinestMip == b.FinestMip && a.CoarsestMip == b.CoarsestMip && a.SampledCells == b.SampledCells && a.MipHistogram == b.MipHistogram;
+}
+
+/// <summary>
+/// Compares every feedback reduction kernel the CPU supports against the scalar one, for
+/// 32 bit and compact feedback: empty and single mip maps long enough that each byte counter
+/// passes the 255 iteration flush, then random maps whose widths are no multiple of the
+/// vector widths, with cells past the no sample value.
+/// </summary>
+bool RunReductionTest()
+{
+	const char* check = "Reduction test";
+
+	std::vector<FeedbackReductionKernel> kernels;
+	for (auto kernel : { FeedbackReductionKernel::SSE41, FeedbackReductionKernel::AVX2 })
+	{
+		if (kernel <= GetBestFeedbackReductionKernel())
+			kernels.push_back(kernel);
+	}
+
+	auto compare = [&](const std::vector<uint32_t>& feedback, uint32_t noSampleValue, const std::string& map) {
+		std::vector<uint8_t> compact(feedback.size());
+		for (size_t i = 0; i < feedback.size(); i++)
+			compact[i] = static_cast<uint8_t>(std::min<uint32_t>(feedback[i], UINT8_MAX));
+
+		FeedbackReduction expected = ReduceFeedback(feedback.data(), feedback.size(), noSampleValue, FeedbackReductionKernel::Scalar);
+		if (!(ReduceFeedback(compact.data(), compact.size(), noSampleValue, FeedbackReductionKernel::Scalar) == expected))
+			return Fail(check, "the scalar kernel read compact feedback differently for " + map);
+
+		for (auto kernel : kernels)
+		{
+			std::string name = GetFeedbackReductionKernelName(kernel);
+			if (!(ReduceFeedback(feedback.data(), feedback.size(), noSampleValue, kernel) == expected))
+				return Fail(check, name + " differed from the scalar kernel on 32 bit feedback for " + map);
+			if (!(ReduceFeedback(compact.data(), compact.size(), noSampleValue, kernel) == expected))
+				return Fail(check, name + " differed from the scalar kernel on compact feedback for " + map);
+		}
+		return true;
+	};
+
+	// Three byte counter flushes of the widest kernel and a tail
+	const size_t longCount = 255 * 32 * 3 + 5;
+	std::vector<uint32_t> feedback(longCount, 13);
+	FeedbackReduction empty = ReduceFeedback(feedback.data(), feedback.size(), 13, FeedbackReductionKernel::Scalar);
+	if (empty.FinestMip != 13 || empty.CoarsestMip != 0 || empty.SampledCells != 0)
+		return Fail(check, "an unsampled map was not reported as empty");
+	if (!compare(feedback, 13, "an unsampled map"))
+		return false;
+
+	std::fill(feedback.begin(), feedback.end(), 4u);
+	FeedbackReduction single = ReduceFeedback(feedback.data(), feedback.size(), 13, FeedbackReductionKernel::Scalar);
+	if (single.FinestMip != 4 || single.CoarsestMip != 4 || single.SampledCells != longCount || single.MipHistogram[4] != longCount)
+		return Fail(check, "a single mip map was not counted cell by cell");
+	if (!compare(feedback, 13, "a single mip map"))
+		return false;
+
+	// Random maps, one in four cells is unsampled and a few are past the no sample value
+	std::mt19937 rng(37);
+	uint32_t maps = 0;
+	uint64_t cells = 0;
+	for (uint32_t iteration = 0; iteration < 400; iteration++)
+	{
+		uint32_t width = 1 + rng() % 97;
+		uint32_t height = 1 + rng() % (iteration % 4 == 0 ? 300 : 8);
+		uint32_t noSampleValue = 1 + rng() % MaxFeedbackMips;
+		uint32_t finest = rng() % noSampleValue;
+
+		feedback.resize(size_t(width) * height);
+		for (auto& cell : feedback)
+		{
+			uint32_t roll = rng() % 16;
+			if (roll < 4)
+				cell = noSampleValue;
+			else if (roll == 4)
+				cell = noSampleValue + rng() % 300;
+			else
+				cell = finest + rng() % (noSampleValue - finest);
+		}
+
+		if (!compare(feedback, noSampleValue, std::to_string(width) + "x" + std::to_string(height) + " map " + std::to_string(iteration)))
+			return false;
+		maps++;
+		cells += feedback.size();
+	}
+
+	std::cout << "Reduction test passed, " << maps << " random maps with " << cells << " cells matched the scalar kernel with";
+	for (auto kernel : kernels)
+		std::cout << " " << GetFeedbackReductionKernelName(kernel);
+	if (kernels.empty())
+		std::cout << " no vector kernel supported";
+	std::cout << std::endl;
+	return true;
+}
@@ -0,0 +1,95 @@
+#include "trpch.h"
+#include "Tests/SimulatorChecks.h"
+
+#include <iomanip>
+#include <random>
+
+#include "TitaniumRose/Core/FramePipeline.h"
+
+using namespace Roses;
+
+/// <summary>
+/// Checks the frame pipeline: slots are reused in order, a frame only waits for the frame
+/// that used its slot before, and never more frames than slots are in flight. Then replays
+/// frames with varying CPU and GPU times to compare the frame rate against draining the GPU
+/// every frame.
+/// </summary>
+bool RunFramePipelineTest()
+{
+	const char* check = "Frame pipeline test";
+
+	static constexpr uint32_t Slots = 3;
+
+	uint64_t completed = 0;
+	uint64_t waitedFor = 0;
+	auto isComplete = [&](uint64_t value) { return value <= completed; };
+	auto wait = [&](uint64_t value) { waitedFor = value; completed = std::max(completed, value); };
+
+	FramePipeline pipeline(Slots);
+	for (uint64_t frame = 0; frame < Slots; frame++)
+	{
+		if (pipeline.BeginFrame(isComplete, wait) != frame)
+			return Fail(check, "the slots were not used in order");
+		pipeline.EndFrame(frame + 1);
+	}
+	if (waitedFor != 0 || pipeline.GetFramesInFlight(isComplete) != Slots)
+		return Fail(check, "a frame waited before every slot was in flight");
+
+	if (pipeline.BeginFrame(isComplete, wait) != 0 || waitedFor != 1)
+		return Fail(check, "a frame did not wait for the frame that used its slot");
+	pipeline.EndFrame(4);
+
+	completed = 3;
+	if (pipeline.BeginFrame(isComplete, wait) != 1 || waitedFor != 1 || pipeline.GetStats().Waits != 1)
+		return Fail(check, "a frame waited for a slot the GPU was done with");
+	pipeline.EndFrame(5);
+	if (pipeline.GetLastFence() != 5 || pipeline.GetFrameIndex() != 5 || pipeline.GetFramesInFlight(isComplete) != 2)
+		return Fail(check, "the frame count or the fences in flight are wrong");
+
+	// Frames with a varying CPU and GPU cost in milliseconds. The GPU runs the frames in
+	// order, each starts once the CPU submitted it and the GPU finished the previous one
+	static constexpr uint32_t Frames = 2000;
+
+	std::mt19937 random(23);
+	std::uniform_real_distribution<double> cpuCost(4.0, 9.0);
+	std::uniform_real_distribution<double> gpuCost(5.0, 10.0);
+	std::vector<std::pair<double, double>> costs(Frames);
+	for (auto& cost : costs)
+		cost = { cpuCost(random), gpuCost(random) };
+
+	double serialized = 0.0;
+	for (auto& cost : costs)
+		serialized += cost.first + cost.second;
+
+	FramePipeline frames(Slots);
+	std::vector<double> gpuDone(Frames + 1, 0.0);
+	double now = 0.0;
+	double gpuFree = 0.0;
+	uint32_t maxInFlight = 0;
+	auto frameComplete = [&](uint64_t value) { return gpuDone[value] <= now; };
+	auto frameWait = [&](uint64_t value) { now = std::max(now, gpuDone[value]); };
+	for (uint32_t frame = 0; frame < Frames; frame++)
+	{
+		frames.BeginFrame(frameComplete, frameWait);
+		now += costs[frame].first;
+
+		uint64_t fence = frame + 1;
+		gpuFree = std::max(gpuFree, now) + costs[frame].second;
+		gpuDone[fence] = gpuFree;
+		frames.EndFrame(fence);
+
+		maxInFlight = std::max(maxInFlight, frames.GetFramesInFlight(frameComplete));
+	}
+	if (maxInFlight > Slots)
+		return Fail(check, "more frames than slots were in flight");
+
+	double pipelined = gpuFree;
+	if (pipelined >= serialized)
+		return Fail(check, "pipelining did not make the frames faster");
+
+	std::cout << "Frame pipeline test passed: " << Frames << " frames with " << Slots << " slots took "
+		<< pipelined / 1000.0 << " s (" << Frames * 1000.0 / pipelined << " FPS), " << frames.GetStats().Waits
+		<< " frames waited for their slot. Draining the GPU every frame would have taken " << serialized / 1000.0
+		<< " s (" << Frames * 1000.0 / serialized << " FPS)" << std::endl;
+	return true;
+}
@@ -0,0 +1,241 @@
+#include "trpch.h"
+#include "Tests/SimulatorChecks.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <random>
+#include <thread>
+
+#include "TitaniumRose/Core/JobSystem.h"
+#include "TitaniumRose/Core/WorkStealingDeque.h"
+
+using namespace Roses;
+
+/// <summary>
+/// Checks the work stealing deque against thieves, and the job system's counters,
+/// dependencies, nested waits and ParallelFor, with a few worker counts.
+/// </summary>
+bool RunJobSystemTest()
+{
+	const char* check = "Job system test";
+
+	// The owner works at the bottom, thieves at the top, and the ring grows past its capacity
+	{
+		WorkStealingDeque<uint32_t> deque(4);
+		for (uint32_t i = 0; i < 10; i++)
+			deque.Push(i);
+		if (deque.GetCapacity() < 10 || deque.GetSize() != 10)
+			return Fail(check, "the deque did not grow");
+
+		uint32_t item;
+		if (!deque.Steal(item) || item != 0)
+			return Fail(check, "a thief did not take the oldest item");
+		if (!deque.Pop(item) || item != 9)
+			return Fail(check, "the owner did not take the newest item");
+		while (deque.Pop(item)) {}
+		if (deque.Steal(item) || deque.GetSize() != 0)
+			return Fail(check, "an empty deque handed out an item");
+	}
+
+	// Thieves race the owner, every item has to be taken exactly once
+	{
+		static constexpr uint32_t Items = 200000;
+		static constexpr uint32_t Thieves = 3;
+		WorkStealingDeque<uint32_t> deque(16);
+		std::vector<std::atomic<uint32_t>> taken(Items);
+		std::atomic<bool> pushing = true;
+
+		std::vector<std::thread> thieves;
+		for (uint32_t t = 0; t < Thieves; t++)
+		{
+			thieves.emplace_back([&]() {
+				uint32_t item;
+				while (pushing.load() || deque.GetSize() > 0)
+				{
+					if (deque.Steal(item))
+						taken[item].fetch_add(1);
+				}
+			});
+		}
+
+		uint32_t item;
+		for (uint32_t i = 0; i < Items; i++)
+		{
+			deque.Push(i);
+			if (i % 3 == 0 && deque.Pop(item))
+				taken[item].fetch_add(1);
+		}
+		while (deque.Pop(item))
+			taken[item].fetch_add(1);
+		pushing.store(false);
+		for (auto& thief : thieves)
+			thief.join();
+
+		for (uint32_t i = 0; i < Items; i++)
+		{
+			if (taken[i].load() != 1)
+				return Fail(check, "item " + std::to_string(i) + " was taken " + std::to_string(taken[i].load()) + " times");
+		}
+	}
+
+	for (uint32_t workers : { 1u, 2u, 4u })
+	{
+		JobSystemDesc desc;
+		desc.WorkerCount = workers;
+		desc.PinWorkers = workers == 2;
+		JobSystem jobs(desc);
+		std::string suffix = " with " + std::to_string(workers) + " workers";
+
+		// Many small jobs against one counter
+		{
+			static constexpr uint32_t Jobs = 10000;
+			std::atomic<uint32_t> ran = 0;
+			JobCounter counter;
+			for (uint32_t i = 0; i < Jobs; i++)
+				jobs.Schedule([&ran]() { ran.fetch_add(1); }, &counter);
+			jobs.Wait(counter);
+			if (ran.load() != Jobs || !counter.IsDone())
+				return Fail(check, "not every job ran" + suffix);
+		}
+
+		// A chain of stages, every stage only starts once the one before finished
+		{
+			static constexpr uint32_t Stages = 4;
+			static constexpr uint32_t JobsPerStage = 50;
+			std::vector<std::unique_ptr<JobCounter>> counters;
+			std::vector<std::atomic<uint32_t>> finished(Stages);
+			std::atomic<bool> early = false;
+			for (uint32_t stage = 0; stage < Stages; stage++)
+				counters.push_back(std::make_unique<JobCounter>());
+
+			// The first stage is still running while the later ones are scheduled, so they get parked
+			for (uint32_t stage = 0; stage < Stages; stage++)
+			{
+				JobCounter* dependency = stage > 0 ? counters[stage - 1].get() : nullptr;
+				for (uint32_t i = 0; i < JobsPerStage; i++)
+				{
+					jobs.Schedule([&, stage]() {
+						if (stage > 0 && finished[stage - 1].load() != JobsPerStage)
+							early.store(true);
+						std::this_thread::sleep_for(std::chrono::microseconds(20));
+						finished[stage].fetch_add(1);
+					}, counters[stage].get(), dependency);
+				}
+			}
+
+			jobs.Wait(*counters[Stages - 1]);
+			for (uint32_t stage = 0; stage < Stages - 1; stage++)
+				jobs.Wait(*counters[stage]);
+			if (early.load())
+				return Fail(check, "a job ran before its dependency" + suffix);
+			for (auto& count : finished)
+			{
+				if (count.load() != JobsPerStage)
+					return Fail(check, "a stage did not run every job" + suffix);
+			}
+		}
+
+		// Jobs that schedule and wait on jobs of their own, which only works because waits help
+		{
+			std::atomic<uint32_t> leaves = 0;
+			JobCounter outer;
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				jobs.Schedule([&]() {
+					JobCounter inner;
+					for (uint32_t k = 0; k < 16; k++)
+						jobs.Schedule([&leaves]() { leaves.fetch_add(1); }, &inner);
+					jobs.Wait(inner);
+				}, &outer);
+			}
+			jobs.Wait(outer);
+			if (leaves.load() != 16 * 16)
+				return Fail(check, "nested jobs were lost" + suffix);
+		}
+
+		// ParallelFor covers every index exactly once, whatever the count
+		for (size_t count : { size_t(0), size_t(1), size_t(7), size_t(1000), size_t(100003) })
+		{
+			std::vector<std::atomic<uint8_t>> hits(count);
+			jobs.ParallelFor(count, 16, [&hits](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++)
+					hits[i].fetch_add(1);
+			});
+			for (size_t i = 0; i < count; i++)
+			{
+				if (hits[i].load() != 1)
+					return Fail(check, "ParallelFor missed or repeated an index of " + std::to_string(count) + suffix);
+			}
+		}
+	}
+
+	std::cout << "Job system test passed" << std::endl;
+	return true;
+}
+
+/// <summary>
+/// Times a ParallelFor over a compute bound kernel and a flood of tiny jobs from 1 to
+/// MaxBenchmarkThreads threads, the speedup is against the kernel run on the calling thread.
+/// </summary>
+bool RunJobSystemBenchmark()
+{
+	static constexpr size_t Items = 1 << 20;
+	static constexpr uint32_t TinyJobs = 100000;
+
+	std::vector<float> input(Items);
+	std::vector<float> output(Items);
+	std::mt19937 random(24);
+	std::uniform_real_distribution<float> value(0.0f, 1.0f);
+	for (auto& v : input)
+		v = value(random);
+
+	auto kernel = [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++)
+		{
+			float x = input[i];
+			for (int k = 0; k < 32; k++)
+				x = x * 0.999f + std::sqrt(x + 1.0f) * 0.001f;
+			output[i] = x;
+		}
+	};
+
+	auto time = [](auto&& fn) {
+		double best = std::numeric_limits<double>::max();
+		for (int run = 0; run < 3; run++)
+		{
+			auto start = std::chrono::high_resolution_clock::now();
+			fn();
+			best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+		}
+		return best;
+	};
+
+	double serial = time([&]() { kernel(0, Items); });
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << "Hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+	std::cout << "Kernel on the calling thread: " << serial << " ms" << std::endl;
+	for (uint32_t threadCount = 2; threadCount <= MaxBenchmarkThreads; threadCount *= 2)
+	{
+		JobSystemDesc desc;
+		desc.WorkerCount = threadCount - 1;
+		JobSystem jobs(desc);
+
+		double parallel = time([&]() { jobs.ParallelFor(Items, 1024, kernel); });
+		double tiny = time([&]() {
+			JobCounter counter;
+			std::atomic<uint32_t> ran = 0;
+			for (uint32_t i = 0; i < TinyJobs; i++)
+				jobs.Schedule([&ran]() { ran.fetch_add(1, std::memory_order_relaxed); }, &counter);
+			jobs.Wait(counter);
+		});
+
+		auto stats = jobs.GetStats();
+		std::cout << std::setw(4) << threadCount << " threads: ParallelFor " << parallel << " ms (" << serial / parallel
+			<< "x), " << TinyJobs / tiny / 1e+3 << " M tiny jobs per second, "
+			<< stats.Steals << " steals" << std::endl;
+	}
+	return true;
+}
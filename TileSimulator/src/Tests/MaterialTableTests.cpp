@@ -0,0 +1,146 @@
+#include "trpch.h"
+#include "Tests/SimulatorChecks.h"
+
+#include <cstring>
+#include <iomanip>
+#include <random>
+
+#include "TitaniumRose/Renderer/MaterialTable.h"
+
+using namespace Roses;
+
+/// <summary>
+/// Checks the bindless material table: an index stays the same while its material is
+/// registered, is only reused after the reuse delay, the lowest free index goes first, and
+/// only changed materials are uploaded, neighbouring ones in one copy. Then replays a scene
+/// whose materials come and go to report how much of the table is uploaded per frame.
+/// </summary>
+bool RunMaterialTableTest()
+{
+	const char* check = "Material table test";
+	auto owner = [](uintptr_t id) { return reinterpret_cast<const void*>(id); };
+
+	// Index stability
+	static constexpr uint32_t ReuseDelay = 3;
+	MaterialTable table(8, ReuseDelay);
+	for (uintptr_t id = 1; id <= 8; id++)
+	{
+		if (table.Register(owner(id)) != id - 1)
+			return Fail(check, "indices were not handed out in order");
+	}
+	if (table.Register(owner(3)) != 2 || table.Find(owner(3)) != 2)
+		return Fail(check, "registering a material twice changed its index");
+	if (table.Register(owner(9)) != MaterialTable::InvalidIndex)
+		return Fail(check, "a full table handed out an index");
+
+	if (!table.Unregister(owner(6)) || !table.Unregister(owner(2)) || table.Unregister(owner(2)))
+		return Fail(check, "unregistering did not find the material exactly once");
+	if (table.Find(owner(2)) != MaterialTable::InvalidIndex || table.GetCount() != 6)
+		return Fail(check, "an unregistered material kept its index");
+	for (uint32_t frame = 0; frame + 1 < ReuseDelay; frame++)
+	{
+		table.EndFrame();
+		if (table.Register(owner(10)) != MaterialTable::InvalidIndex)
+			return Fail(check, "an index was reused before the reuse delay");
+	}
+	table.EndFrame();
+	if (table.Register(owner(10)) != 1 || table.Register(owner(11)) != 5)
+		return Fail(check, "the lowest free index was not reused first");
+	for (uintptr_t id : { 1, 3, 4, 5, 7, 8 })
+	{
+		if (table.Find(owner(id)) != id - 1)
+			return Fail(check, "reusing an index moved another material");
+	}
+
+	// Packing and dirty tracking
+	MaterialTable packing(64, ReuseDelay);
+	for (uintptr_t id = 0; id < 64; id++)
+		packing.Register(owner(id + 1));
+
+	std::vector<GpuMaterial> gpuTable(64);
+	auto upload = [&](MaterialTable& source) {
+		std::vector<std::pair<uint32_t, uint32_t>> runs;
+		source.FlushDirty([&](uint32_t first, uint32_t count, const GpuMaterial* materials) {
+			std::memcpy(&gpuTable[first], materials, count * sizeof(GpuMaterial));
+			runs.emplace_back(first, count);
+		});
+		return runs;
+	};
+	if (upload(packing) != std::vector<std::pair<uint32_t, uint32_t>>{ { 0, 64 } })
+		return Fail(check, "newly registered materials were not uploaded in one copy");
+	if (!upload(packing).empty())
+		return Fail(check, "a clean table uploaded materials");
+
+	GpuMaterial material;
+	material.Color = { 0.25f, 0.5f, 1.0f };
+	material.AlbedoTexture = 17;
+	material.Roughness = 0.8f;
+	if (!packing.Set(10, material) || packing.Set(10, material))
+		return Fail(check, "setting the same material twice changed it twice");
+	material.NormalTexture = 18;
+	packing.Set(12, material);
+	packing.Set(40, material);
+	auto runs = upload(packing);
+	if (runs != std::vector<std::pair<uint32_t, uint32_t>>{ { 10, 3 }, { 40, 1 } })
+		return Fail(check, "dirty materials were not packed into the expected runs");
+	for (uint32_t i = 0; i < 64; i++)
+	{
+		if (gpuTable[i] != packing.Get(i))
+			return Fail(check, "the uploaded table does not match the CPU table");
+	}
+	if (gpuTable[12].NormalTexture != 18 || gpuTable[11].AlbedoTexture != GpuMaterial::NoTexture)
+		return Fail(check, "a material was packed into the wrong slot");
+
+	// Churn: a scene of 512 materials where a few change every frame and a few are replaced
+	static constexpr uint32_t Materials = 512;
+	static constexpr uint32_t Frames = 1000;
+	MaterialTable scene(1024, ReuseDelay);
+	gpuTable.assign(1024, GpuMaterial());
+	std::vector<uintptr_t> owners(Materials);
+	uintptr_t nextOwner = 1;
+	for (uintptr_t& o : owners)
+		o = nextOwner++;
+	std::mt19937 random(7);
+	uint64_t uploaded = 0;
+	uint64_t copies = 0;
+
+	for (uint32_t frame = 0; frame < Frames; frame++)
+	{
+		for (uint32_t i = 0; i < 2; i++)
+		{
+			uintptr_t& o = owners[random() % Materials];
+			scene.Unregister(owner(o));
+			o = nextOwner++;
+		}
+
+		for (uint32_t m = 0; m < Materials; m++)
+		{
+			uint32_t index = scene.Register(owner(owners[m]));
+			if (index == MaterialTable::InvalidIndex)
+				return Fail(check, "the scene ran out of material indices");
+
+			GpuMaterial sceneMaterial;
+			sceneMaterial.AlbedoTexture = static_cast<uint32_t>(owners[m] % 1000);
+			// A few materials are animated
+			sceneMaterial.Roughness = m % 64 == 0 ? float(frame % 100) / 100.0f : 0.5f;
+			scene.Set(index, sceneMaterial);
+		}
+
+		uint64_t before = scene.GetStats().UploadedMaterials;
+		copies += upload(scene).size();
+		uploaded += scene.GetStats().UploadedMaterials - before;
+		scene.EndFrame();
+	}
+
+	for (uint32_t m = 0; m < Materials; m++)
+	{
+		uint32_t index = scene.Find(owner(owners[m]));
+		if (gpuTable[index] != scene.Get(index) || gpuTable[index].AlbedoTexture != owners[m] % 1000)
+			return Fail(check, "the uploaded scene table does not match its materials");
+	}
+
+	std::cout << "Material table test passed: " << scene.GetUsedCount() << " of " << scene.GetCapacity()
+		<< " indices used for " << Materials << " materials, " << float(uploaded) / Frames << " materials in "
+		<< float(copies) / Frames << " copies uploaded per frame" << std::endl;
+	return true;
+}
@@ -0,0 +1,110 @@
+#include "trpch.h"
+#include "Tests/SimulatorChecks.h"
+
+#include <cmath>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "TitaniumRose/Renderer/VirtualTexture/MipEstimation.h"
+
+using namespace Roses;
+
+static std::string DescribeMips(const MipEstimate& estimate)
+{
+	return "mips " + std::to_string(estimate.FinestMip) + " to " + std::to_string(estimate.CoarsestMip);
+}
+
+/// <summary>
+/// Checks the mips estimated for a floor quad whose mips were worked out by hand, the same
+/// quad given in scaled object space, a quad facing the camera, a mesh without UVs and
+/// bounds outside the view, then the error statistics against the feedback.
+/// </summary>
+bool RunMipEstimationTest()
+{
+	const char* check = "Mip estimation test";
+
+	// A 90 degree field of view on a square viewport is 512 pixels per world unit at depth 1
+	MipEstimateView view;
+	view.ViewProjection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 100.0f);
+	view.ViewportWidth = 1024.0f;
+	view.ViewportHeight = 1024.0f;
+
+	// A 1x6 floor quad half a unit below the camera, from depth 2 to depth 8. Three quarters
+	// of a 2048x2048 texture over 6 units of surface is 2^19 texels per world area, and the
+	// mip at depth d is half the log2 of 2^19 / (512 / d)^2, 0.5 + log2(d). That is 1.5 at
+	// the near edge and 3.5 at the far one, so the finest mip rounds down to 1 and the
+	// coarsest rounds up to 4.
+	MipEstimateInput floor;
+	floor.BoundsMin = glm::vec3(-0.5f, -0.5f, -8.0f);
+	floor.BoundsMax = glm::vec3(0.5f, -0.5f, -2.0f);
+	floor.SurfaceArea = 6.0f;
+	floor.UVArea = 0.75f;
+	floor.TextureWidth = 2048;
+	floor.TextureHeight = 2048;
+	floor.MipLevels = 12;
+
+	MipEstimate estimate = EstimateMips(floor, view);
+	if (!estimate.Valid || !estimate.Visible || estimate.FinestMip != 1 || estimate.CoarsestMip != 4)
+		return Fail(check, "the floor quad was given " + DescribeMips(estimate) + " instead of 1 to 4");
+
+	// The same quad at half its size in object space, scaled by 2
+	MipEstimateInput scaled = floor;
+	scaled.LocalToWorld = glm::scale(glm::mat4(1.0f), glm::vec3(2.0f));
+	scaled.BoundsMin = floor.BoundsMin * 0.5f;
+	scaled.BoundsMax = floor.BoundsMax * 0.5f;
+	scaled.SurfaceArea = floor.SurfaceArea * 0.25f;
+	estimate = EstimateMips(scaled, view);
+	if (estimate.FinestMip != 1 || estimate.CoarsestMip != 4)
+		return Fail(check, "the scaled floor quad was given " + DescribeMips(estimate) + " instead of 1 to 4");
+
+	// A unit quad facing the camera at depth 2 spans a quarter of the view in each direction,
+	// 256x256 pixels. Its 2^19 texels per world area give 0.5 * log2(2^19 / 256^2) = 1.5 at
+	// every point of it, the finest mip rounds down to 1 and the coarsest up to 2.
+	MipEstimateInput facing;
+	facing.LocalToWorld = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -2.0f));
+	facing.BoundsMin = glm::vec3(-0.5f, -0.5f, 0.0f);
+	facing.BoundsMax = glm::vec3(0.5f, 0.5f, 0.0f);
+	facing.SurfaceArea = 1.0f;
+	facing.UVArea = 1.0f;
+	facing.TextureWidth = 1024;
+	facing.TextureHeight = 512;
+	facing.MipLevels = 10;
+	estimate = EstimateMips(facing, view);
+	if (std::abs(estimate.ScreenArea - 256.0f * 256.0f) > 1.0f)
+		return Fail(check, "the facing quad covered " + std::to_string(estimate.ScreenArea) + " pixels instead of 65536");
+	if (estimate.FinestMip != 1 || estimate.CoarsestMip != 2)
+		return Fail(check, "the facing quad was given " + DescribeMips(estimate) + " instead of 1 to 2");
+
+	// Nothing to estimate from, every mip is kept
+	MipEstimateInput noUVs = floor;
+	noUVs.UVArea = 0.0f;
+	estimate = EstimateMips(noUVs, view);
+	if (estimate.Valid || estimate.FinestMip != 0 || estimate.CoarsestMip != floor.MipLevels - 1)
+		return Fail(check, "a mesh without UVs was given " + DescribeMips(estimate) + " instead of every mip");
+
+	// Behind the camera, off to the side and past the far plane only need the coarsest mip
+	const glm::vec3 outsideOffsets[] = { { 0.0f, 0.0f, 12.0f }, { -100.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, -200.0f } };
+	for (const glm::vec3& offset : outsideOffsets)
+	{
+		MipEstimateInput outside = floor;
+		outside.LocalToWorld = glm::translate(glm::mat4(1.0f), offset);
+		estimate = EstimateMips(outside, view);
+		if (estimate.Visible || estimate.FinestMip != floor.MipLevels - 1 || estimate.CoarsestMip != floor.MipLevels - 1)
+			return Fail(check, "a quad outside the view was given " + DescribeMips(estimate) + " instead of the coarsest mip");
+	}
+
+	// Error statistics, one exact estimate, one too coarse by 1 and two too fine by 2 and 1
+	MipEstimateErrorStats stats;
+	stats.Add(3, 3);
+	stats.Add(4, 3);
+	stats.Add(1, 3);
+	stats.Add(2, 3);
+	if (stats.Samples != 4 || stats.AbsoluteErrorSum != 4 || stats.Exact != 1 || stats.WithinOne != 3 ||
+		stats.TooCoarse != 1 || stats.TooFine != 2 || stats.MeanAbsoluteError() != 1.0)
+		return Fail(check, "the error statistics were miscounted");
+	if (MipEstimateErrorStats().MeanAbsoluteError() != 0.0)
+		return Fail(check, "the error of no samples was not 0");
+
+	std::cout << "Mip estimation test passed" << std::endl;
+	return true;
+}
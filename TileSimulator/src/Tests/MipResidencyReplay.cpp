@@ -0,0 +1,190 @@
+#include "trpch.h"
+#include "Tests/SimulatorChecks.h"
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <random>
+
+#include "TitaniumRose/Renderer/VirtualTexture/MipResidency.h"
+#include "TitaniumRose/Renderer/VirtualTexture/TilePoolCore.h"
+
+#include "SimulatedTiling.h"
+
+using namespace Roses;
+
+struct ReplayTexture
+{
+	VirtualTextureLayout Layout;
+	// Textures with no amplitude keep the same mips the whole replay
+	float BaseMip;
+	float Amplitude;
+	float Period;
+	float Phase;
+	uint32_t Span;
+
+	// The mapped tiles of every standard mip for the sweep the pool did before MipResidency
+	std::vector<std::vector<uint8_t>> SweepTiles;
+};
+
+struct ReplayPathStats
+{
+	uint64_t TilesMapped = 0;
+	uint64_t TilesUnmapped = 0;
+	uint64_t TilesVisited = 0;
+	uint64_t TexturesTouched = 0;
+	uint64_t TilesResident = 0;
+	double Milliseconds = 0.0;
+};
+
+// The standard mips a texture asks for in a frame, like a camera moving back and forth
+static void GetReplayMips(const ReplayTexture& texture, uint32_t frame, uint32_t& finestMip, uint32_t& coarsestMip)
+{
+	float distance = texture.BaseMip + texture.Amplitude * std::sin(6.2831853f * (frame / texture.Period + texture.Phase));
+	finestMip = std::min(static_cast<uint32_t>(std::max(std::lround(distance), 0l)), texture.Layout.MipLevels - 1);
+	coarsestMip = std::min(finestMip + texture.Span, texture.Layout.MipLevels - 1);
+}
+
+// What MapTexture did before it kept the resident range: every frame it null-maps the mips
+// finer than the finest used one, maps the used ones and null-maps the rest except the mip
+// right after the coarsest used one, visiting every tile of each
+static void SweepMips(ReplayTexture& texture, uint32_t finestMip, uint32_t coarsestMip, ReplayPathStats& stats)
+{
+	const uint32_t numStandardMips = static_cast<uint32_t>(texture.Layout.MipGrids.size());
+
+	auto visit = [&](uint32_t mip, bool map) {
+		for (auto& tile : texture.SweepTiles[mip])
+		{
+			stats.TilesVisited++;
+			if (tile != uint8_t(map))
+			{
+				tile = uint8_t(map);
+				(map ? stats.TilesMapped : stats.TilesUnmapped)++;
+			}
+		}
+	};
+
+	uint32_t unmapEnd = (finestMip >= numStandardMips && numStandardMips != 0) ? numStandardMips - 1 : finestMip;
+	for (uint32_t mip = 0; mip < unmapEnd; mip++)
+		visit(mip, false);
+
+	uint32_t mapEnd = (coarsestMip >= numStandardMips && numStandardMips != 0) ? numStandardMips : coarsestMip + 1;
+	for (uint32_t mip = finestMip; mip < mapEnd; mip++)
+		visit(mip, true);
+
+	for (uint32_t mip = mapEnd + 1; mip < numStandardMips; mip++)
+		visit(mip, false);
+
+	stats.TexturesTouched++;
+}
+
+/// <summary>
+/// Replays a few hundred frames of 128 textures whose mips drift with the camera, a quarter of
+/// them standing still, through the per frame sweep the pool used before and through
+/// TilePoolCore with MakeResidentRange and DiffMipRanges. Reports the tiles each path mapped,
+/// unmapped and visited, and checks the pool ends up with exactly the requested mips resident.
+/// </summary>
+bool RunMipResidencyReplay()
+{
+	const char* check = "Mip residency replay";
+
+	static constexpr uint32_t NumTextures = 128;
+	static constexpr uint32_t NumFrames = 300;
+
+	std::mt19937 rng(3);
+	std::vector<ReplayTexture> textures(NumTextures);
+	for (auto& texture : textures)
+	{
+		uint32_t width = 1024u << (rng() % 4);
+		uint32_t height = rng() % 3 == 0 ? width / 2 : width;
+		uint32_t mipLevels = 1;
+		while ((std::max(width, height) >> mipLevels) > 0)
+			mipLevels++;
+
+		texture.Layout = MakeLayout(width, height, mipLevels);
+		texture.BaseMip = 1.0f + float(rng() % 4);
+		texture.Amplitude = rng() % 4 == 0 ? 0.0f : 0.5f + float(rng() % 3);
+		texture.Period = 60.0f + float(rng() % 240);
+		texture.Phase = float(rng() % 100) / 100.0f;
+		texture.Span = 1 + rng() % 3;
+		for (auto& grid : texture.Layout.MipGrids)
+			texture.SweepTiles.emplace_back(size_t(grid.Width) * grid.Height, uint8_t(0));
+	}
+
+	// Before
+	ReplayPathStats sweep;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (uint32_t frame = 0; frame < NumFrames; frame++)
+	{
+		for (auto& texture : textures)
+		{
+			uint32_t finestMip, coarsestMip;
+			GetReplayMips(texture, frame, finestMip, coarsestMip);
+			SweepMips(texture, finestMip, coarsestMip, sweep);
+		}
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	sweep.Milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+
+	// After
+	NullMappingBackend backend;
+	TilePoolCore pool(backend, TilesPerPage);
+	ReplayPathStats ranges;
+	start = std::chrono::high_resolution_clock::now();
+	for (uint32_t frame = 0; frame < NumFrames; frame++)
+	{
+		for (auto& texture : textures)
+		{
+			TextureResidencyRequest request;
+			GetReplayMips(texture, frame, request.FinestMip, request.CoarsestMip);
+			pool.MapTexture(&texture, texture.Layout, request);
+		}
+		pool.FlushUpdates();
+
+		auto& flush = pool.GetLastFlushStats();
+		ranges.TilesMapped += flush.TilesMapped;
+		ranges.TilesUnmapped += flush.TilesUnmapped;
+		ranges.TexturesTouched += flush.TexturesUpdated;
+	}
+	end = std::chrono::high_resolution_clock::now();
+	ranges.Milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+
+	// Both against the mips asked for in the last frame
+	uint64_t tilesRequested = 0;
+	for (auto& texture : textures)
+	{
+		uint32_t finestMip, coarsestMip;
+		GetReplayMips(texture, NumFrames - 1, finestMip, coarsestMip);
+		MipRange range = MakeResidentRange(finestMip, coarsestMip, static_cast<uint32_t>(texture.Layout.MipGrids.size()));
+
+		uint64_t textureTiles = 0;
+		for (uint32_t mip = range.Begin; mip < range.End; mip++)
+			textureTiles += uint64_t(texture.Layout.MipGrids[mip].Width) * texture.Layout.MipGrids[mip].Height;
+		tilesRequested += textureTiles;
+
+		uint64_t poolTiles = pool.GetTilesUsed(&texture) - (texture.Layout.NumPackedTiles > 0 ? 1 : 0);
+		if (poolTiles != textureTiles)
+			return Fail(check, "the pool kept " + std::to_string(poolTiles) + " tiles of a texture that asked for " + std::to_string(textureTiles));
+		ranges.TilesResident += poolTiles;
+
+		for (auto& mipTiles : texture.SweepTiles)
+			for (auto tile : mipTiles)
+				sweep.TilesResident += tile;
+	}
+
+	// Only the tiles of the mips that changed are visited
+	ranges.TilesVisited = ranges.TilesMapped + ranges.TilesUnmapped;
+
+	auto report = [&](const char* name, const ReplayPathStats& stats) {
+		std::cout << std::setw(7) << name << ": " << stats.TilesMapped << " tiles mapped, " << stats.TilesUnmapped << " unmapped, "
+			<< stats.TilesVisited << " visited, " << stats.TexturesTouched << " texture updates, " << stats.TilesResident
+			<< " resident at the end, " << stats.Milliseconds << " ms" << std::endl;
+	};
+
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "Mip residency replay of " << NumTextures << " textures over " << NumFrames << " frames, "
+		<< tilesRequested << " tiles requested in the last frame" << std::endl;
+	report("sweep", sweep);
+	report("ranges", ranges);
+	return true;
+}
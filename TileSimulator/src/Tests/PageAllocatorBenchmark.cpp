@@ -0,0 +1,150 @@
+#include "trpch.h"
+#include "Tests/SimulatorChecks.h"
+
+#include <chrono>
+#include <iomanip>
+#include <random>
+
+#include "TitaniumRose/Renderer/VirtualTexture/TilePageAllocator.h"
+
+using namespace Roses;
+
+// The page the tile pool used before TilePageAllocator, one byte per tile scanned from the start
+class ByteScanPage
+{
+public:
+	ByteScanPage(uint32_t numTiles) : m_Tiles(numTiles, 0) {}
+
+	uint32_t Allocate()
+	{
+		for (uint32_t i = 0; i < m_Tiles.size(); i++)
+		{
+			if (m_Tiles[i] == 0)
+			{
+				m_Tiles[i] = 1;
+				return i;
+			}
+		}
+		return TilePageAllocator::InvalidTile;
+	}
+
+	void Release(uint32_t tile) { m_Tiles[tile] = 0; }
+
+private:
+	std::vector<uint8_t> m_Tiles;
+};
+
+template<typename Function>
+static double TimeMilliseconds(Function function)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	function();
+	auto end = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+/// <summary>
+/// Times filling a page tile by tile, releasing a random half of it and filling it again,
+/// for the byte scan the pool used before and for TilePageAllocator. Then churns the page
+/// with runs of the sizes mips are mapped in to report how fragmented it gets.
+/// </summary>
+bool RunPageAllocatorBenchmark()
+{
+	const char* check = "Page allocator benchmark";
+
+	std::cout << std::fixed << std::setprecision(3);
+
+	for (uint32_t numTiles : { 8192u, 16384u, 32768u })
+	{
+		std::mt19937 rng(numTiles);
+		std::vector<uint32_t> releaseOrder(numTiles);
+		for (uint32_t i = 0; i < numTiles; i++)
+			releaseOrder[i] = i;
+		std::shuffle(releaseOrder.begin(), releaseOrder.end(), rng);
+		releaseOrder.resize(numTiles / 2);
+
+		// Fill, release half and refill, the same sequence for both
+		auto run = [&](const char* name, auto& page, double& checksum) {
+			double fill = TimeMilliseconds([&] {
+				for (uint32_t i = 0; i < numTiles; i++)
+					checksum += page.Allocate();
+			});
+			double release = TimeMilliseconds([&] {
+				for (uint32_t tile : releaseOrder)
+					page.Release(tile);
+			});
+			double refill = TimeMilliseconds([&] {
+				for (size_t i = 0; i < releaseOrder.size(); i++)
+					checksum += page.Allocate();
+			});
+
+			std::cout << numTiles << " tiles " << std::setw(17) << name << ": fill " << fill << " ms, release "
+				<< release << " ms, refill " << refill << " ms" << std::endl;
+		};
+
+		double byteScanChecksum = 0.0;
+		double allocatorChecksum = 0.0;
+		ByteScanPage byteScan(numTiles);
+		TilePageAllocator allocator(numTiles);
+		run("byte scan", byteScan, byteScanChecksum);
+		run("TilePageAllocator", allocator, allocatorChecksum);
+
+		// Both hand out the lowest free tile, so they have to agree
+		if (byteScanChecksum != allocatorChecksum)
+			return Fail(check, "the allocator handed out different tiles than the byte scan");
+		if (allocator.NumFreeTiles() != 0 || allocator.Allocate() != TilePageAllocator::InvalidTile)
+			return Fail(check, "a refilled page still had free tiles");
+
+		// Fragmentation: map and release runs of 1 to 64 tiles, keeping the page about three quarters full
+		TilePageAllocator page(numTiles);
+		struct Run { uint32_t First; uint32_t Count; };
+		std::vector<Run> live;
+		uint32_t requested = 0;
+		uint32_t placed = 0;
+		uint32_t failed = 0;
+		double churn = TimeMilliseconds([&] {
+			for (uint32_t step = 0; step < numTiles * 4; step++)
+			{
+				bool release = !live.empty() && (page.NumFreeTiles() < numTiles / 4 || rng() % 4 == 0);
+				if (release)
+				{
+					size_t index = rng() % live.size();
+					page.ReleaseRun(live[index].First, live[index].Count);
+					live[index] = live.back();
+					live.pop_back();
+					continue;
+				}
+
+				uint32_t count = 1u << (rng() % 7);
+				uint32_t first = page.AllocateRun(count);
+				requested++;
+				if (first == TilePageAllocator::InvalidTile)
+				{
+					failed++;
+					continue;
+				}
+				live.push_back({ first, count });
+				placed++;
+			}
+		});
+
+		uint32_t liveTiles = 0;
+		for (auto& liveRun : live)
+		{
+			for (uint32_t tile = liveRun.First; tile < liveRun.First + liveRun.Count; tile++)
+			{
+				if (!page.IsAllocated(tile))
+					return Fail(check, "a live run lost a tile");
+			}
+			liveTiles += liveRun.Count;
+		}
+		if (liveTiles + page.NumFreeTiles() != numTiles)
+			return Fail(check, "the free tile count does not match the live runs");
+
+		std::cout << numTiles << " tiles fragmentation: " << placed << " of " << requested << " runs placed ("
+			<< (100.0 * failed / requested) << "% did not fit) in " << churn << " ms, " << page.NumFreeTiles()
+			<< " tiles free with the largest run " << page.LargestFreeRun() << std::endl;
+	}
+
+	return true;
+}
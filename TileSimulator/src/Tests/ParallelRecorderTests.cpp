@@ -0,0 +1,156 @@
+#include "trpch.h"
+#include "Tests/SimulatorChecks.h"
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <random>
+#include <thread>
+
+#include "TitaniumRose/Core/ParallelRecorder.h"
+
+using namespace Roses;
+
+/// <summary>
+/// Checks the parallel recorder: the chunks cover the items in order, every chunk is submitted
+/// once and in order whatever thread finishes first. Then records 10k draws with a CPU cost
+/// like setting up a draw, on one thread and split over the hardware threads, and reports
+/// how the record time scales.
+/// </summary>
+bool RunParallelRecordTest()
+{
+	const char* check = "Parallel record test";
+
+	ParallelRecorder splitter(64, 8);
+	for (size_t count : { 0, 1, 63, 64, 65, 127, 128, 511, 512, 513, 10000 })
+	{
+		auto chunks = splitter.Split(count);
+		if (chunks.size() != splitter.GetChunkCount(count) || chunks.size() > 8)
+			return Fail(check, "the chunk count is wrong for " + std::to_string(count) + " items");
+
+		size_t next = 0;
+		for (auto& chunk : chunks)
+		{
+			if (chunk.Begin != next || chunk.End <= chunk.Begin)
+				return Fail(check, "the chunks of " + std::to_string(count) + " items are not contiguous");
+			if (chunks.size() > 1 && chunk.End - chunk.Begin < 64)
+				return Fail(check, "a chunk is smaller than the minimum");
+			next = chunk.End;
+		}
+		if (next != count)
+			return Fail(check, "the chunks do not cover " + std::to_string(count) + " items");
+	}
+
+	// Later chunks finish first, the submitted items still have to come out in order
+	{
+		ParallelRecorder recorder(16, 8);
+		static constexpr size_t Items = 1000;
+		auto chunks = recorder.Split(Items);
+		std::vector<std::vector<size_t>> recorded(chunks.size());
+		std::vector<size_t> submitted;
+		std::thread::id caller = std::this_thread::get_id();
+		bool submittedElsewhere = false;
+
+		recorder.Record(Items,
+			[&](size_t chunkIndex, const ParallelRecorder::Chunk& chunk) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(2 * (chunks.size() - chunkIndex)));
+				for (size_t i = chunk.Begin; i < chunk.End; i++)
+					recorded[chunkIndex].push_back(i);
+			},
+			[&](size_t chunkIndex) {
+				submittedElsewhere |= std::this_thread::get_id() != caller;
+				submitted.insert(submitted.end(), recorded[chunkIndex].begin(), recorded[chunkIndex].end());
+			});
+
+		if (submittedElsewhere)
+			return Fail(check, "a chunk was submitted from another thread");
+		if (submitted.size() != Items)
+			return Fail(check, "not every item was submitted exactly once");
+		for (size_t i = 0; i < Items; i++)
+		{
+			if (submitted[i] != i)
+				return Fail(check, "the items were submitted out of order");
+		}
+		if (recorder.GetStats().ParallelPasses != 1 || recorder.GetStats().Chunks != chunks.size())
+			return Fail(check, "the statistics are wrong");
+	}
+
+	// Every draw transforms its object and writes a few commands, roughly what a draw costs
+	// the CPU with the root arguments and dynamic constants it sets
+	static constexpr size_t Objects = 10000;
+	struct Command
+	{
+		float Data[20];
+	};
+
+	std::mt19937 random(23);
+	std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+	std::vector<std::array<float, 16>> transforms(Objects);
+	for (auto& transform : transforms)
+	{
+		for (auto& v : transform)
+			v = value(random);
+	}
+
+	auto recordDraw = [&](std::vector<Command>& commands, size_t object) {
+		const auto& m = transforms[object];
+		for (int pass = 0; pass < 4; pass++)
+		{
+			Command command;
+			for (int i = 0; i < 16; i++)
+			{
+				float sum = 0.0f;
+				for (int k = 0; k < 4; k++)
+					sum += m[(i / 4) * 4 + k] * m[k * 4 + i % 4] * (1.0f + 0.1f * pass);
+				command.Data[i] = sum;
+			}
+			for (int i = 16; i < 20; i++)
+				command.Data[i] = static_cast<float>(object + i + pass);
+			commands.push_back(command);
+		}
+	};
+
+	auto recordAll = [&](ParallelRecorder& recorder, std::vector<Command>& queue) {
+		std::vector<std::vector<Command>> lists(recorder.GetChunkCount(Objects));
+		auto start = std::chrono::high_resolution_clock::now();
+		recorder.Record(Objects,
+			[&](size_t chunkIndex, const ParallelRecorder::Chunk& chunk) {
+				auto& commands = lists[chunkIndex];
+				commands.reserve((chunk.End - chunk.Begin) * 4);
+				for (size_t i = chunk.Begin; i < chunk.End; i++)
+					recordDraw(commands, i);
+			},
+			[&](size_t chunkIndex) {
+				queue.insert(queue.end(), lists[chunkIndex].begin(), lists[chunkIndex].end());
+			});
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	};
+
+	size_t threads = std::max(std::thread::hardware_concurrency(), 1u);
+	ParallelRecorder serial(Objects, 1);
+	ParallelRecorder parallel(64, threads);
+
+	// The best of a few runs, the first one also warms the caches up
+	double serialTime = std::numeric_limits<double>::max();
+	double parallelTime = std::numeric_limits<double>::max();
+	std::vector<Command> serialQueue;
+	std::vector<Command> parallelQueue;
+	for (int run = 0; run < 5; run++)
+	{
+		serialQueue.clear();
+		parallelQueue.clear();
+		serialTime = std::min(serialTime, recordAll(serial, serialQueue));
+		parallelTime = std::min(parallelTime, recordAll(parallel, parallelQueue));
+	}
+
+	if (serialQueue.size() != Objects * 4 || parallelQueue.size() != serialQueue.size() ||
+		std::memcmp(serialQueue.data(), parallelQueue.data(), serialQueue.size() * sizeof(Command)) != 0)
+		return Fail(check, "the commands recorded in parallel differ from the ones recorded on one thread");
+	if (threads > 1 && parallelTime >= serialTime)
+		return Fail(check, "recording in parallel was not faster than on one thread");
+
+	std::cout << "Parallel record test passed: " << Objects << " draws took " << serialTime << " ms on one thread and "
+		<< parallelTime << " ms in " << parallel.GetChunkCount(Objects) << " chunks (" << serialTime / parallelTime
+		<< "x on " << threads << " hardware threads)" << std::endl;
+	return true;
+}
@@ -0,0 +1,141 @@
+#include "trpch.h"
+#include "Tests/SimulatorChecks.h"
+
+#include <deque>
+#include <random>
+
+#include "TitaniumRose/Renderer/VirtualTexture/ReadbackRing.h"
+
+using namespace Roses;
+
+/// <summary>
+/// Checks the readback ring: copies are aligned and skip to the start of the arena instead of
+/// wrapping, a full arena or too many frames in flight stall the copy, frames retire in
+/// submission order once their fence completed and forgotten slots are never handed back.
+/// Then replays feedback copies with a lagging GPU, checking that no two copies in flight
+/// overlap and that every one is handed back once, in order.
+/// </summary>
+bool RunReadbackRingTest()
+{
+	const char* check = "Readback ring test";
+	auto all = [](uint64_t) { return true; };
+
+	int first = 0, second = 0;
+	std::vector<void*> handedBack;
+	auto collect = [&](const ReadbackSlot& slot) { handedBack.push_back(slot.Owner); };
+
+	ReadbackRing ring(1024, 2);
+	ReadbackSlot a, b, c, d;
+	if (!ring.Allocate(&first, 300, 256, a) || !ring.Allocate(&second, 200, 256, b) || a.Offset != 0 || b.Offset != 512)
+		return Fail(check, "copies were not placed at aligned offsets");
+	ring.EndFrame(1);
+
+	// Stall, 400 bytes only fit at the start of the arena which frame 1 still holds
+	if (ring.Allocate(&first, 400, 256, c) || ring.GetStats().SlotsDenied != 1)
+		return Fail(check, "a copy was placed over a frame in flight");
+	if (ring.Allocate(&first, 2048, 256, c) || ring.GetStats().SlotsDenied != 2)
+		return Fail(check, "a copy larger than the arena was placed");
+
+	// Retire
+	if (ring.Retire([](uint64_t value) { return value == 0; }, collect) != 0 || !handedBack.empty())
+		return Fail(check, "a frame retired before its fence completed");
+	ring.Forget(&second);
+	if (ring.Retire(all, collect) != 1 || handedBack != std::vector<void*>{ &first } || ring.GetUsedBytes() != 0)
+		return Fail(check, "a retired frame did not hand back exactly its remembered slots");
+
+	// Skip, the aligned head is at 768 and 400 bytes do not fit before the end
+	if (!ring.Allocate(&first, 400, 256, c) || c.Offset != 0)
+		return Fail(check, "a copy that did not fit at the end did not skip to the start");
+	if (ring.GetRingStats().Wraps != 1 || ring.GetRingStats().Skipped != 1024 - 712 || ring.GetUsedBytes() != 1024 - 712 + 400)
+		return Fail(check, "the bytes skipped at the end were not accounted for");
+	ring.EndFrame(2);
+	if (!ring.Allocate(&second, 100, 256, d) || d.Offset != 512)
+		return Fail(check, "a copy after the skip was misplaced");
+	ring.EndFrame(3);
+
+	// Frames in flight, the arena still has room but two frames wait on the GPU
+	ReadbackSlot e;
+	if (ring.Allocate(&first, 16, 256, e) || ring.GetStats().SlotsDenied != 3)
+		return Fail(check, "a copy was placed with every frame in flight");
+
+	handedBack.clear();
+	if (ring.Retire([](uint64_t value) { return value == 3; }, collect) != 0)
+		return Fail(check, "a frame retired before an older one");
+	if (ring.Retire(all, collect) != 2 || handedBack != std::vector<void*>{ &first, &second })
+		return Fail(check, "frames did not retire in submission order");
+	ring.EndFrame(4);
+	if (ring.GetFramesInFlight() != 0 || ring.GetUsedBytes() != 0)
+		return Fail(check, "the ring did not drain, or tracked a frame without copies");
+
+	// Copies of random feedback maps, the GPU completes a frame a few frames late
+	static constexpr uint64_t Capacity = 1024 * 1024;
+	static constexpr uint64_t Alignment = 256;
+	static constexpr uint32_t FramesInFlight = 3;
+	static constexpr uint32_t Frames = 3000;
+	static constexpr uint64_t GpuLatency = 2;
+
+	struct Copy { uint32_t Id; uint64_t Offset; uint64_t Size; };
+	ReadbackRing readback(Capacity, FramesInFlight);
+	std::mt19937 rng(29);
+	std::vector<Copy> owners;
+	std::deque<uint32_t> inFlight;
+	uint64_t completedFence = 0;
+	uint32_t stalls = 0;
+	// Every copy handed back has to be the oldest one in flight
+	auto retire = [&]() {
+		handedBack.clear();
+		readback.Retire([&](uint64_t value) { return value <= completedFence; }, collect);
+		for (void* owner : handedBack)
+		{
+			if (inFlight.empty() || owner != &owners[inFlight.front()])
+				return false;
+			inFlight.pop_front();
+		}
+		return true;
+	};
+
+	// Pointers into owners are the slot owners, so it must never reallocate
+	owners.reserve(Frames * 6);
+	for (uint32_t frame = 1; frame <= Frames; frame++)
+	{
+		uint32_t copies = 1 + rng() % 6;
+		for (uint32_t i = 0; i < copies; i++)
+		{
+			// Sizes of 8 and 32 bit feedback maps that are rarely a multiple of the alignment
+			uint64_t size = 64 + rng() % (Capacity / 8);
+			ReadbackSlot slot;
+			owners.push_back({ static_cast<uint32_t>(owners.size()), 0, size });
+			if (!readback.Allocate(&owners.back(), size, Alignment, slot))
+			{
+				owners.pop_back();
+				++stalls;
+				continue;
+			}
+			if (slot.Offset % Alignment != 0 || slot.Offset + size > Capacity)
+				return Fail(check, "a copy was misplaced in frame " + std::to_string(frame));
+
+			for (uint32_t other : inFlight)
+			{
+				const Copy& copy = owners[other];
+				if (slot.Offset < copy.Offset + copy.Size && copy.Offset < slot.Offset + size)
+					return Fail(check, "two copies in flight overlap in frame " + std::to_string(frame));
+			}
+			owners.back().Offset = slot.Offset;
+			inFlight.push_back(owners.back().Id);
+		}
+
+		readback.EndFrame(frame);
+		completedFence = frame > GpuLatency ? frame - GpuLatency : 0;
+
+		if (!retire())
+			return Fail(check, "a copy was handed back out of order in frame " + std::to_string(frame));
+	}
+
+	completedFence = Frames;
+	if (!retire() || !inFlight.empty() || readback.GetFramesInFlight() != 0)
+		return Fail(check, "copies were left in the ring once the GPU caught up");
+
+	std::cout << "Readback ring test passed, " << readback.GetStats().SlotsRetired << " copies read back over " << Frames
+		<< " frames, " << readback.GetRingStats().Wraps << " wraps and " << stalls << " copies skipped on a full ring" << std::endl;
+	return true;
+}
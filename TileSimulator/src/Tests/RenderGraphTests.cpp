@@ -0,0 +1,185 @@
+#include "trpch.h"
+#include "Tests/SimulatorChecks.h"
+
+#include "TitaniumRose/Renderer/RenderGraph.h"
+
+using namespace Roses;
+
+/// <summary>
+/// Checks the render graph's culling, dependency levels, barrier batching, split barriers and
+/// read merging on small graphs with known results.
+/// </summary>
+bool RunRenderGraphTest()
+{
+	const char* check = "Render graph test";
+
+	// The barriers of a type the batch issues for a resource
+	auto countBarriers = [](const RenderGraph& graph, size_t batch, RenderGraphResource resource, RenderGraphBarrierType type) {
+		uint32_t count = 0;
+		for (auto& barrier : graph.GetBatches()[batch].Barriers)
+			count += barrier.Resource == resource && barrier.Type == type ? 1 : 0;
+		return count;
+	};
+
+	RenderGraph graph;
+
+	// Passes nothing reads are culled, and so are writers whose results are overwritten
+	{
+		auto output = graph.ImportResource("Output", RenderGraphAccess_None, RenderGraphResourceFlags_Output);
+		auto unused = graph.ImportResource("Unused");
+		auto stats = graph.ImportResource("Stats");
+		auto history = graph.ImportResource("History");
+
+		uint32_t unusedPass = graph.AddPass("Unused");
+		graph.Write(unusedPass, unused, RenderGraphAccess_RenderTarget, true);
+		uint32_t overwritten = graph.AddPass("Overwritten");
+		graph.Write(overwritten, output, RenderGraphAccess_RenderTarget, true);
+		uint32_t sideEffects = graph.AddPass("Side effects", RenderGraphPassFlags_SideEffects);
+		graph.Write(sideEffects, stats, RenderGraphAccess_UnorderedAccess);
+		uint32_t historyPass = graph.AddPass("History");
+		graph.Write(historyPass, history, RenderGraphAccess_RenderTarget, true);
+		uint32_t blend = graph.AddPass("Blend");
+		graph.Write(blend, history, RenderGraphAccess_RenderTarget);
+		uint32_t final = graph.AddPass("Final");
+		graph.Read(final, history, RenderGraphAccess_PixelShaderRead);
+		graph.Write(final, output, RenderGraphAccess_RenderTarget, true);
+		graph.Compile();
+
+		if (!graph.IsCulled(unusedPass) || !graph.IsCulled(overwritten))
+			return Fail(check, "a pass nothing needs was kept");
+		if (graph.IsCulled(sideEffects))
+			return Fail(check, "a pass with side effects was culled");
+		if (graph.IsCulled(historyPass) || graph.IsCulled(blend) || graph.IsCulled(final))
+			return Fail(check, "a pass whose results are read was culled");
+		if (graph.GetStats().CulledPasses != 2)
+			return Fail(check, "the culled passes were miscounted");
+	}
+
+	// Independent passes share a level, whatever order they were declared in. A transition that
+	// has batches to spare is split, the others are issued whole before the pass
+	{
+		graph.Reset();
+		auto backBuffer = graph.ImportResource("Back buffer", RenderGraphAccess_Present, RenderGraphResourceFlags_Output);
+		auto shadow = graph.ImportResource("Shadow", RenderGraphAccess_PixelShaderRead);
+		auto depth = graph.ImportResource("Depth");
+		auto color = graph.ImportResource("Color");
+		auto overlay = graph.ImportResource("Overlay");
+
+		uint32_t shadowPass = graph.AddPass("Shadow");
+		graph.Write(shadowPass, shadow, RenderGraphAccess_DepthWrite, true);
+		uint32_t prepass = graph.AddPass("Depth prepass");
+		graph.Write(prepass, depth, RenderGraphAccess_DepthWrite, true);
+		uint32_t main = graph.AddPass("Main");
+		graph.Read(main, shadow, RenderGraphAccess_PixelShaderRead);
+		graph.Read(main, depth, RenderGraphAccess_DepthRead);
+		graph.Write(main, color, RenderGraphAccess_RenderTarget, true);
+		uint32_t overlayPass = graph.AddPass("Overlay");
+		graph.Write(overlayPass, overlay, RenderGraphAccess_RenderTarget, true);
+		uint32_t post = graph.AddPass("Post");
+		graph.Read(post, color, RenderGraphAccess_PixelShaderRead);
+		graph.Read(post, overlay, RenderGraphAccess_PixelShaderRead);
+		graph.Write(post, backBuffer, RenderGraphAccess_RenderTarget, true);
+		graph.Compile();
+
+		auto& batches = graph.GetBatches();
+		if (batches.size() != 3 || graph.GetLevel(shadowPass) != 0 || graph.GetLevel(prepass) != 0 ||
+			graph.GetLevel(overlayPass) != 0 || graph.GetLevel(main) != 1 || graph.GetLevel(post) != 2)
+			return Fail(check, "the passes were not leveled by their dependencies");
+		if (batches[0].Passes != std::vector<uint32_t>{ shadowPass, prepass, overlayPass })
+			return Fail(check, "a batch did not keep the declaration order");
+
+		if (countBarriers(graph, 0, shadow, RenderGraphBarrierType_Transition) != 1 ||
+			countBarriers(graph, 1, shadow, RenderGraphBarrierType_Transition) != 1)
+			return Fail(check, "the shadow map was not transitioned before each use");
+		if (countBarriers(graph, 0, backBuffer, RenderGraphBarrierType_SplitBegin) != 1 ||
+			countBarriers(graph, 2, backBuffer, RenderGraphBarrierType_SplitEnd) != 1)
+			return Fail(check, "the back buffer transition was not split over the batches before its use");
+		if (countBarriers(graph, 0, depth, RenderGraphBarrierType_SplitBegin) != 0)
+			return Fail(check, "a resource of unknown state was split");
+		if (countBarriers(graph, 1, overlay, RenderGraphBarrierType_SplitBegin) != 1 ||
+			countBarriers(graph, 2, overlay, RenderGraphBarrierType_SplitEnd) != 1)
+			return Fail(check, "the overlay transition did not begin right after its write");
+		if (graph.GetStats().SplitBarriers != 2)
+			return Fail(check, "the split barriers were miscounted");
+	}
+
+	// A split can not be open across a pass that submits its own command lists
+	{
+		graph.Reset();
+		auto backBuffer = graph.ImportResource("Back buffer", RenderGraphAccess_Present, RenderGraphResourceFlags_Output);
+		auto color = graph.ImportResource("Color");
+
+		uint32_t scene = graph.AddPass("Scene", RenderGraphPassFlags_Submits);
+		graph.Write(scene, color, RenderGraphAccess_RenderTarget, true);
+		uint32_t post = graph.AddPass("Post");
+		graph.Read(post, color, RenderGraphAccess_PixelShaderRead);
+		graph.Write(post, backBuffer, RenderGraphAccess_RenderTarget, true);
+		graph.Compile();
+
+		if (graph.GetStats().SplitBarriers != 0 || countBarriers(graph, 1, backBuffer, RenderGraphBarrierType_Transition) != 1)
+			return Fail(check, "a split barrier was open across a submitting pass");
+	}
+
+	// Reads that follow each other share one transition to their combined state, and
+	// unordered access writes that follow each other get a UAV barrier instead of a transition
+	{
+		graph.Reset();
+		auto output = graph.ImportResource("Output", RenderGraphAccess_None, RenderGraphResourceFlags_Output);
+		auto texture = graph.ImportResource("Texture");
+		auto buffer = graph.ImportResource("Buffer");
+		auto counts = graph.ImportResource("Counts", RenderGraphAccess_None, RenderGraphResourceFlags_Untracked);
+
+		uint32_t draw = graph.AddPass("Draw");
+		graph.Write(draw, texture, RenderGraphAccess_RenderTarget, true);
+		uint32_t count = graph.AddPass("Count");
+		graph.Write(count, buffer, RenderGraphAccess_UnorderedAccess, true);
+		graph.Write(count, counts, RenderGraphAccess_UnorderedAccess);
+		uint32_t accumulate = graph.AddPass("Accumulate");
+		graph.Read(accumulate, texture, RenderGraphAccess_PixelShaderRead);
+		graph.Write(accumulate, buffer, RenderGraphAccess_UnorderedAccess);
+		uint32_t resolve = graph.AddPass("Resolve");
+		graph.Read(resolve, texture, RenderGraphAccess_NonPixelShaderRead);
+		graph.Read(resolve, buffer, RenderGraphAccess_NonPixelShaderRead);
+		graph.Read(resolve, counts, RenderGraphAccess_NonPixelShaderRead);
+		graph.Write(resolve, output, RenderGraphAccess_UnorderedAccess, true);
+		graph.Compile();
+
+		auto& batches = graph.GetBatches();
+		if (batches.size() != 3 || graph.GetLevel(accumulate) != 1 || graph.GetLevel(resolve) != 2)
+			return Fail(check, "the passes were not leveled by their dependencies");
+
+		uint32_t combined = RenderGraphAccess_PixelShaderRead | RenderGraphAccess_NonPixelShaderRead;
+		bool merged = countBarriers(graph, 1, texture, RenderGraphBarrierType_Transition) == 1 &&
+			countBarriers(graph, 2, texture, RenderGraphBarrierType_Transition) == 0;
+		for (auto& barrier : batches[1].Barriers)
+			merged = merged && (barrier.Resource != texture || barrier.After == combined);
+		if (!merged)
+			return Fail(check, "consecutive reads were not merged into one transition");
+
+		if (countBarriers(graph, 1, buffer, RenderGraphBarrierType_UAV) != 1 ||
+			countBarriers(graph, 1, buffer, RenderGraphBarrierType_Transition) != 0)
+			return Fail(check, "consecutive unordered access writes did not get a UAV barrier");
+		if (countBarriers(graph, 2, buffer, RenderGraphBarrierType_Transition) != 1)
+			return Fail(check, "the buffer was not transitioned for its read");
+
+		for (auto& batch : batches)
+		{
+			for (auto& barrier : batch.Barriers)
+			{
+				if (barrier.Resource == counts)
+					return Fail(check, "an untracked resource got a barrier");
+			}
+		}
+		if (graph.GetLevel(resolve) <= graph.GetLevel(count))
+			return Fail(check, "an untracked resource did not order its passes");
+	}
+
+	// A graph without passes compiles to nothing
+	graph.Reset();
+	graph.Compile();
+	if (!graph.GetBatches().empty() || graph.GetPassCount() != 0)
+		return Fail(check, "an empty graph has batches");
+
+	std::cout << "Render graph test passed" << std::endl;
+	return true;
+}
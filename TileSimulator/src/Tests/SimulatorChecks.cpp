@@ -0,0 +1,36 @@
+#include "trpch.h"
+#include "Tests/SimulatorChecks.h"
+
+bool Fail(const std::string& check, const std::string& message)
+{
+	std::cerr << check << " failed: " << message << std::endl;
+	return false;
+}
+
+const std::vector<SimulatorCheck>& GetSimulatorChecks()
+{
+	static const std::vector<SimulatorCheck> checks = {
+		{ "benchmark-reduction", "Times the feedback reduction kernels", RunReductionBenchmark },
+		{ "test-reduction", "Checks every feedback reduction kernel against the scalar one on random maps", RunReductionTest },
+		{ "benchmark-page-allocator", "Times the tile page allocator against the byte scan it replaced and reports fragmentation", RunPageAllocatorBenchmark },
+		{ "benchmark-mip-residency", "Replays drifting mips over 128 textures through the old per frame sweep and the resident mip ranges", RunMipResidencyReplay },
+		{ "benchmark-descriptors", "Stress tests and times the descriptor heap allocator", RunDescriptorAllocatorBenchmark },
+		{ "test-view-cache", "Checks the descriptor view cache and reports its hit rate", RunViewCacheTest },
+		{ "test-material-table", "Checks the bindless material table and reports its upload size", RunMaterialTableTest },
+		{ "test-upload-ring", "Checks the upload ring and reports its high-water mark", RunUploadRingTest },
+		{ "test-readback-ring", "Checks the feedback readback ring against a lagging GPU", RunReadbackRingTest },
+		{ "test-upload-batcher", "Checks the copy queue upload batching against a mock queue", RunUploadBatcherTest },
+		{ "test-frame-pipeline", "Checks the frame slot bookkeeping and reports the frame rate it gains", RunFramePipelineTest },
+		{ "test-parallel-record", "Checks the order of chunks recorded in parallel and reports how the record time scales", RunParallelRecordTest },
+		{ "test-jobs", "Checks the job system and its work stealing deque", RunJobSystemTest },
+		{ "benchmark-jobs", "Times how the job system scales with its worker count", RunJobSystemBenchmark },
+		{ "test-render-graph", "Checks the render graph ordering, culling and barriers", RunRenderGraphTest },
+		{ "test-tile-residency", "Checks how feedback maps turn into resident tiles", RunTileResidencyTest },
+		{ "test-tile-mapping", "Checks the coalescing of tile mapping requests against random request sets", RunTileMappingTest },
+		{ "test-tile-compaction", "Checks the tile compaction plans against hand made and random pools", RunTileCompactionTest },
+		{ "test-oscillating-trace", "Checks the mip changes of traces/oscillating_mips.txt with and without hysteresis", RunOscillatingTraceTest },
+		{ "test-mip-estimation", "Checks the mips estimated from geometry against hand computed ones", RunMipEstimationTest },
+		{ "test-texel-density", "Checks the texel density of hand measured meshes and the vector kernels against the scalar one", RunTexelDensityTest },
+	};
+	return checks;
+}
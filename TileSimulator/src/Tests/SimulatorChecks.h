@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// A check or benchmark that runs instead of a trace replay when its option is given
+/// </summary>
+struct SimulatorCheck
+{
+	const char* Option;
+	const char* Description;
+	// Returns false when the check failed
+	bool (*Run)();
+};
+
+// Every check in the order the help lists them
+const std::vector<SimulatorCheck>& GetSimulatorChecks();
+
+// Reports why the named check failed, returns false so a check can return it
+bool Fail(const std::string& check, const std::string& message);
+
+// The benchmarks double their thread count up to this
+static constexpr uint32_t MaxBenchmarkThreads = 16;
+
+bool RunReductionBenchmark();
+bool RunReductionTest();
+bool RunPageAllocatorBenchmark();
+bool RunDescriptorAllocatorBenchmark();
+bool RunViewCacheTest();
+bool RunMaterialTableTest();
+bool RunUploadRingTest();
+bool RunReadbackRingTest();
+bool RunUploadBatcherTest();
+bool RunFramePipelineTest();
+bool RunParallelRecordTest();
+bool RunJobSystemTest();
+bool RunJobSystemBenchmark();
+bool RunRenderGraphTest();
+bool RunTileResidencyTest();
+bool RunTileMappingTest();
+bool RunTileCompactionTest();
+bool RunTexelDensityTest();
+bool RunMipEstimationTest();
+bool RunMipResidencyReplay();
+bool RunOscillatingTraceTest();
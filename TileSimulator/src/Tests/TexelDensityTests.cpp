@@ -0,0 +1,120 @@
+#include "trpch.h"
+#include "Tests/SimulatorChecks.h"
+
+#include <cmath>
+#include <random>
+
+#include "TitaniumRose/Renderer/VirtualTexture/TexelDensity.h"
+
+using namespace Roses;
+
+struct DensityVertex
+{
+	float Position[3];
+	float UV[2];
+};
+
+static TexelDensityTable MeasureMesh(const std::vector<DensityVertex>& vertices, const std::vector<uint32_t>& indices, TexelDensityKernel kernel)
+{
+	return ComputeTexelDensity(vertices[0].Position, vertices[0].UV, sizeof(DensityVertex), vertices.size(),
+		indices.data(), indices.size() / 3, kernel);
+}
+
+static bool NearlyEqual(float a, float b)
+{
+	return std::abs(a - b) <= 1e-6f * std::max(1.0f, std::max(std::abs(a), std::abs(b)));
+}
+
+/// <summary>
+/// Checks the texel density of a hand measured mesh, a degenerate triangle and a UV seam,
+/// then compares every vector kernel the CPU supports against the scalar one on random
+/// meshes, most of them with a triangle count that fills no whole block.
+/// </summary>
+bool RunTexelDensityTest()
+{
+	const char* check = "Texel density test";
+
+	// Two triangles of a 2x2 quad mapped to the lower left quarter of the UV space, and a
+	// triangle with no surface sharing a vertex
+	std::vector<DensityVertex> quad = {
+		{ { 0, 0, 0 }, { 0.0f, 0.0f } }, { { 2, 0, 0 }, { 0.5f, 0.0f } },
+		{ { 2, 2, 0 }, { 0.5f, 0.5f } }, { { 0, 2, 0 }, { 0.0f, 0.5f } },
+		{ { 1, 0, 0 }, { 0.25f, 0.0f } }
+	};
+	std::vector<uint32_t> quadIndices = { 0, 1, 2, 0, 2, 3, 0, 1, 4 };
+	TexelDensityTable table = MeasureMesh(quad, quadIndices, TexelDensityKernel::Scalar);
+	if (!NearlyEqual(table.SurfaceArea, 4.0f) || !NearlyEqual(table.UVArea, 0.25f) || !NearlyEqual(table.Density.Mean, 0.0625f))
+		return Fail(check, "the quad was not measured as 4 units of surface over a quarter of the UV space");
+	if (!NearlyEqual(table.TriangleDensity[0], 0.0625f) || table.TriangleDensity[2] != 0.0f || !NearlyEqual(table.Density.Distortion(), 1.0f))
+		return Fail(check, "a degenerate triangle was given a density");
+	if (table.Charts.size() != 1 || table.Charts[0].TriangleCount != 3)
+		return Fail(check, "triangles sharing vertices were not grouped into one chart");
+
+	// A UV seam, the second triangle shares the diagonal's positions but not its UVs
+	quad.push_back({ { 0, 0, 0 }, { 0.5f, 0.5f } });
+	quad.push_back({ { 2, 2, 0 }, { 1.0f, 1.0f } });
+	quadIndices = { 0, 1, 2, 5, 6, 3 };
+	table = MeasureMesh(quad, quadIndices, TexelDensityKernel::Scalar);
+	if (table.Charts.size() != 2 || table.TriangleChart[1] != 1)
+		return Fail(check, "a UV seam did not split the charts");
+
+	// Every kernel against the scalar one
+	std::vector<TexelDensityKernel> kernels;
+	for (TexelDensityKernel kernel : { TexelDensityKernel::SSE, TexelDensityKernel::AVX })
+	{
+		if (kernel <= GetBestTexelDensityKernel())
+			kernels.push_back(kernel);
+	}
+
+	std::mt19937 rng(31);
+	std::uniform_real_distribution<float> coordinate(-4.0f, 4.0f);
+	std::uniform_real_distribution<float> uvCoordinate(0.0f, 1.0f);
+	uint32_t meshes = 0;
+	for (uint32_t iteration = 0; iteration < 300; iteration++)
+	{
+		size_t vertexCount = 3 + rng() % 40;
+		std::vector<DensityVertex> vertices(vertexCount);
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			vertices[v] = { { coordinate(rng), coordinate(rng), coordinate(rng) }, { uvCoordinate(rng), uvCoordinate(rng) } };
+			// Some vertices repeat an earlier one, so charts and degenerate triangles show up
+			if (v > 0 && rng() % 4 == 0)
+				vertices[v] = vertices[rng() % v];
+		}
+
+		// 1 to 41 triangles, every remainder of both vector widths
+		size_t triangleCount = 1 + iteration % 41;
+		std::vector<uint32_t> indices(triangleCount * 3);
+		for (auto& index : indices)
+			index = static_cast<uint32_t>(rng() % vertexCount);
+
+		TexelDensityTable expected = MeasureMesh(vertices, indices, TexelDensityKernel::Scalar);
+		for (TexelDensityKernel kernel : kernels)
+		{
+			std::string name = GetTexelDensityKernelName(kernel);
+			TexelDensityTable actual = MeasureMesh(vertices, indices, kernel);
+			if (actual.TriangleDensity.size() != triangleCount)
+				return Fail(check, name + " measured " + std::to_string(actual.TriangleDensity.size()) + " of " + std::to_string(triangleCount) + " triangles");
+			for (size_t t = 0; t < triangleCount; t++)
+			{
+				if (!NearlyEqual(actual.TriangleDensity[t], expected.TriangleDensity[t]))
+					return Fail(check, name + " differed from the scalar kernel on triangle " + std::to_string(t) + " of " + std::to_string(triangleCount));
+			}
+			if (!NearlyEqual(actual.SurfaceArea, expected.SurfaceArea) || !NearlyEqual(actual.UVArea, expected.UVArea) ||
+				!NearlyEqual(actual.Density.Min, expected.Density.Min) || !NearlyEqual(actual.Density.Max, expected.Density.Max) ||
+				actual.Charts.size() != expected.Charts.size())
+			{
+				return Fail(check, name + " differed from the scalar kernel in the totals of " + std::to_string(triangleCount) + " triangles");
+			}
+		}
+		meshes++;
+	}
+
+	std::cout << "Texel density test passed, " << meshes << " random meshes matched the scalar kernel with";
+	for (TexelDensityKernel kernel : kernels)
+		std::cout << " " << GetTexelDensityKernelName(kernel);
+	if (kernels.empty())
+		std::cout << " no vector kernel supported";
+	std::cout << std::endl;
+	return true;
+}
@@ -0,0 +1,217 @@
+#include "trpch.h"
+#include "Tests/SimulatorChecks.h"
+
+#include <random>
+
+#include "TitaniumRose/Renderer/VirtualTexture/TileCompaction.h"
+
+using namespace Roses;
+
+static constexpr int FreeTile = -1;
+
+// The pool being compacted, every used tile holds the id of what was mapped to it
+struct CompactionPool
+{
+	std::vector<TilePageAllocator> Allocators;
+	std::vector<std::vector<int>> Contents;
+
+	CompactionPool(uint32_t numPages, uint32_t tilesPerPage)
+		: Allocators(numPages, TilePageAllocator(tilesPerPage)), Contents(numPages, std::vector<int>(tilesPerPage, FreeTile))
+	{
+	}
+
+	void Use(uint16_t page, uint32_t tile, int content)
+	{
+		Allocators[page].AllocateAt(tile);
+		Contents[page][tile] = content;
+	}
+
+	// Page i is given index i, the moves name pages by it
+	std::vector<CompactionPage> GetPages() const
+	{
+		std::vector<CompactionPage> pages;
+		for (size_t p = 0; p < Allocators.size(); p++)
+			pages.push_back({ static_cast<uint16_t>(p), &Allocators[p] });
+		return pages;
+	}
+};
+
+/// <summary>
+/// Applies the moves in order like the pool does, and checks every one of them: the source
+/// holds a tile that did not move yet, the destination is free, no tile moves twice and the
+/// moved tiles take the lowest free tiles of their destination, so they end contiguous after
+/// the tiles already there. Every page the plan names as emptied must end empty.
+/// </summary>
+static bool ApplyPlan(const char* check, CompactionPool& pool, const CompactionPlan& plan)
+{
+	std::vector<std::vector<bool>> movedIn(pool.Allocators.size(), std::vector<bool>(pool.Allocators[0].Size(), false));
+	for (size_t m = 0; m < plan.Moves.size(); m++)
+	{
+		const TileMove& move = plan.Moves[m];
+		std::string where = "move " + std::to_string(m);
+		if (move.SourcePage == move.DestinationPage)
+			return Fail(check, where + " stayed within its page");
+
+		auto& source = pool.Allocators[move.SourcePage];
+		auto& destination = pool.Allocators[move.DestinationPage];
+		if (!source.IsAllocated(move.SourceTile))
+			return Fail(check, where + " moved a free tile");
+		if (movedIn[move.SourcePage][move.SourceTile])
+			return Fail(check, where + " moved a tile a second time");
+		if (destination.IsAllocated(move.DestinationTile))
+			return Fail(check, where + " landed on a tile in use");
+		for (uint32_t tile = 0; tile < move.DestinationTile; tile++)
+		{
+			if (!destination.IsAllocated(tile))
+				return Fail(check, where + " left a hole below it in its destination");
+		}
+
+		destination.AllocateAt(move.DestinationTile);
+		source.Release(move.SourceTile);
+		pool.Contents[move.DestinationPage][move.DestinationTile] = pool.Contents[move.SourcePage][move.SourceTile];
+		pool.Contents[move.SourcePage][move.SourceTile] = FreeTile;
+		movedIn[move.DestinationPage][move.DestinationTile] = true;
+	}
+
+	for (uint16_t page : plan.PagesEmptied)
+	{
+		if (pool.Allocators[page].NumFreeTiles() != pool.Allocators[page].Size())
+			return Fail(check, "page " + std::to_string(page) + " was named as emptied but still holds tiles");
+	}
+	return true;
+}
+
+// Every content id, sorted, so two states of the pool can be compared
+static std::vector<int> GetContents(const CompactionPool& pool)
+{
+	std::vector<int> contents;
+	for (auto& page : pool.Contents)
+	{
+		for (int content : page)
+		{
+			if (content != FreeTile)
+				contents.push_back(content);
+		}
+	}
+	std::sort(contents.begin(), contents.end());
+	return contents;
+}
+
+/// <summary>
+/// Checks the compaction planner on a hand made pool, then with the move budget running out
+/// halfway through a page, then plans random pools until they stop changing, applying the
+/// moves and checking that every mapped tile is still there exactly once.
+/// </summary>
+bool RunTileCompactionTest()
+{
+	const char* check = "Tile compaction test";
+
+	// A dense page, a fairly dense one and a sparse one that fits in the free tiles of the dense one
+	CompactionPool pool(3, 16);
+	int content = 0;
+	for (uint32_t tile = 0; tile < 12; tile++)
+		pool.Use(0, tile, content++);
+	for (uint32_t tile = 0; tile < 10; tile++)
+		pool.Use(1, tile, content++);
+	for (uint32_t tile : { 3, 7, 12 })
+		pool.Use(2, tile, content++);
+
+	CompactionPlan plan = PlanTileCompaction(pool.GetPages(), 100);
+	if (plan.Before.UsedTiles != 25 || plan.Before.PagesInUse != 3 || plan.Before.MinimumPages != 2)
+		return Fail(check, "the fragmentation of the hand made pool was mismeasured");
+	if (plan.Moves.size() != 3 || plan.PagesEmptied != std::vector<uint16_t>{ 2 })
+		return Fail(check, "the sparse page was not the only one emptied, or the page too big to fit was moved");
+	for (uint32_t m = 0; m < 3; m++)
+	{
+		const TileMove& move = plan.Moves[m];
+		if (move.SourcePage != 2 || move.DestinationPage != 0 || move.DestinationTile != 12 + m)
+			return Fail(check, "the sparse page was not moved behind the tiles of the densest page");
+	}
+	if (plan.After.PagesInUse != 2 || plan.After.UsedTiles != 25 || plan.After.Fragmentation >= plan.Before.Fragmentation)
+		return Fail(check, "the fragmentation once the plan is applied was mismeasured");
+
+	// The budget runs out halfway through the sparse page, planning again picks it up
+	CompactionPool budgeted = pool;
+	std::vector<int> expected = GetContents(budgeted);
+	plan = PlanTileCompaction(budgeted.GetPages(), 2);
+	if (plan.Moves.size() != 2 || !plan.PagesEmptied.empty() || !ApplyPlan(check, budgeted, plan))
+		return Fail(check, "the move budget was not respected");
+	plan = PlanTileCompaction(budgeted.GetPages(), 2);
+	if (plan.Moves.size() != 1 || plan.Moves[0].SourcePage != 2 || plan.Moves[0].DestinationTile != 14 || !ApplyPlan(check, budgeted, plan))
+		return Fail(check, "planning again did not finish the page the budget stopped in");
+	if (GetContents(budgeted) != expected || budgeted.Contents[2] != std::vector<int>(16, FreeTile))
+		return Fail(check, "tiles were lost or duplicated when the budget ran out");
+
+	// Random pools, a page size that is no multiple of the bitmap words
+	static constexpr uint32_t TilesPerPage = 100;
+	std::mt19937 rng(41);
+	uint32_t pools = 0;
+	uint64_t moves = 0;
+	uint64_t pagesEmptied = 0;
+	for (uint32_t iteration = 0; iteration < 300; iteration++)
+	{
+		uint32_t numPages = 2 + rng() % 12;
+		CompactionPool random(numPages, TilesPerPage);
+		content = 0;
+		for (uint16_t page = 0; page < numPages; page++)
+		{
+			// Mostly low tiles, as the pool hands them out, with holes where tiles were unmapped
+			uint32_t filled = rng() % (TilesPerPage + 1);
+			for (uint32_t tile = 0; tile < filled; tile++)
+			{
+				if (rng() % 5 != 0)
+					random.Use(page, tile, content++);
+			}
+		}
+
+		expected = GetContents(random);
+		uint32_t budget = 1 + rng() % 200;
+		uint32_t rounds = 0;
+		while (true)
+		{
+			plan = PlanTileCompaction(random.GetPages(), budget);
+			if (plan.Moves.size() > budget)
+				return Fail(check, "the move budget was exceeded in pool " + std::to_string(iteration));
+			if (plan.Moves.empty())
+				break;
+			if (!ApplyPlan(check, random, plan))
+				return false;
+
+			FragmentationStats after = MeasureFragmentation(random.GetPages());
+			if (after.PagesInUse != plan.After.PagesInUse || after.UsedTiles != plan.After.UsedTiles)
+				return Fail(check, "the planned fragmentation did not match the applied plan in pool " + std::to_string(iteration));
+			if (GetContents(random) != expected)
+				return Fail(check, "tiles were lost or duplicated in pool " + std::to_string(iteration));
+
+			moves += plan.Moves.size();
+			pagesEmptied += plan.PagesEmptied.size();
+			// Every round moves at least one tile out of a sparser page, so this has to settle
+			if (++rounds > numPages * TilesPerPage)
+				return Fail(check, "the plans never settled in pool " + std::to_string(iteration));
+		}
+
+		FragmentationStats settled = MeasureFragmentation(random.GetPages());
+		if (settled.PagesInUse > 1 && settled.PagesInUse > settled.MinimumPages)
+		{
+			// Settled means even the sparsest page does not fit in the free tiles of the others
+			uint32_t sparsest = TilesPerPage;
+			uint32_t free = 0;
+			for (auto& allocator : random.Allocators)
+			{
+				uint32_t used = allocator.Size() - allocator.NumFreeTiles();
+				if (used > 0)
+				{
+					sparsest = std::min(sparsest, used);
+					free += allocator.NumFreeTiles();
+				}
+			}
+			if (sparsest <= free - (TilesPerPage - sparsest))
+				return Fail(check, "pool " + std::to_string(iteration) + " stopped with a page that fit in the others");
+		}
+		pools++;
+	}
+
+	std::cout << "Tile compaction test passed, " << pools << " random pools settled after " << moves << " moves emptying "
+		<< pagesEmptied << " pages" << std::endl;
+	return true;
+}
@@ -0,0 +1,172 @@
+#include "trpch.h"
+#include "Tests/SimulatorChecks.h"
+
+#include <map>
+#include <random>
+#include <tuple>
+
+#include "TitaniumRose/Renderer/VirtualTexture/TileMappingBuilder.h"
+
+using namespace Roses;
+
+// Packed tiles use their index in the packed mips as x, on a row of their own
+static constexpr uint32_t PackedRow = uint32_t(-1);
+
+using TileKey = std::tuple<uint32_t, uint32_t, uint32_t>;
+
+struct TileTarget
+{
+	bool Null;
+	uint16_t Page;
+	uint32_t HeapOffset;
+
+	bool operator==(const TileTarget& other) const
+	{
+		return Null == other.Null && (Null || (Page == other.Page && HeapOffset == other.HeapOffset));
+	}
+};
+
+// Expands the regions back into the tile each of them covers, false if a tile is covered twice
+static bool ExpandRegions(const std::vector<TileMappingRegion>& regions, std::map<TileKey, TileTarget>& tiles)
+{
+	for (auto& region : regions)
+	{
+		for (uint32_t i = 0; i < region.NumTiles(); i++)
+		{
+			TileKey key = region.Packed
+				? TileKey(region.Subresource, PackedRow, i)
+				: TileKey(region.Subresource, region.Y + i / region.Width, region.X + i % region.Width);
+			TileTarget target = { region.Null, region.Page, region.HeapOffset + i };
+			if (!tiles.emplace(key, target).second)
+				return false;
+		}
+	}
+	return true;
+}
+
+/// <summary>
+/// Checks the coalescing of tile mapping requests: contiguous requests merge into boxes,
+/// the last request for a tile wins, null regions come first and the mapped regions are
+/// grouped per page. Then builds random request sets and expands the regions back per tile
+/// to compare them with the requests, reporting how many regions they were merged into.
+/// </summary>
+bool RunTileMappingTest()
+{
+	const char* check = "Tile mapping test";
+
+	TileMappingBuilder builder;
+
+	// A 4x4 block mapped in order is one box
+	for (uint32_t y = 0; y < 4; y++)
+		for (uint32_t x = 0; x < 4; x++)
+			builder.Map(x + 2, y + 1, 0, 3, 10 + y * 4 + x);
+	auto regions = builder.Build();
+	if (regions.size() != 1 || regions[0].X != 2 || regions[0].Y != 1 || regions[0].Width != 4 || regions[0].Height != 4 || regions[0].HeapOffset != 10)
+		return Fail(check, "a contiguous block was not merged into one box");
+
+	// Last request wins
+	builder.Clear();
+	builder.Map(0, 0, 0, 1, 5);
+	builder.Unmap(0, 0, 0);
+	builder.Unmap(1, 0, 0);
+	builder.Map(1, 0, 0, 2, 7);
+	builder.MapPacked(4, 3, 1, 20);
+	builder.MapPacked(4, 2, 2, 30);
+	regions = builder.Build();
+	std::map<TileKey, TileTarget> tiles;
+	if (!ExpandRegions(regions, tiles) || tiles.size() != 4)
+		return Fail(check, "repeated requests for a tile were not collapsed");
+	if (!tiles[TileKey(0, 0, 0)].Null || !(tiles[TileKey(0, 0, 1)] == TileTarget{ false, 2, 7 }) ||
+		!(tiles[TileKey(4, PackedRow, 1)] == TileTarget{ false, 2, 31 }))
+		return Fail(check, "an earlier request for a tile won over a later one");
+
+	// Order
+	if (!regions[0].Null)
+		return Fail(check, "the null region did not come first");
+
+	std::mt19937 rng(17);
+	uint32_t requests = 0;
+	uint32_t mergedRegions = 0;
+	for (uint32_t iteration = 0; iteration < 500; iteration++)
+	{
+		builder.Clear();
+		std::map<TileKey, TileTarget> expected;
+
+		// Runs of neighbouring tiles with consecutive offsets, as the pool hands them out, over scattered ones
+		uint32_t numRuns = 1 + rng() % 40;
+		for (uint32_t run = 0; run < numRuns; run++)
+		{
+			uint32_t subresource = rng() % 3;
+			uint16_t page = static_cast<uint16_t>(rng() % 4);
+			uint32_t heapOffset = rng() % 256;
+
+			if (rng() % 10 == 0)
+			{
+				uint32_t numTiles = 1 + rng() % 4;
+				builder.MapPacked(subresource, numTiles, page, heapOffset);
+				requests++;
+
+				for (auto it = expected.begin(); it != expected.end();)
+					it = (std::get<0>(it->first) == subresource && std::get<1>(it->first) == PackedRow) ? expected.erase(it) : std::next(it);
+				for (uint32_t i = 0; i < numTiles; i++)
+					expected[TileKey(subresource, PackedRow, i)] = { false, page, heapOffset + i };
+				continue;
+			}
+
+			bool unmap = rng() % 3 == 0;
+			uint32_t x0 = rng() % 12;
+			uint32_t y0 = rng() % 12;
+			uint32_t width = 1 + rng() % 5;
+			uint32_t height = 1 + rng() % 3;
+			for (uint32_t y = y0; y < y0 + height; y++)
+			{
+				for (uint32_t x = x0; x < x0 + width; x++)
+				{
+					if (unmap)
+					{
+						builder.Unmap(x, y, subresource);
+						expected[TileKey(subresource, y, x)] = { true, 0, 0 };
+					}
+					else
+					{
+						builder.Map(x, y, subresource, page, heapOffset);
+						expected[TileKey(subresource, y, x)] = { false, page, heapOffset };
+						heapOffset++;
+					}
+					requests++;
+				}
+			}
+		}
+
+		const auto& built = builder.Build();
+		std::map<TileKey, TileTarget> actual;
+		if (!ExpandRegions(built, actual))
+			return Fail(check, "regions overlapped in iteration " + std::to_string(iteration));
+		if (actual.size() != expected.size())
+			return Fail(check, "the regions covered " + std::to_string(actual.size()) + " tiles instead of " +
+				std::to_string(expected.size()) + " in iteration " + std::to_string(iteration));
+		for (auto& [key, target] : expected)
+		{
+			auto search = actual.find(key);
+			if (search == actual.end() || !(search->second == target))
+				return Fail(check, "a tile did not end up with its last request in iteration " + std::to_string(iteration));
+		}
+
+		// Null regions first, then one run per page
+		size_t r = 0;
+		while (r < built.size() && built[r].Null)
+			r++;
+		for (size_t rest = r + 1; rest < built.size(); rest++)
+		{
+			if (built[rest].Null)
+				return Fail(check, "a null region followed a mapped one in iteration " + std::to_string(iteration));
+			if (built[rest].Page < built[rest - 1].Page)
+				return Fail(check, "the mapped regions were not grouped per page in iteration " + std::to_string(iteration));
+		}
+
+		mergedRegions += static_cast<uint32_t>(built.size());
+	}
+
+	std::cout << "Tile mapping test passed, " << requests << " random requests were merged into " << mergedRegions << " regions" << std::endl;
+	return true;
+}
@@ -0,0 +1,172 @@
+#include "trpch.h"
+#include "Tests/SimulatorChecks.h"
+
+#include <random>
+
+#include "TitaniumRose/Renderer/VirtualTexture/TileResidency.h"
+
+using namespace Roses;
+
+static constexpr uint32_t NoSample = 0xFF;
+
+// The tiles a feedback map asks for, marking the chain of every cell on its own
+static TileResidencySet BuildReferenceResidency(const std::vector<uint8_t>& feedback, uint32_t width, uint32_t height,
+	const std::vector<TileGridSize>& grids, uint32_t border, uint32_t generatedFromMip)
+{
+	TileResidencySet residency(grids);
+	for (uint32_t y = 0; y < height; y++)
+	{
+		for (uint32_t x = 0; x < width; x++)
+		{
+			uint32_t requested = feedback[y * width + x];
+			if (requested == NoSample)
+				continue;
+
+			for (uint32_t mip = std::min(requested, generatedFromMip); mip < grids.size(); mip++)
+				residency.Set(mip, x * grids[mip].Width / width, y * grids[mip].Height / height);
+		}
+	}
+
+	// Dilates one tile at a time against a copy
+	TileResidencySet dilated = residency;
+	for (uint32_t mip = 0; mip < grids.size(); mip++)
+	{
+		for (uint32_t y = 0; y < grids[mip].Height; y++)
+		{
+			for (uint32_t x = 0; x < grids[mip].Width; x++)
+			{
+				for (int32_t dy = -int32_t(border); dy <= int32_t(border); dy++)
+				{
+					for (int32_t dx = -int32_t(border); dx <= int32_t(border); dx++)
+					{
+						int32_t sx = int32_t(x) + dx;
+						int32_t sy = int32_t(y) + dy;
+						if (sx >= 0 && sy >= 0 && sx < int32_t(grids[mip].Width) && sy < int32_t(grids[mip].Height) &&
+							residency.IsResident(mip, sx, sy))
+						{
+							dilated.Set(mip, x, y);
+						}
+					}
+				}
+			}
+		}
+	}
+	return dilated;
+}
+
+/// <summary>
+/// Checks how feedback turns into resident tiles: cells nobody sampled are skipped, every
+/// cell marks its whole chain even when the grids do not halve exactly, generatedFromMip
+/// pulls coarse and packed tail requests up to that mip and dilation adds a clamped border.
+/// Then compares random maps over odd sized grids with a per cell reference.
+/// </summary>
+bool RunTileResidencyTest()
+{
+	const char* check = "Tile residency test";
+
+	// Nothing sampled
+	const std::vector<TileGridSize> grids = { { 8, 8 }, { 4, 4 }, { 2, 2 }, { 1, 1 } };
+	std::vector<uint8_t> feedback(8 * 8, NoSample);
+	if (BuildTileResidency(feedback.data(), 8, 8, NoSample, grids).CountResident() != 0)
+		return Fail(check, "cells that were not sampled made tiles resident");
+
+	std::vector<uint32_t> wideFeedback(8 * 8, 0xFFFFFFFF);
+	wideFeedback[9] = 4;
+	if (BuildTileResidency(wideFeedback.data(), 8, 8, 0xFFFFFFFF, grids).CountResident() != 0)
+		return Fail(check, "a request for the packed tail made tiles resident");
+	if (BuildTileResidency(static_cast<const uint8_t*>(nullptr), 8, 8, NoSample, grids).CountResident() != 0)
+		return Fail(check, "a missing feedback map made tiles resident");
+
+	// A chain
+	feedback[5 * 8 + 5] = 1;
+	TileResidencySet residency = BuildTileResidency(feedback.data(), 8, 8, NoSample, grids);
+	if (residency.CountResident() != 3 || !residency.IsResident(1, 2, 2) || !residency.IsResident(2, 1, 1) || !residency.IsResident(3, 0, 0))
+		return Fail(check, "a request did not mark exactly its chain");
+
+	// generatedFromMip
+	feedback[5 * 8 + 5] = 3;
+	if (BuildTileResidency(feedback.data(), 8, 8, NoSample, grids).CountResident() != 1)
+		return Fail(check, "a coarse request marked finer mips");
+	residency = BuildTileResidency(feedback.data(), 8, 8, NoSample, grids, 0, 1);
+	if (residency.CountResident(0) != 0 || residency.CountResident(1) != 1 || !residency.IsResident(1, 2, 2) || residency.CountResident() != 3)
+		return Fail(check, "a coarse request was not pulled up to the mip the chain is generated from");
+	feedback[5 * 8 + 5] = 0;
+	if (BuildTileResidency(feedback.data(), 8, 8, NoSample, grids, 0, 1).CountResident(0) != 1)
+		return Fail(check, "generatedFromMip dropped a finer request");
+
+	// A cell that only sampled the packed tail, mip 5 of a texture with 4 standard mips
+	std::fill(feedback.begin(), feedback.end(), uint8_t(NoSample));
+	feedback[2 * 8 + 6] = 5;
+	residency = BuildTileResidency(feedback.data(), 8, 8, NoSample, grids, 0, 2);
+	if (residency.CountResident() != 2 || !residency.IsResident(2, 1, 0) || !residency.IsResident(3, 0, 0))
+		return Fail(check, "a packed tail request was not pulled up to the mip the chain is generated from");
+	if (BuildTileResidency(feedback.data(), 8, 8, NoSample, grids).CountResident() != 0)
+		return Fail(check, "a packed tail request made tiles resident without generatedFromMip");
+
+	// Grids that do not halve exactly. x=2 and x=3 share the tile of the 3 wide mip but not of the 2 wide one
+	const std::vector<TileGridSize> oddGrids = { { 3, 1 }, { 2, 1 } };
+	std::vector<uint8_t> oddFeedback = { NoSample, NoSample, 0, 0, NoSample, NoSample };
+	residency = BuildTileResidency(oddFeedback.data(), 6, 1, NoSample, oddGrids);
+	if (!residency.IsResident(1, 0, 0) || !residency.IsResident(1, 1, 0))
+		return Fail(check, "a cell sharing a resident tile did not mark its own coarser tile");
+
+	// Dilation
+	TileResidencySet dilated(grids);
+	dilated.Set(0, 0, 0);
+	dilated.Set(0, 5, 5);
+	dilated.Set(3, 0, 0);
+	TileResidencySet undilated = dilated;
+	dilated.Dilate(0);
+	if (dilated != undilated)
+		return Fail(check, "a border of 0 changed the set");
+	dilated.Dilate(1);
+	if (dilated.CountResident(0) != 4 + 9 || !dilated.IsResident(0, 1, 1) || !dilated.IsResident(0, 6, 6) || dilated.IsResident(0, 2, 2))
+		return Fail(check, "a border of 1 did not add the clamped ring around each tile");
+	if (dilated.CountResident(3) != 1)
+		return Fail(check, "dilation went past a single tile grid");
+	dilated.Dilate(8);
+	if (dilated.CountResident(0) != 64)
+		return Fail(check, "a border wider than the grid did not cover it");
+
+	// Random maps against the reference
+	std::mt19937 rng(23);
+	uint32_t maps = 0;
+	uint32_t tiles = 0;
+	for (uint32_t iteration = 0; iteration < 400; iteration++)
+	{
+		std::vector<TileGridSize> randomGrids;
+		uint32_t width = 1 + rng() % 13;
+		uint32_t height = 1 + rng() % 13;
+		uint32_t numMips = 1 + rng() % 5;
+		for (uint32_t mip = 0; mip < numMips; mip++)
+		{
+			randomGrids.push_back({ width, height });
+			// Mostly the rounded up half, sometimes any smaller grid
+			width = rng() % 4 ? (width + 1) / 2 : 1 + rng() % width;
+			height = rng() % 4 ? (height + 1) / 2 : 1 + rng() % height;
+		}
+
+		uint32_t feedbackWidth = randomGrids[0].Width * (1 + rng() % 3) + rng() % 3;
+		uint32_t feedbackHeight = randomGrids[0].Height * (1 + rng() % 3) + rng() % 3;
+		std::vector<uint8_t> randomFeedback(feedbackWidth * feedbackHeight);
+		for (auto& cell : randomFeedback)
+			cell = rng() % 3 ? NoSample : uint8_t(rng() % (numMips + 1));
+
+		uint32_t border = rng() % 3;
+		uint32_t generatedFromMip = rng() % 2 ? uint32_t(-1) : rng() % numMips;
+
+		TileResidencySet expected = BuildReferenceResidency(randomFeedback, feedbackWidth, feedbackHeight, randomGrids, border, generatedFromMip);
+		if (BuildTileResidency(randomFeedback.data(), feedbackWidth, feedbackHeight, NoSample, randomGrids, border, generatedFromMip) != expected)
+			return Fail(check, "a random map differed from the reference in iteration " + std::to_string(iteration));
+
+		std::vector<uint32_t> randomWideFeedback(randomFeedback.begin(), randomFeedback.end());
+		if (BuildTileResidency(randomWideFeedback.data(), feedbackWidth, feedbackHeight, NoSample, randomGrids, border, generatedFromMip) != expected)
+			return Fail(check, "the 32 bit feedback differed from the 8 bit feedback in iteration " + std::to_string(iteration));
+
+		maps++;
+		tiles += expected.CountResident();
+	}
+
+	std::cout << "Tile residency test passed, " << maps << " random maps matched the reference over " << tiles << " resident tiles" << std::endl;
+	return true;
+}
@@ -0,0 +1,64 @@
+#include "trpch.h"
+#include "Tests/SimulatorChecks.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "TraceReplay.h"
+
+using namespace Roses;
+
+// Relative to the working directory, the TileSimulator folder when started from the IDE
+static const char* OscillatingTracePath = "traces/oscillating_mips.txt";
+
+/// <summary>
+/// Replays the oscillating mips trace with the default hysteresis and with both the demote
+/// delay and the feedback accumulation off. Every one of its 60 frames flips texture 0 and
+/// texture 1 between two finest mips, 59 changes each. Without hysteresis all 118 are
+/// applied. With it the accumulated feedback hides the flips of texture 1, and the demote
+/// delay keeps the finer mip of texture 0, so none of the 59 changes asked for are applied
+/// and no tile is unmapped.
+/// </summary>
+bool RunOscillatingTraceTest()
+{
+	const char* check = "Oscillating trace test";
+
+	auto replay = [&](const MipHysteresisSettings& hysteresis, SimulationSummary& summary) {
+		std::ifstream trace(OscillatingTracePath);
+		if (!trace.is_open())
+			return Fail(check, std::string("could not open ") + OscillatingTracePath + ", run it from the TileSimulator folder");
+
+		TraceReplaySettings settings;
+		settings.Hysteresis = hysteresis;
+		std::ostringstream csv;
+		if (!ReplayTrace(trace, OscillatingTracePath, settings, csv, summary))
+			return Fail(check, "the trace could not be replayed");
+		return true;
+	};
+
+	SimulationSummary on;
+	if (!replay(MipHysteresisSettings(), on))
+		return false;
+	if (on.Frames != 60 || on.MipChangesRequested != 59 || on.MipChangesApplied != 0 || on.TilesUnmapped != 0)
+	{
+		return Fail(check, "with hysteresis " + std::to_string(on.MipChangesApplied) + " of " + std::to_string(on.MipChangesRequested) +
+			" mip changes were applied and " + std::to_string(on.TilesUnmapped) + " tiles unmapped, expected 0 of 59 and none");
+	}
+
+	MipHysteresisSettings disabled;
+	disabled.DemoteDelay = 0;
+	disabled.AccumulationFrames = 0;
+	SimulationSummary off;
+	if (!replay(disabled, off))
+		return false;
+	if (off.MipChangesRequested != 118 || off.MipChangesApplied != 118)
+	{
+		return Fail(check, "without hysteresis " + std::to_string(off.MipChangesApplied) + " of " + std::to_string(off.MipChangesRequested) +
+			" mip changes were applied, expected 118 of 118");
+	}
+
+	std::cout << "Oscillating trace test passed, the hysteresis applied " << on.MipChangesApplied << " of " << on.MipChangesRequested
+		<< " mip changes and mapped " << on.TilesMapped << " tiles, without it " << off.MipChangesApplied << " of " << off.MipChangesRequested
+		<< " mapped " << off.TilesMapped << " and unmapped " << off.TilesUnmapped << std::endl;
+	return true;
+}
@@ -0,0 +1,176 @@
+#include "trpch.h"
+#include "Tests/SimulatorChecks.h"
+
+#include <iomanip>
+#include <random>
+
+#include "TitaniumRose/Core/UploadBatcher.h"
+
+using namespace Roses;
+
+/// <summary>
+/// Checks the upload batcher against a mock copy queue: tickets only complete with their
+/// batch's fence, batches close when full, and the staging budget is only reused once the
+/// batches that staged into it completed. Then loads a scene of meshes and textures through
+/// it to compare the time the loader waits against one blocking round trip per upload.
+/// </summary>
+bool RunUploadBatcherTest()
+{
+	const char* check = "Upload batcher test";
+
+	// A copy queue that finishes the batches in order, a batch takes a fixed latency plus
+	// its bytes over the bandwidth. Time is in microseconds
+	struct MockCopyQueue
+	{
+		double Latency = 0.0;
+		double BytesPerMicrosecond = 0.0;
+		double Now = 0.0;
+		uint64_t NextFence = 1;
+		std::deque<std::pair<uint64_t, double>> Pending;
+		uint64_t Completed = 0;
+
+		uint64_t Execute(size_t bytes)
+		{
+			double start = Pending.empty() ? Now : std::max(Now, Pending.back().second);
+			Pending.emplace_back(NextFence, start + Latency + bytes / BytesPerMicrosecond);
+			return NextFence++;
+		}
+		void Advance(double time)
+		{
+			Now = std::max(Now, time);
+			while (!Pending.empty() && Pending.front().second <= Now)
+			{
+				Completed = Pending.front().first;
+				Pending.pop_front();
+			}
+		}
+		void WaitForFence(uint64_t fence)
+		{
+			while (Completed < fence && !Pending.empty())
+				Advance(Pending.front().second);
+		}
+	};
+
+	MockCopyQueue queue;
+	queue.Latency = 100.0;
+	queue.BytesPerMicrosecond = 10000.0;
+	auto isComplete = [&](uint64_t value) { return value <= queue.Completed; };
+
+	UploadBatcher batcher(4096, 1024, 3);
+	UploadBatcher::Reservation a = batcher.Reserve(300, 256);
+	UploadBatcher::Reservation b = batcher.Reserve(300, 256);
+	if (!a.IsValid() || !b.IsValid() || a.Ticket == b.Ticket || b.Offset != 512)
+		return Fail(check, "requests were not staged back to back");
+	if (batcher.IsBatchFull())
+		return Fail(check, "a batch was full before its limits");
+	uint64_t fence = 0;
+	if (batcher.IsSubmitted(a.Ticket) || batcher.GetFence(a.Ticket, fence))
+		return Fail(check, "a ticket of the open batch had a fence");
+
+	UploadBatcher::Reservation c = batcher.Reserve(10);
+	if (!batcher.IsBatchFull())
+		return Fail(check, "a batch was not full at its request limit");
+	uint64_t first = queue.Execute(610);
+	if (batcher.CloseBatch(first) != c.Ticket || batcher.CloseBatch(first + 1) != 0)
+		return Fail(check, "closing a batch did not return its last ticket");
+	if (!batcher.GetFence(b.Ticket, fence) || fence != first)
+		return Fail(check, "a submitted ticket did not report its batch's fence");
+
+	UploadBatcher::Reservation d = batcher.Reserve(2000);
+	if (!batcher.IsBatchFull())
+		return Fail(check, "a batch was not full at its byte limit");
+	uint64_t second = queue.Execute(2000);
+	batcher.CloseBatch(second);
+
+	if (batcher.Reserve(2048).IsValid())
+		return Fail(check, "the staging budget was overcommitted");
+	batcher.Retire(isComplete);
+	if (batcher.IsComplete(a.Ticket))
+		return Fail(check, "a ticket completed before its fence");
+
+	queue.WaitForFence(first);
+	batcher.Retire(isComplete);
+	if (!batcher.IsComplete(c.Ticket) || batcher.IsComplete(d.Ticket))
+		return Fail(check, "tickets did not complete with their batch");
+	if (!batcher.GetOldestFence(fence) || fence != second)
+		return Fail(check, "the oldest staging range does not wait for the second batch");
+
+	queue.WaitForFence(second);
+	batcher.Retire(isComplete);
+	if (!batcher.IsComplete(d.Ticket) || batcher.GetStagedBytes() != 0 || batcher.GetBatchesInFlight() != 0)
+		return Fail(check, "the batcher did not drain");
+
+	// A scene load: mostly small meshes, some large textures, the loader only waits when
+	// the staging budget is exhausted. The blocking path waits for a round trip per upload
+	static constexpr size_t Budget = 64 * 1024 * 1024;
+	static constexpr uint32_t Uploads = 2000;
+	static constexpr double RecordTime = 20.0;
+
+	MockCopyQueue loadQueue;
+	loadQueue.Latency = 250.0;
+	loadQueue.BytesPerMicrosecond = 8000.0;
+	auto loadComplete = [&](uint64_t value) { return value <= loadQueue.Completed; };
+
+	UploadBatcher loader(Budget, 16 * 1024 * 1024, 64);
+	std::mt19937 random(5);
+	std::vector<uint64_t> tickets;
+	double blockingTime = 0.0;
+	double waited = 0.0;
+	uint64_t stalls = 0;
+
+	auto submit = [&]() {
+		if (loader.HasOpenBatch())
+			loader.CloseBatch(loadQueue.Execute(loader.GetOpenBytes()));
+	};
+
+	for (uint32_t u = 0; u < Uploads; u++)
+	{
+		size_t size = random() % 10 == 0 ? (1 + random() % 16) * 1024 * 1024 / 2 : 4096 + random() % (256 * 1024);
+		blockingTime += RecordTime + loadQueue.Latency + size / loadQueue.BytesPerMicrosecond;
+
+		loadQueue.Advance(loadQueue.Now + RecordTime);
+		loader.Retire(loadComplete);
+
+		UploadBatcher::Reservation r = loader.Reserve(size, 512);
+		while (!r.IsValid())
+		{
+			uint64_t oldest = 0;
+			if (!loader.GetOldestFence(oldest))
+			{
+				submit();
+				continue;
+			}
+			double before = loadQueue.Now;
+			loadQueue.WaitForFence(oldest);
+			waited += loadQueue.Now - before;
+			++stalls;
+			loader.Retire(loadComplete);
+			r = loader.Reserve(size, 512);
+		}
+		tickets.push_back(r.Ticket);
+
+		if (loader.IsBatchFull())
+			submit();
+	}
+	submit();
+
+	double loadTime = loadQueue.Now;
+	loadQueue.WaitForFence(loadQueue.NextFence - 1);
+	loader.Retire(loadComplete);
+	for (uint64_t ticket : tickets)
+	{
+		if (!loader.IsComplete(ticket))
+			return Fail(check, "a ticket never completed");
+	}
+	if (loader.GetPeakStagedBytes() > Budget)
+		return Fail(check, "the staging budget was exceeded");
+
+	auto& stats = loader.GetStats();
+	std::cout << "Upload batcher test passed: " << stats.Requests << " uploads ("
+		<< stats.BytesStaged / (1024 * 1024) << " MB) in " << stats.Batches << " batches, peak staging "
+		<< loader.GetPeakStagedBytes() / (1024.0 * 1024.0) << " of " << Budget / (1024 * 1024) << " MB, "
+		<< stalls << " budget stalls. The loader finished after " << loadTime / 1000.0 << " ms, "
+		<< waited / 1000.0 << " ms of it waiting, everything was on the GPU after " << loadQueue.Now / 1000.0
+		<< " ms. Blocking uploads would have taken " << blockingTime / 1000.0 << " ms" << std::endl;
+	return true;
+}
@@ -0,0 +1,167 @@
+#include "trpch.h"
+#include "Tests/SimulatorChecks.h"
+
+#include <iomanip>
+#include <random>
+
+#include "TitaniumRose/Core/UploadRing.h"
+
+using namespace Roses;
+
+/// <summary>
+/// Checks the upload ring: blocks never overlap, wrap instead of splitting, and are only
+/// reclaimed in order once closed and complete, whatever order they are closed in. Then
+/// replays bursty uploads from a few contexts to report the high-water mark next to the
+/// memory the old page pool would have created for them.
+/// </summary>
+bool RunUploadRingTest()
+{
+	const char* check = "Upload ring test";
+	auto all = [](uint64_t) { return true; };
+
+	// Ring math
+	UploadRing ring(1024);
+	UploadRing::Block a = ring.Allocate(300);
+	UploadRing::Block b = ring.Allocate(300);
+	UploadRing::Block c = ring.Allocate(300);
+	if (a.Offset != 0 || b.Offset != 300 || c.Offset != 600 || ring.GetUsedBytes() != 900)
+		return Fail(check, "blocks were not handed out back to back");
+	if (ring.Allocate(300).IsValid() || ring.Allocate(2048).IsValid() || ring.Allocate(0).IsValid())
+		return Fail(check, "a block was handed out without room for it");
+
+	uint64_t fence = 0;
+	if (ring.GetOldestFence(fence))
+		return Fail(check, "an open block had a fence to wait on");
+	ring.Close(b.Id, 1);
+	if (ring.Retire(all) != 0)
+		return Fail(check, "a block was reclaimed before an older open one");
+	ring.Close(a.Id, 2);
+	if (!ring.GetOldestFence(fence) || fence != 2)
+		return Fail(check, "the oldest fence is not the first block's");
+	if (ring.Retire([](uint64_t value) { return value <= 1; }) != 0)
+		return Fail(check, "a block was reclaimed before its fence completed");
+	if (ring.Retire(all) != 2 || ring.GetUsedBytes() != 300)
+		return Fail(check, "closed and completed blocks were not reclaimed");
+
+	UploadRing::Block wrapped = ring.Allocate(300);
+	if (wrapped.Offset != 0 || ring.GetStats().Wraps != 1 || ring.GetStats().Skipped != 124)
+		return Fail(check, "a block that did not fit at the end did not wrap");
+	UploadRing::Block aligned = ring.Allocate(10, 256);
+	if (aligned.Offset != 512)
+		return Fail(check, "a block was not aligned");
+	ring.Close(c.Id, 3);
+	ring.Close(aligned.Id, 4);
+	ring.Close(wrapped.Id, 5);
+	ring.Retire(all);
+	if (!ring.IsEmpty() || ring.GetUsedBytes() != 0)
+		return Fail(check, "the ring did not drain");
+
+	// Bursty uploads from several contexts that finish in any order, every byte of the ring
+	// is owned by at most one block. A full ring waits for its oldest block like the
+	// renderer's blocking policy, unless that block is still open
+	static constexpr size_t Capacity = 16 * 1024 * 1024;
+	static constexpr size_t BlockSize = 64 * 1024;
+	static constexpr uint32_t Contexts = 4;
+	static constexpr uint32_t Frames = 2000;
+	static constexpr uint64_t GpuLatency = 3;
+
+	UploadRing uploads(Capacity);
+	std::vector<uint8_t> owned(Capacity, 0);
+	std::deque<UploadRing::Block> inFlight;
+	std::vector<std::vector<UploadRing::Block>> contextBlocks(Contexts);
+	std::mt19937 random(11);
+	uint64_t nextFence = 1;
+	uint64_t completedFence = 0;
+	uint64_t denied = 0;
+	uint64_t stalls = 0;
+	// The old page pool: 64 KB pages reused once retired, a dedicated page per oversized request
+	uint64_t poolPages = 0;
+	uint64_t poolFreePages = 0;
+	uint64_t dedicatedBytes = 0;
+	std::deque<std::pair<uint64_t, uint64_t>> poolRetired;
+	auto retire = [&]() {
+		uint32_t retired = uploads.Retire([&](uint64_t value) { return value <= completedFence; });
+		for (uint32_t i = 0; i < retired; i++)
+		{
+			UploadRing::Block& block = inFlight.front();
+			std::fill(owned.begin() + block.Offset, owned.begin() + block.Offset + block.Size, 0);
+			inFlight.pop_front();
+		}
+	};
+
+	for (uint32_t frame = 0; frame < Frames; frame++)
+	{
+		bool burst = frame % 200 < 5;
+		for (uint32_t context = 0; context < Contexts; context++)
+		{
+			uint32_t uploadsThisFrame = burst ? 40 : 4;
+			uint64_t pagesUsed = 0;
+			for (uint32_t u = 0; u < uploadsThisFrame; u++)
+			{
+				size_t size = random() % 8 == 0 ? 256 * 1024 + random() % (512 * 1024) : BlockSize;
+				UploadRing::Block block = uploads.Allocate(size, 512);
+				uint64_t oldestFence = 0;
+				while (!block.IsValid() && uploads.GetOldestFence(oldestFence))
+				{
+					completedFence = std::max(completedFence, oldestFence);
+					retire();
+					++stalls;
+					block = uploads.Allocate(size, 512);
+				}
+				if (!block.IsValid())
+				{
+					++denied;
+					continue;
+				}
+
+				for (size_t i = block.Offset; i < block.Offset + block.Size; i++)
+				{
+					if (owned[i])
+						return Fail(check, "two blocks in flight overlap");
+					owned[i] = 1;
+				}
+				contextBlocks[context].push_back(block);
+				inFlight.push_back(block);
+
+				if (size > BlockSize)
+					dedicatedBytes += size;
+				else
+					++pagesUsed;
+			}
+
+			while (!poolRetired.empty() && poolRetired.front().first <= completedFence)
+			{
+				poolFreePages += poolRetired.front().second;
+				poolRetired.pop_front();
+			}
+			uint64_t reused = std::min(poolFreePages, pagesUsed);
+			poolFreePages -= reused;
+			poolPages += pagesUsed - reused;
+		}
+
+		// The contexts finish in a random order
+		std::vector<uint32_t> order(Contexts);
+		for (uint32_t i = 0; i < Contexts; i++)
+			order[i] = i;
+		std::shuffle(order.begin(), order.end(), random);
+		for (uint32_t context : order)
+		{
+			uint64_t contextFence = nextFence++;
+			for (auto& block : contextBlocks[context])
+				uploads.Close(block.Id, contextFence);
+			poolRetired.emplace_back(contextFence, contextBlocks[context].size());
+			contextBlocks[context].clear();
+		}
+
+		completedFence = std::max(completedFence, nextFence > GpuLatency * Contexts ? nextFence - GpuLatency * Contexts : 0);
+		retire();
+	}
+
+	auto& stats = uploads.GetStats();
+	std::cout << "Upload ring test passed: " << stats.Allocations << " blocks, high-water mark "
+		<< stats.HighWater / (1024.0 * 1024.0) << " of " << Capacity / (1024 * 1024) << " MB, "
+		<< stats.Wraps << " wraps (" << stats.Skipped / 1024 << " KB skipped), " << stalls << " stalls, "
+		<< denied << " would have grown the ring. "
+		<< "The page pool would have created " << (poolPages * BlockSize + dedicatedBytes) / (1024 * 1024) << " MB" << std::endl;
+	return true;
+}
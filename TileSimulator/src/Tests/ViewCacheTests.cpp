@@ -0,0 +1,119 @@
+#include "trpch.h"
+#include "Tests/SimulatorChecks.h"
+
+#include <cstring>
+#include <iomanip>
+#include <random>
+
+#include "TitaniumRose/Core/DescriptorViewCache.h"
+
+using namespace Roses;
+
+// Mirrors the bytes of a texture view description, zeroed before it is filled in
+struct SimulatedViewDesc
+{
+	uint32_t Format;
+	uint32_t Dimension;
+	uint32_t MostDetailedMip;
+	uint32_t MipLevels;
+	uint64_t Reserved;
+};
+
+static DescriptorViewKey MakeViewKey(uintptr_t resource, uint32_t viewType, uint32_t mip, uint32_t mipLevels = 1)
+{
+	SimulatedViewDesc desc;
+	std::memset(&desc, 0, sizeof(desc));
+	desc.Format = 28;
+	desc.Dimension = 4;
+	desc.MostDetailedMip = mip;
+	desc.MipLevels = mipLevels;
+	return DescriptorViewKey::Create(reinterpret_cast<const void*>(resource), viewType, &desc, sizeof(desc));
+}
+
+/// <summary>
+/// Checks the view cache key and policy: identical requests hit, any difference in the
+/// resource, view type or description misses, invalidating a resource only drops its own
+/// views and a full cache stops caching instead of evicting. Then replays a frame loop that
+/// asks for a few views per texture to report the hit rate.
+/// </summary>
+bool RunViewCacheTest()
+{
+	const char* check = "View cache test";
+
+	// Keys
+	DescriptorViewKey key = MakeViewKey(0x1000, 0, 2);
+	if (key != MakeViewKey(0x1000, 0, 2) || HashDescriptorViewKey(key) != HashDescriptorViewKey(MakeViewKey(0x1000, 0, 2)))
+		return Fail(check, "identical requests produced different keys");
+	if (key == MakeViewKey(0x2000, 0, 2) || key == MakeViewKey(0x1000, 1, 2) ||
+		key == MakeViewKey(0x1000, 0, 3) || key == MakeViewKey(0x1000, 0, 2, 2))
+		return Fail(check, "different requests produced the same key");
+	if (HashDescriptorViewKey(key) == HashDescriptorViewKey(MakeViewKey(0x1000, 0, 3)))
+		return Fail(check, "neighbouring mips hash the same");
+
+	// Policy
+	DescriptorViewCache<uint32_t> cache(4);
+	if (cache.Find(key) != nullptr)
+		return Fail(check, "an empty cache returned a view");
+	cache.Insert(key, 7);
+	const uint32_t* view = cache.Find(MakeViewKey(0x1000, 0, 2));
+	if (view == nullptr || *view != 7)
+		return Fail(check, "an identical request did not return the cached view");
+
+	cache.Insert(MakeViewKey(0x1000, 1, 0), 8);
+	cache.Insert(MakeViewKey(0x2000, 0, 0), 9);
+	cache.Insert(MakeViewKey(0x2000, 0, 1), 10);
+	if (cache.Insert(MakeViewKey(0x3000, 0, 0), 11) || cache.GetCount() != 4 || cache.GetStats().Rejected != 1)
+		return Fail(check, "a full cache accepted a view");
+
+	std::vector<uint32_t> evicted;
+	if (cache.Invalidate(reinterpret_cast<const void*>(uintptr_t(0x1000)), [&](uint32_t v) { evicted.push_back(v); }) != 2)
+		return Fail(check, "invalidating a resource did not drop its two views");
+	std::sort(evicted.begin(), evicted.end());
+	if (evicted != std::vector<uint32_t>{ 7, 8 })
+		return Fail(check, "invalidating a resource evicted the wrong views");
+	if (cache.Find(key) != nullptr || cache.Find(MakeViewKey(0x2000, 0, 1)) == nullptr)
+		return Fail(check, "invalidation dropped the wrong resource");
+	if (cache.Invalidate(reinterpret_cast<const void*>(uintptr_t(0x1000)), [&](uint32_t) {}) != 0)
+		return Fail(check, "a resource was invalidated twice");
+	if (!cache.Insert(MakeViewKey(0x3000, 0, 0), 11))
+		return Fail(check, "invalidation did not make room");
+
+	// Hit rate over a frame loop: every texture is read at a mip that drifts slowly and
+	// written at one of two mips, a texture is recreated every 50 frames
+	static constexpr uint32_t Textures = 64;
+	static constexpr uint32_t Frames = 1000;
+	DescriptorViewCache<uint32_t> frameCache(1024);
+	std::vector<uintptr_t> resources(Textures);
+	for (uint32_t t = 0; t < Textures; t++)
+		resources[t] = 0x10000 + t * 0x100;
+	uintptr_t nextResource = 0x10000 + Textures * 0x100;
+	uint32_t created = 0;
+	std::mt19937 random(5);
+
+	for (uint32_t frame = 0; frame < Frames; frame++)
+	{
+		if (frame % 50 == 49)
+		{
+			uint32_t t = random() % Textures;
+			frameCache.Invalidate(reinterpret_cast<const void*>(resources[t]), [](uint32_t) {});
+			resources[t] = nextResource += 0x100;
+		}
+
+		for (uint32_t t = 0; t < Textures; t++)
+		{
+			uint32_t readMip = (frame / 100 + t) % 6;
+			uint32_t writeMip = (frame + t) % 2;
+			for (DescriptorViewKey request : { MakeViewKey(resources[t], 0, readMip, 6 - readMip), MakeViewKey(resources[t], 1, writeMip) })
+			{
+				if (frameCache.Find(request) == nullptr)
+					frameCache.Insert(request, created++);
+			}
+		}
+	}
+
+	auto& stats = frameCache.GetStats();
+	std::cout << "View cache test passed: " << stats.Hits << " hits, " << stats.Misses << " misses ("
+		<< stats.HitRate() * 100.0f << "% hit rate), " << created << " views written, "
+		<< frameCache.GetCount() << " cached at the end" << std::endl;
+	return true;
+}
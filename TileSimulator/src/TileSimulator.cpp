@@ -0,0 +1,132 @@
+#include "trpch.h"
+#include "cxxopts/include/cxxopts.hpp"
+
+#include <fstream>
+#include <iomanip>
+
+#include "SimulatedTiling.h"
+#include "TraceReplay.h"
+#include "Tests/SimulatorChecks.h"
+
+using namespace Roses;
+
+/// <summary>
+/// Replays the trace given on the command line, see ReplayTrace for its format, or runs
+/// one of the checks.
+/// </summary>
+int main(int argc, char** argv)
+{
+	cxxopts::Options options("TileSimulator", "Replays texture residency traces through the tile pool");
+	const TraceReplaySettings defaults;
+
+	options.add_options()
+		("t,trace", "The trace to replay", cxxopts::value<std::string>())
+		("o,output", "Where to write the per frame CSV, defaults to the standard output", cxxopts::value<std::string>())
+		("b,budget", "Tile pool budget in MB, 0 is unlimited", cxxopts::value<uint64_t>()->default_value("0"))
+		("m,mode", "Residency mode, mips or tiles", cxxopts::value<std::string>()->default_value("mips"))
+		("border", "Tiles kept around every requested tile in tiles mode",
+			cxxopts::value<uint32_t>()->default_value(std::to_string(defaults.Border)))
+		("c,compaction", "Tiles compacted per frame, 0 disables compaction",
+			cxxopts::value<uint32_t>()->default_value(std::to_string(defaults.CompactionBudget)))
+		("r,release-delay", "Frames a page stays empty before it is released",
+			cxxopts::value<uint32_t>()->default_value(std::to_string(defaults.PageReleaseDelay)))
+		("demote-delay", "Frames a mip has to go unused before it is dropped, 0 follows the trace",
+			cxxopts::value<uint32_t>()->default_value(std::to_string(defaults.Hysteresis.DemoteDelay)))
+		("readback-latency", "Frames before the feedback of a frame can be read",
+			cxxopts::value<uint32_t>()->default_value(std::to_string(defaults.ReadbackLatency)))
+		("feedback-format", "compact (a byte per cell) or full (a uint32_t per cell) readback", cxxopts::value<std::string>()->default_value("compact"))
+		("readback-arena", "Size of the feedback readback arena in MB",
+			cxxopts::value<uint64_t>()->default_value(std::to_string(defaults.ReadbackArenaBytes / (1024 * 1024))))
+		("accumulation", "Frames a feedback cell keeps its finest mip, 0 disables the accumulation",
+			cxxopts::value<uint32_t>()->default_value(std::to_string(defaults.Hysteresis.AccumulationFrames)))
+		("h,help", "Prints this help")
+		;
+	for (auto& check : GetSimulatorChecks())
+		options.add_options("Checks")(check.Option, std::string(check.Description) + " instead of replaying a trace");
+	options.parse_positional({ "trace" });
+
+	auto result = options.parse(argc, argv);
+
+	for (auto& check : GetSimulatorChecks())
+	{
+		if (result.count(check.Option))
+			return check.Run() ? 0 : 1;
+	}
+
+	if (result.count("help") || !result.count("trace"))
+	{
+		std::cout << options.help({ "", "Checks" }) << std::endl;
+		return result.count("help") ? 0 : 1;
+	}
+
+	std::string tracePath = result["trace"].as<std::string>();
+	std::ifstream trace(tracePath);
+	if (!trace.is_open())
+	{
+		std::cerr << "Could not open trace " << tracePath << std::endl;
+		return 1;
+	}
+
+	std::ofstream outputFile;
+	if (result.count("output"))
+	{
+		outputFile.open(result["output"].as<std::string>());
+		if (!outputFile.is_open())
+		{
+			std::cerr << "Could not open output " << result["output"].as<std::string>() << std::endl;
+			return 1;
+		}
+	}
+	std::ostream& csv = outputFile.is_open() ? outputFile : std::cout;
+
+	std::string mode = result["mode"].as<std::string>();
+	if (mode != "mips" && mode != "tiles")
+	{
+		std::cerr << "Unknown residency mode " << mode << ", expected mips or tiles" << std::endl;
+		return 1;
+	}
+
+	TraceReplaySettings settings;
+	settings.Mode = mode == "tiles" ? TileResidencyMode::FeedbackTiles : TileResidencyMode::MipRange;
+	settings.Border = result["border"].as<uint32_t>();
+	settings.TileBudget = result["budget"].as<uint64_t>() * 1024 * 1024 / TileSizeInBytes;
+	settings.CompactionBudget = result["compaction"].as<uint32_t>();
+	settings.PageReleaseDelay = result["release-delay"].as<uint32_t>();
+	settings.Hysteresis.DemoteDelay = result["demote-delay"].as<uint32_t>();
+	settings.Hysteresis.AccumulationFrames = result["accumulation"].as<uint32_t>();
+	settings.ReadbackLatency = result["readback-latency"].as<uint32_t>();
+	settings.ReadbackArenaBytes = result["readback-arena"].as<uint64_t>() * 1024 * 1024;
+
+	const std::string feedbackFormat = result["feedback-format"].as<std::string>();
+	if (feedbackFormat != "compact" && feedbackFormat != "full")
+	{
+		std::cerr << "Unknown feedback format " << feedbackFormat << ", expected compact or full" << std::endl;
+		return 1;
+	}
+	settings.CompactFeedback = feedbackFormat == "compact";
+
+	SimulationSummary summary;
+	if (!ReplayTrace(trace, tracePath, settings, csv, summary))
+		return 1;
+
+	std::cerr << std::fixed << std::setprecision(3)
+		<< "Frames:          " << summary.Frames << "\n"
+		<< "Tiles mapped:    " << summary.TilesMapped << "\n"
+		<< "Tiles unmapped:  " << summary.TilesUnmapped << "\n"
+		<< "Tiles evicted:   " << summary.TilesEvicted << "\n"
+		<< "Tiles denied:    " << summary.TilesDenied << "\n"
+		<< "Tiles moved:     " << summary.TilesMoved << "\n"
+		<< "Mip changes:     " << summary.MipChangesApplied << " of " << summary.MipChangesRequested << " applied, "
+			<< summary.DemotionsDelayed << " demotions delayed\n"
+		<< "Pages:           " << summary.Pages << " (peak " << summary.PeakPages << ", "
+			<< summary.PagesCreated << " created, " << summary.PagesDestroyed << " destroyed)\n"
+		<< "Fragmentation:   " << summary.Fragmentation << "\n"
+		<< "Mapping calls:   " << summary.MappingCalls << "\n"
+		<< "Readback:        " << summary.CopiesRead << " copies read, "
+			<< summary.CopiesSkipped << " skipped, " << summary.BytesCopied << " bytes\n"
+		<< "CPU time (ms):   " << summary.TotalCpuTime << " total, "
+			<< (summary.Frames > 0 ? summary.TotalCpuTime / summary.Frames : 0.0) << " average, "
+			<< summary.MaxCpuTime << " max" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,335 @@
+#include "trpch.h"
+#include "TraceReplay.h"
+
+#include <chrono>
+#include <cstring>
+#include <sstream>
+
+#include "TitaniumRose/Renderer/VirtualTexture/FeedbackReduction.h"
+#include "TitaniumRose/Renderer/VirtualTexture/ReadbackRing.h"
+
+#include "SimulatedTiling.h"
+
+using namespace Roses;
+
+struct SimulatedTexture
+{
+	VirtualTextureLayout Layout;
+	bool Used = false;
+
+	// Set by a mips line, only for the frame it is in
+	bool HasMips = false;
+	uint32_t FinestMip = 0;
+	uint32_t CoarsestMip = 0;
+
+	// The feedback of the last feedback line, waiting to be read back
+	std::vector<uint32_t> TracedFeedback;
+	bool FeedbackWritten = false;
+
+	// The last feedback that was read back, kept until the next one like a feedback map would be.
+	// Always compact, whatever the format it was read back in.
+	std::vector<uint8_t> Feedback;
+	uint32_t FeedbackWidth = 0;
+	uint32_t FeedbackHeight = 0;
+
+	MipHysteresis Hysteresis;
+	FeedbackAccumulator Accumulator;
+};
+
+/// <summary>
+/// Stands in for D3D12FeedbackReadback. The arena is plain memory and the fence of a frame
+/// completes Latency frames after it was submitted.
+/// </summary>
+struct SimulatedReadback
+{
+	SimulatedReadback(uint64_t capacity, uint32_t latency, bool compact)
+		: Ring(capacity, latency + 1), Arena(capacity), Latency(latency), Compact(compact)
+	{
+	}
+
+	ReadbackRing Ring;
+	std::vector<uint8_t> Arena;
+	uint32_t Latency;
+	// One byte per cell like a compact feedback map, or a uint32_t per cell
+	bool Compact;
+	uint64_t Frame = 0;
+	uint64_t BytesCopied = 0;
+};
+
+/// <summary>
+/// Does what VirtualTexture2D::ExtractMipsUsed does with the traced data: accumulates the
+/// feedback, reduces it unless a mips line gave the mips, and runs it through the hysteresis.
+/// </summary>
+static TextureResidencyRequest MakeRequest(SimulatedTexture& texture, const MipHysteresisSettings& hysteresis)
+{
+	TextureResidencyRequest request;
+	uint32_t mipLevels = texture.Layout.MipLevels;
+
+	if (!texture.Feedback.empty())
+	{
+		request.Feedback = texture.Feedback.data();
+		if (hysteresis.AccumulationFrames > 0) {
+			request.Feedback = texture.Accumulator.Accumulate(request.Feedback, texture.FeedbackWidth,
+				texture.FeedbackHeight, hysteresis.AccumulationFrames).data();
+		}
+		request.FeedbackWidth = texture.FeedbackWidth;
+		request.FeedbackHeight = texture.FeedbackHeight;
+	}
+
+	uint32_t finestMip = texture.FinestMip;
+	uint32_t coarsestMip = texture.CoarsestMip;
+	if (!texture.HasMips && request.Feedback == nullptr)
+	{
+		// Nothing was read back yet, which looks like nothing was sampled
+		finestMip = coarsestMip = mipLevels - 1;
+	}
+	else if (!texture.HasMips)
+	{
+		FeedbackReduction reduction = ReduceFeedback(request.Feedback, texture.Feedback.size(), mipLevels);
+		finestMip = std::min(reduction.FinestMip, mipLevels - 1);
+		coarsestMip = std::max(reduction.CoarsestMip, finestMip);
+	}
+
+	texture.Hysteresis.Update(finestMip, coarsestMip, hysteresis);
+	request.FinestMip = texture.Hysteresis.GetFinestMip();
+	request.CoarsestMip = texture.Hysteresis.GetCoarsestMip();
+
+	return request;
+}
+
+/// <summary>
+/// Copies the feedback written this frame into the arena and hands out the copies whose
+/// fence completed, like UpdateVirtualTextures does with the feedback maps.
+/// </summary>
+static void ReadbackFeedback(SimulatedReadback& readback, std::unordered_map<uint32_t, SimulatedTexture>& textures)
+{
+	for (auto& [id, texture] : textures)
+	{
+		if (!texture.FeedbackWritten)
+			continue;
+
+		ReadbackSlot slot;
+		const auto& cells = texture.TracedFeedback;
+		uint64_t size = cells.size() * (readback.Compact ? sizeof(uint8_t) : sizeof(uint32_t));
+		if (readback.Ring.Allocate(&texture, size, 256, slot))
+		{
+			uint8_t* target = readback.Arena.data() + slot.Offset;
+			if (readback.Compact)
+			{
+				for (size_t i = 0; i < cells.size(); i++)
+					target[i] = static_cast<uint8_t>(std::min<uint32_t>(cells[i], UINT8_MAX));
+			}
+			else
+			{
+				memcpy(target, cells.data(), size);
+			}
+			readback.BytesCopied += size;
+		}
+
+		texture.FeedbackWritten = false;
+	}
+
+	readback.Ring.EndFrame(readback.Frame);
+	readback.Ring.Retire(
+		[&](uint64_t fenceValue) { return fenceValue + readback.Latency <= readback.Frame; },
+		[&](const ReadbackSlot& slot) {
+			auto texture = static_cast<SimulatedTexture*>(slot.Owner);
+			const uint8_t* source = readback.Arena.data() + slot.Offset;
+			if (readback.Compact)
+			{
+				texture->Feedback.assign(source, source + slot.Size);
+				return;
+			}
+
+			// The same narrowing D3D12FeedbackMap::ReceiveData does
+			texture->Feedback.resize(slot.Size / sizeof(uint32_t));
+			for (size_t i = 0; i < texture->Feedback.size(); i++)
+			{
+				uint32_t cell;
+				memcpy(&cell, source + i * sizeof(uint32_t), sizeof(cell));
+				texture->Feedback[i] = static_cast<uint8_t>(std::min<uint32_t>(cell, UINT8_MAX));
+			}
+		}
+	);
+	readback.Frame++;
+}
+
+static void RunFrame(TilePoolCore& pool, std::unordered_map<uint32_t, SimulatedTexture>& textures,
+	SimulatedReadback& readback, const MipHysteresisSettings& hysteresis, SimulationSummary& summary, std::ostream& csv)
+{
+	uint32_t texturesUsed = 0;
+	uint64_t mipChangesRequested = 0;
+	uint64_t mipChangesApplied = 0;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	ReadbackFeedback(readback, textures);
+	for (auto& [id, texture] : textures)
+	{
+		if (!texture.Used)
+			continue;
+
+		MipHysteresisStats before = texture.Hysteresis.GetStats();
+		pool.MapTexture(&texture, texture.Layout, MakeRequest(texture, hysteresis));
+		++texturesUsed;
+
+		auto& after = texture.Hysteresis.GetStats();
+		mipChangesRequested += after.RequestedChanges - before.RequestedChanges;
+		mipChangesApplied += after.AppliedChanges - before.AppliedChanges;
+		summary.DemotionsDelayed += after.DemotionsDelayed - before.DemotionsDelayed;
+	}
+	pool.FlushUpdates();
+	pool.Compact();
+	auto end = std::chrono::high_resolution_clock::now();
+
+	double cpuTime = std::chrono::duration<double, std::milli>(end - start).count();
+	auto& flush = pool.GetLastFlushStats();
+	auto& compaction = pool.GetLastCompactionStats();
+	FragmentationStats fragmentation = pool.GetFragmentation();
+	uint32_t pages = pool.GetPageCount();
+
+	csv << summary.Frames << ","
+		<< texturesUsed << ","
+		<< flush.TilesMapped << ","
+		<< flush.TilesUnmapped << ","
+		<< flush.TilesEvicted << ","
+		<< flush.TilesDenied << ","
+		<< mipChangesRequested << ","
+		<< mipChangesApplied << ","
+		<< compaction.TilesMoved << ","
+		<< pages << ","
+		<< fragmentation.UsedTiles << ","
+		<< fragmentation.Fragmentation << ","
+		<< cpuTime << "\n";
+
+	summary.Frames++;
+	summary.TilesMapped += flush.TilesMapped;
+	summary.TilesUnmapped += flush.TilesUnmapped;
+	summary.TilesEvicted += flush.TilesEvicted;
+	summary.TilesDenied += flush.TilesDenied;
+	summary.TilesMoved += compaction.TilesMoved;
+	summary.MipChangesRequested += mipChangesRequested;
+	summary.MipChangesApplied += mipChangesApplied;
+	summary.PeakPages = std::max(summary.PeakPages, pages);
+	summary.TotalCpuTime += cpuTime;
+	summary.MaxCpuTime = std::max(summary.MaxCpuTime, cpuTime);
+
+	for (auto& [id, texture] : textures)
+	{
+		texture.Used = false;
+		texture.HasMips = false;
+	}
+}
+bool ReplayTrace(std::istream& trace, const std::string& tracePath, const TraceReplaySettings& settings,
+	std::ostream& csv, SimulationSummary& summary)
+{
+	NullMappingBackend backend;
+	TilePoolCore pool(backend, TilesPerPage);
+	pool.SetResidencyMode(settings.Mode);
+	pool.SetResidencyBorder(settings.Border);
+	pool.SetTileBudget(settings.TileBudget);
+	pool.SetCompactionBudget(settings.CompactionBudget);
+	pool.SetPageReleaseDelay(settings.PageReleaseDelay);
+
+	SimulatedReadback readback(settings.ReadbackArenaBytes, settings.ReadbackLatency, settings.CompactFeedback);
+
+	std::unordered_map<uint32_t, SimulatedTexture> textures;
+	bool framePending = false;
+
+	csv << "frame,textures,tiles_mapped,tiles_unmapped,tiles_evicted,tiles_denied,mip_changes_requested,mip_changes_applied,tiles_moved,pages,tiles_used,fragmentation,cpu_ms\n";
+
+	std::string line;
+	uint32_t lineNumber = 0;
+	while (std::getline(trace, line))
+	{
+		++lineNumber;
+		std::istringstream tokens(line);
+		std::string command;
+		if (!(tokens >> command) || command[0] == '#')
+			continue;
+
+		auto fail = [&](const char* reason) {
+			std::cerr << tracePath << ":" << lineNumber << ": " << reason << std::endl;
+			return false;
+		};
+
+		if (command == "frame")
+		{
+			RunFrame(pool, textures, readback, settings.Hysteresis, summary, csv);
+			framePending = false;
+			continue;
+		}
+
+		uint32_t id;
+		if (!(tokens >> id))
+			return fail("Expected a texture id");
+
+		if (command == "texture")
+		{
+			uint32_t width, height, mipLevels;
+			if (!(tokens >> width >> height >> mipLevels) || mipLevels == 0)
+				return fail("Expected texture <id> <width> <height> <mips>");
+			if (textures.count(id))
+				return fail("Texture is already declared");
+
+			textures[id].Layout = MakeLayout(width, height, mipLevels);
+			continue;
+		}
+
+		auto it = textures.find(id);
+		if (it == textures.end())
+			return fail("Unknown texture");
+		SimulatedTexture& texture = it->second;
+
+		if (command == "mips")
+		{
+			if (!(tokens >> texture.FinestMip >> texture.CoarsestMip))
+				return fail("Expected mips <id> <finest> <coarsest>");
+			texture.HasMips = true;
+			texture.Used = true;
+		}
+		else if (command == "feedback")
+		{
+			if (!(tokens >> texture.FeedbackWidth >> texture.FeedbackHeight))
+				return fail("Expected feedback <id> <width> <height> <values...>");
+
+			texture.TracedFeedback.resize(size_t(texture.FeedbackWidth) * texture.FeedbackHeight);
+			for (auto& value : texture.TracedFeedback)
+			{
+				if (!(tokens >> value))
+					return fail("Not enough feedback values");
+			}
+			texture.FeedbackWritten = true;
+			texture.Used = true;
+		}
+		else if (command == "release")
+		{
+			pool.ReleaseTexture(&texture);
+			texture.Used = false;
+			texture.Feedback.clear();
+			texture.FeedbackWritten = false;
+			readback.Ring.Forget(&texture);
+			texture.Hysteresis = MipHysteresis();
+			texture.Accumulator.Reset();
+		}
+		else
+		{
+			return fail("Unknown command");
+		}
+
+		framePending = true;
+	}
+
+	// A trace does not have to end with a frame
+	if (framePending)
+		RunFrame(pool, textures, readback, settings.Hysteresis, summary, csv);
+
+	summary.Pages = pool.GetPageCount();
+	summary.PagesCreated = backend.PagesCreated;
+	summary.PagesDestroyed = backend.PagesDestroyed;
+	summary.Fragmentation = pool.GetFragmentation().Fragmentation;
+	summary.MappingCalls = backend.Calls;
+	summary.CopiesRead = readback.Ring.GetStats().SlotsRetired;
+	summary.CopiesSkipped = readback.Ring.GetStats().SlotsDenied;
+	summary.BytesCopied = readback.BytesCopied;
+	return true;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+#include "TitaniumRose/Renderer/VirtualTexture/MipHysteresis.h"
+#include "TitaniumRose/Renderer/VirtualTexture/TilePoolCore.h"
+
+/// <summary>
+/// How a trace is replayed, main fills it from the command line and uses these as its defaults
+/// </summary>
+struct TraceReplaySettings
+{
+	Roses::TileResidencyMode Mode = Roses::TileResidencyMode::MipRange;
+	// Tiles kept around every requested tile in FeedbackTiles mode
+	uint32_t Border = 1;
+	// 0 is unlimited
+	uint64_t TileBudget = 0;
+	uint32_t CompactionBudget = 0;
+	uint32_t PageReleaseDelay = 120;
+	Roses::MipHysteresisSettings Hysteresis;
+	uint32_t ReadbackLatency = 0;
+	// One byte per cell like a compact feedback map, or a uint32_t per cell
+	bool CompactFeedback = true;
+	uint64_t ReadbackArenaBytes = 16 * 1024 * 1024;
+};
+
+struct SimulationSummary
+{
+	uint32_t Frames = 0;
+	uint64_t TilesMapped = 0;
+	uint64_t TilesUnmapped = 0;
+	uint64_t TilesEvicted = 0;
+	uint64_t TilesDenied = 0;
+	uint64_t TilesMoved = 0;
+	uint32_t PeakPages = 0;
+	uint64_t MipChangesRequested = 0;
+	uint64_t MipChangesApplied = 0;
+	uint64_t DemotionsDelayed = 0;
+	double TotalCpuTime = 0.0;
+	double MaxCpuTime = 0.0;
+
+	// The pool and the readback once the trace ended
+	uint32_t Pages = 0;
+	uint64_t PagesCreated = 0;
+	uint64_t PagesDestroyed = 0;
+	float Fragmentation = 0.0f;
+	uint64_t MappingCalls = 0;
+	uint64_t CopiesRead = 0;
+	uint64_t CopiesSkipped = 0;
+	uint64_t BytesCopied = 0;
+};
+
+/// <summary>
+/// Replays a trace of texture requests through the tile pool. The trace is a text file
+/// with one command per line, lines starting with # are ignored:
+///   texture <id> <width> <height> <mips>       declares a texture
+///   mips <id> <finest> <coarsest>              the mips a texture used this frame
+///   feedback <id> <width> <height> <values...> the feedback map of a texture this frame,
+///                                              the mips come from it if there is no mips line
+///   release <id>                               unmaps every tile of a texture
+///   frame                                      maps the textures used and ends the frame
+/// </summary>
+/// <param name="tracePath">Only used to report where the trace is malformed</param>
+/// <param name="csv">Gets a line of statistics per frame</param>
+/// <returns>False if the trace is malformed, the reason is written to the standard error</returns>
+bool ReplayTrace(std::istream& trace, const std::string& tracePath, const TraceReplaySettings& settings,
+	std::ostream& csv, SimulationSummary& summary);
@@ -31,6 +31,7 @@ namespace Roses {
 
     ID3D12CommandAllocator* CommandAllocatorPool::RequestAllocator(uint64_t fenceValue)
     {
+        std::lock_guard<std::mutex> lock(m_Mutex);
         ID3D12CommandAllocator* allocator = nullptr;
 
         if (!m_ReadyQueue.empty()) {
@@ -54,6 +55,7 @@ namespace Roses {
 
     void CommandAllocatorPool::DiscardAllocator(uint64_t fenceValue, ID3D12CommandAllocator* allocator)
     {
+        std::lock_guard<std::mutex> lock(m_Mutex);
         m_ReadyQueue.push({ fenceValue, allocator });
     }
 }
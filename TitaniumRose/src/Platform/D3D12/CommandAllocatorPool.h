@@ -1,11 +1,13 @@
 #pragma once
 #include <d3d12.h>
+#include <mutex>
 #include <queue>
 
 namespace Roses {
     /**
      * A CommandAllocatorPool will handle creating new ID3D12CommandQueues when we need them
-     * and will reuse them if their recorded commands have been executed.
+     * and will reuse them if their recorded commands have been executed. Contexts recorded
+     * in parallel request their allocators from worker threads, so the pool takes a lock.
      */
     class CommandAllocatorPool
     {
@@ -29,6 +31,7 @@ namespace Roses {
         D3D12_COMMAND_LIST_TYPE m_Type;
 
         ID3D12Device2* m_Device;
+        std::mutex m_Mutex;
         std::vector<ID3D12CommandAllocator*> m_AllAllocators;
         std::queue<ReadyAllocator> m_ReadyQueue;
     };
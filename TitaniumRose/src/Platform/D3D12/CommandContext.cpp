@@ -3,6 +3,7 @@
 
 #include "Platform/D3D12/CommandQueue.h"
 #include "Platform/D3D12/D3D12Renderer.h"
+#include "Platform/D3D12/D3D12UploadService.h"
 #include "Platform/D3D12/GpuResource.h"
 
 static Roses::ContextManager s_ContextManager;
@@ -76,7 +77,13 @@ namespace Roses {
 
         HZ_CORE_ASSERT(m_CurrentAllocator != nullptr, "This context has not been properly reset/initialized");
 
-        uint64_t fence = D3D12Renderer::CommandQueueManager.GetQueue(m_Type).ExecuteCommandList(m_CommandList);
+        CommandQueue& queue = D3D12Renderer::CommandQueueManager.GetQueue(m_Type);
+        if (D3D12Renderer::UploadService && m_Type != D3D12_COMMAND_LIST_TYPE_COPY)
+            D3D12Renderer::UploadService->MakeVisibleTo(queue);
+
+        uint64_t fence = queue.ExecuteCommandList(m_CommandList);
+        // A context that flushes in a loop would otherwise keep its upload blocks open until Finish
+        m_CpuLinearAllocator.CleanupUsedPages(fence);
 
         if (waitForCompletion) {
             D3D12Renderer::CommandQueueManager.WaitForFence(fence);
@@ -107,6 +114,8 @@ namespace Roses {
         HZ_CORE_ASSERT(m_CurrentAllocator != nullptr, "");
 
         CommandQueue& queue = D3D12Renderer::CommandQueueManager.GetQueue(m_Type);
+        if (D3D12Renderer::UploadService)
+            D3D12Renderer::UploadService->MakeVisibleTo(queue);
 
         auto fence = queue.ExecuteCommandList(m_CommandList);
         queue.DiscardAllocator(fence, m_CurrentAllocator);
@@ -114,13 +123,10 @@ namespace Roses {
         m_CpuLinearAllocator.CleanupUsedPages(fence);
         m_GpuLinearAllocator.CleanupUsedPages(fence);
 
-        ReturnAllocations();
+        ReturnAllocations(fence);
         if (waitForCompletion) {
             D3D12Renderer::CommandQueueManager.WaitForFence(fence);
-            for (auto r : m_TransientResources) {
-                delete r;
-            }
-            m_TransientResources.clear();
+            s_ContextManager.ReleaseRetiredResources();
         }
         s_ContextManager.FreeContext(this);
         
@@ -292,6 +298,33 @@ namespace Roses {
         }
     }
 
+    void CommandContext::BeginResourceTransition(GpuResource& resource, D3D12_RESOURCE_STATES newState, bool flushImmediate)
+    {
+        // A transition already under way has to end before another one can begin
+        if (resource.m_TransitioningState != static_cast<D3D12_RESOURCE_STATES>(-1))
+            TransitionResource(resource, resource.m_TransitioningState);
+
+        D3D12_RESOURCE_STATES oldState = resource.m_CurrentState;
+
+        if (oldState != newState) {
+            HZ_CORE_ASSERT(m_NumCachedBarriers < MAX_RESOURCE_BARRIERS, "Run out of space for cached barriers. Flush sooner!");
+
+            D3D12_RESOURCE_BARRIER& desc = m_ResourceBarriers[m_NumCachedBarriers++];
+            desc.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+            desc.Transition.pResource = resource.GetResource();
+            desc.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+            desc.Transition.StateBefore = oldState;
+            desc.Transition.StateAfter = newState;
+            desc.Flags = D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY;
+
+            resource.m_TransitioningState = newState;
+        }
+
+        if (flushImmediate || m_NumCachedBarriers == MAX_RESOURCE_BARRIERS) {
+            FlushResourceBarriers();
+        }
+    }
+
     void CommandContext::InsertUAVBarrier(GpuResource& resource, bool flushImmediate)
     {
         HZ_CORE_ASSERT(m_NumCachedBarriers < MAX_RESOURCE_BARRIERS, "Run out of space for cached barriers. Flush sooner!");
@@ -360,16 +393,9 @@ namespace Roses {
 #endif
     }
 
-    void CommandContext::ReturnAllocations() {
-        for (auto& allocation : m_RTVAllocations)
-        {
-            D3D12Renderer::s_RenderTargetDescriptorHeap->Release(allocation);
-        }
-
-        for (auto& allocation : m_ResourceAllocations)
-        {
-            D3D12Renderer::s_ResourceDescriptorHeap->Release(allocation);
-        }
+    void CommandContext::ReturnAllocations(uint64_t fenceValue) {
+        // Frames are no longer waited for, so the GPU may still read these after Finish returned
+        s_ContextManager.RetireResources(fenceValue, m_RTVAllocations, m_ResourceAllocations, m_TransientResources);
     }
 
     void CommandContext::Reset()
@@ -394,20 +420,30 @@ namespace Roses {
 
     CommandContext* ContextManager::AllocateContext(D3D12_COMMAND_LIST_TYPE type)
     {
-        auto& contextsForType = m_AvailableContexts[type];
+        ReleaseRetiredResources();
 
         CommandContext* ctx = nullptr;
+        bool isNew = false;
+        {
+            std::lock_guard<std::mutex> lock(m_ContextMutex);
+            auto& contextsForType = m_AvailableContexts[type];
 
-        if (contextsForType.empty()) {
-            ctx = new CommandContext(type);
-            m_ContextPool[type].emplace_back(ctx);
-            ctx->Initialize();
+            if (contextsForType.empty()) {
+                ctx = new CommandContext(type);
+                m_ContextPool[type].emplace_back(ctx);
+                isNew = true;
+            }
+            else {
+                ctx = contextsForType.front();
+                contextsForType.pop();
+            }
         }
-        else {
-            ctx = contextsForType.front();
-            contextsForType.pop();
+
+        // The context is this thread's alone from here on
+        if (isNew)
+            ctx->Initialize();
+        else
             ctx->Reset();
-        }
 
         HZ_CORE_ASSERT(ctx != nullptr, "The context we got is null");
         HZ_CORE_ASSERT(ctx->m_Type == type, "Something's gone horrible wrong with the queues, we got a contex for the wrong type");
@@ -419,11 +455,53 @@ namespace Roses {
     {
         HZ_CORE_ASSERT(context != nullptr, "Called with null context");
 
+        std::lock_guard<std::mutex> lock(m_ContextMutex);
         m_AvailableContexts[context->m_Type].push(context);
     }
 
+    void ContextManager::RetireResources(uint64_t fenceValue, std::vector<HeapAllocationDescription>& rtvAllocations,
+        std::vector<HeapAllocationDescription>& resourceAllocations, std::vector<GpuResource*>& resources)
+    {
+        if (rtvAllocations.empty() && resourceAllocations.empty() && resources.empty())
+            return;
+
+        RetiredResources retired;
+        retired.FenceValue = fenceValue;
+        retired.RTVAllocations.swap(rtvAllocations);
+        retired.ResourceAllocations.swap(resourceAllocations);
+        retired.Resources.swap(resources);
+
+        std::lock_guard<std::mutex> lock(m_RetiredMutex);
+        m_RetiredResources.emplace_back(std::move(retired));
+    }
+
+    void ContextManager::ReleaseRetiredResources()
+    {
+        std::lock_guard<std::mutex> lock(m_RetiredMutex);
+
+        for (size_t i = 0; i < m_RetiredResources.size();) {
+            auto& retired = m_RetiredResources[i];
+            if (!D3D12Renderer::CommandQueueManager.IsFenceComplete(retired.FenceValue)) {
+                i++;
+                continue;
+            }
+
+            for (auto& allocation : retired.RTVAllocations)
+                D3D12Renderer::s_RenderTargetDescriptorHeap->Release(allocation);
+            for (auto& allocation : retired.ResourceAllocations)
+                D3D12Renderer::s_ResourceDescriptorHeap->Release(allocation);
+            for (auto r : retired.Resources)
+                delete r;
+
+            if (i + 1 != m_RetiredResources.size())
+                retired = std::move(m_RetiredResources.back());
+            m_RetiredResources.pop_back();
+        }
+    }
+
     void ContextManager::DestroyAll()
     {
+        std::lock_guard<std::mutex> lock(m_ContextMutex);
         for (auto& contextsForType : m_ContextPool) {
             for (int i = 0; i < contextsForType.size(); i++) {
                 delete contextsForType[i];
@@ -460,6 +538,15 @@ namespace Roses {
         m_CommandList->SetComputeRootConstantBufferView(rootIndex, alloc.GpuAddress);
     }
 
+    D3D12_GPU_VIRTUAL_ADDRESS CommandContext::UploadDynamicData(const void* data, size_t sizeInBytes)
+    {
+        HZ_CORE_ASSERT(data != nullptr, "");
+
+        DynamicAllocation alloc = m_CpuLinearAllocator.Allocate(sizeInBytes);
+        ::memcpy(alloc.CpuAddress, data, sizeInBytes);
+        return alloc.GpuAddress;
+    }
+
     void GraphicsContext::SetDynamicContantBufferView(uint32_t rootIndex, size_t sizeInBytes, const void* data)
     {
         HZ_CORE_ASSERT(data != nullptr, "");
@@ -469,6 +556,15 @@ namespace Roses {
         m_CommandList->SetGraphicsRootConstantBufferView(rootIndex, alloc.GpuAddress);
     }
 
+    void GraphicsContext::SetDynamicShaderResourceView(uint32_t rootIndex, size_t sizeInBytes, const void* data)
+    {
+        HZ_CORE_ASSERT(data != nullptr, "");
+
+        DynamicAllocation alloc = m_CpuLinearAllocator.Allocate(sizeInBytes);
+        ::memcpy(alloc.CpuAddress, data, sizeInBytes);
+        m_CommandList->SetGraphicsRootShaderResourceView(rootIndex, alloc.GpuAddress);
+    }
+
     void GraphicsContext::SetDynamicBufferAsTable(uint32_t rootIndex, size_t sizeInBytes, const void* data)
     {
         HZ_CORE_ASSERT(false, "Do not use, does not work");
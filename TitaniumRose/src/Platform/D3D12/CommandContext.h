@@ -1,5 +1,6 @@
 #pragma once
 #include <d3d12.h>
+#include <mutex>
 
 #include "Platform/D3D12/GpuResource.h"
 #include "Platform/D3D12/LinearAllocator.h"
@@ -85,6 +86,9 @@ namespace Roses {
         DynamicAllocation ReserveUploadMemory(size_t size) {
             return m_CpuLinearAllocator.Allocate(size);
         }
+        // Copies data into upload memory that lasts as long as this context's commands, for root
+        // views that contexts recorded in parallel bind as well
+        D3D12_GPU_VIRTUAL_ADDRESS UploadDynamicData(const void* data, size_t sizeInBytes);
 
         static void InitializeTexture(GpuResource& destination, uint32_t numSubresources, D3D12_SUBRESOURCE_DATA subData[]);
         static void InitializeBuffer(GpuResource& destination, const void* data, size_t sizeInBytes, size_t offset = 0);
@@ -104,11 +108,19 @@ namespace Roses {
         void FlushResourceBarriers();
 
         void TransitionResource(GpuResource& resource, D3D12_RESOURCE_STATES newState, bool flushImmediate = false);
+        // Starts a split transition, the next TransitionResource to the same state ends it
+        void BeginResourceTransition(GpuResource& resource, D3D12_RESOURCE_STATES newState, bool flushImmediate = false);
         void InsertUAVBarrier(GpuResource& resource, bool flushImmediate);
 
         inline void TrackAllocation(HeapAllocationDescription& allocation, D3D12_DESCRIPTOR_HEAP_TYPE type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV)
         {
-            
+            // Transient descriptors are reused with their whole frame, there is nothing to return
+            if (allocation.Transient)
+            {
+                allocation.Allocated = false;
+                return;
+            }
+
             switch (type)
             {
             case D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV:
@@ -142,7 +154,8 @@ namespace Roses {
 
         void SetName(const std::string& name) { m_Name = name; }
         void BindDescriptorHeaps();
-        void ReturnAllocations();
+        // Hands the descriptors and transient resources to the context manager until fenceValue completed
+        void ReturnAllocations(uint64_t fenceValue);
 
     protected:
         D3D12_COMMAND_LIST_TYPE     m_Type;
@@ -174,6 +187,8 @@ namespace Roses {
         }
 
         void SetDynamicContantBufferView(uint32_t rootIndex, size_t sizeInBytes, const void* data);
+        // Binds the data as a root SRV, for StructuredBuffers that only live for the command list
+        void SetDynamicShaderResourceView(uint32_t rootIndex, size_t sizeInBytes, const void* data);
         void SetDynamicBufferAsTable(uint32_t rootIndex, size_t sizeInBytes, const void* data);
     };
 
@@ -187,6 +202,7 @@ namespace Roses {
         void SetDynamicContantBufferView(uint32_t rootIndex, size_t sizeInBytes, const void* data);
     };
 
+    // Contexts can be allocated and freed from any thread, for the passes recorded in parallel
     class ContextManager {
     public:
         ContextManager() = default;
@@ -194,9 +210,28 @@ namespace Roses {
         CommandContext* AllocateContext(D3D12_COMMAND_LIST_TYPE type);
         void FreeContext(CommandContext* context);
         void DestroyAll();
+
+        // Keeps what a submitted command list referenced alive until its fence completed, the vectors are emptied
+        void RetireResources(uint64_t fenceValue, std::vector<HeapAllocationDescription>& rtvAllocations,
+            std::vector<HeapAllocationDescription>& resourceAllocations, std::vector<GpuResource*>& resources);
+        void ReleaseRetiredResources();
     private:
+        struct RetiredResources
+        {
+            uint64_t FenceValue;
+            std::vector<HeapAllocationDescription> RTVAllocations;
+            std::vector<HeapAllocationDescription> ResourceAllocations;
+            std::vector<GpuResource*> Resources;
+        };
+
         std::vector<CommandContext*> m_ContextPool[4];
         std::queue<CommandContext*> m_AvailableContexts[4];
+        // Guards the two above
+        std::mutex m_ContextMutex;
+
+        // Fences of different queues, so they do not complete in order
+        std::mutex m_RetiredMutex;
+        std::vector<RetiredResources> m_RetiredResources;
     };
 }
 
@@ -60,8 +60,6 @@ namespace Roses {
         ss << ::GetQueueName(m_Type) << TOSTRING(m_Fence);
         m_Fence->SetName(ss.str().c_str());
 
-        m_FenceEvent = CreateEvent(nullptr, false, false, nullptr);
-        HZ_CORE_ASSERT(m_FenceEvent != nullptr, "Fence event was null!");
         m_AllocatorPool.Initialize(device);
 
         HZ_CORE_ASSERT(m_CommandQueue != nullptr, "How did we get here and the command queue is still null?");
@@ -72,7 +70,6 @@ namespace Roses {
         if (m_CommandQueue == nullptr)
             return;
 
-        ::CloseHandle(m_FenceEvent);
         m_Fence->Release();
         m_Fence = nullptr;
 
@@ -82,15 +79,27 @@ namespace Roses {
 
     uint64_t CommandQueue::IncrementFence()
     {
+        std::lock_guard<std::mutex> lock(m_FenceMutex);
         m_CommandQueue->Signal(m_Fence, m_FenceValue);
         return m_FenceValue++;
     }
 
     bool CommandQueue::IsFenceComplete(uint64_t fenceValue)
     {
-//        HZ_CORE_ASSERT(m_LastCompletedFenceValue == m_Fence->GetCompletedValue(), "We have a shitty race condition");
+        // Only ask the fence when the cached value is behind, the value used to be refreshed
+        // by WaitForFence alone so polling never saw a fence complete
+        if (fenceValue > m_LastCompletedFenceValue.load(std::memory_order_acquire))
+            UpdateCompletedFenceValue(m_Fence->GetCompletedValue());
 
-        return fenceValue < m_LastCompletedFenceValue;
+        return fenceValue <= m_LastCompletedFenceValue.load(std::memory_order_acquire);
+    }
+
+    void CommandQueue::UpdateCompletedFenceValue(uint64_t fenceValue)
+    {
+        uint64_t last = m_LastCompletedFenceValue.load(std::memory_order_relaxed);
+        while (fenceValue > last && !m_LastCompletedFenceValue.compare_exchange_weak(last, fenceValue, std::memory_order_release))
+        {
+        }
     }
 
     void CommandQueue::StallForFence(uint64_t fenceValue)
@@ -101,8 +110,12 @@ namespace Roses {
 
     void CommandQueue::StallForQueue(CommandQueue& other)
     {
-        HZ_CORE_ASSERT(other.m_FenceValue > 0, "");
-        m_CommandQueue->Wait(other.m_Fence, other.m_FenceValue - 1);
+        uint64_t lastSignaled;
+        {
+            std::lock_guard<std::mutex> lock(other.m_FenceMutex);
+            lastSignaled = other.m_FenceValue - 1;
+        }
+        m_CommandQueue->Wait(other.m_Fence, lastSignaled);
     }
 
     void CommandQueue::WaitForFence(uint64_t value)
@@ -110,14 +123,22 @@ namespace Roses {
         if (IsFenceComplete(value))
             return;
 
-        m_Fence->SetEventOnCompletion(value, m_FenceEvent);
-        ::WaitForSingleObject(m_FenceEvent, INFINITE);
-        m_LastCompletedFenceValue = value;
+        // An event per wait, threads waiting on different values of one shared event would
+        // steal each other's wake up
+        HANDLE fenceEvent = ::CreateEvent(nullptr, false, false, nullptr);
+        HZ_CORE_ASSERT(fenceEvent != nullptr, "Fence event was null!");
+        m_Fence->SetEventOnCompletion(value, fenceEvent);
+        ::WaitForSingleObject(fenceEvent, INFINITE);
+        ::CloseHandle(fenceEvent);
+        UpdateCompletedFenceValue(value);
     }
 
     uint64_t CommandQueue::ExecuteCommandList(ID3D12CommandList* list)
     {
         D3D12::ThrowIfFailed(static_cast<ID3D12GraphicsCommandList*>(list)->Close());
+
+        // Lists submitted from several threads must signal their values in submission order
+        std::lock_guard<std::mutex> lock(m_FenceMutex);
         m_CommandQueue->ExecuteCommandLists(1, &list);
         m_CommandQueue->Signal(m_Fence, m_FenceValue);
         return m_FenceValue++;
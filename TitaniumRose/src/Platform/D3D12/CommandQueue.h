@@ -1,5 +1,7 @@
 #pragma once
 #include <d3d12.h>
+#include <atomic>
+#include <mutex>
 
 #include "Platform/D3D12/CommandAllocatorPool.h"
 
@@ -10,6 +12,7 @@ namespace Roses
         // So we can call Execute
         friend class CommandListManager;
         friend class CommandContext;
+        friend class D3D12UploadService;
 
     public:
         CommandQueue(D3D12_COMMAND_LIST_TYPE type);
@@ -47,6 +50,9 @@ namespace Roses
         ID3D12CommandQueue* GetRawPtr() { return m_CommandQueue; }
 
     private:
+        // Raises the cached completed value, which can be read from any thread
+        void UpdateCompletedFenceValue(uint64_t fenceValue);
+
         uint64_t ExecuteCommandList(ID3D12CommandList* list);
         ID3D12CommandAllocator* RequestAllocator();
         void DiscardAllocator(uint64_t fenceValue, ID3D12CommandAllocator* allocator);
@@ -59,9 +65,10 @@ namespace Roses
         CommandAllocatorPool m_AllocatorPool;
 
         ID3D12Fence*    m_Fence;
+        // Guards m_FenceValue, so the values are signaled in the order they are handed out
+        std::mutex      m_FenceMutex;
         uint64_t        m_FenceValue;
-        uint64_t        m_LastCompletedFenceValue;
-        HANDLE          m_FenceEvent;
+        std::atomic<uint64_t> m_LastCompletedFenceValue;
     };
 
     class CommandListManager
@@ -6,6 +6,7 @@
 #include "Platform/D3D12/D3D12Helpers.h"
 #include "Platform/D3D12/D3D12ResourceBatch.h"
 #include "Platform/D3D12/D3D12Renderer.h"
+#include "Platform/D3D12/D3D12UploadService.h"
 
 #include <d3d12.h>
 #include "Platform/D3D12/d3dx12.h"
@@ -14,8 +15,24 @@ namespace Roses {
 	
 	D3D12VertexBuffer::D3D12VertexBuffer(CommandContext& context, float* vertices, uint32_t size)
 	{
-		
+		Create(size);
 
+		if (vertices) {
+			context.WriteBuffer(*this, 0, vertices, size);
+		}
+	}
+
+	D3D12VertexBuffer::D3D12VertexBuffer(float* vertices, uint32_t size)
+	{
+		Create(size);
+
+		if (vertices) {
+			D3D12Renderer::UploadService->UploadBuffer(*this, vertices, size);
+		}
+	}
+
+	void D3D12VertexBuffer::Create(uint32_t size)
+	{
 		D3D12::ThrowIfFailed(D3D12Renderer::GetDevice()->CreateCommittedResource(
 			&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
 			D3D12_HEAP_FLAG_NONE,
@@ -26,12 +43,8 @@ namespace Roses {
 		));
 		BypassAndSetState(D3D12_RESOURCE_STATE_COPY_DEST);
 
-		if (vertices) {
-			context.WriteBuffer(*this, 0, vertices, size);
-
-			m_View.BufferLocation = m_Resource->GetGPUVirtualAddress();
-			m_View.SizeInBytes = size;
-		}
+		m_View.BufferLocation = m_Resource->GetGPUVirtualAddress();
+		m_View.SizeInBytes = size;
 	}
 	
 	D3D12VertexBuffer::~D3D12VertexBuffer()
@@ -41,7 +54,26 @@ namespace Roses {
 	D3D12IndexBuffer::D3D12IndexBuffer(CommandContext& context, uint32_t* indices, uint32_t count)
 		: m_Count(count)
 	{
-		const uint32_t size = sizeof(uint32_t) * count;
+		Create();
+
+		if (indices) {
+			context.WriteBuffer(*this, 0, indices, sizeof(uint32_t) * count);
+		}
+	}
+
+	D3D12IndexBuffer::D3D12IndexBuffer(uint32_t* indices, uint32_t count)
+		: m_Count(count)
+	{
+		Create();
+
+		if (indices) {
+			D3D12Renderer::UploadService->UploadBuffer(*this, indices, sizeof(uint32_t) * count);
+		}
+	}
+
+	void D3D12IndexBuffer::Create()
+	{
+		const uint32_t size = sizeof(uint32_t) * m_Count;
 
 		D3D12::ThrowIfFailed(D3D12Renderer::GetDevice()->CreateCommittedResource(
 			&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
@@ -53,16 +85,26 @@ namespace Roses {
 		));
 		BypassAndSetState(D3D12_RESOURCE_STATE_COPY_DEST);
 
-		if (indices) {
-			context.WriteBuffer(*this, 0, indices, size);
-
-			m_View.BufferLocation = m_Resource->GetGPUVirtualAddress();
-			m_View.Format = DXGI_FORMAT_R32_UINT;
-			m_View.SizeInBytes = size;
-		}
+		m_View.BufferLocation = m_Resource->GetGPUVirtualAddress();
+		m_View.Format = DXGI_FORMAT_R32_UINT;
+		m_View.SizeInBytes = size;
 	}
 
 	D3D12IndexBuffer::~D3D12IndexBuffer()
 	{
 	}
+
+	D3D12StructuredBuffer::D3D12StructuredBuffer(uint32_t elementCount, uint32_t stride)
+		: m_ElementCount(elementCount), m_Stride(stride)
+	{
+		D3D12::ThrowIfFailed(D3D12Renderer::GetDevice()->CreateCommittedResource(
+			&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+			D3D12_HEAP_FLAG_NONE,
+			&CD3DX12_RESOURCE_DESC::Buffer(static_cast<uint64_t>(elementCount) * stride),
+			D3D12_RESOURCE_STATE_COPY_DEST,
+			nullptr,
+			IID_PPV_ARGS(m_Resource.GetAddressOf())
+		));
+		BypassAndSetState(D3D12_RESOURCE_STATE_COPY_DEST);
+	}
 }
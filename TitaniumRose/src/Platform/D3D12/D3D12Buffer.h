@@ -11,10 +11,14 @@ namespace Roses {
 	{
 	public:
 		D3D12VertexBuffer(CommandContext& context, float* vertices, uint32_t size);
+		// Uploads the vertices on the copy queue instead of recording the copy in a context
+		D3D12VertexBuffer(float* vertices, uint32_t size);
 		virtual ~D3D12VertexBuffer();
 
 		inline D3D12_VERTEX_BUFFER_VIEW GetView() const { return m_View; }
 	private:
+		void Create(uint32_t size);
+
 		D3D12_VERTEX_BUFFER_VIEW m_View;
 	};
 
@@ -22,14 +26,33 @@ namespace Roses {
 	{
 	public:
 		D3D12IndexBuffer(CommandContext& context, uint32_t* indices, uint32_t count);
+		// Uploads the indices on the copy queue instead of recording the copy in a context
+		D3D12IndexBuffer(uint32_t* indices, uint32_t count);
 		virtual ~D3D12IndexBuffer();
 
 		virtual uint32_t GetCount() const { return m_Count; }
 		inline D3D12_INDEX_BUFFER_VIEW GetView() const { return m_View; }
 	private:
+		void Create();
+
 		uint32_t m_Count;
 		D3D12_INDEX_BUFFER_VIEW m_View;
 	};
+
+	// A buffer in the default heap that shaders read as a StructuredBuffer, it is written
+	// with copies through CommandContext::WriteBuffer
+	class D3D12StructuredBuffer : public GpuResource
+	{
+	public:
+		D3D12StructuredBuffer(uint32_t elementCount, uint32_t stride);
+
+		inline D3D12_GPU_VIRTUAL_ADDRESS GetGpuAddress() const { return m_Resource->GetGPUVirtualAddress(); }
+		inline uint32_t GetElementCount() const { return m_ElementCount; }
+		inline uint32_t GetStride() const { return m_Stride; }
+	private:
+		uint32_t m_ElementCount;
+		uint32_t m_Stride;
+	};
 #if 1
 	template<typename T>
 	class D3D12UploadBuffer: public GpuResource
@@ -262,10 +262,10 @@ namespace Roses {
 		Viewport.Height = static_cast<float>(height);
 	}
 
-	void D3D12Context::NewFrame()
+	void D3D12Context::NewFrame(uint32_t slot)
 	{
 		HZ_PROFILE_FUNCTION();
-		NextFrameResource();
+		NextFrameResource(slot);
 		// Get from resource
 		auto fr = CurrentFrameResource;
 
@@ -310,19 +310,18 @@ namespace Roses {
 		//WaitForGpu();
 	}
 
-	void D3D12Context::NextFrameResource()
+	void D3D12Context::NextFrameResource(uint32_t slot)
 	{
 		m_CurrentBackbufferIndex = DeviceResources->SwapChain->GetCurrentBackBufferIndex();
 
-		CurrentFrameResource = FrameResources[m_CurrentBackbufferIndex].get();
-		// Wait until this frame resource catches up
-		WaitForGpu();
+		// Indexed by the frame slot rather than the back buffer, the GPU is done with it already
+		CurrentFrameResource = FrameResources[slot].get();
 		CurrentFrameResource->PrepareForNewFrame();
 	}
 
 	void D3D12Context::BuildFrameResources()
 	{
-		auto count = DeviceResources->SwapChainBufferCount;
+		auto count = D3D12Renderer::FrameLatency;
 		FrameResources.reserve(count);
 
 #if HZ_DEBUG
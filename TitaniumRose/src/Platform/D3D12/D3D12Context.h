@@ -33,7 +33,8 @@ namespace Roses{
 		void ResetBackbuffers();
 		void WaitForGpu();
 		void ResizeSwapChain();
-		void NewFrame();
+		// The renderer already waited for the frame that used the slot before
+		void NewFrame(uint32_t slot);
 
 		D3D12FrameResource* CurrentFrameResource;
 
@@ -59,7 +60,7 @@ namespace Roses{
 		uint64_t  m_FenceValue = 0;
 		
 		void PerformInitializationTransitions();
-		void NextFrameResource();
+		void NextFrameResource(uint32_t slot);
 		void BuildFrameResources();
 
 		friend class D3D12RendererAPI;
@@ -1,6 +1,7 @@
 #include "trpch.h"
 #include "Platform/D3D12/D3D12DescriptorHeap.h"
 #include "Platform/D3D12/D3D12Helpers.h"
+#include "Platform/D3D12/D3D12Renderer.h"
 #include "Platform/D3D12/D3D12Texture.h"
 
 namespace Roses
@@ -17,7 +18,7 @@ namespace Roses
 
         m_IncrementSize = device->GetDescriptorHandleIncrementSize(m_Description.Type);
 
-        m_FreeDescriptors.emplace_front(0, m_Description.NumDescriptors);
+        m_FreeRanges.Reset(m_Description.NumDescriptors);
     }
 
     D3D12DescriptorHeap::D3D12DescriptorHeap(ID3D12Device* device, const D3D12_DESCRIPTOR_HEAP_DESC* pDesc) noexcept(false)
@@ -25,43 +26,39 @@ namespace Roses
         Initialize(device, pDesc);
     }
 
-    D3D12DescriptorHeap::D3D12DescriptorHeap(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type, D3D12_DESCRIPTOR_HEAP_FLAGS flags, size_t count) noexcept(false)
+    D3D12DescriptorHeap::D3D12DescriptorHeap(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type, D3D12_DESCRIPTOR_HEAP_FLAGS flags, size_t count, size_t transientCount) noexcept(false)
     {
         HZ_CORE_ASSERT(count < UINT32_MAX, "That's a lot of descriptors!!");
+        HZ_CORE_ASSERT(transientCount <= count, "The transient region does not fit in the heap");
 
         D3D12_DESCRIPTOR_HEAP_DESC desc = {};
         desc.Flags = flags;
         desc.NumDescriptors = count;
         desc.Type = type;
-        Initialize(device, &desc);
+        Initialize(device, &desc, transientCount);
     }
 
     HeapAllocationDescription D3D12DescriptorHeap::Allocate(size_t numDescriptors)
     {
         HeapAllocationDescription allocation;
 
-        if (m_FreeDescriptors.empty()) {
+        if (numDescriptors > m_Description.NumDescriptors)
+        {
+            HZ_CORE_ERROR("Tried to allocate {0} descriptors, but the heap has {1} total", numDescriptors, m_Description.NumDescriptors);
             return allocation;
         }
 
-        size_t offset = GetAvailableDescirptorRange(numDescriptors);
-
-        if (offset == D3D12_GPU_VIRTUAL_ADDRESS_UNKNOWN)
-            __debugbreak();
+        size_t offset = m_FreeRanges.Allocate(numDescriptors);
 
-        if (offset != D3D12_GPU_VIRTUAL_ADDRESS_UNKNOWN)
+        if (offset == ConcurrentRangeAllocator::InvalidOffset)
         {
-            allocation.Allocated = true;
-            allocation.OffsetInHeap = offset;
-            allocation.Range = numDescriptors;
-            allocation.CPUHandle = GetCPUHandle(offset);
-            if ((m_Description.Flags & D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE))
-            {
-                allocation.GPUHandle = GetGPUHandle(offset);
-            }
+            HZ_CORE_ERROR("Could not find {0} contiguous descriptors, {1} are free in {2} ranges",
+                numDescriptors, m_FreeRanges.GetFreeCount(), m_FreeRanges.GetFreeRangeCount());
+            __debugbreak();
+            return allocation;
         }
 
-        return allocation;
+        return DescribeAllocation(offset, numDescriptors);
     }
 
     void D3D12DescriptorHeap::Release(HeapAllocationDescription& allocation)
@@ -69,74 +66,72 @@ namespace Roses
         if (!allocation.Allocated)
             return;
 
-        // NOTE: We could combine this loop to the one below
-        for (auto& range : m_FreeDescriptors)
+        if (allocation.Transient || allocation.Cached)
         {
-            // We can add the allocation to the begining of this range
-            if (allocation.OffsetInHeap + allocation.Range == range.Start)
-            {
-                range.Start = allocation.OffsetInHeap;
-                range.Count += allocation.Range;
-                goto ret;
-            }
-            // We can add the allocation to the end of this range
-            else if ((range.Start + range.Count) == allocation.OffsetInHeap)
-            {
-                range.Count += allocation.Range;
-                goto ret;
-            }
+            allocation.Allocated = false;
+            return;
         }
-        
-        // At this point the for loop has finished so we need to add a new range
-        for (auto it = m_FreeDescriptors.begin(); it != m_FreeDescriptors.end(); ++it)
+
+        bool released = m_FreeRanges.Release(allocation.OffsetInHeap, allocation.Range);
+        HZ_CORE_ASSERT(released, "Descriptors were released twice. There is probably a dynamic resource that is assumed discarded, but it is not");
+
+        allocation.Allocated = false;
+        allocation.CPUHandle.ptr = allocation.GPUHandle.ptr = D3D12_GPU_VIRTUAL_ADDRESS_UNKNOWN;
+    }
+
+    HeapAllocationDescription D3D12DescriptorHeap::AllocateTransient(size_t numDescriptors)
+    {
+        size_t offset;
         {
-            auto next = std::next(it);
+            std::lock_guard<std::mutex> lock(m_TransientMutex);
+            offset = m_TransientRing.Allocate(numDescriptors);
 
-            // That means we only have a single free section. We need to either add
-            // the whole allocation before or after the current one
-            if (next == m_FreeDescriptors.end())
-            {
-                if (allocation.OffsetInHeap + allocation.Range < it->Start)
-                {
-                    m_FreeDescriptors.emplace_front(allocation.OffsetInHeap, allocation.Range);
-                }
-                else if (allocation.OffsetInHeap > it->Start + it->Count)
-                {
-                    m_FreeDescriptors.emplace_back(allocation.OffsetInHeap, allocation.Range);
-                }
-                else
-                {
-                    goto invalid_path;
-                }
-                goto ret;
-            }
-            
-            if((allocation.OffsetInHeap > it->Start + it->Count)            // The allocation release must start AFTER it
-            && (allocation.OffsetInHeap + allocation.Range < next->Start)   // The allocation must be BEFORE next
-            && (next->Start - (it->Start + it->Count) >= allocation.Range))
+            // The GPU might have caught up since the frame ended
+            if (offset == FrameRingAllocator::InvalidOffset && m_TransientRing.GetCapacity() > 0)
             {
-                m_FreeDescriptors.emplace(next, allocation.OffsetInHeap, allocation.Range);
-                goto ret;
+                RetireTransientFrames();
+                offset = m_TransientRing.Allocate(numDescriptors);
             }
         }
-invalid_path:
-        HZ_CORE_ASSERT(false, "This execution path should not be reachable. There is probably a dynamic resource that is assumed discarded, but it is not");
-ret:
-        allocation.Allocated = false;
-        allocation.CPUHandle.ptr = allocation.GPUHandle.ptr = D3D12_GPU_VIRTUAL_ADDRESS_UNKNOWN;
+
+        if (offset == FrameRingAllocator::InvalidOffset)
+        {
+            ++m_TransientFallbacks;
+            return Allocate(numDescriptors);
+        }
+
+        HeapAllocationDescription allocation = DescribeAllocation(m_TransientStart + offset, numDescriptors);
+        allocation.Transient = true;
+        return allocation;
     }
 
-    size_t D3D12DescriptorHeap::GetFreeDescriptorCount() const noexcept
+    void D3D12DescriptorHeap::EndTransientFrame(uint64_t fenceValue)
     {
-        size_t accumulator = 0;
-        
-        for (auto& range : m_FreeDescriptors)
+        std::lock_guard<std::mutex> lock(m_TransientMutex);
+        m_TransientRing.EndFrame(fenceValue);
+        RetireTransientFrames();
+    }
+
+    void D3D12DescriptorHeap::RetireTransientFrames()
+    {
+        m_TransientRing.Retire([](uint64_t fenceValue) {
+            return D3D12Renderer::CommandQueueManager.IsFenceComplete(fenceValue);
+        });
+    }
+
+    HeapAllocationDescription D3D12DescriptorHeap::DescribeAllocation(size_t offset, size_t numDescriptors) const
+    {
+        HeapAllocationDescription allocation;
+        allocation.Allocated = true;
+        allocation.OffsetInHeap = offset;
+        allocation.Range = numDescriptors;
+        allocation.CPUHandle = GetCPUHandle(offset);
+        if ((m_Description.Flags & D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE))
         {
-            accumulator += range.Count;
+            allocation.GPUHandle = GetGPUHandle(offset);
         }
 
-        return accumulator;
-
+        return allocation;
     }
 
     D3D12_CPU_DESCRIPTOR_HANDLE D3D12DescriptorHeap::GetFirstCPUHandle() const noexcept
@@ -180,7 +175,7 @@ ret:
         return handle;
     }
 
-    void D3D12DescriptorHeap::Initialize(ID3D12Device* pDevice, const D3D12_DESCRIPTOR_HEAP_DESC* pDesc)
+    void D3D12DescriptorHeap::Initialize(ID3D12Device* pDevice, const D3D12_DESCRIPTOR_HEAP_DESC* pDesc, size_t transientCount)
     {
         HZ_CORE_ASSERT(pDesc != nullptr, "Heap Description cannot be null");
 
@@ -192,7 +187,8 @@ ret:
             m_Heap.Reset();
             m_CPUHandle.ptr = 0;
             m_GPUHandle.ptr = 0;
-            m_FreeDescriptors.clear();
+            m_FreeRanges.Reset(0);
+            m_TransientRing.Reset(0);
         }
         else
         {
@@ -208,48 +204,9 @@ ret:
                 m_GPUHandle = m_Heap->GetGPUDescriptorHandleForHeapStart();
             }
 
-            m_FreeDescriptors.emplace_front(0, m_Description.NumDescriptors);
-        }
-    }
-
-    size_t D3D12DescriptorHeap::GetAvailableDescirptorRange(size_t numDescriptors)
-    {
-        if (numDescriptors > m_Description.NumDescriptors)
-        {
-            HZ_CORE_ERROR("Tried to allocate {0} descriptors, but the heap has {1} total", numDescriptors, m_Description.NumDescriptors);
-            return D3D12_GPU_VIRTUAL_ADDRESS_UNKNOWN;
-        }
-
-        auto r = m_FreeDescriptors.end();
-        size_t offset = D3D12_GPU_VIRTUAL_ADDRESS_UNKNOWN;
-        for (auto range = m_FreeDescriptors.begin(); range != m_FreeDescriptors.end(); ++range) {
-            if (range->Count < numDescriptors) {
-                continue;
-            }
-        
-            offset = range->Start;
-            range->Start += (numDescriptors);
-            range->Count -= (numDescriptors);
-            r = range;
-            break;
-        }
-
-        // We couldn't find a range to allocate
-        if (r == m_FreeDescriptors.end())
-        {
-            return D3D12_GPU_VIRTUAL_ADDRESS_UNKNOWN;
+            m_TransientStart = m_Description.NumDescriptors - transientCount;
+            m_FreeRanges.Reset(m_TransientStart);
+            m_TransientRing.Reset(transientCount);
         }
-
-        if (r->Count == 0)
-        {
-            m_FreeDescriptors.erase(r);
-        }
-
-        if (offset == D3D12_GPU_VIRTUAL_ADDRESS_UNKNOWN)
-            __debugbreak();
-
-        return offset;
     }
 }
-
-
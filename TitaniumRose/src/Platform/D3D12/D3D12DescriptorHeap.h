@@ -1,9 +1,9 @@
 #pragma once
 
-#include <set>
-#include <list>
 #include "d3d12.h"
 
+#include "TitaniumRose/Core/ConcurrentRangeAllocator.h"
+#include "TitaniumRose/Core/FrameRingAllocator.h"
 #include "Platform/D3D12/ComPtr.h"
 #include "Platform/D3D12/D3D12Helpers.h"
 #include "Platform/D3D12/HeapAllocationDescription.h"
@@ -11,16 +11,22 @@
 namespace Roses {
     
 
+    /// <summary>
+    /// Allocate, Release and AllocateTransient can be called from any thread. Single
+    /// persistent descriptors come from a per-thread cache and usually take no lock.
+    /// </summary>
     class D3D12DescriptorHeap
     {
     public:
         D3D12DescriptorHeap(ID3D12DescriptorHeap* pExistingHeap) noexcept;
         D3D12DescriptorHeap(ID3D12Device* device, const D3D12_DESCRIPTOR_HEAP_DESC* pDesc) noexcept(false);
+        // The last transientCount descriptors are kept for AllocateTransient, the rest are persistent
         D3D12DescriptorHeap(
             ID3D12Device* device,
             D3D12_DESCRIPTOR_HEAP_TYPE type,
             D3D12_DESCRIPTOR_HEAP_FLAGS flags,
-            size_t count) noexcept(false);
+            size_t count,
+            size_t transientCount = 0) noexcept(false);
         D3D12DescriptorHeap(
             ID3D12Device* device,
             size_t count) noexcept(false) :
@@ -28,9 +34,6 @@ namespace Roses {
                 D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
                 D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE, count) {}
 
-        D3D12DescriptorHeap(D3D12DescriptorHeap&&) = default;
-        D3D12DescriptorHeap& operator=(D3D12DescriptorHeap&&) = default;
-
         D3D12DescriptorHeap(const D3D12DescriptorHeap&) = delete;
         D3D12DescriptorHeap& operator=(const D3D12DescriptorHeap&) = delete;
 
@@ -38,7 +41,37 @@ namespace Roses {
 
         void Release(HeapAllocationDescription& allocation);
 
-        size_t GetFreeDescriptorCount() const noexcept;
+        /// <summary>
+        /// Descriptors that are only used by the frame being recorded, a pointer bump in the
+        /// transient region. They are never released one by one, the whole frame is reused once
+        /// the fence given to EndTransientFrame completed. Falls back to a persistent allocation
+        /// if the frames in flight fill the region, so the caller still has to track it.
+        /// </summary>
+        HeapAllocationDescription AllocateTransient(size_t numDescriptors);
+
+        /// <summary>
+        /// Closes the transient descriptors allocated since the last call, fenceValue has to be
+        /// signalled after every command list that uses them. Also reuses the frames whose fence
+        /// completed.
+        /// </summary>
+        void EndTransientFrame(uint64_t fenceValue);
+
+        inline const FrameRingAllocator& GetTransientRing() const { return m_TransientRing; }
+        // Transient allocations that had to come from the persistent region
+        inline uint64_t GetTransientFallbacks() const { return m_TransientFallbacks.load(std::memory_order_relaxed); }
+        inline ConcurrentRangeAllocatorStats GetAllocatorStats() const { return m_FreeRanges.GetStats(); }
+
+        /// <summary>
+        /// Gives back the descriptors cached for the calling thread, for worker threads that
+        /// are done allocating from this heap.
+        /// </summary>
+        void FlushThreadCache() { m_FreeRanges.FlushThreadCache(); }
+
+        size_t GetFreeDescriptorCount() const noexcept { return m_FreeRanges.GetFreeCount(); }
+        // Diagnostics for fragmentation, a heap with plenty of free descriptors can still fail
+        // a large allocation if they are spread over many ranges
+        size_t GetFreeRangeCount() const noexcept { return m_FreeRanges.GetFreeRangeCount(); }
+        size_t GetLargestFreeRange() const noexcept { return m_FreeRanges.GetLargestFreeRange(); }
         size_t GetCount() const noexcept { return m_Description.NumDescriptors; }
         unsigned int GetFlags() const noexcept { return m_Description.Flags; }
         D3D12_DESCRIPTOR_HEAP_TYPE GetType() const noexcept { return m_Description.Type; }
@@ -51,20 +84,10 @@ namespace Roses {
         D3D12_GPU_DESCRIPTOR_HANDLE GetGPUHandle(size_t index) const;
 
     private:
-
-        struct AvailableDescriptorRange
-        {
-            AvailableDescriptorRange(size_t start, size_t count)
-                : Start(start), Count(count)
-            {}
-            size_t Start;
-            size_t Count;
-        };
-
-        void Initialize(ID3D12Device* pDevice, const D3D12_DESCRIPTOR_HEAP_DESC* pDesc);
-
-        size_t GetAvailableDescirptorRange(size_t numDescriptors);
-        
+        void Initialize(ID3D12Device* pDevice, const D3D12_DESCRIPTOR_HEAP_DESC* pDesc, size_t transientCount = 0);
+        // Expects m_TransientMutex to be held
+        void RetireTransientFrames();
+        HeapAllocationDescription DescribeAllocation(size_t offset, size_t numDescriptors) const;
 
         TComPtr<ID3D12DescriptorHeap> m_Heap;
 
@@ -72,7 +95,13 @@ namespace Roses {
         D3D12_GPU_DESCRIPTOR_HANDLE m_GPUHandle;
         D3D12_DESCRIPTOR_HEAP_DESC  m_Description;
         uint32_t                    m_IncrementSize;
-        std::list<AvailableDescriptorRange> m_FreeDescriptors;
+        ConcurrentRangeAllocator    m_FreeRanges;
+        // Guards m_TransientRing, transient allocations are a pointer bump so a lock is cheap enough
+        std::mutex                  m_TransientMutex;
+        FrameRingAllocator          m_TransientRing;
+        // Where the transient region starts, it runs to the end of the heap
+        size_t                      m_TransientStart = 0;
+        std::atomic<uint64_t>       m_TransientFallbacks = 0;
     };
 
 
@@ -4,14 +4,17 @@
 #include "Platform/D3D12/D3D12Helpers.h"
 #include "Platform/D3D12/d3dx12.h"
 #include "Platform/D3D12/CommandContext.h"
+#include "Platform/D3D12/D3D12FeedbackReadback.h"
+#include "Platform/D3D12/D3D12Renderer.h"
 
 namespace Roses
 {
 	D3D12FeedbackMap::D3D12FeedbackMap(ID3D12Device2* device, uint32_t width, uint32_t height, size_t elementSize)
 		: GpuBuffer(width, height, 1, "", D3D12_RESOURCE_STATE_UNORDERED_ACCESS), 
-		m_ElementSize(elementSize), m_ReadbackBuffer(nullptr)
+		m_ElementSize(elementSize)
 	{
-		m_ActualSize = D3D12::AlignUp(m_Width * m_Height * m_ElementSize);
+		HZ_CORE_ASSERT(m_ElementSize == sizeof(uint8_t) || m_ElementSize == sizeof(uint32_t), "Feedback cells are either 1 or 4 bytes");
+		m_ActualSize = D3D12::AlignUp(GetDataSize());
 		
 		auto desc = CD3DX12_RESOURCE_DESC::Buffer(m_ActualSize, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
 		D3D12::ThrowIfFailed(device->CreateCommittedResource(
@@ -23,18 +26,37 @@ namespace Roses
 			IID_PPV_ARGS(&m_Resource)
 		));
 
-		m_ReadbackBuffer = new ReadbackBuffer(m_ActualSize);
-
-
+		// Higher than any mip count, so nothing is requested before the first readback
+		m_Data.resize(size_t(m_Width) * m_Height, UINT8_MAX);
 	}
 
 	D3D12FeedbackMap::~D3D12FeedbackMap()
 	{
-		delete m_ReadbackBuffer;
+		if (D3D12Renderer::FeedbackReadback != nullptr)
+			D3D12Renderer::FeedbackReadback->Forget(*this);
 	}
 
 	void D3D12FeedbackMap::Update(CommandContext& context)
 	{		
-		context.CopyBuffer(*this, *m_ReadbackBuffer);
+		D3D12Renderer::FeedbackReadback->Enqueue(context, *this);
+	}
+
+	void D3D12FeedbackMap::ReceiveData(const void* data, size_t size)
+	{
+		HZ_CORE_ASSERT(size <= GetDataSize(), "The readback does not fit the feedback map");
+
+		if (IsCompact())
+		{
+			memcpy(m_Data.data(), data, std::min(size, m_Data.size()));
+			return;
+		}
+
+		// Mips always fit a byte, anything past it was not sampled either way
+		const uint32_t* cells = static_cast<const uint32_t*>(data);
+		size_t count = std::min(size / sizeof(uint32_t), m_Data.size());
+		for (size_t i = 0; i < count; i++)
+		{
+			m_Data[i] = static_cast<uint8_t>(std::min<uint32_t>(cells[i], UINT8_MAX));
+		}
 	}
 }
\ No newline at end of file
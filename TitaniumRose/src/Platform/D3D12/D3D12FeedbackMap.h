@@ -5,12 +5,16 @@
 #include "Platform/D3D12/ComPtr.h"
 #include "Platform/D3D12/D3D12DescriptorHeap.h"
 #include "Platform/D3D12/GpuBuffer.h"
-#include "Platform/D3D12/ReadbackBuffer.h"
 #include "Platform/D3D12/CommandContext.h"
 
 namespace Roses
 {
 
+	/// <summary>
+	/// One cell per tile of the finest mip, holding the finest mip sampled in it. With an
+	/// element size of 4 every cell is a uint32_t, with an element size of 1 the map is
+	/// compact and packs four byte cells into every uint32_t of the buffer.
+	/// </summary>
 	class D3D12FeedbackMap : public GpuBuffer
 	{
 	public:
@@ -24,16 +28,36 @@ namespace Roses
 		inline glm::ivec3 GetDimensions() const { return glm::ivec3(m_Width, m_Height, m_ElementSize); }
 		inline const size_t GetElementSize() const { return m_ElementSize; }
 		inline const size_t GetSize() const { return m_ActualSize; }
+		inline bool IsCompact() const { return m_ElementSize == sizeof(uint8_t); }
+		// The number of uint32_t the shaders see, compact maps round up to whole ones
+		inline uint32_t GetNumElements() const { return static_cast<uint32_t>((size_t(m_Width) * m_Height * m_ElementSize + 3) / 4); }
+		// The bytes that are actually read back, without the alignment padding
+		inline size_t GetDataSize() const { return size_t(GetNumElements()) * sizeof(uint32_t); }
+		// What every element has to be cleared to so all the cells hold the given value
+		inline uint32_t GetClearValue(uint32_t cellValue) const { return IsCompact() ? (cellValue & 0xFF) * 0x01010101u : cellValue; }
 
+		/// <summary>
+		/// Queues the copy of this frame's feedback into the shared readback arena. The data
+		/// shows up in GetData once the copy completed, a few frames later.
+		/// </summary>
 		void Update(CommandContext& context);
 
-		uint32_t* GetData() { return m_ReadbackBuffer->Map<uint32_t*>(); }
+		/// <summary>
+		/// The last feedback that was read back, one byte per cell whatever the element size
+		/// on the GPU. Until the first copy lands every cell is marked as not sampled.
+		/// </summary>
+		const uint8_t* GetData() const { return m_Data.data(); }
+
+		/// <summary>
+		/// Called by the readback arena when a copy of this map completed
+		/// </summary>
+		void ReceiveData(const void* data, size_t size);
 
 		HeapAllocationDescription UAVAllocation;
 	private:
 		size_t m_ElementSize;
 		size_t m_ActualSize;
-		ReadbackBuffer* m_ReadbackBuffer;
+		std::vector<uint8_t> m_Data;
 	};
 
 }
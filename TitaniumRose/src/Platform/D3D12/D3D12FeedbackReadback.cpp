@@ -0,0 +1,55 @@
+#include "trpch.h"
+#include "Platform/D3D12/D3D12FeedbackReadback.h"
+#include "Platform/D3D12/D3D12FeedbackMap.h"
+#include "Platform/D3D12/D3D12Renderer.h"
+
+namespace Roses
+{
+	// CopyBufferRegion does not need more, this keeps the copies away from each other's cache lines
+	static constexpr uint64_t ReadbackAlignment = 256;
+
+	D3D12FeedbackReadback::D3D12FeedbackReadback(uint64_t capacity, uint32_t framesInFlight)
+		: m_Arena(capacity),
+		m_Data(nullptr),
+		m_Ring(capacity, framesInFlight)
+	{
+		m_Arena.GetResource()->SetName(L"Feedback Readback Arena");
+		m_Data = m_Arena.Map<const uint8_t*>();
+	}
+
+	D3D12FeedbackReadback::~D3D12FeedbackReadback()
+	{
+		m_Arena.Unmap();
+	}
+
+	bool D3D12FeedbackReadback::Enqueue(CommandContext& context, D3D12FeedbackMap& feedbackMap)
+	{
+		ReadbackSlot slot;
+		if (!m_Ring.Allocate(&feedbackMap, feedbackMap.GetDataSize(), ReadbackAlignment, slot))
+			return false;
+
+		context.TransitionResource(feedbackMap, D3D12_RESOURCE_STATE_COPY_SOURCE);
+		context.CopyBufferRegion(m_Arena, slot.Offset, feedbackMap, 0, slot.Size);
+		return true;
+	}
+
+	void D3D12FeedbackReadback::EndFrame(uint64_t fenceValue)
+	{
+		m_Ring.EndFrame(fenceValue);
+	}
+
+	void D3D12FeedbackReadback::Resolve()
+	{
+		m_Ring.Retire(
+			[](uint64_t fenceValue) { return D3D12Renderer::CommandQueueManager.IsFenceComplete(fenceValue); },
+			[this](const ReadbackSlot& slot) {
+				static_cast<D3D12FeedbackMap*>(slot.Owner)->ReceiveData(m_Data + slot.Offset, slot.Size);
+			}
+		);
+	}
+
+	void D3D12FeedbackReadback::Forget(D3D12FeedbackMap& feedbackMap)
+	{
+		m_Ring.Forget(&feedbackMap);
+	}
+}
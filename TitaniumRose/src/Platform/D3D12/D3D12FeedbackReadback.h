@@ -0,0 +1,55 @@
+#pragma once
+#include "TitaniumRose/Renderer/VirtualTexture/ReadbackRing.h"
+
+#include "Platform/D3D12/ReadbackBuffer.h"
+#include "Platform/D3D12/CommandContext.h"
+
+namespace Roses
+{
+	class D3D12FeedbackMap;
+
+	/// <summary>
+	/// A single readback arena shared by all the feedback maps. The copies of a frame are
+	/// suballocated from it and handed to their feedback map once the fence of that frame
+	/// completed, so the CPU never waits for the GPU to read the feedback. In exchange the
+	/// feedback is a few frames old.
+	/// </summary>
+	class D3D12FeedbackReadback
+	{
+	public:
+		static constexpr uint64_t DefaultCapacity = 16 * 1024 * 1024;
+
+		D3D12FeedbackReadback(uint64_t capacity, uint32_t framesInFlight);
+		~D3D12FeedbackReadback();
+
+		/// <summary>
+		/// Records the copy of the feedback map into the arena. If the arena is full the copy
+		/// is skipped and the feedback map keeps its older data.
+		/// </summary>
+		bool Enqueue(CommandContext& context, D3D12FeedbackMap& feedbackMap);
+
+		/// <summary>
+		/// Closes the frame, fenceValue has to be signalled after all the copies enqueued since
+		/// the last call.
+		/// </summary>
+		void EndFrame(uint64_t fenceValue);
+
+		/// <summary>
+		/// Hands every copy whose fence completed to its feedback map
+		/// </summary>
+		void Resolve();
+
+		/// <summary>
+		/// Drops the copies in flight of a feedback map that is being destroyed
+		/// </summary>
+		void Forget(D3D12FeedbackMap& feedbackMap);
+
+		inline const ReadbackRing& GetRing() const { return m_Ring; }
+
+	private:
+		ReadbackBuffer m_Arena;
+		// The arena stays mapped, readback heaps can be read while the GPU writes other parts of them
+		const uint8_t* m_Data;
+		ReadbackRing m_Ring;
+	};
+}
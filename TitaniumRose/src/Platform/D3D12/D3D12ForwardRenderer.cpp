@@ -10,12 +10,20 @@
 #include "winpixeventruntime/pix3.h"
 
 #include <future>
+#include <optional>
 #include <sstream>
 
 DECLARE_SHADER_NAMED("SurfaceShader-Forward", Surface);
+DECLARE_SHADER_NAMED("SurfaceShader-ForwardBindless", SurfaceBindless);
 
 void Roses::D3D12ForwardRenderer::ImplRenderSubmitted(GraphicsContext& gfxContext)
 {
+    if (s_BindlessMaterials)
+    {
+        RenderBindless(gfxContext);
+        return;
+    }
+
 #if 1
    
     auto shader = g_ShaderLibrary->GetAs<D3D12Shader>(ShaderNameSurface);
@@ -32,37 +40,156 @@ void Roses::D3D12ForwardRenderer::ImplRenderSubmitted(GraphicsContext& gfxContex
     
     ScopedTimer passTimer("Forward Pass", gfxContext);
 
-    gfxContext.GetCommandList()->SetPipelineState(shader->GetPipelineState());
-    gfxContext.GetCommandList()->SetGraphicsRootSignature(shader->GetRootSignature());
-    gfxContext.GetCommandList()->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    gfxContext.GetCommandList()->RSSetViewports(1, &Context->Viewport);
-    gfxContext.GetCommandList()->RSSetScissorRects(1, &Context->ScissorRect);
-    gfxContext.GetCommandList()->OMSetRenderTargets(1, &framebuffer->RTVAllocation.CPUHandle, true, &framebuffer->DSVAllocation.CPUHandle);
-    gfxContext.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_Lights, s_LightsBufferAllocation.GPUHandle);
-    gfxContext.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_EnvRadiance, envRad->SRVAllocation.GPUHandle);
-    gfxContext.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_EnvIrradiance, envIrr->SRVAllocation.GPUHandle);
-    gfxContext.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_BRDFLUT, lut->SRVAllocation.GPUHandle);
-    gfxContext.SetDynamicContantBufferView(ShaderIndices_Pass, sizeof(passData), &passData);
-
-    for (size_t i = 0; i < s_ForwardOpaqueObjects.size(); i++)
-    {
-        auto go = s_ForwardOpaqueObjects[i];
+    D3D12_GPU_VIRTUAL_ADDRESS passAddress = 0;
+    auto preparePass = [&](GraphicsContext& context) {
+        passAddress = context.UploadDynamicData(&passData, sizeof(passData));
+    };
+
+    auto beginPass = [&](GraphicsContext& context) {
+        context.GetCommandList()->SetPipelineState(shader->GetPipelineState());
+        context.GetCommandList()->SetGraphicsRootSignature(shader->GetRootSignature());
+        context.GetCommandList()->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        context.GetCommandList()->RSSetViewports(1, &Context->Viewport);
+        context.GetCommandList()->RSSetScissorRects(1, &Context->ScissorRect);
+        context.GetCommandList()->OMSetRenderTargets(1, &framebuffer->RTVAllocation.CPUHandle, true, &framebuffer->DSVAllocation.CPUHandle);
+        context.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_Lights, GetLightsBufferAllocation().GPUHandle);
+        context.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_EnvRadiance, envRad->SRVAllocation.GPUHandle);
+        context.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_EnvIrradiance, envIrr->SRVAllocation.GPUHandle);
+        context.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_BRDFLUT, lut->SRVAllocation.GPUHandle);
+        context.GetCommandList()->SetGraphicsRootConstantBufferView(ShaderIndices_Pass, passAddress);
+    };
+
+    auto recordDraws = [&](GraphicsContext& context, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            auto& go = s_ForwardOpaqueObjects[i];
 
-        if (go == nullptr) {
-            continue;
+            if (go == nullptr) {
+                continue;
+            }
+
+            if (go->Mesh == nullptr) {
+                continue;
+            }
+
+            std::vector<uint32_t> lights;
+
+            for (uint32_t i = 0; i < s_CommonData.Scene->Lights.size(); i++)
+            {
+#if 0
+                lights.push_back(i);
+#else
+                auto l = s_CommonData.Scene->Lights[i];
+
+                auto v = l->gameObject->Transform.Position() - go->Transform.Position();
+
+                auto d = glm::length(v);
+
+                if (d <= l->Range * 2 || go->Material->IncludeAllLights) {
+                    lights.push_back(i);
+                }
+#endif
+            }
+
+            if (!lights.empty())
+            {
+                D3D12UploadBuffer<uint32_t>* objectLightsList = new D3D12UploadBuffer<uint32_t>(
+                lights.size(),
+                false
+                );
+
+                objectLightsList->CopyDataBlock(lights.size(), lights.data());
+                objectLightsList->SRVAllocation = s_ResourceDescriptorHeap->AllocateTransient(1);
+                CreateBufferSRV(*objectLightsList, lights.size(), sizeof(uint32_t));
+                context.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_ObjectLightsList, objectLightsList->SRVAllocation.GPUHandle);
+                context.TrackResource(objectLightsList);
+                context.TrackAllocation(objectLightsList->SRVAllocation);
+            }
+            
+
+
+            // The profiler is not thread safe
+            std::optional<ScopedTimer> objectTimer;
+            if (&context == &gfxContext)
+                objectTimer.emplace(go->Name, context);
+
+            HPerObjectData objectData;
+            objectData.LocalToWorld = go->Transform.LocalToWorldMatrix();
+            objectData.WorldToLocal = glm::transpose(go->Transform.WorldToLocalMatrix());
+            objectData.MaterialColor = go->Material->Color;
+            objectData.HasAlbedo = go->Material->HasAlbedoTexture;
+            objectData.EmissiveColor = go->Material->EmissiveColor;
+            objectData.HasNormal = go->Material->HasNormalTexture;
+            objectData.HasMetallic = go->Material->HasMetallicTexture;
+            objectData.Metallic = go->Material->Metallic;
+            objectData.HasRoughness = go->Material->HasRoughnessTexture;
+            objectData.Roughness = go->Material->Roughness;
+            objectData.NumObjectLights = lights.size();
+
+            auto vb = go->Mesh->vertexBuffer->GetView();
+            vb.StrideInBytes = sizeof(Vertex);
+            auto ib = go->Mesh->indexBuffer->GetView();
+
+            context.GetCommandList()->IASetVertexBuffers(0, 1, &vb);
+            context.GetCommandList()->IASetIndexBuffer(&ib);
+
+            if (go->Material->HasAlbedoTexture) {
+                context.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_Albedo, go->Material->AlbedoTexture->SRVAllocation.GPUHandle);
+            }
+
+            if (go->Material->HasNormalTexture) {
+                context.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_Normal, go->Material->NormalTexture->SRVAllocation.GPUHandle);
+            }
+
+            if (go->Material->HasRoughnessTexture) {
+                context.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_Roughness, go->Material->RoughnessTexture->SRVAllocation.GPUHandle);
+            }
+
+            if (go->Material->HasMetallicTexture) {
+                context.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_Metalness, go->Material->MetallicTexture->SRVAllocation.GPUHandle);
+            }
+
+            context.SetDynamicContantBufferView(ShaderIndices_PerObject, sizeof(objectData), &objectData);
+
+            context.GetCommandList()->DrawIndexedInstanced(go->Mesh->indexBuffer->GetCount(), 1, 0, 0, 0);
         }
+    };
+
+    UpdateTransforms(s_ForwardOpaqueObjects);
+    RecordDraws(gfxContext, s_ForwardOpaqueObjects.size(), preparePass, beginPass, recordDraws);
+#endif
+}
+
+void Roses::D3D12ForwardRenderer::RenderBindless(GraphicsContext& gfxContext)
+{
+    auto shader = g_ShaderLibrary->GetAs<D3D12Shader>(ShaderNameSurfaceBindless);
 
-        if (go->Mesh == nullptr) {
+    HPassData passData;
+    passData.ViewProjection = s_CommonData.Scene->Camera->GetViewProjectionMatrix();
+    passData.NumLights = s_CommonData.NumLights;
+    passData.EyePosition = s_CommonData.Scene->Camera->GetPosition();
+
+    // Every object of the pass and its lights go into one buffer each, bound once
+    std::vector<HGameObject*> drawn;
+    std::vector<BindlessObjectData> objects;
+    std::vector<BindlessDrawConstants> draws;
+    std::vector<uint32_t> objectLights;
+    drawn.reserve(s_ForwardOpaqueObjects.size());
+    objects.reserve(s_ForwardOpaqueObjects.size());
+    draws.reserve(s_ForwardOpaqueObjects.size());
+
+    for (auto& go : s_ForwardOpaqueObjects)
+    {
+        if (go == nullptr || go->Mesh == nullptr) {
             continue;
         }
 
-        std::vector<uint32_t> lights;
+        BindlessObjectData objectData = {};
+        objectData.LocalToWorld = go->Transform.LocalToWorldMatrix();
+        objectData.LightOffset = static_cast<uint32_t>(objectLights.size());
 
         for (uint32_t i = 0; i < s_CommonData.Scene->Lights.size(); i++)
         {
-#if 0
-            lights.push_back(i);
-#else
             auto l = s_CommonData.Scene->Lights[i];
 
             auto v = l->gameObject->Transform.Position() - go->Transform.Position();
@@ -70,70 +197,82 @@ void Roses::D3D12ForwardRenderer::ImplRenderSubmitted(GraphicsContext& gfxContex
             auto d = glm::length(v);
 
             if (d <= l->Range * 2 || go->Material->IncludeAllLights) {
-                lights.push_back(i);
+                objectLights.push_back(i);
             }
-#endif
         }
+        objectData.LightCount = static_cast<uint32_t>(objectLights.size()) - objectData.LightOffset;
 
-        if (!lights.empty())
-        {
-            D3D12UploadBuffer<uint32_t>* objectLightsList = new D3D12UploadBuffer<uint32_t>(
-            lights.size(),
-            false
-            );
-
-            objectLightsList->CopyDataBlock(lights.size(), lights.data());
-            CreateBufferSRV(*objectLightsList, lights.size(), sizeof(uint32_t));
-            gfxContext.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_ObjectLightsList, objectLightsList->SRVAllocation.GPUHandle);
-            gfxContext.TrackResource(objectLightsList);
-            gfxContext.TrackAllocation(objectLightsList->SRVAllocation);
-        }
-        
+        BindlessDrawConstants drawConstants;
+        drawConstants.MaterialIndex = GetMaterialIndex(*go->Material);
+        drawConstants.ObjectIndex = static_cast<uint32_t>(objects.size());
+
+        drawn.push_back(go.get());
+        objects.push_back(objectData);
+        draws.push_back(drawConstants);
+    }
 
+    if (drawn.empty()) {
+        return;
+    }
 
-        ScopedTimer objectTimer(go->Name, gfxContext);
+    // Root SRVs can not be empty
+    if (objectLights.empty()) {
+        objectLights.push_back(0);
+    }
 
-        HPerObjectData objectData;
-        objectData.LocalToWorld = go->Transform.LocalToWorldMatrix();
-        objectData.WorldToLocal = glm::transpose(go->Transform.WorldToLocalMatrix());
-        objectData.MaterialColor = go->Material->Color;
-        objectData.HasAlbedo = go->Material->HasAlbedoTexture;
-        objectData.EmissiveColor = go->Material->EmissiveColor;
-        objectData.HasNormal = go->Material->HasNormalTexture;
-        objectData.HasMetallic = go->Material->HasMetallicTexture;
-        objectData.Metallic = go->Material->Metallic;
-        objectData.HasRoughness = go->Material->HasRoughnessTexture;
-        objectData.Roughness = go->Material->Roughness;
-        objectData.NumObjectLights = lights.size();
-
-        auto vb = go->Mesh->vertexBuffer->GetView();
-        vb.StrideInBytes = sizeof(Vertex);
-        auto ib = go->Mesh->indexBuffer->GetView();
-
-        gfxContext.GetCommandList()->IASetVertexBuffers(0, 1, &vb);
-        gfxContext.GetCommandList()->IASetIndexBuffer(&ib);
-
-        if (go->Material->HasAlbedoTexture) {
-            gfxContext.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_Albedo, go->Material->AlbedoTexture->SRVAllocation.GPUHandle);
-        }
+    FlushMaterialTable(gfxContext);
 
-        if (go->Material->HasNormalTexture) {
-            gfxContext.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_Normal, go->Material->NormalTexture->SRVAllocation.GPUHandle);
-        }
+    auto framebuffer = ResolveFrameBuffer();
 
-        if (go->Material->HasRoughnessTexture) {
-            gfxContext.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_Roughness, go->Material->RoughnessTexture->SRVAllocation.GPUHandle);
-        }
+    ScopedTimer passTimer("Forward Pass", gfxContext);
 
-        if (go->Material->HasMetallicTexture) {
-            gfxContext.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_Metalness, go->Material->MetallicTexture->SRVAllocation.GPUHandle);
-        }
+    // Every chunk binds the same copies
+    D3D12_GPU_VIRTUAL_ADDRESS passAddress = 0;
+    D3D12_GPU_VIRTUAL_ADDRESS objectsAddress = 0;
+    D3D12_GPU_VIRTUAL_ADDRESS objectLightsAddress = 0;
+    auto preparePass = [&](GraphicsContext& context) {
+        passAddress = context.UploadDynamicData(&passData, sizeof(passData));
+        objectsAddress = context.UploadDynamicData(objects.data(), objects.size() * sizeof(BindlessObjectData));
+        objectLightsAddress = context.UploadDynamicData(objectLights.data(), objectLights.size() * sizeof(uint32_t));
+    };
+
+    auto beginPass = [&](GraphicsContext& context) {
+        context.GetCommandList()->SetPipelineState(shader->GetPipelineState());
+        context.GetCommandList()->SetGraphicsRootSignature(shader->GetRootSignature());
+        context.GetCommandList()->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        context.GetCommandList()->RSSetViewports(1, &Context->Viewport);
+        context.GetCommandList()->RSSetScissorRects(1, &Context->ScissorRect);
+        context.GetCommandList()->OMSetRenderTargets(1, &framebuffer->RTVAllocation.CPUHandle, true, &framebuffer->DSVAllocation.CPUHandle);
+
+        SetBindlessPassResources(context);
+        context.GetCommandList()->SetGraphicsRootConstantBufferView(BindlessRootParameters_Pass, passAddress);
+        context.GetCommandList()->SetGraphicsRootShaderResourceView(BindlessRootParameters_Objects, objectsAddress);
+        context.GetCommandList()->SetGraphicsRootShaderResourceView(BindlessRootParameters_ObjectLights, objectLightsAddress);
+    };
+
+    auto recordDraws = [&](GraphicsContext& context, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            auto go = drawn[i];
 
-        gfxContext.SetDynamicContantBufferView(ShaderIndices_PerObject, sizeof(objectData), &objectData);
+            // The profiler is not thread safe
+            std::optional<ScopedTimer> objectTimer;
+            if (&context == &gfxContext)
+                objectTimer.emplace(go->Name, context);
 
-        gfxContext.GetCommandList()->DrawIndexedInstanced(go->Mesh->indexBuffer->GetCount(), 1, 0, 0, 0);
-    }
-#endif
+            auto vb = go->Mesh->vertexBuffer->GetView();
+            vb.StrideInBytes = sizeof(Vertex);
+            auto ib = go->Mesh->indexBuffer->GetView();
+
+            context.GetCommandList()->IASetVertexBuffers(0, 1, &vb);
+            context.GetCommandList()->IASetIndexBuffer(&ib);
+            context.GetCommandList()->SetGraphicsRoot32BitConstants(BindlessRootParameters_DrawConstants, 2, &draws[i], 0);
+
+            context.GetCommandList()->DrawIndexedInstanced(go->Mesh->indexBuffer->GetCount(), 1, 0, 0, 0);
+        }
+    };
+
+    RecordDraws(gfxContext, drawn.size(), preparePass, beginPass, recordDraws);
 }
 
 void Roses::D3D12ForwardRenderer::ImplOnInit()
@@ -156,6 +295,9 @@ void Roses::D3D12ForwardRenderer::ImplOnInit()
         pipelineStateStream.RasterizerState = CD3DX12_PIPELINE_STATE_STREAM_RASTERIZER(rasterizer);
         auto shader = Roses::CreateRef<Roses::D3D12Shader>(std::string(ShaderPathSurface), pipelineStateStream);
         D3D12Renderer::g_ShaderLibrary->Add(shader);
+
+        auto bindlessShader = Roses::CreateRef<Roses::D3D12Shader>(std::string(ShaderPathSurfaceBindless), pipelineStateStream);
+        D3D12Renderer::g_ShaderLibrary->Add(bindlessShader);
     }
 }
 
@@ -17,6 +17,9 @@ namespace Roses
 
 
     private:
+        // Same pass with the bindless shader, a draw only sets its material and object index
+        void RenderBindless(GraphicsContext& gfxContext);
+
         static constexpr uint32_t MaxItemsPerQueue = 25;
 
         enum ShaderIndices
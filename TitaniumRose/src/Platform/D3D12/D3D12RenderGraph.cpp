@@ -0,0 +1,101 @@
+#include "trpch.h"
+#include "Platform/D3D12/D3D12RenderGraph.h"
+
+namespace Roses
+{
+	RenderGraphResource D3D12RenderGraph::ImportResource(const std::string& name, GpuResource* resource,
+		uint32_t initialAccess, uint32_t flags)
+	{
+		HZ_CORE_ASSERT(resource != nullptr || (flags & RenderGraphResourceFlags_Untracked), "A tracked resource needs its GPU resource");
+		m_Resources.push_back(resource);
+		return m_Graph.ImportResource(name, initialAccess, flags);
+	}
+
+	uint32_t D3D12RenderGraph::AddPass(const std::string& name, PassFunction function, uint32_t flags)
+	{
+		m_Passes.push_back(std::move(function));
+		return m_Graph.AddPass(name, flags);
+	}
+
+	void D3D12RenderGraph::Execute(GraphicsContext& gfxContext)
+	{
+		m_Graph.Compile();
+
+		// Whether the context holds barriers of the resource that were not submitted yet
+		std::vector<bool> pending(m_Resources.size(), false);
+
+		for (auto& batch : m_Graph.GetBatches())
+		{
+			for (auto& barrier : batch.Barriers)
+			{
+				GpuResource& resource = *m_Resources[barrier.Resource];
+				D3D12_RESOURCE_STATES state = GetResourceState(barrier.After);
+
+				switch (barrier.Type)
+				{
+				case RenderGraphBarrierType_Transition:
+				case RenderGraphBarrierType_SplitEnd:
+					gfxContext.TransitionResource(resource, state);
+					break;
+				case RenderGraphBarrierType_SplitBegin:
+					// Transitions to unordered access are only UAV barriers, there is nothing to begin
+					if (state != D3D12_RESOURCE_STATE_UNORDERED_ACCESS)
+						gfxContext.BeginResourceTransition(resource, state);
+					break;
+				case RenderGraphBarrierType_UAV:
+					gfxContext.InsertUAVBarrier(resource, false);
+					break;
+				}
+				pending[barrier.Resource] = true;
+			}
+			gfxContext.FlushResourceBarriers();
+
+			for (uint32_t pass : batch.Passes)
+			{
+				if (m_Graph.GetPassFlags(pass) & RenderGraphPassFlags_Submits)
+				{
+					bool flush = false;
+					for (RenderGraphResource resource = 0; resource < pending.size(); resource++)
+						flush = flush || (pending[resource] && m_Graph.UsesResource(pass, resource));
+					if (flush)
+					{
+						gfxContext.Flush();
+						std::fill(pending.begin(), pending.end(), false);
+					}
+				}
+
+				m_Passes[pass](gfxContext);
+			}
+		}
+	}
+
+	void D3D12RenderGraph::Reset()
+	{
+		m_Graph.Reset();
+		m_Resources.clear();
+		m_Passes.clear();
+	}
+
+	D3D12_RESOURCE_STATES D3D12RenderGraph::GetResourceState(uint32_t access)
+	{
+		D3D12_RESOURCE_STATES state = D3D12_RESOURCE_STATE_COMMON;
+		if (access & RenderGraphAccess_RenderTarget)
+			state |= D3D12_RESOURCE_STATE_RENDER_TARGET;
+		if (access & RenderGraphAccess_DepthWrite)
+			state |= D3D12_RESOURCE_STATE_DEPTH_WRITE;
+		if (access & RenderGraphAccess_DepthRead)
+			state |= D3D12_RESOURCE_STATE_DEPTH_READ;
+		if (access & RenderGraphAccess_PixelShaderRead)
+			state |= D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+		if (access & RenderGraphAccess_NonPixelShaderRead)
+			state |= D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+		if (access & RenderGraphAccess_UnorderedAccess)
+			state |= D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+		if (access & RenderGraphAccess_CopySource)
+			state |= D3D12_RESOURCE_STATE_COPY_SOURCE;
+		if (access & RenderGraphAccess_CopyDest)
+			state |= D3D12_RESOURCE_STATE_COPY_DEST;
+		// PRESENT is COMMON, it combines with nothing
+		return state;
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "TitaniumRose/Renderer/RenderGraph.h"
+
+#include "Platform/D3D12/CommandContext.h"
+#include "Platform/D3D12/GpuResource.h"
+
+#include <functional>
+
+namespace Roses
+{
+	/// <summary>
+	/// Runs a RenderGraph on a graphics context. The resources are bound to the GPU resources
+	/// whose tracked states the barriers change, and the passes to the functions recording them.
+	/// The passes of a batch run after the barriers of the batch are flushed together.
+	/// </summary>
+	class D3D12RenderGraph
+	{
+	public:
+		using PassFunction = std::function<void(GraphicsContext&)>;
+
+		/// <param name="resource">May be null for untracked resources, which only order the passes</param>
+		RenderGraphResource ImportResource(const std::string& name, GpuResource* resource,
+			uint32_t initialAccess = RenderGraphAccess_None, uint32_t flags = RenderGraphResourceFlags_None);
+
+		uint32_t AddPass(const std::string& name, PassFunction function, uint32_t flags = RenderGraphPassFlags_None);
+
+		inline void Read(uint32_t pass, RenderGraphResource resource, uint32_t access) { m_Graph.Read(pass, resource, access); }
+		inline void Write(uint32_t pass, RenderGraphResource resource, uint32_t access, bool discardsContents = false)
+		{
+			m_Graph.Write(pass, resource, access, discardsContents);
+		}
+
+		/// <summary>
+		/// Compiles the graph and records it into gfxContext. A pass that submits command lists of
+		/// its own gets the context flushed first if it uses a resource the context has barriers for.
+		/// </summary>
+		void Execute(GraphicsContext& gfxContext);
+
+		// Clears the passes and resources for the next frame
+		void Reset();
+
+		inline const RenderGraph& GetGraph() const { return m_Graph; }
+
+		static D3D12_RESOURCE_STATES GetResourceState(uint32_t access);
+
+	private:
+		RenderGraph m_Graph;
+		std::vector<GpuResource*> m_Resources;
+		std::vector<PassFunction> m_Passes;
+	};
+}
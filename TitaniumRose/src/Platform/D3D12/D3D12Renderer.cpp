@@ -8,14 +8,23 @@
 #include "Platform/D3D12/DecoupledRenderer.h"
 #include "Platform/D3D12/D3D12Shader.h"
 #include "Platform/D3D12/D3D12TilePool.h"
+#include "Platform/D3D12/D3D12FeedbackReadback.h"
+#include "Platform/D3D12/D3D12UploadService.h"
 #include "Platform/D3D12/Profiler/Profiler.h"
 
 #include "Platform/D3D12/CommandQueue.h"
 #include "Platform/D3D12/CommandContext.h"
 
+#include "TitaniumRose/Core/DescriptorViewCache.h"
+#include "TitaniumRose/Core/FramePipeline.h"
+#include "TitaniumRose/Core/ParallelRecorder.h"
+#include "TitaniumRose/Renderer/MaterialTable.h"
+
 #include "glm/gtc/type_ptr.hpp"
 
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <ImGui/imgui.h>
 
 #include "WinPixEventRuntime/pix3.h"
@@ -32,6 +41,13 @@ extern "C" { __declspec(dllexport) extern const char* D3D12SDKPath = u8".\\D3D12
 
 #define MAX_RESOURCES       3000
 #define MAX_RENDERTARGETS   1500
+// Views that only live for a frame, on top of the persistent ones above
+#define MAX_TRANSIENT_RESOURCES     1024
+#define MAX_TRANSIENT_RENDERTARGETS 256
+// Views kept by the view cache, taken from the persistent descriptors
+#define MAX_CACHED_VIEWS            512
+// Entries of the bindless material table
+#define MAX_MATERIALS               4096
 
 DECLARE_SHADER(ClearUAV);
 DECLARE_SHADER(Dilate);
@@ -45,6 +61,8 @@ namespace Roses {
     ShaderLibrary*	D3D12Renderer::g_ShaderLibrary;
     TextureLibrary*	D3D12Renderer::g_TextureLibrary;
     D3D12TilePool*	D3D12Renderer::TilePool;
+    D3D12FeedbackReadback* D3D12Renderer::FeedbackReadback = nullptr;
+    D3D12UploadService* D3D12Renderer::UploadService = nullptr;
 
 	CommandListManager D3D12Renderer::CommandQueueManager;
 
@@ -57,10 +75,51 @@ namespace Roses {
 
 	D3D12Renderer::CommonData D3D12Renderer::s_CommonData;
 
-	Scope<D3D12UploadBuffer<D3D12Renderer::RendererLight>> D3D12Renderer::s_LightsBuffer;
-	HeapAllocationDescription D3D12Renderer::s_LightsBufferAllocation;
+	Scope<D3D12UploadBuffer<D3D12Renderer::RendererLight>> D3D12Renderer::s_LightsBuffer[D3D12Renderer::FrameLatency];
+	HeapAllocationDescription D3D12Renderer::s_LightsBufferAllocation[D3D12Renderer::FrameLatency];
 	HeapAllocationDescription D3D12Renderer::s_ImGuiAllocation;
 
+	// Summed over the decoupled objects of the last UpdateVirtualTextures
+	static uint64_t s_TexelsShaded = 0;
+	static uint64_t s_TexelsSavedByMipPolicy = 0;
+	static MipHysteresisStats s_MipHysteresisStats;
+	static MipEstimateErrorStats s_MipEstimateError;
+
+	enum CachedViewType : uint32_t
+	{
+		CachedViewType_SRV,
+		CachedViewType_UAV,
+		CachedViewType_RTV
+	};
+
+	struct CachedView
+	{
+		D3D12DescriptorHeap* Heap = nullptr;
+		HeapAllocationDescription Allocation;
+		// The frame fence after which the descriptor can be reused, 0 while the frame is recorded
+		uint64_t FenceValue = 0;
+	};
+
+	static DescriptorViewCache<CachedView>* s_ViewCache = nullptr;
+	// Views whose resource was released, the GPU might still read them
+	static std::vector<CachedView> s_RetiredViews;
+	// Guards the two above, resources can be released from any thread
+	static std::mutex s_ViewCacheMutex;
+
+	// Keeps the CPU at most FrameLatency frames ahead of the GPU
+	static FramePipeline s_FramePipeline(D3D12Renderer::FrameLatency);
+
+	// A chunk costs a context, its pass setup and a submission, fewer draws are not worth it
+	static constexpr size_t s_MinDrawsPerChunk = 64;
+	static ParallelRecorder s_ParallelRecorder(s_MinDrawsPerChunk, std::max(std::thread::hardware_concurrency(), 1u));
+
+	static MaterialTable* s_MaterialTable = nullptr;
+	static D3D12StructuredBuffer* s_MaterialBuffer = nullptr;
+	// Used by the objects whose material did not fit in the table
+	static uint32_t s_DefaultMaterialIndex = MaterialTable::InvalidIndex;
+	// Guards s_MaterialTable, materials can be destroyed from any thread
+	static std::mutex s_MaterialTableMutex;
+
 
 	D3D12_INPUT_ELEMENT_DESC D3D12Renderer::s_InputLayout[] = {
 			{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, offsetof(Roses::Vertex, Position), D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
@@ -77,6 +136,8 @@ namespace Roses {
 	uint64_t D3D12Renderer::s_FrameCount = 0;
 	uint64_t D3D12Renderer::s_PerFrameDecoupledCap = 0;
 	int32_t D3D12Renderer::s_DecoupledUpdateRate = -1;
+	bool D3D12Renderer::s_BindlessMaterials = false;
+	bool D3D12Renderer::s_ParallelRecording = true;
 
 
     std::vector<Ref<FrameBuffer>> D3D12Renderer::s_Framebuffers;
@@ -108,7 +169,11 @@ namespace Roses {
 
     void D3D12Renderer::BeginFrame()
 	{
-		Context->NewFrame();
+		uint32_t slot = s_FramePipeline.BeginFrame(
+			[](uint64_t fenceValue) { return CommandQueueManager.IsFenceComplete(fenceValue); },
+			[](uint64_t fenceValue) { CommandQueueManager.WaitForFence(fenceValue); }
+		);
+		Context->NewFrame(slot);
 
         s_ForwardTransparentObjects.clear();
         s_ForwardOpaqueObjects.clear();
@@ -149,11 +214,51 @@ namespace Roses {
 		GraphicsContext& context = GraphicsContext::Begin("Present");
 		ColorBuffer& backbuffer = Context->GetCurrentBackBuffer();
 		context.TransitionResource(backbuffer, D3D12_RESOURCE_STATE_PRESENT);
-		context.Finish(true);
+		context.Finish();
+
+		// The frame's transient descriptors are reused once both queues are past it, the graphics
+		// queue waits for the compute queue so a single fence covers them
+		CommandQueue& graphicsQueue = CommandQueueManager.GetGraphicsQueue();
+		graphicsQueue.StallForQueue(CommandQueueManager.GetComputeQueue());
+		uint64_t frameFence = graphicsQueue.IncrementFence();
+		s_FramePipeline.EndFrame(frameFence);
+		s_ResourceDescriptorHeap->EndTransientFrame(frameFence);
+		s_RenderTargetDescriptorHeap->EndTransientFrame(frameFence);
+
+		std::unique_lock<std::mutex> viewCacheLock(s_ViewCacheMutex);
+		for (size_t i = 0; i < s_RetiredViews.size();)
+		{
+			CachedView& view = s_RetiredViews[i];
+			if (view.FenceValue == 0)
+				view.FenceValue = frameFence;
+
+			if (!CommandQueueManager.IsFenceComplete(view.FenceValue))
+			{
+				i++;
+				continue;
+			}
+
+			view.Allocation.Cached = false;
+			view.Heap->Release(view.Allocation);
+			view = s_RetiredViews.back();
+			s_RetiredViews.pop_back();
+		}
+		viewCacheLock.unlock();
+
+		{
+			std::lock_guard<std::mutex> lock(s_MaterialTableMutex);
+			s_MaterialTable->EndFrame();
+		}
+
 		s_FrameCount++;
 		Context->SwapBuffers();
 	}
 
+	uint32_t D3D12Renderer::GetFrameSlot()
+	{
+		return s_FramePipeline.GetCurrentSlot();
+	}
+
 	void D3D12Renderer::BeginScene(Scene& scene)
 	{
 		s_CommonData.Scene = &scene;
@@ -167,7 +272,7 @@ namespace Roses {
 			rl.Position = glm::vec4(l->gameObject->Transform.Position(), 1.0f);
 			rl.Range = l->Range;
 			rl.Intensity = l->Intensity;
-			s_LightsBuffer->CopyData(static_cast<int>(i), rl);
+			s_LightsBuffer[GetFrameSlot()]->CopyData(static_cast<int>(i), rl);
 
 			s_CommonData.NumLights++;
 		}
@@ -384,7 +489,7 @@ namespace Roses {
                 GenerateMips(decoupledContext, tex, mips.FinestMip, mips.CoarsestMip);
             }
 		}
-		decoupledContext.Finish(true);
+		decoupledContext.Finish();
 	}
 
 	void D3D12Renderer::RenderSkybox(GraphicsContext& gfxContext, uint32_t miplevel)
@@ -453,6 +558,84 @@ namespace Roses {
 		const double totalUsedMemory = (static_cast<double>(usedTiles) * D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT) / 1e+6;
 		ImGui::Text("Tiles Used: %d/%d (%.2lf MB)", usedTiles, totalTiles, totalUsedMemory);
 
+		auto& flushStats = TilePool->GetLastFlushStats();
+		ImGui::Text("Tile mapping: %d tiles in %d regions (%d calls)", flushStats.TilesRequested, flushStats.RegionsSubmitted, flushStats.Calls);
+		ImGui::Text("Residency: %d textures changed, %d unchanged (+%d/-%d tiles)", 
+			flushStats.TexturesUpdated, flushStats.TexturesUnchanged, flushStats.TilesMapped, flushStats.TilesUnmapped);
+		ImGui::Text("Evictions: %d tiles from %d textures, %d tiles denied, %d pages released",
+			flushStats.TilesEvicted, flushStats.TexturesEvicted, flushStats.TilesDenied, flushStats.PagesReleased);
+
+		auto& compactionStats = TilePool->GetLastCompactionStats();
+		ImGui::Text("Compaction: %d tiles moved, %d pages emptied, fragmentation %.1f%% -> %.1f%%",
+			compactionStats.TilesMoved, compactionStats.PagesEmptied,
+			compactionStats.Before.Fragmentation * 100.0f, compactionStats.After.Fragmentation * 100.0f);
+
+		auto& readbackRing = FeedbackReadback->GetRing();
+		ImGui::Text("Feedback readback: %d frames in flight, %.2lf MB used, %llu copies, %llu skipped",
+			readbackRing.GetFramesInFlight(), readbackRing.GetUsedBytes() / 1e+6,
+			readbackRing.GetStats().SlotsAllocated, readbackRing.GetStats().SlotsDenied);
+
+		auto& recorderStats = s_ParallelRecorder.GetStats();
+		ImGui::Text("Parallel recording: %llu of %llu passes split, %.1f chunks and %.0f draws per pass, %zu threads",
+			recorderStats.ParallelPasses, recorderStats.Passes,
+			recorderStats.Passes ? recorderStats.Chunks / static_cast<float>(recorderStats.Passes) : 0.0f,
+			recorderStats.Passes ? recorderStats.Items / static_cast<float>(recorderStats.Passes) : 0.0f,
+			s_ParallelRecorder.GetMaxChunks());
+
+		auto& jobSystem = Application::Get().GetJobSystem();
+		auto jobStats = jobSystem.GetStats();
+		ImGui::Text("Jobs: %u workers, %llu jobs, %llu stolen, %llu run by waiting threads",
+			jobSystem.GetWorkerCount(), jobStats.Jobs, jobStats.Steals, jobStats.HelpedJobs);
+
+		auto& framePipelineStats = s_FramePipeline.GetStats();
+		ImGui::Text("Frame pipeline: %u/%u frames in flight, %llu of %llu frames waited for the GPU",
+			s_FramePipeline.GetFramesInFlight([](uint64_t fenceValue) { return CommandQueueManager.IsFenceComplete(fenceValue); }),
+			s_FramePipeline.GetSlotCount(), framePipelineStats.Waits, framePipelineStats.Frames);
+
+		auto& transientRing = s_ResourceDescriptorHeap->GetTransientRing();
+		ImGui::Text("Descriptors: %zu persistent free in %zu ranges, %zu/%zu transient in flight (peak %zu), %llu fallbacks",
+			s_ResourceDescriptorHeap->GetFreeDescriptorCount(), s_ResourceDescriptorHeap->GetFreeRangeCount(),
+			transientRing.GetUsedCount(), transientRing.GetCapacity(), transientRing.GetStats().HighWater,
+			s_ResourceDescriptorHeap->GetTransientFallbacks());
+		auto allocatorStats = s_ResourceDescriptorHeap->GetAllocatorStats();
+		ImGui::Text("Descriptor allocator: %llu lock-free thread cache hits, %llu locked operations",
+			allocatorStats.MagazineHits, allocatorStats.LockedOperations);
+
+		auto uploadServiceStats = UploadService->GetStats();
+		ImGui::Text("Copy queue uploads: %llu in %llu batches, %.1f/%.1f MB staged (peak %.1f MB), %llu stalls",
+			uploadServiceStats.Requests, uploadServiceStats.Batches, UploadService->GetStagedBytes() / (1024.0f * 1024.0f),
+			UploadService->GetStagingBudget() / (1024.0f * 1024.0f), UploadService->GetPeakStagedBytes() / (1024.0f * 1024.0f),
+			UploadService->GetStalls());
+
+		auto uploadStats = LinearAllocator::GetUploadRingStatistics();
+		ImGui::Text("Upload ring: %.1f/%.1f MB in flight (peak %.1f MB), %llu wraps, %llu stalls, %llu grows",
+			uploadStats.UsedBytes / (1024.0f * 1024.0f), uploadStats.Capacity / (1024.0f * 1024.0f),
+			uploadStats.HighWater / (1024.0f * 1024.0f), uploadStats.Wraps, uploadStats.Stalls, uploadStats.Grows);
+
+		auto viewCacheStats = s_ViewCache->GetStats();
+		ImGui::Text("View cache: %zu/%zu views, %.1f%% hit rate (%llu hits, %llu misses), %llu invalidated, %llu uncached",
+			s_ViewCache->GetCount(), s_ViewCache->GetCapacity(), viewCacheStats.HitRate() * 100.0f,
+			viewCacheStats.Hits, viewCacheStats.Misses, viewCacheStats.Invalidated, viewCacheStats.Rejected);
+
+		{
+			std::lock_guard<std::mutex> lock(s_MaterialTableMutex);
+			auto& materialStats = s_MaterialTable->GetStats();
+			ImGui::Text("Material table: %u/%u materials (%u indices used), %llu updates, %llu uploaded in %llu copies",
+				s_MaterialTable->GetCount(), s_MaterialTable->GetCapacity(), s_MaterialTable->GetUsedCount(),
+				materialStats.Updates, materialStats.UploadedMaterials, materialStats.UploadRuns);
+		}
+
+		ImGui::Text("Mip policy: %llu texels shaded, %llu saved", s_TexelsShaded, s_TexelsSavedByMipPolicy);
+		// Summed over the lifetime of the textures shaded this frame
+		ImGui::Text("Mip hysteresis: %llu of %llu mip changes avoided, %llu demotions delayed",
+			s_MipHysteresisStats.ChangesAvoided(), s_MipHysteresisStats.RequestedChanges, s_MipHysteresisStats.DemotionsDelayed);
+		if (s_MipEstimateError.Samples > 0)
+		{
+			ImGui::Text("Mip estimate: %.2lf mips off on average, %.1lf%% within one, %.1lf%% too coarse (%llu samples)",
+				s_MipEstimateError.MeanAbsoluteError(), 100.0 * s_MipEstimateError.WithinOne / s_MipEstimateError.Samples,
+				100.0 * s_MipEstimateError.TooCoarse / s_MipEstimateError.Samples, s_MipEstimateError.Samples);
+		}
+
 
 		if (ImGui::TreeNode(&level, "Heap pages: %d", stats.size()))
 		{
@@ -463,6 +646,7 @@ namespace Roses {
 				{
 					ImGui::Text("Max Tiles: %d", s.MaxTiles);
 					ImGui::Text("Free Tiles: %d", s.FreeTiles);
+					ImGui::Text("Tiles Evicted: %d", s.TilesEvicted);
 					ImGui::TreePop();
 				}
 			}
@@ -729,6 +913,9 @@ namespace Roses {
 		D3D12Renderer::g_ShaderLibrary = new Roses::ShaderLibrary(D3D12Renderer::FrameLatency);
 		D3D12Renderer::g_TextureLibrary = new Roses::TextureLibrary("");
 		D3D12Renderer::TilePool = new Roses::D3D12TilePool();
+		D3D12Renderer::FeedbackReadback = new Roses::D3D12FeedbackReadback(D3D12FeedbackReadback::DefaultCapacity, FrameLatency);
+		D3D12Renderer::UploadService = new Roses::D3D12UploadService(D3D12UploadService::DefaultStagingBudget);
+		s_ParallelRecorder.SetJobSystem(&Application::Get().GetJobSystem());
 
 
 		auto r = Context->DeviceResources.get();
@@ -752,14 +939,16 @@ namespace Roses {
 				D3D12Renderer::Context->DeviceResources->Device.Get(),
 				D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
 				D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE,
-				MAX_RESOURCES
+				MAX_RESOURCES + MAX_TRANSIENT_RESOURCES,
+				MAX_TRANSIENT_RESOURCES
 			);
 
 			s_RenderTargetDescriptorHeap = new D3D12DescriptorHeap(
 				D3D12Renderer::Context->DeviceResources->Device.Get(),
 				D3D12_DESCRIPTOR_HEAP_TYPE_RTV,
 				D3D12_DESCRIPTOR_HEAP_FLAG_NONE,
-				MAX_RENDERTARGETS
+				MAX_RENDERTARGETS + MAX_TRANSIENT_RENDERTARGETS,
+				MAX_TRANSIENT_RENDERTARGETS
 			);
 
 			s_DepthStencilDescriptorHeap = new D3D12DescriptorHeap(
@@ -768,6 +957,8 @@ namespace Roses {
 				D3D12_DESCRIPTOR_HEAP_FLAG_NONE,
 				10
 			);
+
+			s_ViewCache = new DescriptorViewCache<CachedView>(MAX_CACHED_VIEWS);
 		}
 #pragma endregion
 
@@ -936,13 +1127,6 @@ namespace Roses {
 		{
 			HZ_CORE_ASSERT((sizeof(RendererLight) % 16) == 0, "The size of the light struct should be 128-bit aligned");
 
-			s_LightsBuffer = CreateScope<D3D12UploadBuffer<RendererLight>>(MaxSupportedLights, false);
-			s_LightsBuffer->GetResource()->SetName(L"Lights buffer");
-
-			s_LightsBufferAllocation = s_ResourceDescriptorHeap->Allocate(1);
-			HZ_CORE_ASSERT(s_LightsBufferAllocation.Allocated, "Could not allocate the light buffer");
-			s_CommonData.StaticResources++;
-
 			D3D12_SHADER_RESOURCE_VIEW_DESC desc;
 			desc.Format = DXGI_FORMAT_UNKNOWN;
 			desc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
@@ -952,17 +1136,39 @@ namespace Roses {
 			desc.Buffer.StructureByteStride = sizeof(RendererLight);
 			desc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_NONE;
 
-			Context->DeviceResources->Device->CreateShaderResourceView(
-				s_LightsBuffer->GetResource(),
-				&desc,
-				s_LightsBufferAllocation.CPUHandle
-			);
+			for (uint32_t i = 0; i < FrameLatency; i++)
+			{
+				s_LightsBuffer[i] = CreateScope<D3D12UploadBuffer<RendererLight>>(MaxSupportedLights, false);
+				s_LightsBuffer[i]->GetResource()->SetName(L"Lights buffer");
+
+				s_LightsBufferAllocation[i] = s_ResourceDescriptorHeap->Allocate(1);
+				HZ_CORE_ASSERT(s_LightsBufferAllocation[i].Allocated, "Could not allocate the light buffer");
+				s_CommonData.StaticResources++;
+
+				Context->DeviceResources->Device->CreateShaderResourceView(
+					s_LightsBuffer[i]->GetResource(),
+					&desc,
+					s_LightsBufferAllocation[i].CPUHandle
+				);
+			}
 		}
 #pragma endregion
 		
 		s_ImGuiAllocation = s_ResourceDescriptorHeap->Allocate(1);
 		s_CommonData.StaticResources++;
 
+#pragma region Material Table
+		// The bindless shaders read every material from here, an index is only reused once the
+		// frames that could still read its old material are done
+		{
+			s_MaterialTable = new MaterialTable(MAX_MATERIALS, FrameLatency);
+			s_MaterialBuffer = new D3D12StructuredBuffer(MAX_MATERIALS, sizeof(GpuMaterial));
+			s_MaterialBuffer->SetName("Material table");
+
+			s_DefaultMaterialIndex = s_MaterialTable->Register(nullptr);
+		}
+#pragma endregion
+
 	}
 
 	void D3D12Renderer::Shutdown()
@@ -971,7 +1177,8 @@ namespace Roses {
         s_ForwardTransparentObjects.clear();
         s_ForwardOpaqueObjects.clear();
         s_DecoupledOpaqueObjects.clear();
-		s_LightsBuffer.release();
+		for (auto& lightsBuffer : s_LightsBuffer)
+			lightsBuffer.reset();
 		delete s_FullscreenQuadVB;
 		delete s_FullscreenQuadIB;
 
@@ -979,6 +1186,25 @@ namespace Roses {
 		delete g_ShaderLibrary;
 		delete g_TextureLibrary;
 		delete TilePool;
+		delete FeedbackReadback;
+		FeedbackReadback = nullptr;
+		delete UploadService;
+		UploadService = nullptr;
+
+		// The GPU is idle, resources released from now on have no views to drop
+		delete s_ViewCache;
+		s_ViewCache = nullptr;
+		s_RetiredViews.clear();
+
+		{
+			std::lock_guard<std::mutex> lock(s_MaterialTableMutex);
+			delete s_MaterialTable;
+			s_MaterialTable = nullptr;
+			delete s_MaterialBuffer;
+			s_MaterialBuffer = nullptr;
+		}
+
+		LinearAllocator::DestroyAll();
 
 		delete s_ResourceDescriptorHeap;
 		delete s_RenderTargetDescriptorHeap;
@@ -1078,21 +1304,11 @@ namespace Roses {
 
     }
 
-    void D3D12Renderer::CreateUAV(Ref<Texture> texture, uint32_t mip)
-	{
-		if (!texture->UAVAllocation.Allocated)
-		{
-			texture->UAVAllocation = s_ResourceDescriptorHeap->Allocate(1);
-		}
-		
-		CreateUAV(texture, texture->UAVAllocation, mip);
-	}
-
-	void D3D12Renderer::CreateUAV(Ref<Texture> texture, HeapAllocationDescription& description, uint32_t mip)
+	// The view descriptions are zeroed as a whole, the view cache compares their bytes
+	static D3D12_UNORDERED_ACCESS_VIEW_DESC DescribeTextureUAV(const D3D12_RESOURCE_DESC& desc, uint32_t mip)
 	{
-		auto desc = texture->GetResource()->GetDesc();
-
-		D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+		D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc;
+		memset(&uavDesc, 0, sizeof(uavDesc));
 		uavDesc.Format = desc.Format;
 
 		if (desc.DepthOrArraySize > 1)
@@ -1107,42 +1323,11 @@ namespace Roses {
 			uavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
 			uavDesc.Texture2D.MipSlice = mip;
 		}
-
-		Context->DeviceResources->Device->CreateUnorderedAccessView(
-			texture->GetResource(),
-			nullptr,
-			&uavDesc,
-			description.CPUHandle
-		);
-	}
-
-	void D3D12Renderer::CreateSRV(Ref<Texture> texture, uint32_t mostDetailedMip, uint32_t mips, bool forceArray)
-	{
-		if (!texture->SRVAllocation.Allocated)
-		{
-			texture->SRVAllocation = s_ResourceDescriptorHeap->Allocate(1);
-		}
-		
-		CreateSRV(texture, texture->SRVAllocation, mostDetailedMip, mips, forceArray);
+		return uavDesc;
 	}
 
-	void D3D12Renderer::CreateSRV(Ref<Texture> texture, HeapAllocationDescription& description, uint32_t mostDetailedMip, uint32_t mips, bool forceArray)
+	static D3D12_SHADER_RESOURCE_VIEW_DESC DescribeTextureSRV(const D3D12_RESOURCE_DESC& desc, uint32_t mostDetailedMip, uint32_t mips, bool forceArray)
 	{
-		CreateSRV(*texture, description, mostDetailedMip, mips, forceArray);
-	}
-
-	void D3D12Renderer::CreateSRV(Texture& resource, uint32_t mostDetailedMip, uint32_t mips, bool forceArray)
-	{
-		if (!resource.SRVAllocation.Allocated) {
-			resource.SRVAllocation = s_ResourceDescriptorHeap->Allocate(1);
-		}
-		CreateSRV(resource, resource.SRVAllocation, mostDetailedMip, mips, forceArray);
-	}
-
-	void D3D12Renderer::CreateSRV(Texture& resource, HeapAllocationDescription& description, uint32_t mostDetailedMip, uint32_t mips, bool forceArray)
-	{
-        auto desc = resource.GetResource()->GetDesc();
-
         uint32_t actuallMipLevels = (mips > 0) ? mips : desc.MipLevels - mostDetailedMip;
 
         D3D12_SRV_DIMENSION srvDim;
@@ -1156,7 +1341,8 @@ namespace Roses {
             srvDim = D3D12_SRV_DIMENSION_TEXTURE2DARRAY;
         }
 
-        D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+        D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc;
+        memset(&srvDesc, 0, sizeof(srvDesc));
         srvDesc.Format = desc.Format;
         srvDesc.ViewDimension = srvDim;
         srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
@@ -1178,6 +1364,255 @@ namespace Roses {
             srvDesc.TextureCube.MipLevels = actuallMipLevels;
             break;
         }
+        return srvDesc;
+	}
+
+	static D3D12_RENDER_TARGET_VIEW_DESC DescribeRTV(DXGI_FORMAT format, uint32_t mip)
+	{
+		D3D12_RENDER_TARGET_VIEW_DESC rtvDesc;
+		memset(&rtvDesc, 0, sizeof(rtvDesc));
+		rtvDesc.Format = format;
+		rtvDesc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE2D;
+		rtvDesc.Texture2D.MipSlice = mip;
+		return rtvDesc;
+	}
+
+	/// <summary>
+	/// Looks the view up in the view cache, on a miss writeView(cpuHandle) writes it to a new
+	/// descriptor of heap which is cached.
+	/// </summary>
+	template<typename TDesc, typename WriteViewFn>
+	static HeapAllocationDescription GetCachedView(D3D12DescriptorHeap* heap, GpuResource& resource, CachedViewType viewType, const TDesc& desc, WriteViewFn writeView)
+	{
+		DescriptorViewKey key = DescriptorViewKey::Create(resource.GetResource(), viewType, &desc, sizeof(desc));
+
+		std::lock_guard<std::mutex> lock(s_ViewCacheMutex);
+		if (const CachedView* view = s_ViewCache->Find(key))
+			return view->Allocation;
+
+		CachedView view;
+		view.Heap = heap;
+		view.Allocation = heap->Allocate(1);
+		// A failed allocation is never cached, the view is written to a transient descriptor instead
+		if (view.Allocation.Allocated)
+		{
+			view.Allocation.Cached = true;
+			if (!s_ViewCache->Insert(key, view))
+			{
+				view.Allocation.Cached = false;
+				heap->Release(view.Allocation);
+				view.Allocation = heap->AllocateTransient(1);
+			}
+		}
+		else
+		{
+			view.Allocation = heap->AllocateTransient(1);
+		}
+
+		writeView(view.Allocation.CPUHandle);
+		return view.Allocation;
+	}
+
+	HeapAllocationDescription D3D12Renderer::GetCachedSRV(Texture& texture, uint32_t mostDetailedMip, uint32_t mips, bool forceArray)
+	{
+		auto srvDesc = DescribeTextureSRV(texture.GetResource()->GetDesc(), mostDetailedMip, mips, forceArray);
+		return GetCachedView(s_ResourceDescriptorHeap, texture, CachedViewType_SRV, srvDesc, [&](D3D12_CPU_DESCRIPTOR_HANDLE handle) {
+			GetDevice()->CreateShaderResourceView(texture.GetResource(), &srvDesc, handle);
+		});
+	}
+
+	HeapAllocationDescription D3D12Renderer::GetCachedUAV(Texture& texture, uint32_t mip)
+	{
+		auto uavDesc = DescribeTextureUAV(texture.GetResource()->GetDesc(), mip);
+		return GetCachedView(s_ResourceDescriptorHeap, texture, CachedViewType_UAV, uavDesc, [&](D3D12_CPU_DESCRIPTOR_HANDLE handle) {
+			GetDevice()->CreateUnorderedAccessView(texture.GetResource(), nullptr, &uavDesc, handle);
+		});
+	}
+
+	HeapAllocationDescription D3D12Renderer::GetCachedRTV(GpuResource& resource, uint32_t mip)
+	{
+		auto rtvDesc = DescribeRTV(resource.GetFormat(), mip);
+		return GetCachedView(s_RenderTargetDescriptorHeap, resource, CachedViewType_RTV, rtvDesc, [&](D3D12_CPU_DESCRIPTOR_HANDLE handle) {
+			GetDevice()->CreateRenderTargetView(resource.GetResource(), &rtvDesc, handle);
+		});
+	}
+
+	void D3D12Renderer::ReleaseCachedViews(const GpuResource& resource)
+	{
+		if (s_ViewCache == nullptr || resource.GetResource() == nullptr)
+			return;
+
+		std::lock_guard<std::mutex> lock(s_ViewCacheMutex);
+		s_ViewCache->Invalidate(resource.GetResource(), [](const CachedView& view) {
+			s_RetiredViews.push_back(view);
+		});
+	}
+
+	void D3D12Renderer::UpdateTransforms(const std::vector<Ref<HGameObject>>& objects)
+	{
+		for (auto& obj : objects)
+		{
+			if (obj == nullptr)
+				continue;
+
+			obj->Transform.LocalToWorldMatrix();
+			obj->Transform.WorldToLocalMatrix();
+		}
+	}
+
+	void D3D12Renderer::RecordDraws(GraphicsContext& gfxContext, size_t count,
+		const std::function<void(GraphicsContext&)>& preparePass,
+		const std::function<void(GraphicsContext&)>& beginPass,
+		const std::function<void(GraphicsContext&, size_t begin, size_t end)>& recordDraws)
+	{
+		if (!s_ParallelRecording || s_ParallelRecorder.GetChunkCount(count) <= 1)
+		{
+			preparePass(gfxContext);
+			beginPass(gfxContext);
+			recordDraws(gfxContext, 0, count);
+			return;
+		}
+
+		// The chunks are submitted right after what gfxContext has so far, and before the rest of
+		// it. What preparePass uploads belongs to that rest, so it outlives the chunks
+		gfxContext.Flush();
+		preparePass(gfxContext);
+
+		std::vector<GraphicsContext*> contexts(s_ParallelRecorder.GetChunkCount(count), nullptr);
+		s_ParallelRecorder.Record(count,
+			[&](size_t chunkIndex, const ParallelRecorder::Chunk& chunk) {
+				GraphicsContext& context = GraphicsContext::Begin();
+				contexts[chunkIndex] = &context;
+				beginPass(context);
+				recordDraws(context, chunk.Begin, chunk.End);
+			},
+			[&](size_t chunkIndex) {
+				contexts[chunkIndex]->Finish();
+			});
+	}
+
+	// The index of the texture's view in the resource heap, which the bindless shaders see whole
+	static uint32_t GetBindlessTextureIndex(bool hasTexture, const Ref<Texture2D>& texture)
+	{
+		if (!hasTexture || texture == nullptr || !texture->SRVAllocation.Allocated)
+			return GpuMaterial::NoTexture;
+
+		return static_cast<uint32_t>(texture->SRVAllocation.OffsetInHeap);
+	}
+
+	uint32_t D3D12Renderer::GetMaterialIndex(HMaterial& material)
+	{
+		GpuMaterial gpuMaterial;
+		gpuMaterial.Color = material.Color;
+		gpuMaterial.AlbedoTexture = GetBindlessTextureIndex(material.HasAlbedoTexture, material.AlbedoTexture);
+		gpuMaterial.EmissiveColor = material.EmissiveColor;
+		gpuMaterial.NormalTexture = GetBindlessTextureIndex(material.HasNormalTexture, material.NormalTexture);
+		gpuMaterial.Roughness = material.Roughness;
+		gpuMaterial.Metallic = material.Metallic;
+		gpuMaterial.RoughnessTexture = GetBindlessTextureIndex(material.HasRoughnessTexture, material.RoughnessTexture);
+		gpuMaterial.MetallicTexture = GetBindlessTextureIndex(material.HasMetallicTexture, material.MetallicTexture);
+
+		std::lock_guard<std::mutex> lock(s_MaterialTableMutex);
+		uint32_t index = s_MaterialTable->Register(&material);
+		if (index == MaterialTable::InvalidIndex)
+		{
+			static bool warned = false;
+			if (!warned)
+			{
+				HZ_CORE_WARN("The material table is full, {} and the materials after it use the default material", material.Name);
+				warned = true;
+			}
+			return s_DefaultMaterialIndex;
+		}
+
+		s_MaterialTable->Set(index, gpuMaterial);
+		return index;
+	}
+
+	void D3D12Renderer::FlushMaterialTable(CommandContext& context)
+	{
+		std::lock_guard<std::mutex> lock(s_MaterialTableMutex);
+		s_MaterialTable->FlushDirty([&](uint32_t firstIndex, uint32_t count, const GpuMaterial* materials) {
+			context.WriteBuffer(*s_MaterialBuffer, firstIndex * sizeof(GpuMaterial), materials, count * sizeof(GpuMaterial));
+		});
+		context.TransitionResource(*s_MaterialBuffer, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, true);
+	}
+
+	void D3D12Renderer::ReleaseMaterial(const HMaterial& material)
+	{
+		// Materials outliving the renderer have nothing to release
+		if (s_MaterialTable == nullptr)
+			return;
+
+		std::lock_guard<std::mutex> lock(s_MaterialTableMutex);
+		if (s_MaterialTable != nullptr)
+			s_MaterialTable->Unregister(&material);
+	}
+
+	void D3D12Renderer::SetBindlessPassResources(GraphicsContext& gfxContext)
+	{
+		auto envRad = s_CommonData.Scene->Environment.EnvironmentMap;
+		auto envIrr = s_CommonData.Scene->Environment.IrradianceMap;
+		auto lut = g_TextureLibrary->GetAs<Texture2D>(std::string("spbrdf"));
+
+		auto commandList = gfxContext.GetCommandList();
+		commandList->SetGraphicsRootShaderResourceView(BindlessRootParameters_Materials, s_MaterialBuffer->GetGpuAddress());
+		commandList->SetGraphicsRootDescriptorTable(BindlessRootParameters_Textures, s_ResourceDescriptorHeap->GetGPUHandle(0));
+		commandList->SetGraphicsRootDescriptorTable(BindlessRootParameters_EnvRadiance, envRad->SRVAllocation.GPUHandle);
+		commandList->SetGraphicsRootDescriptorTable(BindlessRootParameters_EnvIrradiance, envIrr->SRVAllocation.GPUHandle);
+		commandList->SetGraphicsRootDescriptorTable(BindlessRootParameters_BRDFLUT, lut->SRVAllocation.GPUHandle);
+		commandList->SetGraphicsRootDescriptorTable(BindlessRootParameters_Lights, GetLightsBufferAllocation().GPUHandle);
+	}
+
+    void D3D12Renderer::CreateUAV(Ref<Texture> texture, uint32_t mip)
+	{
+		if (!texture->UAVAllocation.Allocated || texture->UAVAllocation.Cached)
+		{
+			texture->UAVAllocation = s_ResourceDescriptorHeap->Allocate(1);
+		}
+		
+		CreateUAV(texture, texture->UAVAllocation, mip);
+	}
+
+	void D3D12Renderer::CreateUAV(Ref<Texture> texture, HeapAllocationDescription& description, uint32_t mip)
+	{
+		auto uavDesc = DescribeTextureUAV(texture->GetResource()->GetDesc(), mip);
+
+		Context->DeviceResources->Device->CreateUnorderedAccessView(
+			texture->GetResource(),
+			nullptr,
+			&uavDesc,
+			description.CPUHandle
+		);
+	}
+
+	void D3D12Renderer::CreateSRV(Ref<Texture> texture, uint32_t mostDetailedMip, uint32_t mips, bool forceArray)
+	{
+		if (!texture->SRVAllocation.Allocated || texture->SRVAllocation.Cached)
+		{
+			texture->SRVAllocation = s_ResourceDescriptorHeap->Allocate(1);
+		}
+		
+		CreateSRV(texture, texture->SRVAllocation, mostDetailedMip, mips, forceArray);
+	}
+
+	void D3D12Renderer::CreateSRV(Ref<Texture> texture, HeapAllocationDescription& description, uint32_t mostDetailedMip, uint32_t mips, bool forceArray)
+	{
+		CreateSRV(*texture, description, mostDetailedMip, mips, forceArray);
+	}
+
+	void D3D12Renderer::CreateSRV(Texture& resource, uint32_t mostDetailedMip, uint32_t mips, bool forceArray)
+	{
+		if (!resource.SRVAllocation.Allocated || resource.SRVAllocation.Cached) {
+			resource.SRVAllocation = s_ResourceDescriptorHeap->Allocate(1);
+		}
+		CreateSRV(resource, resource.SRVAllocation, mostDetailedMip, mips, forceArray);
+	}
+
+	void D3D12Renderer::CreateSRV(Texture& resource, HeapAllocationDescription& description, uint32_t mostDetailedMip, uint32_t mips, bool forceArray)
+	{
+        auto srvDesc = DescribeTextureSRV(resource.GetResource()->GetDesc(), mostDetailedMip, mips, forceArray);
+
         Context->DeviceResources->Device->CreateShaderResourceView(
             resource.GetResource(),
             &srvDesc,
@@ -1210,7 +1645,7 @@ namespace Roses {
 
 	void D3D12Renderer::CreateRTV(Ref<Texture> texture, uint32_t mip)
 	{
-		if (!texture->RTVAllocation.Allocated)
+		if (!texture->RTVAllocation.Allocated || texture->RTVAllocation.Cached)
 		{
 			texture->RTVAllocation = s_RenderTargetDescriptorHeap->Allocate(1);
 		}
@@ -1224,7 +1659,7 @@ namespace Roses {
 
 	void D3D12Renderer::CreateRTV(Texture& texture, uint32_t mip)
 	{
-		if (!texture.RTVAllocation.Allocated) {
+		if (!texture.RTVAllocation.Allocated || texture.RTVAllocation.Cached) {
 			texture.RTVAllocation = s_RenderTargetDescriptorHeap->Allocate(1);
 		}
 		CreateRTV(texture, texture.RTVAllocation, mip);
@@ -1232,10 +1667,7 @@ namespace Roses {
 
 	void D3D12Renderer::CreateRTV(Texture& texture, HeapAllocationDescription& description, uint32_t mip)
 	{
-        D3D12_RENDER_TARGET_VIEW_DESC rtvDesc = {};
-        rtvDesc.Format = texture.GetFormat();
-        rtvDesc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE2D;
-        rtvDesc.Texture2D.MipSlice = mip;
+        auto rtvDesc = DescribeRTV(texture.GetFormat(), mip);
 
         GetDevice()->CreateRenderTargetView(
 			texture.GetResource(),
@@ -1247,10 +1679,7 @@ namespace Roses {
 
 	void D3D12Renderer::CreateRTV(GpuResource& resource, HeapAllocationDescription& description, uint32_t mip)
 	{
-		D3D12_RENDER_TARGET_VIEW_DESC rtvDesc = {};
-		rtvDesc.Format = resource.GetFormat();
-		rtvDesc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE2D;
-		rtvDesc.Texture2D.MipSlice = mip;
+		auto rtvDesc = DescribeRTV(resource.GetFormat(), mip);
 
 		GetDevice()->CreateRenderTargetView(
 			resource.GetResource(),
@@ -1328,8 +1757,7 @@ namespace Roses {
         D3D12_UNORDERED_ACCESS_VIEW_DESC fbUAVDesc = {};
         fbUAVDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
         fbUAVDesc.Format = fbDesc.Format;
-        auto dims = fb->GetDimensions();
-        fbUAVDesc.Buffer.NumElements = dims.x * dims.y;
+        fbUAVDesc.Buffer.NumElements = fb->GetNumElements();
         fbUAVDesc.Buffer.StructureByteStride = sizeof(uint32_t);
         D3D12Renderer::GetDevice()->CreateUnorderedAccessView(
             fb->GetResource(),
@@ -1361,7 +1789,7 @@ namespace Roses {
 		// get positive
 		uint32_t remainingMips = (leastDetailedMip - mostDetailedMip);
 
-		HeapAllocationDescription srcAllocation = s_ResourceDescriptorHeap->Allocate(1);
+		HeapAllocationDescription srcAllocation = s_ResourceDescriptorHeap->AllocateTransient(1);
 
 		HZ_CORE_ASSERT(srcAllocation.Allocated, "Run out of heap space. Something is not releasing properly");
 		context.TrackAllocation(srcAllocation);
@@ -1436,7 +1864,7 @@ namespace Roses {
 
 			for (uint32_t mip = 0; mip < mipCount; mip++)
 			{
-				HeapAllocationDescription allocation = s_ResourceDescriptorHeap->Allocate(1);
+				HeapAllocationDescription allocation = s_ResourceDescriptorHeap->AllocateTransient(1);
 				heapAllocations.push_back(allocation);
 				CreateUAV(texture, allocation, srcMip + mip + 1);
 			}
@@ -1445,7 +1873,7 @@ namespace Roses {
 			{
 				for (uint32_t mip = mipCount; mip < MipsPerIteration; mip++)
 				{
-					HeapAllocationDescription allocation = s_ResourceDescriptorHeap->Allocate(1);
+					HeapAllocationDescription allocation = s_ResourceDescriptorHeap->AllocateTransient(1);
 					HZ_CORE_ASSERT(allocation.Allocated, "WTF");
 					heapAllocations.push_back(allocation);
 					D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
@@ -1503,21 +1931,62 @@ namespace Roses {
 		cmdlist->SetComputeRoot32BitConstants(0, 1, &value, 0);
 
 		ID3D12Resource* res = nullptr;
-		glm::ivec3 dims = { 1, 1, 1 };
+		uint32_t numElements = 1;
 
 		if (resource != nullptr)
 		{
 			res = resource->GetResource();
-			dims = resource->GetDimensions();
+			numElements = resource->GetNumElements();
 		}
 
-		auto dispatch_count = D3D12::RoundToMultiple(dims.x * dims.y, 6);
+		auto dispatch_count = D3D12::RoundToMultiple(numElements, 6);
 
 		cmdlist->Dispatch(dispatch_count, 1, 1);
 		cmdlist->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::UAV(res));
 
 	}
 
+	// Spreading the reductions over threads only pays off past a few textures per task
+	static constexpr size_t s_MinReductionsPerTask = 4;
+
+	static MipEstimateInput GetMipEstimateInput(HGameObject& object)
+	{
+		auto& tex = object.DecoupledComponent.VirtualTexture;
+
+		MipEstimateInput input;
+		input.LocalToWorld = object.Transform.LocalToWorldMatrix();
+		input.BoundsMin = object.Mesh->BoundingBox.Min;
+		input.BoundsMax = object.Mesh->BoundingBox.Max;
+		input.SurfaceArea = object.Mesh->TexelDensity.SurfaceArea;
+		input.UVArea = object.Mesh->TexelDensity.UVArea;
+		input.TextureWidth = tex->GetWidth();
+		input.TextureHeight = tex->GetHeight();
+		input.MipLevels = tex->GetMipLevels();
+		return input;
+	}
+
+	static void UpdateMipsUsed(HGameObject& object, const MipEstimateView& view)
+	{
+		auto& component = object.DecoupledComponent;
+		if (component.AnalyticMips)
+			component.VirtualTexture->ApplyEstimatedMips(EstimateMips(GetMipEstimateInput(object), view), component.MipHysteresis);
+		else
+			component.VirtualTexture->ExtractMipsUsed(component.MipPolicy, component.MipHysteresis);
+	}
+
+	/// <summary>
+	/// Runs ExtractMipsUsed, or the analytic estimate, for every object, in parallel. Every
+	/// reduction only reads its own feedback map and writes its own texture, so the jobs
+	/// share nothing.
+	/// </summary>
+	static void ExtractMipsUsed(const std::vector<Ref<HGameObject>>& objects, const MipEstimateView& view)
+	{
+		Application::Get().GetJobSystem().ParallelFor(objects.size(), s_MinReductionsPerTask, [&objects, &view](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++)
+				UpdateMipsUsed(*objects[i], view);
+		});
+	}
+
 	void D3D12Renderer::UpdateVirtualTextures()
 	{
 		if (s_DecoupledOpaqueObjects.size() == 0)
@@ -1526,27 +1995,74 @@ namespace Roses {
 		ComputeContext& computeContext = ComputeContext::Begin("Feedback Readback");
 		for (auto obj : s_DecoupledOpaqueObjects)
 		{
+			if (obj->DecoupledComponent.AnalyticMips)
+				continue;
+
 			auto tex = obj->DecoupledComponent.VirtualTexture;
 			auto feedback = tex->GetFeedbackMap();
 			//ScopedTimer t("Feedback Update", commandList);
 			feedback->Update(computeContext);
 		}
-        computeContext.Finish(true);
+		// The copies are consumed once their fence completed, a few frames from now, instead of waiting on them
+		FeedbackReadback->EndFrame(computeContext.Finish());
+		FeedbackReadback->Resolve();
 		ScopedTimer timer("Tilemaps Update");
+
+		MipEstimateView view;
+		view.ViewProjection = s_CommonData.Scene->Camera->GetViewProjectionMatrix();
+		view.ViewportWidth = Context->Viewport.Width;
+		view.ViewportHeight = Context->Viewport.Height;
+		ExtractMipsUsed(s_DecoupledOpaqueObjects, view);
+
+		s_TexelsShaded = 0;
+		s_TexelsSavedByMipPolicy = 0;
+		s_MipHysteresisStats = {};
+
+		// The tile pool is not thread safe, the mapping itself stays on this thread
         for (auto obj : s_DecoupledOpaqueObjects)
         {
             auto tex = obj->DecoupledComponent.VirtualTexture;
-			auto mips = tex->ExtractMipsUsed();
+			auto mips = tex->GetMipsUsed();
+			s_TexelsShaded += tex->GetMipSelection().ShadedTexels;
+			s_TexelsSavedByMipPolicy += tex->GetMipSelection().TexelsSaved;
+
+			auto& hysteresisStats = tex->GetMipHysteresisStats();
+			s_MipHysteresisStats.Updates += hysteresisStats.Updates;
+			s_MipHysteresisStats.RequestedChanges += hysteresisStats.RequestedChanges;
+			s_MipHysteresisStats.AppliedChanges += hysteresisStats.AppliedChanges;
+			s_MipHysteresisStats.DemotionsDelayed += hysteresisStats.DemotionsDelayed;
+
+			// Every object that still reads its feedback tells how good the estimate would have been
+			auto& reduction = tex->GetFeedbackReduction();
+			if (!obj->DecoupledComponent.AnalyticMips && reduction.SampledCells > 0)
+			{
+				MipEstimate estimate = EstimateMips(GetMipEstimateInput(*obj), view);
+				if (estimate.Valid && estimate.Visible)
+					s_MipEstimateError.Add(estimate.FinestMip, reduction.FinestMip);
+			}
             //ScopedTimer t("Texture Map", commandList);
 			TilePool->MapTexture(*tex);
 			tex->UpdateFromDescription();
 
             auto mip = mips.FinestMip >= tex->GetMipLevels() ? tex->GetMipLevels() - 1 : mips.FinestMip;
 
+			// Release ignores the allocation if it came from the view cache
 			if (tex->SRVAllocation.Allocated)
 				s_ResourceDescriptorHeap->Release(tex->SRVAllocation);
-            CreateSRV(tex, mip);
-		}		
+            tex->SRVAllocation = GetCachedSRV(*tex, mip);
+		}
+		TilePool->FlushUpdates();
+		TilePool->Compact();
+	}
+
+	const MipEstimateErrorStats& D3D12Renderer::GetMipEstimateErrorStats()
+	{
+		return s_MipEstimateError;
+	}
+
+	void D3D12Renderer::ResetMipEstimateErrorStats()
+	{
+		s_MipEstimateError = {};
 	}
 
 	void D3D12Renderer::RenderVirtualTextures()
@@ -1586,20 +2102,24 @@ namespace Roses {
 
 		for (auto obj : s_DecoupledOpaqueObjects)
 		{
+			// Nothing writes or reads the feedback of estimated objects
+			if (obj->DecoupledComponent.AnalyticMips)
+				continue;
+
 			auto tex = obj->DecoupledComponent.VirtualTexture;
 			auto mips = tex->GetMipLevels();
 			auto fb = tex->GetFeedbackMap();
-			auto dims = fb->GetDimensions();
+			auto clearValue = fb->GetClearValue(mips);
 #if HZ_DEBUG
 			if (mips == 1)
 			{
 				__debugbreak();
 			}
 #endif
-			context.GetCommandList()->SetComputeRoot32BitConstants(0, 1, &mips, 0);
+			context.GetCommandList()->SetComputeRoot32BitConstants(0, 1, &clearValue, 0);
 			context.GetCommandList()->SetComputeRootDescriptorTable(1, fb->UAVAllocation.GPUHandle);
 
-			auto dispatch_count = Roses::D3D12::RoundToMultiple(dims.x * dims.y, 64);
+			auto dispatch_count = Roses::D3D12::RoundToMultiple(fb->GetNumElements(), 64);
 
 			context.GetCommandList()->Dispatch(dispatch_count, 1, 1);
 		}
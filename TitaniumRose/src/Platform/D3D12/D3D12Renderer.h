@@ -22,6 +22,9 @@ namespace Roses
     class D3D12IndexBuffer;
     class CommandListManager;
     class ContextManager;
+    class D3D12FeedbackReadback;
+    class D3D12UploadService;
+    struct MipEstimateErrorStats;
 
     class D3D12Renderer
     {
@@ -42,6 +45,8 @@ namespace Roses
         static TextureLibrary* g_TextureLibrary;
         static D3D12Context* Context;
         static D3D12TilePool* TilePool;
+        static D3D12FeedbackReadback* FeedbackReadback;
+        static D3D12UploadService* UploadService;
 
         static CommandListManager CommandQueueManager;
 
@@ -121,6 +126,41 @@ namespace Roses
         static void CreateRTV(Texture& texture, HeapAllocationDescription& description, uint32_t mip = 0);
         static void CreateRTV(GpuResource& resource, HeapAllocationDescription& description, uint32_t mip = 0);
 
+        /// <summary>
+        /// Returns the view from the view cache, it is only written the first time it is asked
+        /// for. The descriptor belongs to the cache and stays valid until the resource is
+        /// released, it must not be written to. Once the cache is full the view is written
+        /// to a transient descriptor that only lasts the frame.
+        /// </summary>
+        static HeapAllocationDescription GetCachedSRV(Texture& texture, uint32_t mostDetailedMip = 0, uint32_t mips = 0, bool forceArray = false);
+        static HeapAllocationDescription GetCachedUAV(Texture& texture, uint32_t mip = 0);
+        static HeapAllocationDescription GetCachedRTV(GpuResource& resource, uint32_t mip = 0);
+
+        /// <summary>
+        /// Drops the cached views of a resource, their descriptors are freed once the GPU is
+        /// past the current frame. Called by GpuResource when it lets go of its resource.
+        /// </summary>
+        static void ReleaseCachedViews(const GpuResource& resource);
+
+        /// <summary>
+        /// Returns the index of the material in the bindless material table, it is registered
+        /// the first time and keeps its index until it is released. Its entry is rewritten if
+        /// the material changed, the change reaches the GPU with the next FlushMaterialTable.
+        /// </summary>
+        static uint32_t GetMaterialIndex(HMaterial& material);
+
+        /// <summary>
+        /// Copies the materials that changed into the GPU material table, has to be recorded
+        /// before the draws that use them.
+        /// </summary>
+        static void FlushMaterialTable(CommandContext& context);
+
+        /// <summary>
+        /// Frees the index of a material, it is only reused once the frames in flight are done
+        /// with it. Called by HMaterial when it is destroyed.
+        /// </summary>
+        static void ReleaseMaterial(const HMaterial& material);
+
         //static void CreateDSV(Ref<D3D12Texture> texture);
         static void CreateDSV(Ref<Texture> texture, HeapAllocationDescription& description);
         static void CreateMissingVirtualTextures();
@@ -134,14 +174,29 @@ namespace Roses
         static uint64_t GetPerFrameDecoupledCap() { return s_PerFrameDecoupledCap; }
         static void SetDecoupledUpdateRate(int32_t rate) { s_DecoupledUpdateRate = rate; }
         static int32_t GetDecoupledUpdateRate() { return s_DecoupledUpdateRate; }
+        // Draws pass a material and object index instead of binding every texture
+        static void SetBindlessMaterials(bool enable) { s_BindlessMaterials = enable; }
+        static bool GetBindlessMaterials() { return s_BindlessMaterials; }
+        // Splits the draws of the forward, decoupled and simple passes over threads. Objects are
+        // only timed one by one when a pass is recorded on a single thread
+        static void SetParallelRecording(bool enable) { s_ParallelRecording = enable; }
+        static bool GetParallelRecording() { return s_ParallelRecording; }
+
+        // How far the analytic mip estimates were from the feedback since the last reset,
+        // gathered from the objects that still use their feedback
+        static const MipEstimateErrorStats& GetMipEstimateErrorStats();
+        static void ResetMipEstimateErrorStats();
 
         static inline uint64_t GetFrameCount() { return s_FrameCount; }
+        // The slot of the frame being recorded, per-frame resources are indexed by it
+        static uint32_t GetFrameSlot();
 
         static inline ID3D12Device2* GetDevice() { return Context->DeviceResources->Device.Get(); }
 
     protected:
         static void ReclaimDynamicDescriptors();
         static void CreateFrameBuffers(CommandContext& context);
+        static inline const HeapAllocationDescription& GetLightsBufferAllocation() { return s_LightsBufferAllocation[GetFrameSlot()]; }
 
         virtual void ImplRenderSubmitted(GraphicsContext& gfxContext) = 0;
         virtual void ImplOnInit() = 0;
@@ -150,6 +205,32 @@ namespace Roses
         virtual void ImplOnFrameEnd() {};
         virtual RendererType ImplGetRendererType() = 0;
 
+        /// <summary>
+        /// Binds what the draws of a bindless pass share: the material table, the resource heap
+        /// as the texture table, the environment and the scene lights. The material table has
+        /// to be flushed before.
+        /// </summary>
+        static void SetBindlessPassResources(GraphicsContext& gfxContext);
+
+        // Brings the matrices the transforms cache up to date, before the objects are read from
+        // several threads. Objects sharing a parent would otherwise all update it
+        static void UpdateTransforms(const std::vector<Ref<HGameObject>>& objects);
+
+        /// <summary>
+        /// Records count draws, split into chunks that are recorded in parallel into contexts of
+        /// their own when there are enough of them. The chunks run after what gfxContext recorded
+        /// so far and before what it records afterwards.
+        /// </summary>
+        /// <param name="preparePass">Records into gfxContext what the chunks share, like the pass constants.
+        /// The upload memory it takes lives until gfxContext is finished</param>
+        /// <param name="beginPass">Sets up a context for the draws: pipeline state, targets and root arguments</param>
+        /// <param name="recordDraws">Records the draws in [begin, end), called from any thread. It may only
+        /// time objects with the profiler when the context is gfxContext</param>
+        static void RecordDraws(GraphicsContext& gfxContext, size_t count,
+            const std::function<void(GraphicsContext&)>& preparePass,
+            const std::function<void(GraphicsContext&)>& beginPass,
+            const std::function<void(GraphicsContext&, size_t begin, size_t end)>& recordDraws);
+
     protected:
         
         struct CommonData 
@@ -185,12 +266,50 @@ namespace Roses
             // ( 16 bytes )
         };
 
+        // The root parameters of the bindless surface shaders, BINDLESS_RS in RootSignatures.hlsli
+        enum BindlessRootParameters
+        {
+            BindlessRootParameters_DrawConstants,
+            BindlessRootParameters_Pass,
+            BindlessRootParameters_Materials,
+            BindlessRootParameters_Objects,
+            BindlessRootParameters_ObjectLights,
+            BindlessRootParameters_Textures,
+            BindlessRootParameters_EnvRadiance,
+            BindlessRootParameters_EnvIrradiance,
+            BindlessRootParameters_BRDFLUT,
+            BindlessRootParameters_Lights,
+            BindlessRootParameters_Count
+        };
+
+        // The only root constants a bindless draw sets
+        struct BindlessDrawConstants
+        {
+            uint32_t MaterialIndex;
+            uint32_t ObjectIndex;
+        };
+
+        // An object of a bindless pass, ObjectData in Bindless.common.hlsli
+        struct alignas(16) BindlessObjectData
+        {
+            glm::mat4 LocalToWorld;
+            // ----- 16 bytes -----
+            // Where the object's lights start in the pass's light list
+            uint32_t LightOffset;
+            uint32_t LightCount;
+            uint32_t FinestMip;
+            uint32_t _padding;
+            // ----- 16 bytes -----
+        };
+
         static D3D12_INPUT_ELEMENT_DESC s_InputLayout[];
         static uint32_t s_InputLayoutCount;
         static uint32_t s_CurrentFrameBuffer;
         static uint64_t s_FrameCount;
         static uint64_t s_PerFrameDecoupledCap;
         static int32_t s_DecoupledUpdateRate;
+        static bool s_BindlessMaterials;
+        static bool s_ParallelRecording;
 
         static std::vector<Ref<HGameObject>> s_ForwardOpaqueObjects;
         static std::vector<Ref<HGameObject>> s_ForwardTransparentObjects;
@@ -199,8 +318,9 @@ namespace Roses
 
         static std::vector<D3D12Renderer*> s_AvailableRenderers;
         static std::vector<Ref<FrameBuffer>> s_Framebuffers;
-        static Scope<D3D12UploadBuffer<RendererLight>> s_LightsBuffer;
-        static HeapAllocationDescription s_LightsBufferAllocation;
+        // One per frame slot, BeginScene rewrites the lights while older frames may still read theirs
+        static Scope<D3D12UploadBuffer<RendererLight>> s_LightsBuffer[FrameLatency];
+        static HeapAllocationDescription s_LightsBufferAllocation[FrameLatency];
         static HeapAllocationDescription s_ImGuiAllocation;
         
         static D3D12VertexBuffer* s_FullscreenQuadVB;
@@ -6,6 +6,7 @@
 #include "Platform/D3D12/D3D12Renderer.h"
 #include "Platform/D3D12/D3D12Texture.h"
 #include "Platform/D3D12/D3D12TilePool.h"
+#include "Platform/D3D12/D3D12UploadService.h"
 #include "Platform/D3D12/DDSTextureLoader/DDSTextureLoader.h"
 
 
@@ -162,7 +163,7 @@ namespace Roses {
 		return ret;
 	}
 
-	D3D12FeedbackMap* Texture2D::CreateFeedbackMap(Texture2D& texture)
+	D3D12FeedbackMap* Texture2D::CreateFeedbackMap(Texture2D& texture, size_t elementSize)
 	{
 		auto resource = texture.GetResource();
 		auto desc = resource->GetDesc();
@@ -193,9 +194,7 @@ namespace Roses {
 			tiles_y = desc.Height / factor;
 		}
 
-		// TODO: The feedback map is hardcoded to always be uint32_t now. Might have to change it later.
-		// The constructor already supports it.
-		auto ret = new D3D12FeedbackMap(D3D12Renderer::GetDevice(), tiles_x, tiles_y, sizeof(uint32_t));
+		auto ret = new D3D12FeedbackMap(D3D12Renderer::GetDevice(), tiles_x, tiles_y, elementSize);
 		auto name = texture.GetIdentifier() + "-feedback";
 
 		ret->SetName(name);
@@ -230,7 +229,7 @@ namespace Roses {
 		ret->BypassAndSetState(D3D12_RESOURCE_STATE_COPY_DEST);
 		ret->SetName(opts.Path);
 		// The resource is left in the copy_dest state from LoadDDSTextureFromMemory
-		CommandContext::InitializeTexture(*ret, subData.size(), subData.data());
+		D3D12Renderer::UploadService->UploadTexture(*ret, subData.size(), subData.data());
 		ret->UpdateFromDescription();
 
 		return Ref<Texture2D>(ret);
@@ -270,7 +269,7 @@ namespace Roses {
 		data.pData = image->Bytes<void>();
 		data.RowPitch = (uint64_t)image->GetWidth() * image->BytesPerPixel();
 		data.SlicePitch = data.RowPitch * image->GetHeight();
-		CommandContext::InitializeTexture(*ret, 1, &data);
+		D3D12Renderer::UploadService->UploadTexture(*ret, 1, &data);
 
 		ret->UpdateFromDescription();
 				
@@ -293,32 +292,55 @@ namespace Roses {
 	}
 
 	Texture2D::MipLevelsUsed VirtualTexture2D::ExtractMipsUsed()
+	{
+		return ExtractMipsUsed(MipPolicy(), MipHysteresisSettings());
+	}
+
+	Texture2D::MipLevelsUsed VirtualTexture2D::ExtractMipsUsed(const MipPolicy& policy, const MipHysteresisSettings& hysteresis)
 	{
 		HZ_CORE_ASSERT(m_FeedbackMap != nullptr, "Virtual textures should have a feedback map");
 
+		m_UsesFeedback = true;
 		auto dims = m_FeedbackMap->GetDimensions();
 
-		uint32_t* data = m_FeedbackMap->GetData();
+		const uint8_t* feedback = m_FeedbackMap->GetData();
+		if (hysteresis.AccumulationFrames > 0) {
+			feedback = m_FeedbackAccumulator.Accumulate(feedback, dims.x, dims.y, hysteresis.AccumulationFrames).data();
+		}
+		else {
+			m_FeedbackAccumulator.Reset();
+		}
 
-		uint32_t finest_mip = m_MipLevels;
-		uint32_t coarsest_mip = 0;
-		for (int y = 0; y < dims.y; y++)
-		{
-			for (int x = 0; x < dims.x; x++)
-			{
-				uint32_t mip = data[y * dims.x + x];
+		m_FeedbackReduction = ReduceFeedback(feedback, size_t(dims.x) * dims.y, m_MipLevels);
 
-				if (mip < finest_mip) {
-					finest_mip = mip;
-				}
+		m_MipSelection = SelectMips(m_FeedbackReduction, policy, m_Width, m_Height, m_MipLevels);
 
-				if (mip > coarsest_mip && mip != m_MipLevels) {
-					coarsest_mip = mip;
-				}
-			}
-		}
-		m_CachedMipLevels.FinestMip = (finest_mip == m_MipLevels) ? finest_mip - 1 : finest_mip;
-		m_CachedMipLevels.CoarsestMip = (coarsest_mip == m_MipLevels) ? coarsest_mip - 1 : coarsest_mip;
+		m_MipHysteresis.Update(m_MipSelection.FinestMip, m_FeedbackReduction.CoarsestMip, hysteresis);
+
+		m_CachedMipLevels.FinestMip = m_MipHysteresis.GetFinestMip();
+		m_CachedMipLevels.CoarsestMip = m_MipHysteresis.GetCoarsestMip();
+
+		return m_CachedMipLevels;
+	}
+
+	Texture2D::MipLevelsUsed VirtualTexture2D::ApplyEstimatedMips(const MipEstimate& estimate, const MipHysteresisSettings& hysteresis)
+	{
+		m_UsesFeedback = false;
+		m_FeedbackAccumulator.Reset();
+
+		// Nothing was sampled as far as anyone reading the reduction can tell
+		m_FeedbackReduction = FeedbackReduction();
+		m_FeedbackReduction.FinestMip = m_MipLevels;
+
+		m_MipSelection = MipSelection();
+		m_MipSelection.FinestMip = estimate.FinestMip;
+		m_MipSelection.CoarsestMip = estimate.CoarsestMip;
+		m_MipSelection.ShadedTexels = uint64_t(std::max(m_Width >> estimate.FinestMip, 1u)) * std::max(m_Height >> estimate.FinestMip, 1u);
+
+		m_MipHysteresis.Update(estimate.FinestMip, estimate.CoarsestMip, hysteresis);
+
+		m_CachedMipLevels.FinestMip = m_MipHysteresis.GetFinestMip();
+		m_CachedMipLevels.CoarsestMip = m_MipHysteresis.GetCoarsestMip();
 
 		return m_CachedMipLevels;
 	}
@@ -328,6 +350,17 @@ namespace Roses {
 		return m_CachedMipLevels;
 	}
 
+	const uint8_t* VirtualTexture2D::GetResidencyFeedback() const
+	{
+		if (!m_UsesFeedback)
+			return nullptr;
+
+		if (!m_FeedbackAccumulator.Empty())
+			return m_FeedbackAccumulator.GetData();
+
+		return m_FeedbackMap != nullptr ? m_FeedbackMap->GetData() : nullptr;
+	}
+
 	glm::ivec3 VirtualTexture2D::GetTileDimensions(uint32_t subresource) const
 	{
 		HZ_CORE_ASSERT(subresource < m_Tilings.size(), "Subresource is out of bounds");
@@ -382,7 +415,7 @@ namespace Roses {
 
             ret->SetName(opts.Path);
 			ret->BypassAndSetState(D3D12_RESOURCE_STATE_COPY_DEST);
-			CommandContext::InitializeTexture(*ret, subData.size(), subData.data());
+			D3D12Renderer::UploadService->UploadTexture(*ret, subData.size(), subData.data());
 		}
 		else if (!opts.Name.empty())
 		{
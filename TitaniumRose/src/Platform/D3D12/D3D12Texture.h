@@ -1,6 +1,10 @@
 ﻿#pragma once
 
 #include "TitaniumRose/Core/Image.h"
+#include "TitaniumRose/Renderer/VirtualTexture/FeedbackReduction.h"
+#include "TitaniumRose/Renderer/VirtualTexture/MipEstimation.h"
+#include "TitaniumRose/Renderer/VirtualTexture/MipHysteresis.h"
+#include "TitaniumRose/Renderer/VirtualTexture/MipPolicy.h"
 //#include "TitaniumRose/Core/Math/Hash.h"
 
 #include "Platform/D3D12/D3D12FeedbackMap.h"
@@ -85,7 +89,8 @@ namespace Roses {
 
         static Ref<Texture2D>		    CreateVirtualTexture(struct TextureCreationOptions& opts);
         static Ref<Texture2D>		    CreateCommittedTexture(struct TextureCreationOptions& opts);
-        static D3D12FeedbackMap*        CreateFeedbackMap(Texture2D& texture);
+        // Feedback maps are compact, one byte per cell, unless asked for sizeof(uint32_t)
+        static D3D12FeedbackMap*        CreateFeedbackMap(Texture2D& texture, size_t elementSize = sizeof(uint8_t));
 
     protected:
 
@@ -119,8 +124,22 @@ namespace Roses {
         virtual bool IsVirtual() const override { return true; }
 
         virtual MipLevelsUsed ExtractMipsUsed() override;
+        // Picks the finest mip with the given policy instead of taking the finest one sampled,
+        // the hysteresis keeps the result from flipping between neighbouring mips
+        MipLevelsUsed ExtractMipsUsed(const MipPolicy& policy, const MipHysteresisSettings& hysteresis);
+        // Takes the mips from an analytic estimate instead of the feedback map, through the same hysteresis
+        MipLevelsUsed ApplyEstimatedMips(const MipEstimate& estimate, const MipHysteresisSettings& hysteresis);
         virtual MipLevelsUsed GetMipsUsed() override;
 
+        // The feedback the tile residency should be built from, accumulated over the last
+        // few updates when the hysteresis asks for it. Null if the mips were estimated.
+        const uint8_t* GetResidencyFeedback() const;
+
+        // The full result of the last ExtractMipsUsed, including how many cells asked for each mip
+        inline const FeedbackReduction& GetFeedbackReduction() const { return m_FeedbackReduction; }
+        inline const MipSelection& GetMipSelection() const { return m_MipSelection; }
+        inline const MipHysteresisStats& GetMipHysteresisStats() const { return m_MipHysteresis.GetStats(); }
+
         glm::ivec3 GetTileDimensions(uint32_t subresource = 0) const;
         uint64_t GetTileUsage();
 
@@ -130,6 +149,12 @@ namespace Roses {
         std::vector<D3D12_SUBRESOURCE_TILING>	    m_Tilings;
     private:
         MipLevelsUsed m_CachedMipLevels;
+        FeedbackReduction m_FeedbackReduction;
+        MipSelection m_MipSelection;
+        MipHysteresis m_MipHysteresis;
+        FeedbackAccumulator m_FeedbackAccumulator;
+        // False when the last mips came from ApplyEstimatedMips
+        bool m_UsesFeedback = true;
         friend class D3D12TilePool;
         friend class Texture2D;
     };
@@ -0,0 +1,215 @@
+#include "trpch.h"
+#include "Platform/D3D12/D3D12TileMappingBackend.h"
+#include "Platform/D3D12/D3D12Helpers.h"
+#include "Platform/D3D12/D3D12Renderer.h"
+#include "Platform/D3D12/D3D12Texture.h"
+#include "Platform/D3D12/CommandQueue.h"
+#include "Platform/D3D12/CommandContext.h"
+
+namespace Roses
+{
+    static inline VirtualTexture2D* ToTexture(VirtualTextureHandle texture)
+    {
+        return static_cast<VirtualTexture2D*>(texture);
+    }
+
+    void D3D12TileMappingBackend::CreatePage(uint16_t pageIndex, uint32_t numTiles)
+    {
+        uint64_t size = uint64_t(numTiles) * D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+        D3D12_HEAP_DESC heapDesc = CD3DX12_HEAP_DESC(size, D3D12_HEAP_TYPE_DEFAULT);
+        TComPtr<ID3D12Heap> heap = nullptr;
+
+        D3D12::ThrowIfFailed(D3D12Renderer::GetDevice()->CreateHeap(
+            &heapDesc,
+            IID_PPV_ARGS(&heap)
+        ));
+
+        if (m_Heaps.size() <= pageIndex)
+            m_Heaps.resize(pageIndex + 1);
+
+        HZ_CORE_ASSERT(m_Heaps[pageIndex] == nullptr, "Page index is already in use");
+        m_Heaps[pageIndex] = heap;
+    }
+
+    void D3D12TileMappingBackend::DestroyPage(uint16_t pageIndex)
+    {
+        HZ_CORE_ASSERT(pageIndex < m_Heaps.size(), "Page index is out of range");
+        m_Heaps[pageIndex] = nullptr;
+    }
+
+    uint32_t D3D12TileMappingBackend::UpdateMappings(VirtualTextureHandle texture, const std::vector<TileMappingRegion>& regions)
+    {
+        auto& commandQueue = D3D12Renderer::CommandQueueManager.GetGraphicsQueue();
+        uint32_t calls = 0;
+
+        // Every call can only reference a single heap, so submit one batch per page.
+        // Null regions come first and do not need a heap at all.
+        size_t begin = 0;
+        while (begin < regions.size())
+        {
+            size_t end = begin;
+            while (end < regions.size()
+                && regions[end].Null == regions[begin].Null
+                && (regions[end].Null || regions[end].Page == regions[begin].Page))
+            {
+                ++end;
+            }
+
+            m_StartCoordinates.clear();
+            m_RegionSizes.clear();
+            m_RangeFlags.clear();
+            m_HeapRangeStartOffsets.clear();
+            m_RangeTileCounts.clear();
+
+            for (size_t r = begin; r < end; r++)
+            {
+                auto& region = regions[r];
+                m_StartCoordinates.push_back(CD3DX12_TILED_RESOURCE_COORDINATE(region.X, region.Y, 0, region.Subresource));
+                if (region.Packed) {
+                    m_RegionSizes.push_back({ region.NumTiles(), FALSE, 0, 0, 0 });
+                }
+                else {
+                    m_RegionSizes.push_back({ region.NumTiles(), TRUE, region.Width, static_cast<UINT16>(region.Height), 1 });
+                }
+                m_RangeFlags.push_back(region.Null ? D3D12_TILE_RANGE_FLAG_NULL : D3D12_TILE_RANGE_FLAG_NONE);
+                m_HeapRangeStartOffsets.push_back(region.HeapOffset);
+                m_RangeTileCounts.push_back(region.NumTiles());
+            }
+
+            ID3D12Heap* heap = regions[begin].Null ? nullptr : m_Heaps[regions[begin].Page].Get();
+            uint32_t numRegions = static_cast<uint32_t>(end - begin);
+
+            commandQueue.GetRawPtr()->UpdateTileMappings(
+                ToTexture(texture)->GetResource(),
+                numRegions,
+                m_StartCoordinates.data(),
+                m_RegionSizes.data(),
+                heap,
+                numRegions,
+                m_RangeFlags.data(),
+                m_HeapRangeStartOffsets.data(),
+                m_RangeTileCounts.data(),
+                D3D12_TILE_MAPPING_FLAG_NONE
+            );
+
+            ++calls;
+            begin = end;
+        }
+
+        return calls;
+    }
+
+    void D3D12TileMappingBackend::UnmapAll(VirtualTextureHandle texture)
+    {
+        D3D12_TILE_RANGE_FLAGS rangeFlags = D3D12_TILE_RANGE_FLAG_NULL;
+        auto& commandQueue = D3D12Renderer::CommandQueueManager.GetGraphicsQueue();
+
+        commandQueue.GetRawPtr()->UpdateTileMappings(
+            ToTexture(texture)->GetResource(),
+            1,
+            nullptr,
+            nullptr,
+            nullptr,
+            1,
+            &rangeFlags,
+            nullptr,
+            nullptr,
+            D3D12_TILE_MAPPING_FLAG_NONE
+        );
+    }
+
+    void D3D12TileMappingBackend::CopyTilesOut(const std::vector<TileRelocation>& tiles)
+    {
+        ReleaseRetiredStaging();
+
+        const uint64_t stagingSize = tiles.size() * D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES;
+        if (m_StagingSize < stagingSize)
+        {
+            // Earlier compactions can still be copying through the old buffer
+            if (m_Staging != nullptr)
+                m_RetiredStaging.push_back({ m_StagingFence, std::move(m_Staging) });
+
+            D3D12::ThrowIfFailed(D3D12Renderer::GetDevice()->CreateCommittedResource(
+                &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+                D3D12_HEAP_FLAG_NONE,
+                &CD3DX12_RESOURCE_DESC::Buffer(stagingSize),
+                D3D12_RESOURCE_STATE_COPY_DEST,
+                nullptr,
+                IID_PPV_ARGS(&m_Staging)
+            ));
+            m_Staging->SetName(L"Tile Compaction Staging");
+            m_StagingSize = stagingSize;
+        }
+
+        D3D12_TILE_REGION_SIZE singleTile = { 1, FALSE, 0, 0, 0 };
+
+        GraphicsContext& copyOut = GraphicsContext::Begin("Tile Compaction Copy Out");
+        for (auto& tile : tiles)
+        {
+            copyOut.TransitionResource(*ToTexture(tile.Texture), D3D12_RESOURCE_STATE_COPY_SOURCE);
+        }
+        copyOut.FlushResourceBarriers();
+
+        for (size_t i = 0; i < tiles.size(); i++)
+        {
+            auto& tile = tiles[i];
+            copyOut.GetCommandList()->CopyTiles(
+                ToTexture(tile.Texture)->GetResource(),
+                &CD3DX12_TILED_RESOURCE_COORDINATE(tile.X, tile.Y, 0, tile.Subresource),
+                &singleTile,
+                m_Staging.Get(),
+                i * D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES,
+                D3D12_TILE_COPY_FLAG_SWIZZLED_TILED_RESOURCE_TO_LINEAR_BUFFER
+            );
+        }
+        // Queue operations execute in order, so the remap that follows lands between the two copies
+        copyOut.Finish();
+    }
+
+    void D3D12TileMappingBackend::CopyTilesIn(const std::vector<TileRelocation>& tiles)
+    {
+        D3D12_TILE_REGION_SIZE singleTile = { 1, FALSE, 0, 0, 0 };
+
+        GraphicsContext& copyIn = GraphicsContext::Begin("Tile Compaction Copy In");
+        copyIn.GetCommandList()->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_Staging.Get(),
+            D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_COPY_SOURCE));
+        for (auto& tile : tiles)
+        {
+            copyIn.TransitionResource(*ToTexture(tile.Texture), D3D12_RESOURCE_STATE_COPY_DEST);
+        }
+        copyIn.FlushResourceBarriers();
+
+        for (size_t i = 0; i < tiles.size(); i++)
+        {
+            auto& tile = tiles[i];
+            copyIn.GetCommandList()->CopyTiles(
+                ToTexture(tile.Texture)->GetResource(),
+                &CD3DX12_TILED_RESOURCE_COORDINATE(tile.X, tile.Y, 0, tile.Subresource),
+                &singleTile,
+                m_Staging.Get(),
+                i * D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES,
+                D3D12_TILE_COPY_FLAG_LINEAR_BUFFER_TO_SWIZZLED_TILED_RESOURCE
+            );
+        }
+
+        copyIn.GetCommandList()->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_Staging.Get(),
+            D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_COPY_DEST));
+        m_StagingFence = copyIn.Finish();
+    }
+
+    void D3D12TileMappingBackend::ReleaseRetiredStaging()
+    {
+        for (size_t i = 0; i < m_RetiredStaging.size();)
+        {
+            if (!D3D12Renderer::CommandQueueManager.IsFenceComplete(m_RetiredStaging[i].FenceValue))
+            {
+                i++;
+                continue;
+            }
+
+            if (i + 1 != m_RetiredStaging.size())
+                m_RetiredStaging[i] = std::move(m_RetiredStaging.back());
+            m_RetiredStaging.pop_back();
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "d3d12.h"
+#include "TitaniumRose/Renderer/VirtualTexture/TileMappingBackend.h"
+
+#include "Platform/D3D12/ComPtr.h"
+
+namespace Roses
+{
+	/// <summary>
+	/// Backs the pages of the tile pool with ID3D12Heaps and applies the mappings on the
+	/// graphics queue. Texture handles are VirtualTexture2D pointers.
+	/// </summary>
+	class D3D12TileMappingBackend : public TileMappingBackend
+	{
+	public:
+		virtual void CreatePage(uint16_t pageIndex, uint32_t numTiles) override;
+		virtual void DestroyPage(uint16_t pageIndex) override;
+
+		virtual uint32_t UpdateMappings(VirtualTextureHandle texture, const std::vector<TileMappingRegion>& regions) override;
+		virtual void UnmapAll(VirtualTextureHandle texture) override;
+
+		virtual void CopyTilesOut(const std::vector<TileRelocation>& tiles) override;
+		virtual void CopyTilesIn(const std::vector<TileRelocation>& tiles) override;
+
+	private:
+		void ReleaseRetiredStaging();
+
+	private:
+		struct RetiredStaging
+		{
+			uint64_t FenceValue;
+			TComPtr<ID3D12Resource> Resource;
+		};
+
+		std::vector<TComPtr<ID3D12Heap>> m_Heaps;
+
+		// Holds the contents of the tiles that are moved while they are remapped
+		TComPtr<ID3D12Resource> m_Staging;
+		uint64_t m_StagingSize = 0;
+		// The fence of the last copy in, the last list that used the staging buffer
+		uint64_t m_StagingFence = 0;
+		// Staging buffers that were outgrown while lists using them may still be in flight
+		std::vector<RetiredStaging> m_RetiredStaging;
+
+		std::vector<D3D12_TILED_RESOURCE_COORDINATE> m_StartCoordinates;
+		std::vector<D3D12_TILE_REGION_SIZE> m_RegionSizes;
+		std::vector<D3D12_TILE_RANGE_FLAGS> m_RangeFlags;
+		std::vector<uint32_t> m_HeapRangeStartOffsets;
+		std::vector<uint32_t> m_RangeTileCounts;
+	};
+}
@@ -1,79 +1,51 @@
 #pragma once
 
-#include <set>
-
 #include "d3d12.h"
-#include "Platform/D3D12/ComPtr.h"
-#include "Platform/D3D12/D3D12Texture.h"
-#include "Platform/D3D12/D3D12ResourceBatch.h"
-
-namespace std {
-    
-}
+#include "TitaniumRose/Renderer/VirtualTexture/TilePoolCore.h"
 
+#include "Platform/D3D12/D3D12Texture.h"
+#include "Platform/D3D12/D3D12TileMappingBackend.h"
 
 namespace Roses 
 {
-	union TileAddress
-	{
-		uint32_t Address;
-		struct {
-			uint16_t Page;
-			uint16_t Tile;
-		};
-
-		bool operator== (const TileAddress& other) const { return this->Address == other.Address; }
-	};
-	
-	static constexpr TileAddress InvalidTileAddress = { uint32_t(-1) };
-		
-
-	struct TilePoolStats
-	{
-		uint32_t MaxTiles;
-		uint32_t FreeTiles;
-
-	};
-
-	struct TilePage {
-
-		TilePage(uint32_t maxTiles, uint16_t pageIndex)
-			: FreeTiles2(nullptr), 
-			m_MaxTiles(maxTiles), 
-			PageIndex(pageIndex),
-			m_FreeTiles(maxTiles)
-		{
-			FreeTiles2 = new uint8_t[maxTiles];
-			memset(FreeTiles2, 0, maxTiles);
-		}
-
-		~TilePage()
-		{
-			delete[] FreeTiles2;
-		}
-
-		uint32_t AllocateTile();
-		inline uint32_t NumFreeTiles() const { return m_FreeTiles; }
-		inline uint32_t Size() const { return m_MaxTiles; }
-		void ReleaseTile(uint32_t tileNumber);
-
-		uint16_t PageIndex = 0;
-		//std::set<uint32_t> FreeTiles;
-		TComPtr<ID3D12Heap> Heap;
-	private:
-		uint8_t* FreeTiles2;
-		uint32_t m_MaxTiles;
-		uint32_t m_FreeTiles;
-	};
-
+	/// <summary>
+	/// The tile pool used by the renderer. The allocation and residency decisions are made by
+	/// TilePoolCore, this class feeds it the tiling of the D3D12 textures and owns the backend
+	/// that turns its decisions into heaps and tile mappings.
+	/// </summary>
 	class D3D12TilePool
 	{
 	public:
+		static constexpr uint32_t PageSize = 4096 * 2048 * 4;
+
+		D3D12TilePool();
+
 		void MapTexture(VirtualTexture2D& texture);
 		void ReleaseTexture(VirtualTexture2D& texture);
 		void RemoveTexture(VirtualTexture2D& texture);
         uint64_t GetTilesUsed(VirtualTexture2D& texture);
 
+		/// <summary>
+		/// Submits all the tile mapping updates queued by MapTexture since the last flush.
+		/// Should be called once per frame, after all the textures have been mapped and
+		/// before anything samples them.
+		/// </summary>
+		inline void FlushUpdates() { m_Core.FlushUpdates(); }
+
+		/// <summary>
+		/// Moves up to the compaction budget of tiles out of the sparsest pages into the
+		/// densest ones, so the emptied pages can be released. The tile contents are copied
+		/// through a staging buffer on the graphics queue. Should be called after FlushUpdates.
+		/// </summary>
+		inline void Compact() { m_Core.Compact(); }
+
+		/// <summary>
+		/// The maximum number of tiles Compact moves per call, 0 disables compaction
+		/// </summary>
+		inline void SetCompactionBudget(uint32_t tilesPerFrame) { m_Core.SetCompactionBudget(tilesPerFrame); }
+		inline uint32_t GetCompactionBudget() const { return m_Core.GetCompactionBudget(); }
+		inline const TileCompactionStats& GetLastCompactionStats() const { return m_Core.GetLastCompactionStats(); }
+
 
 		inline void MapTexture(Texture2D& texture) {
 			MapTexture(MakeVirtualTexture(texture));
@@ -91,86 +63,45 @@ namespace Roses
 			return GetTilesUsed(MakeVirtualTexture(texture));
 		}
 
-		std::vector<TilePoolStats> GetStats();
+		inline std::vector<TilePoolStats> GetStats() const { return m_Core.GetStats(); }
+		inline const TileMappingFlushStats& GetLastFlushStats() const { return m_Core.GetLastFlushStats(); }
 
-	private:
-        struct TileAllocation
-        {
-            bool Mapped = false;
-            D3D12_TILED_RESOURCE_COORDINATE ResourceCoordinate;
-            TileAddress TileAddress;
-        };
-
-        struct MipAllocationInfo
-        {
-            std::vector<TileAllocation> TileAllocations;
-        };
-
-        struct TextureAllocationInfo
-        {
-            std::vector<MipAllocationInfo> MipAllocations;
-            bool			PackedMipsMapped = false;
-            TileAddress		PackedMipsAddress;
-
-			~TextureAllocationInfo()
-			{
-			}
-        };
-
-        struct UpdateInfo
-        {
-            Ref<TilePage> Page = nullptr;
-
-            std::vector<D3D12_TILED_RESOURCE_COORDINATE> startCoordinates;
-            std::vector<D3D12_TILE_REGION_SIZE> regionSizes;
-            std::vector<D3D12_TILE_RANGE_FLAGS> rangeFlags;
-            std::vector<uint32_t> heapRangeStartOffsets;
-            std::vector<uint32_t> rangeTileCounts;
-            uint32_t tilesUpdated = 0;
-        };
-
-        struct CustomKeyHash {
-            std::size_t operator()(const Roses::Ref<Roses::VirtualTexture2D> k) const {
-                return std::hash<Roses::VirtualTexture2D*>()(k.get());
-            }
-        };
-		
-
-	private:
+		inline void SetResidencyMode(TileResidencyMode mode) { m_Core.SetResidencyMode(mode); }
+		inline TileResidencyMode GetResidencyMode() const { return m_Core.GetResidencyMode(); }
 
 		/// <summary>
-		/// Will search for a page that can fit the requested number of tiles. If
-		/// no page was found, it returns nullptr
+		/// How many tiles around every requested tile are kept resident when using
+		/// TileResidencyMode::FeedbackTiles, to hide the latency of the feedback.
 		/// </summary>
-		/// <param name="tiles">The number of tiles that are required out of the page</param>
-		/// <returns></returns>
-		Ref<TilePage> FindAvailablePage(uint32_t tiles);
+		inline void SetResidencyBorder(uint32_t border) { m_Core.SetResidencyBorder(border); }
+		inline uint32_t GetResidencyBorder() const { return m_Core.GetResidencyBorder(); }
 
 		/// <summary>
-		/// Will add a new page with the requested size.
+		/// Limits the memory used by the heaps of the pool. Once the budget is reached, tiles
+		/// of the least recently seen textures are evicted instead of adding a page, starting
+		/// with their finest mips. A budget of 0 lets the pool grow without limit.
 		/// </summary>
-		/// <param name="batch">The resource batch that will be used to create this page</param>
-		/// <param name="size">The size of the page in bytes</param>
-		/// <returns>A reference to the newly added page</returns>
-		Ref<TilePage> AddPage(uint32_t size);
+		inline void SetMemoryBudget(uint64_t bytes) { m_Core.SetTileBudget(bytes / D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES); }
+		inline uint64_t GetMemoryBudget() const { return m_Core.GetTileBudget() * D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES; }
+		inline uint64_t GetMemoryUsage() const { return m_Core.GetTileCapacity() * D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES; }
 
-        TextureAllocationInfo& GetTextureInfo(VirtualTexture2D& texture);
+		/// <summary>
+		/// How many frames a page has to stay empty before its heap is released. Should be
+		/// longer than the number of frames in flight.
+		/// </summary>
+		inline void SetPageReleaseDelay(uint32_t frames) { m_Core.SetPageReleaseDelay(frames); }
+		inline uint32_t GetPageReleaseDelay() const { return m_Core.GetPageReleaseDelay(); }
 
-		inline void ReleaseTile(TileAddress& address)
-		{
-			m_Pages[address.Page]->ReleaseTile(address.Tile);
-		}
-		
+	private:
 		inline VirtualTexture2D& MakeVirtualTexture(Texture2D& texture) 
 		{
 			HZ_CORE_ASSERT(texture.IsVirtual(), "How did we get here with a non-virtual texture");
 			return dynamic_cast<VirtualTexture2D&>(texture);
 		}
-	private:
-		uint32_t m_FrameCounter;
 
-		std::unordered_map<VirtualTexture2D*, TextureAllocationInfo> m_AllocationMap;
-		std::vector<Ref<TilePage>> m_Pages;
+	private:
+		// Declared before the core, which keeps a reference to it
+		D3D12TileMappingBackend m_Backend;
+		TilePoolCore m_Core;
 	};
 }
-
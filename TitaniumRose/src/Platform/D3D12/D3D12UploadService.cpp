@@ -0,0 +1,192 @@
+#include "trpch.h"
+#include "Platform/D3D12/D3D12UploadService.h"
+#include "Platform/D3D12/CommandQueue.h"
+#include "Platform/D3D12/CommandContext.h"
+#include "Platform/D3D12/D3D12Helpers.h"
+#include "Platform/D3D12/D3D12Renderer.h"
+#include "Platform/D3D12/d3dx12.h"
+
+namespace Roses
+{
+	// Buffers could do with less, a single alignment keeps the staging ranges interchangeable
+	static constexpr size_t StagingAlignment = D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT;
+
+	D3D12UploadService::D3D12UploadService(size_t stagingBudget)
+		: m_Batcher(stagingBudget, MaxBatchBytes, MaxBatchRequests),
+		m_StagingData(nullptr),
+		m_Allocator(nullptr),
+		m_LastFence(0),
+		m_GraphicsVisibleFence(0),
+		m_ComputeVisibleFence(0),
+		m_Stalls(0)
+	{
+		D3D12::ThrowIfFailed(D3D12Renderer::GetDevice()->CreateCommittedResource(
+			&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+			D3D12_HEAP_FLAG_NONE,
+			&CD3DX12_RESOURCE_DESC::Buffer(stagingBudget),
+			D3D12_RESOURCE_STATE_GENERIC_READ,
+			nullptr,
+			IID_PPV_ARGS(m_Staging.GetAddressOf())
+		));
+		m_Staging->SetName(L"Upload Service Staging");
+		D3D12::ThrowIfFailed(m_Staging->Map(0, nullptr, reinterpret_cast<void**>(&m_StagingData)));
+
+		D3D12Renderer::CommandQueueManager.CreateNewCommandList(D3D12_COMMAND_LIST_TYPE_COPY, m_CommandList.GetAddressOf(), &m_Allocator);
+		m_CommandList->SetName(L"Upload Service");
+	}
+
+	D3D12UploadService::~D3D12UploadService()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		Submit();
+		if (m_LastFence != 0)
+			D3D12Renderer::CommandQueueManager.WaitForFence(m_LastFence);
+
+		m_CommandList->Close();
+		m_Staging->Unmap(0, nullptr);
+	}
+
+	uint64_t D3D12UploadService::UploadTexture(GpuResource& destination, uint32_t numSubresources, D3D12_SUBRESOURCE_DATA subData[])
+	{
+		size_t size = GetRequiredIntermediateSize(destination.GetResource(), 0, numSubresources);
+		if (size > m_Batcher.GetStagingBudget()) {
+			CommandContext::InitializeTexture(destination, numSubresources, subData);
+			return 0;
+		}
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		UploadBatcher::Reservation reservation = Reserve(size, StagingAlignment);
+		UpdateSubresources(m_CommandList.Get(), destination.GetResource(), m_Staging.Get(), reservation.Offset, 0, numSubresources, subData);
+		// Resources used on the copy queue decay to COMMON once the batch completes
+		destination.BypassAndSetState(D3D12_RESOURCE_STATE_COMMON);
+		destination.m_UploadTicket = reservation.Ticket;
+
+		if (m_Batcher.IsBatchFull())
+			Submit();
+		return reservation.Ticket;
+	}
+
+	uint64_t D3D12UploadService::UploadBuffer(GpuResource& destination, const void* data, size_t sizeInBytes, size_t offset)
+	{
+		if (sizeInBytes > m_Batcher.GetStagingBudget()) {
+			CommandContext::InitializeBuffer(destination, data, sizeInBytes, offset);
+			return 0;
+		}
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		UploadBatcher::Reservation reservation = Reserve(sizeInBytes, StagingAlignment);
+		::memcpy(m_StagingData + reservation.Offset, data, sizeInBytes);
+		m_CommandList->CopyBufferRegion(destination.GetResource(), offset, m_Staging.Get(), reservation.Offset, sizeInBytes);
+		destination.BypassAndSetState(D3D12_RESOURCE_STATE_COMMON);
+		destination.m_UploadTicket = reservation.Ticket;
+
+		if (m_Batcher.IsBatchFull())
+			Submit();
+		return reservation.Ticket;
+	}
+
+	void D3D12UploadService::MakeVisibleTo(CommandQueue& queue)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		Submit();
+
+		uint64_t& visibleFence = &queue == &D3D12Renderer::CommandQueueManager.GetComputeQueue() ?
+			m_ComputeVisibleFence : m_GraphicsVisibleFence;
+		if (m_LastFence == visibleFence)
+			return;
+
+		queue.StallForFence(m_LastFence);
+		visibleFence = m_LastFence;
+	}
+
+	bool D3D12UploadService::IsComplete(uint64_t ticket)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		Retire();
+		return m_Batcher.IsComplete(ticket);
+	}
+
+	void D3D12UploadService::Wait(uint64_t ticket)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		if (!m_Batcher.IsSubmitted(ticket))
+			Submit();
+
+		uint64_t fenceValue;
+		if (m_Batcher.GetFence(ticket, fenceValue))
+			D3D12Renderer::CommandQueueManager.WaitForFence(fenceValue);
+		Retire();
+	}
+
+	UploadBatcherStats D3D12UploadService::GetStats()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_Batcher.GetStats();
+	}
+
+	size_t D3D12UploadService::GetStagedBytes()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		Retire();
+		return m_Batcher.GetStagedBytes();
+	}
+
+	size_t D3D12UploadService::GetPeakStagedBytes()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_Batcher.GetPeakStagedBytes();
+	}
+
+	uint64_t D3D12UploadService::GetStalls()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_Stalls;
+	}
+
+	UploadBatcher::Reservation D3D12UploadService::Reserve(size_t size, size_t alignment)
+	{
+		Retire();
+
+		UploadBatcher::Reservation reservation = m_Batcher.Reserve(size, alignment);
+		while (!reservation.IsValid()) {
+			uint64_t fenceValue;
+			if (m_Batcher.GetOldestFence(fenceValue)) {
+				++m_Stalls;
+				D3D12Renderer::CommandQueueManager.WaitForFence(fenceValue);
+			}
+			else {
+				// The staging the request needs belongs to the open batch
+				Submit();
+			}
+
+			Retire();
+			reservation = m_Batcher.Reserve(size, alignment);
+		}
+		return reservation;
+	}
+
+	void D3D12UploadService::Submit()
+	{
+		if (!m_Batcher.HasOpenBatch())
+			return;
+
+		CommandQueue& queue = D3D12Renderer::CommandQueueManager.GetCopyQueue();
+		m_LastFence = queue.ExecuteCommandList(m_CommandList.Get());
+		m_Batcher.CloseBatch(m_LastFence);
+
+		queue.DiscardAllocator(m_LastFence, m_Allocator);
+		m_Allocator = queue.RequestAllocator();
+		m_CommandList->Reset(m_Allocator, nullptr);
+	}
+
+	void D3D12UploadService::Retire()
+	{
+		m_Batcher.Retire([](uint64_t fenceValue) { return D3D12Renderer::CommandQueueManager.IsFenceComplete(fenceValue); });
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <mutex>
+
+#include "TitaniumRose/Core/UploadBatcher.h"
+
+#include "Platform/D3D12/ComPtr.h"
+#include "Platform/D3D12/GpuResource.h"
+
+namespace Roses
+{
+	class CommandQueue;
+
+	/// <summary>
+	/// Uploads the initial data of textures and buffers on the copy queue. Requests are staged
+	/// right away and recorded into a batch that is submitted when it is full, or when graphics
+	/// or compute work is submitted. That work waits for the batch on the GPU, so the CPU only
+	/// waits when the staging budget runs out. The returned ticket tells when an upload landed.
+	/// Can be used from any thread.
+	/// </summary>
+	class D3D12UploadService
+	{
+	public:
+		static constexpr size_t DefaultStagingBudget = 64 * 1024 * 1024;
+		static constexpr size_t MaxBatchBytes = 16 * 1024 * 1024;
+		static constexpr uint32_t MaxBatchRequests = 128;
+
+		D3D12UploadService(size_t stagingBudget);
+		~D3D12UploadService();
+
+		/// <summary>
+		/// Copies the subresources into destination, which has to be in the COPY_DEST or
+		/// COMMON state. It is left in the COMMON state, reads promote it from there. The
+		/// ticket is also kept by the resource, see GpuResource::GetUploadTicket.
+		/// </summary>
+		/// <returns>The ticket of the upload, 0 if it was done right away</returns>
+		uint64_t UploadTexture(GpuResource& destination, uint32_t numSubresources, D3D12_SUBRESOURCE_DATA subData[]);
+
+		/// <summary>
+		/// Copies data into destination at offset, with the same states as UploadTexture.
+		/// </summary>
+		/// <returns>The ticket of the upload, 0 if it was done right away</returns>
+		uint64_t UploadBuffer(GpuResource& destination, const void* data, size_t sizeInBytes, size_t offset = 0);
+
+		/// <summary>
+		/// Submits the open batch and makes the queue wait for every batch submitted so far.
+		/// Called before graphics and compute command lists are executed.
+		/// </summary>
+		void MakeVisibleTo(CommandQueue& queue);
+
+		bool IsComplete(uint64_t ticket);
+		// Blocks until the upload landed, for the few callers that read the data back on the CPU
+		void Wait(uint64_t ticket);
+
+		UploadBatcherStats GetStats();
+		size_t GetStagedBytes();
+		size_t GetPeakStagedBytes();
+		inline size_t GetStagingBudget() const { return m_Batcher.GetStagingBudget(); }
+		uint64_t GetStalls();
+
+	private:
+		// These expect m_Mutex to be held
+		UploadBatcher::Reservation Reserve(size_t size, size_t alignment);
+		void Submit();
+		void Retire();
+
+		std::mutex m_Mutex;
+		UploadBatcher m_Batcher;
+
+		TComPtr<ID3D12Resource> m_Staging;
+		uint8_t* m_StagingData;
+
+		TComPtr<ID3D12GraphicsCommandList> m_CommandList;
+		ID3D12CommandAllocator* m_Allocator;
+
+		// The fence of the last batch submitted, and the last one each queue was told to wait for
+		uint64_t m_LastFence;
+		uint64_t m_GraphicsVisibleFence;
+		uint64_t m_ComputeVisibleFence;
+		uint64_t m_Stalls;
+	};
+}
@@ -6,15 +6,24 @@
 
 #include "winpixeventruntime/pix3.h"
 
+#include <optional>
+
 namespace Roses
 {
     DECLARE_SHADER_NAMED("SurfaceShader-Decoupled", Decoupled);
+    DECLARE_SHADER_NAMED("SurfaceShader-DecoupledBindless", DecoupledBindless);
     DECLARE_SHADER_NAMED("SurfaceShader-Simple", Simple);
     DECLARE_SHADER(Dilate);
 
     // 
     void DecoupledRenderer::ImplRenderVirtualTextures(GraphicsContext& gfxContext)
     {
+        if (s_BindlessMaterials)
+        {
+            RenderVirtualTexturesBindless(gfxContext);
+            return;
+        }
+
         auto shader = GetShader();
         auto envRad = s_CommonData.Scene->Environment.EnvironmentMap;
         auto envIrr = s_CommonData.Scene->Environment.IrradianceMap;
@@ -27,136 +36,292 @@ namespace Roses
 
         //ScopedTimer passTimer("Virtual Render", commandList);
 
-        gfxContext.GetCommandList()->SetPipelineState(shader->GetPipelineState());
-        gfxContext.GetCommandList()->SetGraphicsRootSignature(shader->GetRootSignature());
-        gfxContext.GetCommandList()->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-        
-        gfxContext.SetDynamicContantBufferView(ShaderIndices_Pass, sizeof(HPassData), &passData);
-        gfxContext.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_Lights, s_LightsBufferAllocation.GPUHandle);
-        gfxContext.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_EnvRadiance, envRad->SRVAllocation.GPUHandle);
-        gfxContext.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_EnvIrradiance, envIrr->SRVAllocation.GPUHandle);
-        gfxContext.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_BRDFLUT, lut->SRVAllocation.GPUHandle);
-
-
-        for (uint32_t i = 0; i < s_DecoupledOpaqueObjects.size(); i++)
+        // The targets come from a pool that is not thread safe, they are taken up front
+        std::vector<Texture2D*> targets(s_DecoupledOpaqueObjects.size(), nullptr);
+        for (size_t i = 0; i < s_DecoupledOpaqueObjects.size(); i++)
         {
-            auto obj = s_DecoupledOpaqueObjects[i];
+            auto& obj = s_DecoupledOpaqueObjects[i];
             s_SimpleOpaqueObjects.push_back(obj);
 
-            if (obj == nullptr) {
+            if (obj == nullptr || obj->Mesh == nullptr) {
                 continue;
             }
 
-            if (obj->Mesh == nullptr) {
+            targets[i] = RequestTemporaryRenderTarget(gfxContext, obj->DecoupledComponent.VirtualTexture);
+        }
+        UpdateTransforms(s_DecoupledOpaqueObjects);
+
+        D3D12_GPU_VIRTUAL_ADDRESS passAddress = 0;
+        auto preparePass = [&](GraphicsContext& context) {
+            passAddress = context.UploadDynamicData(&passData, sizeof(HPassData));
+        };
+
+        auto beginPass = [&](GraphicsContext& context) {
+            context.GetCommandList()->SetPipelineState(shader->GetPipelineState());
+            context.GetCommandList()->SetGraphicsRootSignature(shader->GetRootSignature());
+            context.GetCommandList()->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+            
+            context.GetCommandList()->SetGraphicsRootConstantBufferView(ShaderIndices_Pass, passAddress);
+            context.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_Lights, GetLightsBufferAllocation().GPUHandle);
+            context.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_EnvRadiance, envRad->SRVAllocation.GPUHandle);
+            context.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_EnvIrradiance, envIrr->SRVAllocation.GPUHandle);
+            context.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_BRDFLUT, lut->SRVAllocation.GPUHandle);
+        };
+
+        auto recordDraws = [&](GraphicsContext& context, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                auto& obj = s_DecoupledOpaqueObjects[i];
+
+                if (targets[i] == nullptr) {
+                    continue;
+                }
+                auto virtualTexture = obj->DecoupledComponent.VirtualTexture;
+
+                std::vector<uint32_t> lights;
+
+                for (uint32_t l = 0; l < s_CommonData.Scene->Lights.size(); l++)
+                {
+#if 0
+                    lights.push_back(i);
+#else
+                    auto light = s_CommonData.Scene->Lights[l];
+                    
+                    auto v = light->gameObject->Transform.Position() - obj->Transform.Position();
+
+                    auto d = glm::length(v);
+
+                    if (d <= light->Range * 2) {
+                        lights.push_back(l);
+                    }
+#endif           
+                }
+
+                if (!lights.empty())
+                {
+                    D3D12UploadBuffer<uint32_t>* objectLightsList = new D3D12UploadBuffer<uint32_t>(
+                        lights.size(),
+                        false
+                        );
+                    objectLightsList->CopyDataBlock(lights.size(), lights.data());
+                    objectLightsList->SRVAllocation = s_ResourceDescriptorHeap->AllocateTransient(1);
+                    CreateBufferSRV(*objectLightsList, lights.size(), sizeof(uint32_t));
+                    context.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_ObjectLightsList, objectLightsList->SRVAllocation.GPUHandle);
+                    context.TrackResource(objectLightsList);
+                    context.TrackAllocation(objectLightsList->SRVAllocation);
+                }
+
+                // The profiler is not thread safe
+                std::optional<ScopedTimer> timer;
+                if (&context == &gfxContext)
+                    timer.emplace(obj->Name, context);
+
+                auto mips = virtualTexture->GetMipsUsed();
+                SetTemporaryRenderTarget(context, *targets[i]);
+
+                HPerObjectData objectData;
+                objectData.LocalToWorld = obj->Transform.LocalToWorldMatrix();
+                objectData.WorldToLocal = glm::transpose(obj->Transform.WorldToLocalMatrix());
+                objectData.MaterialColor = obj->Material->Color;
+                objectData.HasAlbedo = obj->Material->HasAlbedoTexture;
+                objectData.EmissiveColor = obj->Material->EmissiveColor;
+                objectData.HasNormal = obj->Material->HasNormalTexture;
+                objectData.HasMetallic = obj->Material->HasMetallicTexture;
+                objectData.Metallic = obj->Material->Metallic;
+                objectData.HasRoughness = obj->Material->HasRoughnessTexture;
+                objectData.Roughness = obj->Material->Roughness;
+                objectData.FinestMip = mips.FinestMip;
+                objectData.NumObjectLights = lights.size();
+                
+
+                auto vb = obj->Mesh->vertexBuffer->GetView();
+                vb.StrideInBytes = sizeof(Vertex);
+                auto ib = obj->Mesh->indexBuffer->GetView();
+
+                context.GetCommandList()->IASetVertexBuffers(0, 1, &vb);
+                context.GetCommandList()->IASetIndexBuffer(&ib);
+                if (obj->Material->HasAlbedoTexture) {
+                    context.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_Albedo, obj->Material->AlbedoTexture->SRVAllocation.GPUHandle);
+                }
+
+                if (obj->Material->HasNormalTexture) {
+                    context.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_Normal, obj->Material->NormalTexture->SRVAllocation.GPUHandle);
+                }
+
+                if (obj->Material->HasRoughnessTexture) {
+                    context.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_Roughness, obj->Material->RoughnessTexture->SRVAllocation.GPUHandle);
+                }
+
+                if (obj->Material->HasMetallicTexture) {
+                    context.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_Metalness, obj->Material->MetallicTexture->SRVAllocation.GPUHandle);
+                }
+
+                context.SetDynamicContantBufferView(ShaderIndices_PerObject, sizeof(objectData), &objectData);
+                context.GetCommandList()->DrawIndexedInstanced(obj->Mesh->indexBuffer->GetCount(), 1, 0, 0, 0);
+            }
+        };
+
+        RecordDraws(gfxContext, s_DecoupledOpaqueObjects.size(), preparePass, beginPass, recordDraws);
+    }
+
+    void DecoupledRenderer::RenderVirtualTexturesBindless(GraphicsContext& gfxContext)
+    {
+        auto shader = g_ShaderLibrary->GetAs<D3D12Shader>(ShaderNameDecoupledBindless);
+
+        HPassData passData;
+        passData.ViewProjection = s_CommonData.Scene->Camera->GetViewProjectionMatrix();
+        passData.NumLights = s_CommonData.NumLights;
+        passData.EyePosition = s_CommonData.Scene->Camera->GetPosition();
+
+        // Every object of the pass and its lights go into one buffer each, bound once
+        std::vector<HGameObject*> drawn;
+        std::vector<BindlessObjectData> objects;
+        std::vector<BindlessDrawConstants> draws;
+        std::vector<uint32_t> objectLights;
+        drawn.reserve(s_DecoupledOpaqueObjects.size());
+        objects.reserve(s_DecoupledOpaqueObjects.size());
+        draws.reserve(s_DecoupledOpaqueObjects.size());
+
+        for (auto& obj : s_DecoupledOpaqueObjects)
+        {
+            s_SimpleOpaqueObjects.push_back(obj);
+
+            if (obj == nullptr || obj->Mesh == nullptr) {
                 continue;
             }
-            auto virtualTexture = obj->DecoupledComponent.VirtualTexture;
 
-            std::vector<uint32_t> lights;
+            BindlessObjectData objectData = {};
+            objectData.LocalToWorld = obj->Transform.LocalToWorldMatrix();
+            objectData.FinestMip = obj->DecoupledComponent.VirtualTexture->GetMipsUsed().FinestMip;
+            objectData.LightOffset = static_cast<uint32_t>(objectLights.size());
 
             for (uint32_t l = 0; l < s_CommonData.Scene->Lights.size(); l++)
             {
-#if 0
-                lights.push_back(i);
-#else
                 auto light = s_CommonData.Scene->Lights[l];
-                
+
                 auto v = light->gameObject->Transform.Position() - obj->Transform.Position();
 
                 auto d = glm::length(v);
 
                 if (d <= light->Range * 2) {
-                    lights.push_back(l);
+                    objectLights.push_back(l);
                 }
-#endif           
             }
+            objectData.LightCount = static_cast<uint32_t>(objectLights.size()) - objectData.LightOffset;
+
+            BindlessDrawConstants drawConstants;
+            drawConstants.MaterialIndex = GetMaterialIndex(*obj->Material);
+            drawConstants.ObjectIndex = static_cast<uint32_t>(objects.size());
+
+            drawn.push_back(obj.get());
+            objects.push_back(objectData);
+            draws.push_back(drawConstants);
+        }
+
+        if (drawn.empty()) {
+            return;
+        }
+
+        // Root SRVs can not be empty
+        if (objectLights.empty()) {
+            objectLights.push_back(0);
+        }
+
+        FlushMaterialTable(gfxContext);
+
+        std::vector<Texture2D*> targets(drawn.size());
+        for (size_t i = 0; i < drawn.size(); i++)
+        {
+            targets[i] = RequestTemporaryRenderTarget(gfxContext, drawn[i]->DecoupledComponent.VirtualTexture);
+        }
 
-            if (!lights.empty())
+        D3D12_GPU_VIRTUAL_ADDRESS passAddress = 0;
+        D3D12_GPU_VIRTUAL_ADDRESS objectsAddress = 0;
+        D3D12_GPU_VIRTUAL_ADDRESS objectLightsAddress = 0;
+        auto preparePass = [&](GraphicsContext& context) {
+            passAddress = context.UploadDynamicData(&passData, sizeof(HPassData));
+            objectsAddress = context.UploadDynamicData(objects.data(), objects.size() * sizeof(BindlessObjectData));
+            objectLightsAddress = context.UploadDynamicData(objectLights.data(), objectLights.size() * sizeof(uint32_t));
+        };
+
+        auto beginPass = [&](GraphicsContext& context) {
+            context.GetCommandList()->SetPipelineState(shader->GetPipelineState());
+            context.GetCommandList()->SetGraphicsRootSignature(shader->GetRootSignature());
+            context.GetCommandList()->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+            SetBindlessPassResources(context);
+            context.GetCommandList()->SetGraphicsRootConstantBufferView(BindlessRootParameters_Pass, passAddress);
+            context.GetCommandList()->SetGraphicsRootShaderResourceView(BindlessRootParameters_Objects, objectsAddress);
+            context.GetCommandList()->SetGraphicsRootShaderResourceView(BindlessRootParameters_ObjectLights, objectLightsAddress);
+        };
+
+        auto recordDraws = [&](GraphicsContext& context, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
             {
-                D3D12UploadBuffer<uint32_t>* objectLightsList = new D3D12UploadBuffer<uint32_t>(
-                    lights.size(),
-                    false
-                    );
-                objectLightsList->CopyDataBlock(lights.size(), lights.data());
-                CreateBufferSRV(*objectLightsList, lights.size(), sizeof(uint32_t));
-                gfxContext.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_ObjectLightsList, objectLightsList->SRVAllocation.GPUHandle);
-                gfxContext.TrackResource(objectLightsList);
-                gfxContext.TrackAllocation(objectLightsList->SRVAllocation);
-            }
+                auto obj = drawn[i];
 
-            ScopedTimer timer(obj->Name, gfxContext);
+                // The profiler is not thread safe
+                std::optional<ScopedTimer> timer;
+                if (&context == &gfxContext)
+                    timer.emplace(obj->Name, context);
 
-            auto mips = virtualTexture->GetMipsUsed();
+                SetTemporaryRenderTarget(context, *targets[i]);
 
-            auto targetWidth = virtualTexture->GetWidth() >> mips.FinestMip;
-            auto targetHeight = virtualTexture->GetHeight() >> mips.FinestMip;
-            auto targetFormat = virtualTexture->GetFormat();
+                auto vb = obj->Mesh->vertexBuffer->GetView();
+                vb.StrideInBytes = sizeof(Vertex);
+                auto ib = obj->Mesh->indexBuffer->GetView();
 
-            Texture2D* temporaryRenderTarget = TextureManager::RequestTemporaryRenderTarget(targetWidth, targetHeight, targetFormat, gfxContext.GetCompletedFenceValue());
-            temporaryRenderTarget->SetName(virtualTexture->GetIdentifier() + ".temp");
-            
-            gfxContext.TransitionResource(*temporaryRenderTarget, D3D12_RESOURCE_STATE_RENDER_TARGET, true);
+                context.GetCommandList()->IASetVertexBuffers(0, 1, &vb);
+                context.GetCommandList()->IASetIndexBuffer(&ib);
+                context.GetCommandList()->SetGraphicsRoot32BitConstants(BindlessRootParameters_DrawConstants, 2, &draws[i], 0);
 
-            //TilePool->MapTexture(*temporaryRenderTarget);
+                context.GetCommandList()->DrawIndexedInstanced(obj->Mesh->indexBuffer->GetCount(), 1, 0, 0, 0);
+            }
+        };
 
-            DilateTextureInfo dilateTextureInfo = {};
-            dilateTextureInfo.Target = virtualTexture;
-            dilateTextureInfo.Temporary = temporaryRenderTarget;
+        RecordDraws(gfxContext, drawn.size(), preparePass, beginPass, recordDraws);
+    }
 
-            CreateRTV(*temporaryRenderTarget, 0);
-            gfxContext.TrackAllocation(temporaryRenderTarget->RTVAllocation, D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+    Texture2D* DecoupledRenderer::RequestTemporaryRenderTarget(GraphicsContext& gfxContext, Ref<VirtualTexture2D>& virtualTexture)
+    {
+        auto mips = virtualTexture->GetMipsUsed();
 
-            m_DilationQueue.emplace_back(dilateTextureInfo);
+        auto targetWidth = virtualTexture->GetWidth() >> mips.FinestMip;
+        auto targetHeight = virtualTexture->GetHeight() >> mips.FinestMip;
+        auto targetFormat = virtualTexture->GetFormat();
 
-            D3D12_VIEWPORT vp = { 0, 0, targetWidth, targetHeight, 0, 1 };
-            D3D12_RECT rect = { 0, 0, targetWidth, targetHeight };
+        Texture2D* temporaryRenderTarget = TextureManager::RequestTemporaryRenderTarget(targetWidth, targetHeight, targetFormat, gfxContext.GetCompletedFenceValue());
+        temporaryRenderTarget->SetName(virtualTexture->GetIdentifier() + ".temp");
+        
+        gfxContext.TransitionResource(*temporaryRenderTarget, D3D12_RESOURCE_STATE_RENDER_TARGET, true);
 
-            gfxContext.GetCommandList()->RSSetViewports(1, &vp);
-            gfxContext.GetCommandList()->RSSetScissorRects(1, &rect);
-            gfxContext.GetCommandList()->OMSetRenderTargets(1, &temporaryRenderTarget->RTVAllocation.CPUHandle, true, nullptr);
-            static const float clearColor[] = { 0.0f, 0.0f, 0.0f, 0.0f };
-            gfxContext.GetCommandList()->ClearRenderTargetView(temporaryRenderTarget->RTVAllocation.CPUHandle, clearColor, 0, nullptr);
+        //TilePool->MapTexture(*temporaryRenderTarget);
 
-            HPerObjectData objectData;
-            objectData.LocalToWorld = obj->Transform.LocalToWorldMatrix();
-            objectData.WorldToLocal = glm::transpose(obj->Transform.WorldToLocalMatrix());
-            objectData.MaterialColor = obj->Material->Color;
-            objectData.HasAlbedo = obj->Material->HasAlbedoTexture;
-            objectData.EmissiveColor = obj->Material->EmissiveColor;
-            objectData.HasNormal = obj->Material->HasNormalTexture;
-            objectData.HasMetallic = obj->Material->HasMetallicTexture;
-            objectData.Metallic = obj->Material->Metallic;
-            objectData.HasRoughness = obj->Material->HasRoughnessTexture;
-            objectData.Roughness = obj->Material->Roughness;
-            objectData.FinestMip = mips.FinestMip;
-            objectData.NumObjectLights = lights.size();
-            
+        DilateTextureInfo dilateTextureInfo = {};
+        dilateTextureInfo.Target = virtualTexture;
+        dilateTextureInfo.Temporary = temporaryRenderTarget;
 
-            auto vb = obj->Mesh->vertexBuffer->GetView();
-            vb.StrideInBytes = sizeof(Vertex);
-            auto ib = obj->Mesh->indexBuffer->GetView();
+        // The temporary targets are pooled, their views come back from the cache
+        temporaryRenderTarget->RTVAllocation = GetCachedRTV(*temporaryRenderTarget, 0);
 
-            gfxContext.GetCommandList()->IASetVertexBuffers(0, 1, &vb);
-            gfxContext.GetCommandList()->IASetIndexBuffer(&ib);
-            if (obj->Material->HasAlbedoTexture) {
-                gfxContext.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_Albedo, obj->Material->AlbedoTexture->SRVAllocation.GPUHandle);
-            }
+        m_DilationQueue.emplace_back(dilateTextureInfo);
 
-            if (obj->Material->HasNormalTexture) {
-                gfxContext.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_Normal, obj->Material->NormalTexture->SRVAllocation.GPUHandle);
-            }
+        return temporaryRenderTarget;
+    }
 
-            if (obj->Material->HasRoughnessTexture) {
-                gfxContext.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_Roughness, obj->Material->RoughnessTexture->SRVAllocation.GPUHandle);
-            }
+    void DecoupledRenderer::SetTemporaryRenderTarget(GraphicsContext& context, Texture2D& target)
+    {
+        auto targetWidth = target.GetWidth();
+        auto targetHeight = target.GetHeight();
 
-            if (obj->Material->HasMetallicTexture) {
-                gfxContext.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndices_Metalness, obj->Material->MetallicTexture->SRVAllocation.GPUHandle);
-            }
+        D3D12_VIEWPORT vp = { 0, 0, targetWidth, targetHeight, 0, 1 };
+        D3D12_RECT rect = { 0, 0, targetWidth, targetHeight };
 
-            gfxContext.SetDynamicContantBufferView(ShaderIndices_PerObject, sizeof(objectData), &objectData);
-            gfxContext.GetCommandList()->DrawIndexedInstanced(obj->Mesh->indexBuffer->GetCount(), 1, 0, 0, 0);
-        }
+        context.GetCommandList()->RSSetViewports(1, &vp);
+        context.GetCommandList()->RSSetScissorRects(1, &rect);
+        context.GetCommandList()->OMSetRenderTargets(1, &target.RTVAllocation.CPUHandle, true, nullptr);
+        static const float clearColor[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        context.GetCommandList()->ClearRenderTargetView(target.RTVAllocation.CPUHandle, clearColor, 0, nullptr);
     }
 
     void DecoupledRenderer::ImplDilateVirtualTextures(GraphicsContext& gfxContext)
@@ -179,11 +344,9 @@ namespace Roses
             gfxContext.TransitionResource(*info.Temporary, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
             gfxContext.TransitionResource(*info.Target, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
 
-            CreateSRV(*(info.Temporary));
-            gfxContext.TrackAllocation(info.Temporary->SRVAllocation);
-
-            CreateUAV(info.Target, mips.FinestMip);
-            gfxContext.TrackAllocation(info.Target->UAVAllocation);
+            info.Temporary->SRVAllocation = GetCachedSRV(*(info.Temporary));
+            s_ResourceDescriptorHeap->Release(info.Target->UAVAllocation);
+            info.Target->UAVAllocation = GetCachedUAV(*info.Target, mips.FinestMip);
 
             glm::vec4 dims = { width, height, 1.0f / width, 1.0f / height };
             gfxContext.GetCommandList()->SetComputeRoot32BitConstants(0, sizeof(dims) / sizeof(float), &dims[0], 0);
@@ -218,59 +381,86 @@ namespace Roses
 
         ScopedTimer timer("Simple Pass", gfxContext);
 
-        gfxContext.GetCommandList()->SetPipelineState(shader->GetPipelineState());
-        gfxContext.GetCommandList()->SetGraphicsRootSignature(shader->GetRootSignature());
-        gfxContext.GetCommandList()->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-        gfxContext.GetCommandList()->RSSetViewports(1, &Context->Viewport);
-        gfxContext.GetCommandList()->RSSetScissorRects(1, &Context->ScissorRect);
-        gfxContext.GetCommandList()->OMSetRenderTargets(1, &framebuffer->RTVAllocation.CPUHandle, true, &framebuffer->DSVAllocation.CPUHandle);
-        gfxContext.SetDynamicContantBufferView(ShaderIndicesSimple_Pass, sizeof(passData), &passData);
-
-        for (size_t i = 0; i < s_SimpleOpaqueObjects.size(); i++)
+        // Transitions and the descriptor cache are not thread safe, the textures are readied up front
+        for (auto& go : s_SimpleOpaqueObjects)
         {
-            auto go = s_SimpleOpaqueObjects[i];
-
-            if (go == nullptr) {
+            if (go == nullptr || go->Mesh == nullptr) {
                 continue;
             }
 
-            if (go->Mesh == nullptr) {
-                continue;
-            }
-
-            ScopedTimer timer(go->Name, gfxContext);
-
             auto tex = go->DecoupledComponent.VirtualTexture;
 
+            gfxContext.TransitionResource(*tex, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+            if (tex->SRVAllocation.Allocated)
+                s_ResourceDescriptorHeap->Release(tex->SRVAllocation);
+            tex->SRVAllocation = GetCachedSRV(*tex, 0);
+        }
+        gfxContext.FlushResourceBarriers();
+        UpdateTransforms(s_SimpleOpaqueObjects);
+
+        D3D12_GPU_VIRTUAL_ADDRESS passAddress = 0;
+        auto preparePass = [&](GraphicsContext& context) {
+            passAddress = context.UploadDynamicData(&passData, sizeof(passData));
+        };
+
+        auto beginPass = [&](GraphicsContext& context) {
+            context.GetCommandList()->SetPipelineState(shader->GetPipelineState());
+            context.GetCommandList()->SetGraphicsRootSignature(shader->GetRootSignature());
+            context.GetCommandList()->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+            context.GetCommandList()->RSSetViewports(1, &Context->Viewport);
+            context.GetCommandList()->RSSetScissorRects(1, &Context->ScissorRect);
+            context.GetCommandList()->OMSetRenderTargets(1, &framebuffer->RTVAllocation.CPUHandle, true, &framebuffer->DSVAllocation.CPUHandle);
+            context.GetCommandList()->SetGraphicsRootConstantBufferView(ShaderIndicesSimple_Pass, passAddress);
+        };
+
+        auto recordDraws = [&](GraphicsContext& context, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                auto& go = s_SimpleOpaqueObjects[i];
 
-            //ScopedTimer timer(tex->GetIdentifier(), commandList);
+                if (go == nullptr) {
+                    continue;
+                }
 
-            gfxContext.TransitionResource(*tex, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, true);
+                if (go->Mesh == nullptr) {
+                    continue;
+                }
 
-            auto fm = tex->GetFeedbackMap();
+                // The profiler is not thread safe
+                std::optional<ScopedTimer> objectTimer;
+                if (&context == &gfxContext)
+                    objectTimer.emplace(go->Name, context);
 
-            CreateSRV(*tex, 0);
+                auto tex = go->DecoupledComponent.VirtualTexture;
+                auto fm = tex->GetFeedbackMap();
 
+                HPerObjectDataSimple objectData;
+                objectData.LocalToWorld = go->Transform.LocalToWorldMatrix();
+                objectData.FeedbackDims = fm->GetDimensions();
+                if (go->DecoupledComponent.AnalyticMips)
+                    objectData.FeedbackMode = FeedbackModeSimple_None;
+                else
+                    objectData.FeedbackMode = fm->IsCompact() ? FeedbackModeSimple_Compact : FeedbackModeSimple_Full;
+                objectData.Mips = glm::ivec2(tex->GetMipsUsed().CoarsestMip, tex->GetMipsUsed().FinestMip);
+                //objectData.EntityID = go->ID;
 
-            HPerObjectDataSimple objectData;
-            objectData.LocalToWorld = go->Transform.LocalToWorldMatrix();
-            objectData.FeedbackDims = fm->GetDimensions();
-            objectData.Mips = glm::ivec2(tex->GetMipsUsed().CoarsestMip, tex->GetMipsUsed().FinestMip);
-            //objectData.EntityID = go->ID;
+                auto vb = go->Mesh->vertexBuffer->GetView();
+                vb.StrideInBytes = sizeof(Vertex);
+                auto ib = go->Mesh->indexBuffer->GetView();
 
-            auto vb = go->Mesh->vertexBuffer->GetView();
-            vb.StrideInBytes = sizeof(Vertex);
-            auto ib = go->Mesh->indexBuffer->GetView();
+                context.GetCommandList()->IASetVertexBuffers(0, 1, &vb);
+                context.GetCommandList()->IASetIndexBuffer(&ib);
 
-            gfxContext.GetCommandList()->IASetVertexBuffers(0, 1, &vb);
-            gfxContext.GetCommandList()->IASetIndexBuffer(&ib);
+                context.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndicesSimple_Color, tex->SRVAllocation.GPUHandle);
+                context.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndicesSimple_FeedbackMap, fm->UAVAllocation.GPUHandle);
+                context.SetDynamicContantBufferView(ShaderIndicesSimple_PerObject, sizeof(objectData), &objectData);
 
-            gfxContext.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndicesSimple_Color, tex->SRVAllocation.GPUHandle);
-            gfxContext.GetCommandList()->SetGraphicsRootDescriptorTable(ShaderIndicesSimple_FeedbackMap, fm->UAVAllocation.GPUHandle);
-            gfxContext.SetDynamicContantBufferView(ShaderIndicesSimple_PerObject, sizeof(objectData), &objectData);
+                context.GetCommandList()->DrawIndexedInstanced(go->Mesh->indexBuffer->GetCount(), 1, 0, 0, 0);
+            }
+        };
 
-            gfxContext.GetCommandList()->DrawIndexedInstanced(go->Mesh->indexBuffer->GetCount(), 1, 0, 0, 0);
-        }
+        RecordDraws(gfxContext, s_SimpleOpaqueObjects.size(), preparePass, beginPass, recordDraws);
 
         //Profiler::EndBlock(commandList);
     }
@@ -300,6 +490,9 @@ namespace Roses
 
             auto shader = Roses::CreateRef<D3D12Shader>(ShaderPathDecoupled, pipelineStateStream);
             D3D12Renderer::g_ShaderLibrary->Add(shader);
+
+            auto bindlessShader = Roses::CreateRef<D3D12Shader>(ShaderPathDecoupledBindless, pipelineStateStream);
+            D3D12Renderer::g_ShaderLibrary->Add(bindlessShader);
         }
 
         {
@@ -331,7 +524,9 @@ namespace Roses
 
         for (auto& info : m_DilationQueue)
         {
+            // The views stay in the view cache for the next time the texture is handed out
             s_RenderTargetDescriptorHeap->Release(info.Temporary->RTVAllocation);
+            s_ResourceDescriptorHeap->Release(info.Temporary->SRVAllocation);
             TextureManager::DiscardTexture(info.Temporary, fenceValue);
         }
         m_DilationQueue.clear();
@@ -386,8 +581,7 @@ namespace Roses
             D3D12_UNORDERED_ACCESS_VIEW_DESC fbUAVDesc = {};
             fbUAVDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
             fbUAVDesc.Format = fbDesc.Format;
-            auto dims = fb->GetDimensions();
-            fbUAVDesc.Buffer.NumElements = dims.x * dims.y;
+            fbUAVDesc.Buffer.NumElements = fb->GetNumElements();
             fbUAVDesc.Buffer.StructureByteStride = sizeof(uint32_t);
             batch.GetDevice()->CreateUnorderedAccessView(
                 fb->GetResource(),
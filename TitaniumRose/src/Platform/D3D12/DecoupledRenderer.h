@@ -25,6 +25,13 @@ namespace Roses
 
 
     private:
+        // Same pass with the bindless shader, a draw only sets its material and object index
+        void RenderVirtualTexturesBindless(GraphicsContext& gfxContext);
+        // Takes a pooled target at the texture's finest mip and queues its dilation, not thread safe
+        Texture2D* RequestTemporaryRenderTarget(GraphicsContext& gfxContext, Ref<VirtualTexture2D>& virtualTexture);
+        // Binds the target and clears it, can be recorded into any context
+        static void SetTemporaryRenderTarget(GraphicsContext& context, Texture2D& target);
+
         static constexpr uint32_t MaxItemsPerQueue = 25;
         
         enum ShaderIndices
@@ -79,6 +86,16 @@ namespace Roses
             ShaderIndicesSimple_Count
         };
 
+        enum FeedbackModeSimple
+        {
+            // A uint32_t per cell
+            FeedbackModeSimple_Full,
+            // Four byte cells packed into every element
+            FeedbackModeSimple_Compact,
+            // The mips are estimated, nothing reads the feedback
+            FeedbackModeSimple_None
+        };
+
         struct alignas(16) HPassDataSimple {
             glm::mat4 ViewProjection;
         };
@@ -87,6 +104,8 @@ namespace Roses
             glm::mat4 LocalToWorld;
             glm::ivec2 FeedbackDims;
             glm::ivec2 Mips;
+            // One of FeedbackModeSimple
+            uint32_t FeedbackMode;
         };
 
         struct DilateTextureInfo 
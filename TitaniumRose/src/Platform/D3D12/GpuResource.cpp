@@ -3,6 +3,7 @@
 #include "Platform/D3D12/d3dx12.h"
 #include "Platform/D3D12/GpuResource.h"
 #include "Platform/D3D12/D3D12ResourceBatch.h"
+#include "Platform/D3D12/D3D12Renderer.h"
 
 namespace Roses
 {
@@ -12,7 +13,8 @@ namespace Roses
         m_TransitioningState((D3D12_RESOURCE_STATES)-1),
         m_GpuVirtualAddress((D3D12_GPU_VIRTUAL_ADDRESS)0),
         m_Identifier(""),
-        m_Resource(nullptr)
+        m_Resource(nullptr),
+        m_UploadTicket(0)
     {
 
     }
@@ -22,10 +24,16 @@ namespace Roses
         m_TransitioningState((D3D12_RESOURCE_STATES)-1),
         m_GpuVirtualAddress((D3D12_GPU_VIRTUAL_ADDRESS)0),
         m_Identifier(id),
-        m_Resource(nullptr)
+        m_Resource(nullptr),
+        m_UploadTicket(0)
     {
 
     }
+
+    GpuResource::~GpuResource()
+    {
+        D3D12Renderer::ReleaseCachedViews(*this);
+    }
 #if 0
     void GpuResource::Transition(D3D12ResourceBatch& batch, D3D12_RESOURCE_STATES from, D3D12_RESOURCE_STATES to)
     {
@@ -75,12 +83,14 @@ namespace Roses
 #endif
     void GpuResource::Reset()
     {
+        D3D12Renderer::ReleaseCachedViews(*this);
         m_Resource = nullptr;
         m_GpuVirtualAddress = D3D12_GPU_VIRTUAL_ADDRESS_UNKNOWN;
     }
 
     void GpuResource::Release()
     {
+        D3D12Renderer::ReleaseCachedViews(*this);
         D3D12::ThrowIfFailed(m_Resource->Release());
     }
 
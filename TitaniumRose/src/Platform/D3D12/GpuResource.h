@@ -12,10 +12,12 @@ namespace Roses
         friend class CommandContext;
         friend class GraphicsContext;
         friend class ComputeContext;
+        friend class D3D12UploadService;
 
     public:
         GpuResource();
         GpuResource(std::string id, D3D12_RESOURCE_STATES state);
+        ~GpuResource();
 
         inline ID3D12Resource* GetResource() const { return m_Resource.Get(); }
         inline DXGI_FORMAT GetFormat() const { return m_Resource->GetDesc().Format; }
@@ -30,6 +32,9 @@ namespace Roses
         // set by some other API outside the direct engine code (i.e. DDSTextureLoader
         inline void BypassAndSetState(D3D12_RESOURCE_STATES newState) { m_CurrentState = newState; }
 
+        // The upload service ticket of the resource's initial data, 0 if it did not go through it
+        inline uint64_t GetUploadTicket() const { return m_UploadTicket; }
+
         HeapAllocationDescription SRVAllocation;
         HeapAllocationDescription UAVAllocation;
         HeapAllocationDescription RTVAllocation;
@@ -40,6 +45,7 @@ namespace Roses
         D3D12_GPU_VIRTUAL_ADDRESS m_GpuVirtualAddress;
         TComPtr<ID3D12Resource> m_Resource;
         std::string m_Identifier;
+        uint64_t m_UploadTicket;
 
     };
 }
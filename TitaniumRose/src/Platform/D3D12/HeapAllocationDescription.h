@@ -7,11 +7,15 @@ namespace Roses {
     {
     public:
         HeapAllocationDescription()
-            : Allocated(false), OffsetInHeap(0), Range(0),
+            : Allocated(false), Transient(false), Cached(false), OffsetInHeap(0), Range(0),
             CPUHandle({ D3D12_GPU_VIRTUAL_ADDRESS_UNKNOWN }),
             GPUHandle({ D3D12_GPU_VIRTUAL_ADDRESS_UNKNOWN })
         {}
         bool   Allocated;
+        // Lives in the heap's transient ring and is reused once its frame retires, Release ignores it
+        bool   Transient;
+        // Owned by the renderer's view cache and freed when its resource is, Release ignores it
+        bool   Cached;
         size_t OffsetInHeap;
         size_t Range;
         D3D12_CPU_DESCRIPTOR_HANDLE CPUHandle;
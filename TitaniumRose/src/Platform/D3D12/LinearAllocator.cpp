@@ -12,6 +12,11 @@ namespace Roses {
         { AllocatorType::CpuWritable }
     };
 
+    LinearAllocator::UploadRingManager LinearAllocator::s_UploadRing(LinearAllocator::UploadRingSize);
+
+    // Every block starts where a texture upload could
+    static constexpr size_t UploadBlockAlignment = D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT;
+
     LinearAllocator::LinearAllocator(AllocatorType type):
         m_AllocationType(type), m_PageSize(0), 
         m_Offset(-1), m_CurrentPage(nullptr)
@@ -28,6 +33,8 @@ namespace Roses {
         HZ_CORE_ASSERT((alignmentMask & alignment) == 0, "Alignment not a power of 2");
         size_t actualSize = D3D12::AlignUpMasked(size, alignmentMask);
 
+        if (m_AllocationType == AllocatorType::CpuWritable)
+            return AllocateFromRing(actualSize, alignment);
         
         if (actualSize > m_PageSize)
             return AllocateLargePage(actualSize);
@@ -58,20 +65,36 @@ namespace Roses {
 
     void LinearAllocator::CleanupUsedPages(uint64_t fenceValue)
     {
-        if (m_CurrentPage == nullptr)
+        if (m_AllocationType == AllocatorType::CpuWritable) {
+            if (!m_RingBlocks.empty())
+                s_UploadRing.Close(m_RingBlocks, fenceValue);
+            m_RingBlocks.clear();
+            m_CurrentBlock = {};
+            m_Offset = 0;
             return;
+        }
 
-        m_RetiredPages.push_back(m_CurrentPage);
-        m_CurrentPage = nullptr;
-        m_Offset = 0;
+        if (m_CurrentPage != nullptr) {
+            m_RetiredPages.push_back(m_CurrentPage);
+            m_CurrentPage = nullptr;
+            m_Offset = 0;
+        }
 
         s_PageManagers[m_AllocationType].DiscardPages(fenceValue, m_RetiredPages);
         m_RetiredPages.clear();
 
-        s_PageManagers[m_AllocationType].FreeLargePages(fenceValue, m_RetiredPages);
+        s_PageManagers[m_AllocationType].FreeLargePages(fenceValue, m_LargePageList);
         m_LargePageList.clear();
     }
 
+    void LinearAllocator::DestroyAll()
+    {
+        s_UploadRing.Destroy();
+        for (auto& manager : s_PageManagers) {
+            manager.Destroy();
+        }
+    }
+
     LinearAllocator::LinearAllocatorPageManager::LinearAllocatorPageManager(AllocatorType type)
         : m_Type(type)
     {
@@ -172,6 +195,150 @@ namespace Roses {
         m_PagePool.clear();
     }
 
+    LinearAllocator::UploadRingManager::UploadRingManager(size_t capacity)
+        : m_InitialCapacity(capacity)
+    {
+
+    }
+
+    LinearAllocator::UploadRingManager::Block LinearAllocator::UploadRingManager::Allocate(size_t size, size_t alignment)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        RetireBlocks();
+
+        Ring* ring = m_Rings.empty() ? CreateRing(m_InitialCapacity) : m_Rings.back().get();
+        while (true) {
+            UploadRing::Block range = ring->Allocator.Allocate(size, alignment);
+            if (range.IsValid()) {
+                size_t used = 0;
+                for (auto& r : m_Rings) {
+                    used += r->Allocator.GetUsedBytes();
+                }
+                m_HighWater = std::max(m_HighWater, used);
+                return { ring, range };
+            }
+
+            // Waiting only helps if the request fits and the oldest block was submitted,
+            // an open block could belong to the calling context
+            uint64_t fenceValue;
+            if (m_Policy == UploadRingFullPolicy::Block && size <= ring->Allocator.GetCapacity() &&
+                ring->Allocator.GetOldestFence(fenceValue)) {
+                ++m_Stalls;
+                D3D12Renderer::CommandQueueManager.WaitForFence(fenceValue);
+                RetireBlocks();
+                continue;
+            }
+
+            ++m_Grows;
+            size_t capacity = std::max(ring->Allocator.GetCapacity() * 2, D3D12::AlignUp(size, UploadBlockSize));
+            HZ_CORE_WARN("Upload ring is full, growing it to {0} MB", capacity / (1024 * 1024));
+            ring = CreateRing(capacity);
+        }
+    }
+
+    void LinearAllocator::UploadRingManager::Close(const std::vector<Block>& blocks, uint64_t fenceValue)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        for (auto& block : blocks) {
+            block.Owner->Allocator.Close(block.Range.Id, fenceValue);
+        }
+    }
+
+    void LinearAllocator::UploadRingManager::SetPolicy(UploadRingFullPolicy policy)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Policy = policy;
+    }
+
+    UploadRingStatistics LinearAllocator::UploadRingManager::GetStatistics()
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        UploadRingStatistics stats;
+        stats.Capacity = m_Rings.empty() ? m_InitialCapacity : m_Rings.back()->Allocator.GetCapacity();
+        stats.HighWater = m_HighWater;
+        stats.Stalls = m_Stalls;
+        stats.Grows = m_Grows;
+        stats.Wraps = m_RetiredWraps;
+        for (auto& ring : m_Rings) {
+            stats.UsedBytes += ring->Allocator.GetUsedBytes();
+            stats.Wraps += ring->Allocator.GetStats().Wraps;
+        }
+        return stats;
+    }
+
+    void LinearAllocator::UploadRingManager::Destroy()
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Rings.clear();
+    }
+
+    void LinearAllocator::UploadRingManager::RetireBlocks()
+    {
+        auto isComplete = [](uint64_t fenceValue) {
+            return D3D12Renderer::CommandQueueManager.IsFenceComplete(fenceValue);
+        };
+
+        for (auto& ring : m_Rings) {
+            ring->Allocator.Retire(isComplete);
+        }
+
+        // The rings a grow left behind go once their last block retired
+        for (size_t i = 0; i + 1 < m_Rings.size();) {
+            if (m_Rings[i]->Allocator.IsEmpty()) {
+                m_RetiredWraps += m_Rings[i]->Allocator.GetStats().Wraps;
+                m_Rings.erase(m_Rings.begin() + i);
+            }
+            else {
+                i++;
+            }
+        }
+    }
+
+    LinearAllocator::UploadRingManager::Ring* LinearAllocator::UploadRingManager::CreateRing(size_t capacity)
+    {
+        LinearAllocatorPage* buffer = s_PageManagers[AllocatorType::CpuWritable].CreateNewPage(capacity);
+        buffer->GetResource()->SetName(L"Upload Ring");
+
+        m_Rings.emplace_back(new Ring(buffer, capacity));
+        return m_Rings.back().get();
+    }
+
+    DynamicAllocation LinearAllocator::AllocateFromRing(size_t sizeInBytes, size_t alignment)
+    {
+        // Large or coarsely aligned requests take a block of their own, the current one stays open
+        if (sizeInBytes > UploadBlockSize || alignment > UploadBlockAlignment) {
+            UploadRingManager::Block block = s_UploadRing.Allocate(sizeInBytes, std::max(alignment, UploadBlockAlignment));
+            m_RingBlocks.push_back(block);
+
+            DynamicAllocation alloc(*block.Owner->Buffer, sizeInBytes, block.Range.Offset);
+            alloc.CpuAddress = (uint8_t*)block.Owner->Buffer->m_CpuVirtualAddress + block.Range.Offset;
+            alloc.GpuAddress = block.Owner->Buffer->GetGPUAddress() + block.Range.Offset;
+            return alloc;
+        }
+
+        if (m_CurrentBlock.Owner != nullptr)
+            m_Offset = D3D12::AlignUp(m_Offset, alignment);
+
+        if (m_CurrentBlock.Owner == nullptr || m_Offset + sizeInBytes > m_CurrentBlock.Range.Size) {
+            m_CurrentBlock = s_UploadRing.Allocate(UploadBlockSize, UploadBlockAlignment);
+            m_RingBlocks.push_back(m_CurrentBlock);
+            m_Offset = 0;
+        }
+
+        size_t offset = m_CurrentBlock.Range.Offset + m_Offset;
+        LinearAllocatorPage& buffer = *m_CurrentBlock.Owner->Buffer;
+
+        DynamicAllocation alloc(buffer, sizeInBytes, offset);
+        alloc.CpuAddress = (uint8_t*)buffer.m_CpuVirtualAddress + offset;
+        alloc.GpuAddress = buffer.GetGPUAddress() + offset;
+
+        m_Offset += sizeInBytes;
+        return alloc;
+    }
+
     DynamicAllocation LinearAllocator::AllocateLargePage(size_t sizeInBytes)
     {
         LinearAllocatorPage* page = s_PageManagers[m_AllocationType].CreateNewPage(sizeInBytes);
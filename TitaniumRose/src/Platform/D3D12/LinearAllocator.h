@@ -1,7 +1,10 @@
 #pragma once
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <queue>
 
+#include "TitaniumRose/Core/UploadRing.h"
 #include "Platform/D3D12/GpuResource.h"
 
 namespace Roses {
@@ -19,6 +22,26 @@ namespace Roses {
 
     };
 
+    // What the upload ring does when the blocks in flight leave no room
+    enum class UploadRingFullPolicy
+    {
+        // Waits for the oldest block's fence, and only grows if that block is still open
+        Block,
+        // Moves to a ring twice the size, the old one is released once its blocks retire
+        Grow
+    };
+
+    struct UploadRingStatistics
+    {
+        size_t Capacity = 0;
+        size_t UsedBytes = 0;
+        // Over every ring, the largest number of bytes in flight at once
+        size_t HighWater = 0;
+        uint64_t Stalls = 0;
+        uint64_t Grows = 0;
+        uint64_t Wraps = 0;
+    };
+
     class LinearAllocator
     {
 
@@ -29,6 +52,12 @@ namespace Roses {
             CpuWritable,
             Count
         };
+
+        static constexpr size_t UploadRingSize = 32 * 1024 * 1024;
+        // What a context takes from the ring at once and sub-allocates, larger requests get
+        // a block of their own
+        static constexpr size_t UploadBlockSize = 64 * 1024;
+
     private:
 
         class LinearAllocatorPage: public GpuResource {
@@ -99,6 +128,51 @@ namespace Roses {
             std::queue<LinearAllocatorPage*> m_AvailablePages;
         };
 
+        /// <summary>
+        /// The upload memory of every CpuWritable allocator: one persistently mapped ring the
+        /// frames in flight share. Contexts take blocks from it and close them with the fence
+        /// of the command list that used them. Can be used from any thread.
+        /// </summary>
+        class UploadRingManager {
+        public:
+            struct Ring {
+                Ring(LinearAllocatorPage* buffer, size_t capacity) : Buffer(buffer), Allocator(capacity) {}
+
+                std::unique_ptr<LinearAllocatorPage> Buffer;
+                UploadRing Allocator;
+            };
+
+            struct Block {
+                Ring* Owner = nullptr;
+                UploadRing::Block Range;
+            };
+
+            UploadRingManager(size_t capacity);
+
+            Block Allocate(size_t size, size_t alignment);
+            void Close(const std::vector<Block>& blocks, uint64_t fenceValue);
+
+            void SetPolicy(UploadRingFullPolicy policy);
+            UploadRingStatistics GetStatistics();
+
+            void Destroy();
+
+        private:
+            // Expects m_Mutex to be held
+            void RetireBlocks();
+            Ring* CreateRing(size_t capacity);
+
+            std::mutex m_Mutex;
+            // The last one is the current ring, the others are released once they drain
+            std::vector<std::unique_ptr<Ring>> m_Rings;
+            size_t m_InitialCapacity;
+            UploadRingFullPolicy m_Policy = UploadRingFullPolicy::Block;
+            uint64_t m_Stalls = 0;
+            uint64_t m_Grows = 0;
+            size_t m_HighWater = 0;
+            uint64_t m_RetiredWraps = 0;
+        };
+
         enum AllocatorPageSize {
             CPU = 0x010000,     // 64k
             GPU = 0x200000      // 2MB
@@ -111,9 +185,15 @@ namespace Roses {
         DynamicAllocation Allocate(size_t size, size_t alignment = 256);
 
         void CleanupUsedPages(uint64_t fenceValue);
+
+        static void SetUploadRingPolicy(UploadRingFullPolicy policy) { s_UploadRing.SetPolicy(policy); }
+        static UploadRingStatistics GetUploadRingStatistics() { return s_UploadRing.GetStatistics(); }
+        // Releases the upload ring and the page pools, the GPU has to be idle
+        static void DestroyAll();
     private:
 
         DynamicAllocation AllocateLargePage(size_t sizeInBytes);
+        DynamicAllocation AllocateFromRing(size_t sizeInBytes, size_t alignment);
 
 
         AllocatorType m_AllocationType;
@@ -122,6 +202,12 @@ namespace Roses {
         LinearAllocatorPage* m_CurrentPage;
 
         static LinearAllocatorPageManager s_PageManagers[AllocatorType::Count];
+        static UploadRingManager s_UploadRing;
+
+        // The ring blocks of a CpuWritable allocator, closed together by CleanupUsedPages.
+        // m_Offset is the next byte of m_CurrentBlock
+        std::vector<UploadRingManager::Block> m_RingBlocks;
+        UploadRingManager::Block m_CurrentBlock;
 
         std::vector<LinearAllocatorPage*> m_RetiredPages;
         std::vector<LinearAllocatorPage*> m_LargePageList;
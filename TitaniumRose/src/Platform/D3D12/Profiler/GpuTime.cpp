@@ -12,14 +12,16 @@ namespace Roses { namespace GpuTime {
     D3D12Context* c = nullptr;
 
     uint64_t* s_TimestampBuffer;
-    uint64_t s_FenceValue = 0;
     uint32_t s_MaxTimers = 0;
     uint32_t s_NumTimers = 1;
     uint64_t s_ValidTimeStart = 0;
     uint64_t s_ValidTimeEnd = 0;
     double s_GpuTickDelta = 0;
 
-    Scope<ReadbackBuffer> s_ReadbackBuffer;
+    // One per frame in flight, the oldest is read while the newer frames still resolve into theirs
+    Scope<ReadbackBuffer> s_ReadbackBuffers[D3D12Renderer::FrameLatency];
+    uint64_t s_FenceValues[D3D12Renderer::FrameLatency] = {};
+    uint32_t s_ReadbackIndex = 0;
     ID3D12QueryHeap* s_QueryHeap = nullptr;
 
     void Initialize(uint32_t maxTimers)
@@ -31,8 +33,10 @@ namespace Roses { namespace GpuTime {
         D3D12::ThrowIfFailed(D3D12Renderer::CommandQueueManager.GetCommandQueue()->GetTimestampFrequency(&gpuFrequency));
         s_GpuTickDelta = 1.0 / (double)gpuFrequency;
         
-        s_ReadbackBuffer = CreateScope<ReadbackBuffer>(maxTimers * 2 * sizeof(uint64_t));
-        s_ReadbackBuffer->SetName("Timestamp Readback Buffer");
+        for (auto& readbackBuffer : s_ReadbackBuffers) {
+            readbackBuffer = CreateScope<ReadbackBuffer>(maxTimers * 2 * sizeof(uint64_t));
+            readbackBuffer->SetName("Timestamp Readback Buffer");
+        }
 
         D3D12_QUERY_HEAP_DESC QueryHeapDesc;
         QueryHeapDesc.Count = maxTimers * 2;
@@ -46,8 +50,10 @@ namespace Roses { namespace GpuTime {
 
     void Shutdown()
     {
-        if (s_ReadbackBuffer)
-            s_ReadbackBuffer.release();
+        for (auto& readbackBuffer : s_ReadbackBuffers) {
+            if (readbackBuffer)
+                readbackBuffer.release();
+        }
 
         if (s_QueryHeap)
             s_QueryHeap->Release();
@@ -70,9 +76,10 @@ namespace Roses { namespace GpuTime {
 
     void BeginReadBack(void)
     {
-        D3D12Renderer::CommandQueueManager.WaitForFence(s_FenceValue);
+        // Resolved FrameLatency frames ago, so this rarely has to wait
+        D3D12Renderer::CommandQueueManager.WaitForFence(s_FenceValues[s_ReadbackIndex]);
 
-        s_TimestampBuffer = s_ReadbackBuffer->Map<uint64_t*>(0, s_NumTimers * 2 * sizeof(uint64_t));
+        s_TimestampBuffer = s_ReadbackBuffers[s_ReadbackIndex]->Map<uint64_t*>(0, s_NumTimers * 2 * sizeof(uint64_t));
 
         s_ValidTimeStart = s_TimestampBuffer[0];
         s_ValidTimeEnd   = s_TimestampBuffer[1];
@@ -85,14 +92,16 @@ namespace Roses { namespace GpuTime {
     
     void EndReadBack(void)
     {
-        s_ReadbackBuffer->Unmap();
+        auto& readbackBuffer = s_ReadbackBuffers[s_ReadbackIndex];
+        readbackBuffer->Unmap();
         s_TimestampBuffer = nullptr;
 
         CommandContext& context = CommandContext::Begin();
         context.GetCommandList()->EndQuery(s_QueryHeap, D3D12_QUERY_TYPE_TIMESTAMP, 1);
-        context.GetCommandList()->ResolveQueryData(s_QueryHeap, D3D12_QUERY_TYPE_TIMESTAMP, 0, s_NumTimers * 2, s_ReadbackBuffer->GetResource(), 0);
+        context.GetCommandList()->ResolveQueryData(s_QueryHeap, D3D12_QUERY_TYPE_TIMESTAMP, 0, s_NumTimers * 2, readbackBuffer->GetResource(), 0);
         context.GetCommandList()->EndQuery(s_QueryHeap, D3D12_QUERY_TYPE_TIMESTAMP, 0);
-        s_FenceValue = context.Finish();
+        s_FenceValues[s_ReadbackIndex] = context.Finish();
+        s_ReadbackIndex = (s_ReadbackIndex + 1) % D3D12Renderer::FrameLatency;
     }
 
 
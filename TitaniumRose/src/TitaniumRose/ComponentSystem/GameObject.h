@@ -6,6 +6,8 @@
 #include "TitaniumRose/ComponentSystem/Component.h"
 #include "TitaniumRose/Renderer/Material.h"
 #include "TitaniumRose/Renderer/Vertex.h"
+#include "TitaniumRose/Renderer/VirtualTexture/MipHysteresis.h"
+#include "TitaniumRose/Renderer/VirtualTexture/MipPolicy.h"
 
 #include "Platform/D3D12/D3D12Buffer.h"
 #include "Platform/D3D12/D3D12Texture.h"
@@ -23,6 +25,12 @@ namespace Roses {
 		bool OverwriteRefreshRate = false;
 		int64_t LastFrameUpdated = -1;
 		uint64_t UpdateFrequency = 1;
+        // How the finest mip to shade is picked from the feedback
+        Roses::MipPolicy MipPolicy;
+        MipHysteresisSettings MipHysteresis;
+        // Estimates the mips from the mesh and the camera instead, the feedback map is then
+        // neither written nor read back
+        bool AnalyticMips = false;
         Ref<VirtualTexture2D> VirtualTexture = nullptr;
     };
 
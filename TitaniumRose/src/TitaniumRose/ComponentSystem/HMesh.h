@@ -2,6 +2,7 @@
 
 #include "TitaniumRose/Core/Math/AABB.h"
 #include "TitaniumRose/Renderer/Vertex.h"
+#include "TitaniumRose/Renderer/VirtualTexture/TexelDensity.h"
 
 #include "Platform/D3D12/D3D12Buffer.h"
 
@@ -21,5 +22,7 @@ namespace Roses {
 		std::vector<Triangle> triangles;
 
 		AABB BoundingBox;
+		// Measured in object space at import, per triangle and per UV chart
+		TexelDensityTable TexelDensity;
 	};
 }
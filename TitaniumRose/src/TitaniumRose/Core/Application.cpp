@@ -40,9 +40,10 @@ namespace Roses {
 		D3D12Renderer::Shutdown();
 	}
 
-	void Application::Init()
+	void Application::Init(const JobSystemDesc& jobs)
 	{
 		SystemTime::Initialize();
+		m_JobSystem = std::make_unique<JobSystem>(jobs);
 		D3D12Renderer::Init();
 		Profiler::Initialize();
 #if USE_IMGUI
@@ -135,7 +136,7 @@ namespace Roses {
 					//Profiler::BeginBlock("OnRender", D3D12Renderer::Context->DeviceResources->MainCommandList);
                     for (Layer* layer : m_LayerStack)
                         layer->OnRender(m_TimeStep, gfxContext);
-					gfxContext.Finish(true);
+					gfxContext.Finish();
 					//Profiler::EndBlock(D3D12Renderer::Context->DeviceResources->MainCommandList);
 
 #if USE_IMGUI
@@ -153,7 +154,7 @@ namespace Roses {
 					}
 					m_ImGuiLayer->End(uiContext);
                     //Profiler::EndBlock(D3D12Renderer::Context->DeviceResources->MainCommandList);
-					uiContext.Finish(true);
+					uiContext.Finish();
 #endif	
 				}
 				//Profiler::EndBlock(D3D12Renderer::Context->DeviceResources->MainCommandList);
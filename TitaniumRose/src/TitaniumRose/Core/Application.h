@@ -1,6 +1,7 @@
 #pragma once
 
 #include "TitaniumRose/Core/Core.h"
+#include "TitaniumRose/Core/JobSystem.h"
 #include "TitaniumRose/Core/Window.h"
 #include "TitaniumRose/Core/LayerStack.h"
 #include "TitaniumRose/Core/Timestep.h"
@@ -31,7 +32,7 @@ namespace Roses {
 		Application(const ApplicationOptions& opts = { 1280, 720, "Hazel Engine", false });
 		virtual ~Application();
 
-		void Init();
+		void Init(const JobSystemDesc& jobs = {});
 
 		void OnEvent(Event& e);
 		virtual void OnInit(cxxopts::ParseResult& options) = 0;
@@ -43,6 +44,7 @@ namespace Roses {
 		std::string OpenFile(const std::string& filter);
 
 		inline Window& GetWindow() { return *m_Window; }
+		inline JobSystem& GetJobSystem() { return *m_JobSystem; }
 
 		inline static Application& Get() { return *s_Instance; }
 	private:
@@ -55,6 +57,8 @@ namespace Roses {
 		bool m_UseFixedTimestep;
 
 	private:
+		// First, so the workers outlive everything that schedules jobs
+		std::unique_ptr<JobSystem> m_JobSystem;
 		std::unique_ptr<Window> m_Window;
 		ImGuiLayer* m_ImGuiLayer;
 		bool m_Running = true;
@@ -0,0 +1,272 @@
+#include "trpch.h"
+#include "TitaniumRose/Core/ConcurrentRangeAllocator.h"
+
+namespace Roses
+{
+    // The magazine indices are shared by every allocator, a thread keeps its index, and so its
+    // magazines, until it exits
+    struct ThreadIndexRegistry
+    {
+        std::mutex Mutex;
+        std::vector<uint32_t> FreeIndices;
+        uint32_t NextIndex = 0;
+        // The allocators whose magazines an exiting thread has to drain
+        std::vector<ConcurrentRangeAllocator*> Allocators;
+    };
+
+    static ThreadIndexRegistry& GetThreadIndexRegistry()
+    {
+        static ThreadIndexRegistry registry;
+        return registry;
+    }
+
+    struct ThreadMagazineIndex
+    {
+        uint32_t Index = UINT32_MAX;
+
+        ~ThreadMagazineIndex()
+        {
+            if (Index < ConcurrentRangeAllocator::MaxThreads)
+                ConcurrentRangeAllocator::ReleaseThreadIndex(Index);
+        }
+    };
+
+    static thread_local ThreadMagazineIndex t_ThreadIndex;
+
+    ConcurrentRangeAllocator::ConcurrentRangeAllocator(size_t size)
+    {
+        Reset(size);
+
+        auto& registry = GetThreadIndexRegistry();
+        std::lock_guard<std::mutex> lock(registry.Mutex);
+        registry.Allocators.push_back(this);
+    }
+
+    ConcurrentRangeAllocator::~ConcurrentRangeAllocator()
+    {
+        auto& registry = GetThreadIndexRegistry();
+        std::lock_guard<std::mutex> lock(registry.Mutex);
+        registry.Allocators.erase(std::find(registry.Allocators.begin(), registry.Allocators.end(), this));
+    }
+
+    void ConcurrentRangeAllocator::Reset(size_t size)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        m_Size = size;
+        m_Ranges.Reset(size);
+        // A refill takes at most a sixteenth of the space, so a few threads can not hold all of it
+        m_UseMagazines = size >= MinMagazineAllocatorSize;
+        m_RefillCount = static_cast<uint32_t>(std::min<size_t>(MagazineBlock, size / 16));
+        for (Magazine& magazine : m_Magazines)
+        {
+            magazine.Count.store(0, std::memory_order_relaxed);
+            magazine.Hits.store(0, std::memory_order_relaxed);
+        }
+        m_LockedOperations = 0;
+    }
+
+    size_t ConcurrentRangeAllocator::Allocate(size_t count)
+    {
+        Magazine* magazine = (count == 1 && m_UseMagazines) ? GetThreadMagazine() : nullptr;
+        if (magazine != nullptr)
+        {
+            std::lock_guard<std::mutex> lock(magazine->Mutex);
+            uint32_t slots = magazine->Count.load(std::memory_order_relaxed);
+            if (slots > 0 || Refill(*magazine))
+            {
+                slots = magazine->Count.load(std::memory_order_relaxed);
+                magazine->Count.store(slots - 1, std::memory_order_relaxed);
+                magazine->Hits.store(magazine->Hits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return magazine->Slots[slots - 1];
+            }
+        }
+
+        return AllocateLocked(count);
+    }
+
+    bool ConcurrentRangeAllocator::Release(size_t offset, size_t count)
+    {
+        if (count == 0)
+            return true;
+
+        HZ_CORE_ASSERT(offset + count <= m_Size, "Released range is outside of the allocator");
+
+        Magazine* magazine = (count == 1 && m_UseMagazines) ? GetThreadMagazine() : nullptr;
+        if (magazine != nullptr)
+        {
+            std::lock_guard<std::mutex> lock(magazine->Mutex);
+            uint32_t slots = magazine->Count.load(std::memory_order_relaxed);
+            if (slots == MagazineSize)
+            {
+                Drain(*magazine, MagazineBlock);
+                slots -= MagazineBlock;
+            }
+
+            magazine->Slots[slots] = static_cast<uint32_t>(offset);
+            magazine->Count.store(slots + 1, std::memory_order_relaxed);
+            magazine->Hits.store(magazine->Hits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        ++m_LockedOperations;
+        return m_Ranges.Release(offset, count);
+    }
+
+    void ConcurrentRangeAllocator::FlushThreadCache()
+    {
+        Magazine* magazine = GetThreadMagazine();
+        if (magazine != nullptr)
+        {
+            std::lock_guard<std::mutex> lock(magazine->Mutex);
+            Drain(*magazine, magazine->Count.load(std::memory_order_relaxed));
+        }
+    }
+
+    void ConcurrentRangeAllocator::FlushAllMagazines()
+    {
+        for (Magazine& magazine : m_Magazines)
+        {
+            std::lock_guard<std::mutex> lock(magazine.Mutex);
+            uint32_t slots = magazine.Count.load(std::memory_order_relaxed);
+            if (slots > 0)
+                Drain(magazine, slots);
+        }
+    }
+
+    size_t ConcurrentRangeAllocator::AllocateLocked(size_t count)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            ++m_LockedOperations;
+            size_t offset = m_Ranges.Allocate(count);
+            if (offset != InvalidOffset || !m_UseMagazines)
+                return offset;
+        }
+
+        // The slots might only be sitting in the magazines of other threads
+        FlushAllMagazines();
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        ++m_LockedOperations;
+        return m_Ranges.Allocate(count);
+    }
+
+    size_t ConcurrentRangeAllocator::GetFreeCount() const
+    {
+        size_t cached = 0;
+        for (const Magazine& magazine : m_Magazines)
+            cached += magazine.Count.load(std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_Ranges.GetFreeCount() + cached;
+    }
+
+    size_t ConcurrentRangeAllocator::GetFreeRangeCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_Ranges.GetFreeRangeCount();
+    }
+
+    size_t ConcurrentRangeAllocator::GetLargestFreeRange() const
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_Ranges.GetLargestFreeRange();
+    }
+
+    ConcurrentRangeAllocatorStats ConcurrentRangeAllocator::GetStats() const
+    {
+        ConcurrentRangeAllocatorStats stats;
+        for (const Magazine& magazine : m_Magazines)
+            stats.MagazineHits += magazine.Hits.load(std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        stats.LockedOperations = m_LockedOperations;
+        return stats;
+    }
+
+    ConcurrentRangeAllocator::Magazine* ConcurrentRangeAllocator::GetThreadMagazine()
+    {
+        uint32_t& index = t_ThreadIndex.Index;
+        if (index == UINT32_MAX)
+        {
+            auto& registry = GetThreadIndexRegistry();
+            std::lock_guard<std::mutex> lock(registry.Mutex);
+            if (!registry.FreeIndices.empty())
+            {
+                index = registry.FreeIndices.back();
+                registry.FreeIndices.pop_back();
+            }
+            else
+            {
+                // Past MaxThreads a thread stays on the locked path for the rest of its life
+                index = registry.NextIndex < MaxThreads ? registry.NextIndex++ : MaxThreads;
+            }
+        }
+
+        return index < MaxThreads ? &m_Magazines[index] : nullptr;
+    }
+
+    void ConcurrentRangeAllocator::ReleaseThreadIndex(uint32_t index)
+    {
+        auto& registry = GetThreadIndexRegistry();
+        std::lock_guard<std::mutex> lock(registry.Mutex);
+        for (ConcurrentRangeAllocator* allocator : registry.Allocators)
+        {
+            Magazine& magazine = allocator->m_Magazines[index];
+            std::lock_guard<std::mutex> magazineLock(magazine.Mutex);
+            uint32_t slots = magazine.Count.load(std::memory_order_relaxed);
+            if (slots > 0)
+                allocator->Drain(magazine, slots);
+        }
+        registry.FreeIndices.push_back(index);
+    }
+
+    bool ConcurrentRangeAllocator::Refill(Magazine& magazine)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        ++m_LockedOperations;
+
+        // A whole block keeps the thread's descriptors together, single slots are the fallback
+        // for a fragmented space
+        uint32_t slots = 0;
+        size_t block = m_Ranges.Allocate(m_RefillCount);
+        if (block != InvalidOffset)
+        {
+            // Handed out from the front of the block first
+            for (uint32_t i = 0; i < m_RefillCount; i++)
+                magazine.Slots[i] = static_cast<uint32_t>(block + m_RefillCount - 1 - i);
+            slots = m_RefillCount;
+        }
+        else
+        {
+            for (; slots < m_RefillCount; slots++)
+            {
+                size_t slot = m_Ranges.Allocate(1);
+                if (slot == InvalidOffset)
+                    break;
+                magazine.Slots[slots] = static_cast<uint32_t>(slot);
+            }
+        }
+
+        magazine.Count.store(slots, std::memory_order_relaxed);
+        return slots > 0;
+    }
+
+    void ConcurrentRangeAllocator::Drain(Magazine& magazine, uint32_t count)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        ++m_LockedOperations;
+
+        // The oldest slots go back, the ones released last are the most likely to be reused
+        uint32_t slots = magazine.Count.load(std::memory_order_relaxed);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            [[maybe_unused]] bool released = m_Ranges.Release(magazine.Slots[i], 1);
+            HZ_CORE_ASSERT(released, "A slot was released twice");
+        }
+        std::copy(magazine.Slots.begin() + count, magazine.Slots.begin() + slots, magazine.Slots.begin());
+        magazine.Count.store(slots - count, std::memory_order_relaxed);
+    }
+}
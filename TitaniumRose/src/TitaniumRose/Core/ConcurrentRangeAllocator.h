@@ -0,0 +1,116 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "TitaniumRose/Core/RangeAllocator.h"
+
+namespace Roses
+{
+    struct ConcurrentRangeAllocatorStats
+    {
+        // Single slot allocations and releases served by a magazine
+        uint64_t MagazineHits = 0;
+        // Everything that had to take the lock, magazine refills and drains included
+        uint64_t LockedOperations = 0;
+    };
+
+    /// <summary>
+    /// A RangeAllocator that can be used from any thread. Ranges are handed out under a lock,
+    /// but single slots, which is what most descriptor allocations are, come from a small
+    /// per-thread magazine that is refilled and drained a block at a time. Most single slot
+    /// allocations and releases only take their own magazine's lock, which another thread
+    /// only takes when an allocation would fail and the magazines are flushed back. Small
+    /// allocators do not use magazines, a few of them would hold the whole space.
+    /// </summary>
+    class ConcurrentRangeAllocator
+    {
+    public:
+        static constexpr size_t InvalidOffset = RangeAllocator::InvalidOffset;
+        // Threads alive past this many share the locked path. A thread that exits drains its
+        // magazines and leaves its index to the next thread
+        static constexpr uint32_t MaxThreads = 64;
+        static constexpr uint32_t MagazineSize = 32;
+        // Slots moved between a magazine and the shared allocator at once
+        static constexpr uint32_t MagazineBlock = MagazineSize / 2;
+        // Allocators smaller than this take the lock for every allocation
+        static constexpr size_t MinMagazineAllocatorSize = 4 * MagazineBlock;
+
+        ConcurrentRangeAllocator(size_t size = 0);
+        ~ConcurrentRangeAllocator();
+
+        /// <summary>
+        /// Forgets every allocation and empties the magazines. No other thread can be using
+        /// the allocator.
+        /// </summary>
+        void Reset(size_t size);
+
+        /// <summary>
+        /// Allocates a range. If no free range is large enough, the slots in every thread's
+        /// magazine are returned and the allocation is tried again before it fails.
+        /// </summary>
+        /// <returns>The first slot of the range, or InvalidOffset if no free range is large enough</returns>
+        size_t Allocate(size_t count);
+
+        /// <summary>
+        /// Gives a range back. A single slot goes to the calling thread's magazine, so a slot
+        /// released twice is only caught once the magazine is drained.
+        /// </summary>
+        /// <returns>False if the shared allocator found part of the range already free</returns>
+        bool Release(size_t offset, size_t count);
+
+        /// <summary>
+        /// Returns the slots in the calling thread's magazine, for threads that are done
+        /// allocating.
+        /// </summary>
+        void FlushThreadCache();
+
+        inline size_t GetSize() const { return m_Size; }
+        // Includes the slots sitting in magazines, they are not in use
+        size_t GetFreeCount() const;
+        size_t GetFreeRangeCount() const;
+        size_t GetLargestFreeRange() const;
+
+        ConcurrentRangeAllocatorStats GetStats() const;
+
+    private:
+        // Only ever used by its thread, unless an allocation is about to fail. The counters
+        // are atomic so the stats can read them without the lock
+        struct alignas(64) Magazine
+        {
+            std::mutex Mutex;
+            std::atomic<uint32_t> Count = 0;
+            std::atomic<uint64_t> Hits = 0;
+            std::array<uint32_t, MagazineSize> Slots;
+        };
+
+        friend struct ThreadMagazineIndex;
+
+        // The calling thread's magazine, or nullptr while MaxThreads other threads have one
+        Magazine* GetThreadMagazine();
+        // Called when a thread with a magazine index exits, drains its magazine in every allocator
+        static void ReleaseThreadIndex(uint32_t index);
+
+        // Both are called with the magazine's lock held
+        bool Refill(Magazine& magazine);
+        void Drain(Magazine& magazine, uint32_t count);
+        // Returns the slots of every magazine to the shared allocator
+        void FlushAllMagazines();
+        // Takes the lock, tries again after flushing the magazines if nothing fits
+        size_t AllocateLocked(size_t count);
+
+        size_t m_Size = 0;
+        // Whether single slots go through the magazines, and how many a refill takes
+        bool m_UseMagazines = false;
+        uint32_t m_RefillCount = 0;
+
+        mutable std::mutex m_Mutex;
+        RangeAllocator m_Ranges;
+
+        std::array<Magazine, MaxThreads> m_Magazines;
+        // Guarded by m_Mutex
+        uint64_t m_LockedOperations = 0;
+    };
+}
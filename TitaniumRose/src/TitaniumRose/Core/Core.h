@@ -38,7 +38,10 @@
 	#error "Android is not supported!"
 #elif defined(__linux__)
 	#define HZ_PLATFORM_LINUX
-	#error "Linux is not supported!"
+	/* Headless tools only build the platform-neutral code */
+	#ifndef HZ_HEADLESS
+		#error "Linux is not supported!"
+	#endif
 #else
 	/* Unknown compiler/platform */
 	#error "Unknown platform!"
@@ -0,0 +1,44 @@
+#include "trpch.h"
+#include "TitaniumRose/Core/DescriptorViewCache.h"
+
+#include <cstring>
+
+namespace Roses
+{
+    DescriptorViewKey DescriptorViewKey::Create(const void* resource, uint32_t viewType, const void* desc, size_t descSize)
+    {
+        HZ_CORE_ASSERT(descSize <= MaxDescSize, "View description does not fit in the key");
+
+        DescriptorViewKey key;
+        key.Resource = reinterpret_cast<uint64_t>(resource);
+        key.ViewType = viewType;
+        key.DescSize = static_cast<uint32_t>(descSize);
+        std::memcpy(key.Desc.data(), desc, descSize);
+        return key;
+    }
+
+    bool DescriptorViewKey::operator==(const DescriptorViewKey& other) const
+    {
+        // The bytes past DescSize are always zero, comparing all of them is fine
+        return Resource == other.Resource && ViewType == other.ViewType &&
+            DescSize == other.DescSize && Desc == other.Desc;
+    }
+
+    uint64_t HashDescriptorViewKey(const DescriptorViewKey& key)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        auto mix = [&hash](const void* data, size_t size) {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            for (size_t i = 0; i < size; i++)
+            {
+                hash ^= bytes[i];
+                hash *= 1099511628211ull;
+            }
+        };
+
+        mix(&key.Resource, sizeof(key.Resource));
+        mix(&key.ViewType, sizeof(key.ViewType));
+        mix(key.Desc.data(), key.DescSize);
+        return hash;
+    }
+}
@@ -0,0 +1,144 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Roses
+{
+    /// <summary>
+    /// Identifies a view: the resource it looks at, what kind of view it is and the raw bytes
+    /// of its description. The description has to be zeroed before it is filled in, the
+    /// padding and unused union members are compared too.
+    /// </summary>
+    struct DescriptorViewKey
+    {
+        // Large enough for the D3D12 SRV, UAV and RTV descriptions
+        static constexpr size_t MaxDescSize = 48;
+
+        uint64_t Resource = 0;
+        uint32_t ViewType = 0;
+        uint32_t DescSize = 0;
+        std::array<uint8_t, MaxDescSize> Desc = {};
+
+        static DescriptorViewKey Create(const void* resource, uint32_t viewType, const void* desc, size_t descSize);
+
+        bool operator==(const DescriptorViewKey& other) const;
+        bool operator!=(const DescriptorViewKey& other) const { return !(*this == other); }
+    };
+
+    /// <summary>
+    /// FNV-1a over the whole key.
+    /// </summary>
+    uint64_t HashDescriptorViewKey(const DescriptorViewKey& key);
+
+    struct DescriptorViewKeyHasher
+    {
+        size_t operator()(const DescriptorViewKey& key) const { return static_cast<size_t>(HashDescriptorViewKey(key)); }
+    };
+
+    struct DescriptorViewCacheStats
+    {
+        uint64_t Hits = 0;
+        uint64_t Misses = 0;
+        // Misses that were not cached because the cache was full
+        uint64_t Rejected = 0;
+        uint64_t Invalidated = 0;
+
+        float HitRate() const { return Hits + Misses > 0 ? static_cast<float>(Hits) / (Hits + Misses) : 0.0f; }
+    };
+
+    /// <summary>
+    /// Remembers the views built for each resource so asking for the same view again returns
+    /// the existing one instead of writing a new descriptor. Entries stay until their resource
+    /// is invalidated, once the cache is full new views are simply not cached. TView is
+    /// whatever the caller needs to hand the view back, usually a descriptor allocation.
+    /// </summary>
+    template<typename TView>
+    class DescriptorViewCache
+    {
+    public:
+        DescriptorViewCache(size_t capacity = 0) : m_Capacity(capacity) {}
+
+        /// <returns>The cached view, or nullptr on a miss</returns>
+        const TView* Find(const DescriptorViewKey& key)
+        {
+            auto it = m_Entries.find(key);
+            if (it == m_Entries.end())
+            {
+                ++m_Stats.Misses;
+                return nullptr;
+            }
+
+            ++m_Stats.Hits;
+            return &it->second;
+        }
+
+        /// <returns>False if the cache is full, the view was not added then</returns>
+        bool Insert(const DescriptorViewKey& key, const TView& view)
+        {
+            if (m_Entries.size() >= m_Capacity)
+            {
+                ++m_Stats.Rejected;
+                return false;
+            }
+
+            if (m_Entries.emplace(key, view).second)
+                m_ResourceKeys[key.Resource].push_back(key);
+            return true;
+        }
+
+        /// <summary>
+        /// Drops every view of a resource, should be called before the resource is released
+        /// so a new resource at the same address does not get its views.
+        /// </summary>
+        /// <param name="onEvicted">void(const TView&amp;), to free what the view holds</param>
+        /// <returns>The number of views dropped</returns>
+        template<typename EvictFn>
+        uint32_t Invalidate(const void* resource, EvictFn onEvicted)
+        {
+            auto keys = m_ResourceKeys.find(reinterpret_cast<uint64_t>(resource));
+            if (keys == m_ResourceKeys.end())
+                return 0;
+
+            uint32_t evicted = 0;
+            for (const DescriptorViewKey& key : keys->second)
+            {
+                auto it = m_Entries.find(key);
+                onEvicted(it->second);
+                m_Entries.erase(it);
+                ++evicted;
+            }
+            m_ResourceKeys.erase(keys);
+
+            m_Stats.Invalidated += evicted;
+            return evicted;
+        }
+
+        /// <summary>
+        /// Drops every view.
+        /// </summary>
+        template<typename EvictFn>
+        void Clear(EvictFn onEvicted)
+        {
+            for (auto& entry : m_Entries)
+                onEvicted(entry.second);
+
+            m_Stats.Invalidated += m_Entries.size();
+            m_Entries.clear();
+            m_ResourceKeys.clear();
+        }
+
+        inline size_t GetCapacity() const { return m_Capacity; }
+        inline size_t GetCount() const { return m_Entries.size(); }
+        inline const DescriptorViewCacheStats& GetStats() const { return m_Stats; }
+
+    private:
+        size_t m_Capacity;
+        std::unordered_map<DescriptorViewKey, TView, DescriptorViewKeyHasher> m_Entries;
+        // The keys of each resource, so invalidating one does not walk the whole cache
+        std::unordered_map<uint64_t, std::vector<DescriptorViewKey>> m_ResourceKeys;
+        DescriptorViewCacheStats m_Stats;
+    };
+}
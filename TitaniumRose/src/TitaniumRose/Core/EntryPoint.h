@@ -14,6 +14,10 @@ int main(int argc, char** argv)
 	cxxopts::Options options("RoseGarden", "My little rendering engine");
 
 	options.allow_unrecognised_options();
+	options.add_options("Jobs")
+		("job-workers", "Worker threads of the job system, 0 takes one per hardware thread but the main one", cxxopts::value<uint32_t>()->default_value("0"))
+		("pin-workers", "Pins every job worker to a core of its own")
+		;
 
 	auto app = Roses::CreateApplication();
 
@@ -21,7 +25,11 @@ int main(int argc, char** argv)
 
 	auto result = options.parse(argc, argv);
 
-	app->Init();
+	Roses::JobSystemDesc jobs;
+	jobs.WorkerCount = result["job-workers"].as<uint32_t>();
+	jobs.PinWorkers = result.count("pin-workers") > 0;
+
+	app->Init(jobs);
 	app->OnInit(result);
 	app->Run();
 
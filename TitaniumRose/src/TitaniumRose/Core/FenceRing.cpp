@@ -0,0 +1,84 @@
+#include "trpch.h"
+#include "TitaniumRose/Core/FenceRing.h"
+
+namespace Roses
+{
+    FenceRing::FenceRing(size_t capacity)
+    {
+        Reset(capacity);
+    }
+
+    void FenceRing::Reset(size_t capacity)
+    {
+        m_Capacity = capacity;
+        m_Head = 0;
+        m_Tail = 0;
+        // Ids stay unique, a region forgotten here can not be confused with a later one
+        m_FirstRegionId += m_Regions.size();
+        m_Regions.clear();
+    }
+
+    size_t FenceRing::Allocate(size_t size, size_t alignment)
+    {
+        HZ_CORE_ASSERT(alignment > 0, "Alignment cannot be 0");
+
+        if (size == 0 || size > m_Capacity)
+        {
+            ++m_Stats.Denied;
+            return InvalidOffset;
+        }
+
+        size_t offset = static_cast<size_t>(m_Head % m_Capacity);
+        size_t start = (offset + alignment - 1) / alignment * alignment;
+
+        // Skip to the start of the ring rather than split the range
+        if (start + size > m_Capacity)
+            start = 0;
+
+        uint64_t skipped = start >= offset ? start - offset : m_Capacity - offset;
+        uint64_t head = m_Head + skipped + size;
+        if (head - m_Tail > m_Capacity)
+        {
+            ++m_Stats.Denied;
+            return InvalidOffset;
+        }
+
+        if (start < offset)
+        {
+            ++m_Stats.Wraps;
+            m_Stats.Skipped += skipped;
+        }
+
+        m_Head = head;
+        ++m_Stats.Allocations;
+        m_Stats.HighWater = std::max(m_Stats.HighWater, GetUsed());
+        return start;
+    }
+
+    uint64_t FenceRing::Submit()
+    {
+        Region region;
+        region.End = m_Head;
+        m_Regions.push_back(region);
+        return m_FirstRegionId + m_Regions.size() - 1;
+    }
+
+    void FenceRing::Close(uint64_t regionId, uint64_t fenceValue)
+    {
+        HZ_CORE_ASSERT(regionId >= m_FirstRegionId && regionId - m_FirstRegionId < m_Regions.size(), "The region is not in flight");
+
+        Region& region = m_Regions[static_cast<size_t>(regionId - m_FirstRegionId)];
+        HZ_CORE_ASSERT(!region.Closed, "The region was closed twice");
+        region.FenceValue = fenceValue;
+        region.Closed = true;
+    }
+
+    bool FenceRing::GetOldestFence(uint64_t& fenceValue) const
+    {
+        if (m_Regions.empty() || !m_Regions.front().Closed)
+            return false;
+
+        fenceValue = m_Regions.front().FenceValue;
+        return true;
+    }
+}
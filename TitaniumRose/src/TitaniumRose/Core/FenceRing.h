@@ -0,0 +1,125 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+namespace Roses
+{
+    struct FenceRingStats
+    {
+        uint64_t Allocations = 0;
+        uint64_t Denied = 0;
+        uint64_t Wraps = 0;
+        // Left at the end of the ring by the wraps, reclaimed with the region that wrapped
+        uint64_t Skipped = 0;
+        uint64_t Retired = 0;
+        // The most units that were ever waiting on the GPU at once
+        size_t HighWater = 0;
+    };
+
+    /// <summary>
+    /// The ring arithmetic shared by the memory the CPU fills and the GPU consumes, counted in
+    /// whatever unit the owner uses, bytes or descriptor slots. Allocating bumps a head, what
+    /// was allocated since the previous region is submitted as a region of its own and closed
+    /// with a fence value later, in any order. The tail only moves in submission order: it
+    /// stops at the oldest region that is open or whose fence has not completed. Fence values
+    /// are only ever compared through the predicate given to Retire, so any fence, or a mock of
+    /// one, can drive it.
+    /// </summary>
+    class FenceRing
+    {
+    public:
+        static constexpr size_t InvalidOffset = size_t(-1);
+
+        FenceRing(size_t capacity = 0);
+
+        /// <summary>
+        /// Forgets every region, for when the GPU is known to be idle.
+        /// </summary>
+        void Reset(size_t capacity);
+
+        /// <summary>
+        /// Moves the head past size units. A range never wraps around the end of the ring, the
+        /// units left there are skipped instead.
+        /// </summary>
+        /// <returns>The offset of the range, or InvalidOffset if the regions in flight leave no room</returns>
+        size_t Allocate(size_t size, size_t alignment = 1);
+
+        /// <summary>
+        /// Starts tracking what was allocated since the previous region, open until Close.
+        /// </summary>
+        /// <returns>The id of the region, ids are handed out in order</returns>
+        uint64_t Submit();
+
+        /// <summary>
+        /// Closes a region, its units are reused once fenceValue completed and every region
+        /// submitted before it retired.
+        /// </summary>
+        void Close(uint64_t regionId, uint64_t fenceValue);
+
+        /// <summary>
+        /// Moves the tail past the oldest regions that are closed and whose fence completed.
+        /// </summary>
+        /// <param name="isComplete">bool(uint64_t fenceValue)</param>
+        /// <param name="onRetired">void(uint64_t regionId), called before the region's units can be reused</param>
+        /// <returns>The number of regions retired</returns>
+        template<typename IsCompleteFn, typename RetireFn>
+        uint32_t Retire(IsCompleteFn isComplete, RetireFn onRetired)
+        {
+            uint32_t retired = 0;
+            while (!m_Regions.empty() && m_Regions.front().Closed && isComplete(m_Regions.front().FenceValue))
+            {
+                onRetired(m_FirstRegionId);
+                m_Tail = m_Regions.front().End;
+                m_Regions.pop_front();
+                ++m_FirstRegionId;
+                ++retired;
+            }
+            m_Stats.Retired += retired;
+            return retired;
+        }
+
+        template<typename IsCompleteFn>
+        uint32_t Retire(IsCompleteFn isComplete)
+        {
+            return Retire(isComplete, [](uint64_t) {});
+        }
+
+        /// <summary>
+        /// The fence to wait on before the oldest region can be retired.
+        /// </summary>
+        /// <returns>False if no region is in flight or the oldest one is still open</returns>
+        bool GetOldestFence(uint64_t& fenceValue) const;
+
+        /// <summary>
+        /// Whether anything was allocated since the last region was submitted.
+        /// </summary>
+        inline bool HasUnsubmitted() const { return m_Head != (m_Regions.empty() ? m_Tail : m_Regions.back().End); }
+
+        inline size_t GetCapacity() const { return m_Capacity; }
+        inline size_t GetUsed() const { return static_cast<size_t>(m_Head - m_Tail); }
+        inline uint32_t GetRegionsInFlight() const { return static_cast<uint32_t>(m_Regions.size()); }
+        inline bool IsEmpty() const { return m_Regions.empty(); }
+        inline const FenceRingStats& GetStats() const { return m_Stats; }
+
+    private:
+        struct Region
+        {
+            // Where the head was when the region was submitted, the tail moves there once it retires
+            uint64_t End = 0;
+            uint64_t FenceValue = 0;
+            bool Closed = false;
+        };
+
+        size_t m_Capacity = 0;
+
+        // Positions only ever grow, the unit is the position modulo the capacity
+        uint64_t m_Head = 0;
+        uint64_t m_Tail = 0;
+
+        std::deque<Region> m_Regions;
+        // The id of m_Regions.front()
+        uint64_t m_FirstRegionId = 0;
+        FenceRingStats m_Stats;
+    };
+}
@@ -0,0 +1,22 @@
+#include "trpch.h"
+#include "TitaniumRose/Core/FramePipeline.h"
+
+namespace Roses
+{
+    FramePipeline::FramePipeline(uint32_t framesInFlight)
+        : m_SlotFences(framesInFlight, 0)
+    {
+        HZ_CORE_ASSERT(framesInFlight > 0, "At least one frame has to be in flight");
+    }
+
+    void FramePipeline::EndFrame(uint64_t fenceValue)
+    {
+        HZ_CORE_ASSERT(m_InFrame, "No frame was started");
+
+        m_SlotFences[m_CurrentSlot] = fenceValue;
+        m_LastFence = fenceValue;
+        ++m_FrameIndex;
+        ++m_Stats.Frames;
+        m_InFrame = false;
+    }
+}
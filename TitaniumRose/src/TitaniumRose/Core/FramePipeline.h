@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace Roses
+{
+    struct FramePipelineStats
+    {
+        uint64_t Frames = 0;
+        // Frames that found their slot still on the GPU and had to wait for it
+        uint64_t Waits = 0;
+    };
+
+    /// <summary>
+    /// Keeps the CPU at most a fixed number of frames ahead of the GPU. Every frame in flight
+    /// owns a slot, the per-frame resources indexed by it are only reused once the fence the
+    /// slot's previous frame ended with completed.
+    /// </summary>
+    class FramePipeline
+    {
+    public:
+        FramePipeline(uint32_t framesInFlight);
+
+        /// <summary>
+        /// Starts the next frame in the next slot, waiting for the frame that used the slot
+        /// before if the GPU is not done with it.
+        /// </summary>
+        /// <param name="isComplete">bool(uint64_t fenceValue)</param>
+        /// <param name="waitForFence">void(uint64_t fenceValue), blocks until the fence completed</param>
+        /// <returns>The slot of the frame</returns>
+        template<typename IsCompleteFn, typename WaitFn>
+        uint32_t BeginFrame(IsCompleteFn isComplete, WaitFn waitForFence)
+        {
+            HZ_CORE_ASSERT(!m_InFrame, "The previous frame did not end");
+
+            m_CurrentSlot = static_cast<uint32_t>(m_FrameIndex % m_SlotFences.size());
+            uint64_t& fence = m_SlotFences[m_CurrentSlot];
+            if (fence != 0 && !isComplete(fence))
+            {
+                waitForFence(fence);
+                ++m_Stats.Waits;
+            }
+            fence = 0;
+
+            m_InFrame = true;
+            return m_CurrentSlot;
+        }
+
+        /// <summary>
+        /// Ends the frame, fenceValue has to be signalled after all of its work.
+        /// </summary>
+        void EndFrame(uint64_t fenceValue);
+
+        /// <summary>
+        /// The number of ended frames the GPU has not finished yet.
+        /// </summary>
+        template<typename IsCompleteFn>
+        uint32_t GetFramesInFlight(IsCompleteFn isComplete) const
+        {
+            uint32_t count = 0;
+            for (uint64_t fence : m_SlotFences)
+            {
+                if (fence != 0 && !isComplete(fence))
+                    ++count;
+            }
+            return count;
+        }
+
+        inline uint32_t GetCurrentSlot() const { return m_CurrentSlot; }
+        inline uint32_t GetSlotCount() const { return static_cast<uint32_t>(m_SlotFences.size()); }
+        // The number of frames ended so far
+        inline uint64_t GetFrameIndex() const { return m_FrameIndex; }
+        // The fence of the last frame that ended, 0 before the first one
+        inline uint64_t GetLastFence() const { return m_LastFence; }
+        inline const FramePipelineStats& GetStats() const { return m_Stats; }
+
+    private:
+        // The fence each slot's last frame ended with, 0 once it has been waited for
+        std::vector<uint64_t> m_SlotFences;
+        uint32_t m_CurrentSlot = 0;
+        uint64_t m_FrameIndex = 0;
+        uint64_t m_LastFence = 0;
+        bool m_InFrame = false;
+        FramePipelineStats m_Stats;
+    };
+}
@@ -0,0 +1,13 @@
+#include "trpch.h"
+#include "TitaniumRose/Core/FrameRingAllocator.h"
+
+namespace Roses
+{
+    void FrameRingAllocator::EndFrame(uint64_t fenceValue)
+    {
+        if (!m_Ring.HasUnsubmitted())
+            return;
+
+        m_Ring.Close(m_Ring.Submit(), fenceValue);
+    }
+}
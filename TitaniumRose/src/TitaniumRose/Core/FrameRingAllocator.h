@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "TitaniumRose/Core/FenceRing.h"
+
+namespace Roses
+{
+    /// <summary>
+    /// A linear allocator for data that only lives for a frame. Allocating bumps the head of
+    /// a FenceRing of slots, nothing is freed on its own: the slots of a whole frame are one
+    /// region, reused at once when its fence completed.
+    /// </summary>
+    class FrameRingAllocator
+    {
+    public:
+        static constexpr size_t InvalidOffset = FenceRing::InvalidOffset;
+
+        FrameRingAllocator(size_t capacity = 0) : m_Ring(capacity) {}
+
+        /// <summary>
+        /// Drops every frame in flight, see FenceRing::Reset.
+        /// </summary>
+        inline void Reset(size_t capacity) { m_Ring.Reset(capacity); }
+
+        /// <summary>
+        /// Reserves count contiguous slots for the frame being recorded.
+        /// </summary>
+        /// <returns>The first slot, or InvalidOffset if the frames in flight fill the ring</returns>
+        inline size_t Allocate(size_t count, size_t alignment = 1) { return m_Ring.Allocate(count, alignment); }
+
+        /// <summary>
+        /// Closes the frame being recorded, its slots are reused once fenceValue is complete.
+        /// A frame that allocated nothing is not tracked.
+        /// </summary>
+        void EndFrame(uint64_t fenceValue);
+
+        /// <summary>
+        /// Frees the slots of the oldest frames whose fence completed.
+        /// </summary>
+        /// <param name="isComplete">bool(uint64_t fenceValue)</param>
+        /// <returns>The number of frames retired</returns>
+        template<typename IsCompleteFn>
+        uint32_t Retire(IsCompleteFn isComplete) { return m_Ring.Retire(isComplete); }
+
+        inline size_t GetCapacity() const { return m_Ring.GetCapacity(); }
+        inline size_t GetUsedCount() const { return m_Ring.GetUsed(); }
+        inline uint32_t GetFramesInFlight() const { return m_Ring.GetRegionsInFlight(); }
+        inline const FenceRingStats& GetStats() const { return m_Ring.GetStats(); }
+
+    private:
+        FenceRing m_Ring;
+    };
+}
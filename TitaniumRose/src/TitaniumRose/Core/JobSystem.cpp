@@ -0,0 +1,239 @@
+#include "trpch.h"
+#include "TitaniumRose/Core/JobSystem.h"
+
+#ifdef HZ_PLATFORM_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace Roses
+{
+    // The system the calling thread is a worker of, and its index there
+    static thread_local JobSystem* t_JobSystem = nullptr;
+    static thread_local uint32_t t_WorkerIndex = 0;
+
+    JobSystem::JobSystem(const JobSystemDesc& desc)
+    {
+        uint32_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+        uint32_t workerCount = desc.WorkerCount > 0 ? desc.WorkerCount : std::max(hardwareThreads - 1, 1u);
+
+        // Every deque exists before the first worker can steal from it
+        for (uint32_t i = 0; i < workerCount; i++)
+            m_Deques.push_back(std::make_unique<WorkStealingDeque<Job*>>());
+
+        for (uint32_t i = 0; i < workerCount; i++)
+        {
+            m_Workers.emplace_back(&JobSystem::WorkerMain, this, i);
+            if (desc.PinWorkers)
+                PinToCore(m_Workers.back(), (i + 1) % hardwareThreads);
+        }
+    }
+
+    JobSystem::~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_SleepMutex);
+            m_Running.store(false);
+        }
+        m_WakeUp.notify_all();
+
+        for (auto& worker : m_Workers)
+            worker.join();
+    }
+
+    void JobSystem::Schedule(std::function<void()> function, JobCounter* counter, JobCounter* dependency)
+    {
+        Job* job = new Job{ std::move(function), counter };
+        if (counter)
+            counter->m_Count.fetch_add(1);
+
+        if (dependency)
+        {
+            std::lock_guard<std::mutex> lock(dependency->m_Mutex);
+            if (dependency->m_Count.load() != 0)
+            {
+                dependency->m_Waiting.push_back(job);
+                return;
+            }
+        }
+
+        Enqueue(job);
+    }
+
+    void JobSystem::Wait(JobCounter& counter)
+    {
+        while (!counter.IsDone())
+        {
+            Job* job = FindJob();
+            if (job)
+            {
+                m_HelpedJobs.fetch_add(1, std::memory_order_relaxed);
+                Run(job);
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        // The job that brought the counter to zero may still hold its lock, the counter can be
+        // destroyed once it let go
+        std::lock_guard<std::mutex> lock(counter.m_Mutex);
+    }
+
+    size_t JobSystem::GetJobCount(size_t count, size_t minItemsPerJob) const
+    {
+        if (count == 0)
+            return 0;
+
+        size_t threads = m_Workers.size() + 1;
+        return std::clamp<size_t>(count / std::max<size_t>(minItemsPerJob, 1), 1, threads);
+    }
+
+    bool JobSystem::IsWorkerThread() const
+    {
+        return t_JobSystem == this;
+    }
+
+    JobSystemStats JobSystem::GetStats() const
+    {
+        JobSystemStats stats;
+        stats.Jobs = m_Jobs.load(std::memory_order_relaxed);
+        stats.Steals = m_Steals.load(std::memory_order_relaxed);
+        stats.HelpedJobs = m_HelpedJobs.load(std::memory_order_relaxed);
+        stats.Sleeps = m_Sleeps.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    void JobSystem::WorkerMain(uint32_t index)
+    {
+        t_JobSystem = this;
+        t_WorkerIndex = index;
+
+        while (true)
+        {
+            Job* job = FindJob();
+            if (job)
+            {
+                Run(job);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_SleepMutex);
+            if (!m_Running.load() && m_Pending.load() == 0)
+                break;
+
+            // Schedule reads m_Sleeping after it counted the job, so either it sees this worker
+            // and wakes it or the predicate sees the job
+            m_Sleeping.fetch_add(1);
+            if (m_Pending.load() == 0 && m_Running.load())
+                m_Sleeps.fetch_add(1, std::memory_order_relaxed);
+            m_WakeUp.wait(lock, [this]() { return m_Pending.load() > 0 || !m_Running.load(); });
+            m_Sleeping.fetch_sub(1);
+        }
+
+        t_JobSystem = nullptr;
+    }
+
+    void JobSystem::Enqueue(Job* job)
+    {
+        if (IsWorkerThread())
+        {
+            m_Deques[t_WorkerIndex]->Push(job);
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(m_QueueMutex);
+            m_Queue.push_back(job);
+        }
+
+        m_Pending.fetch_add(1);
+        if (m_Sleeping.load() > 0)
+        {
+            // Taking the lock orders this after a worker that is about to wait checked the predicate
+            { std::lock_guard<std::mutex> lock(m_SleepMutex); }
+            m_WakeUp.notify_one();
+        }
+    }
+
+    Job* JobSystem::FindJob()
+    {
+        Job* job = nullptr;
+        bool isWorker = IsWorkerThread();
+
+        if (isWorker && m_Deques[t_WorkerIndex]->Pop(job))
+        {
+            m_Pending.fetch_sub(1);
+            return job;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_QueueMutex);
+            if (!m_Queue.empty())
+            {
+                job = m_Queue.front();
+                m_Queue.pop_front();
+                m_Pending.fetch_sub(1);
+                return job;
+            }
+        }
+
+        // Start with the next worker so the thieves spread over the deques
+        size_t numDeques = m_Deques.size();
+        size_t start = isWorker ? t_WorkerIndex + 1 : 0;
+        for (size_t i = 0; i < numDeques; i++)
+        {
+            size_t victim = (start + i) % numDeques;
+            if (isWorker && victim == t_WorkerIndex)
+                continue;
+
+            if (m_Deques[victim]->Steal(job))
+            {
+                m_Pending.fetch_sub(1);
+                m_Steals.fetch_add(1, std::memory_order_relaxed);
+                return job;
+            }
+        }
+        return nullptr;
+    }
+
+    void JobSystem::Run(Job* job)
+    {
+        job->Function();
+        m_Jobs.fetch_add(1, std::memory_order_relaxed);
+
+        JobCounter* counter = job->Counter;
+        delete job;
+
+        if (counter == nullptr)
+            return;
+
+        // Only the job that may bring the counter to zero takes the lock
+        uint32_t count = counter->m_Count.load();
+        while (count > 1 && !counter->m_Count.compare_exchange_weak(count, count - 1)) {}
+        if (count > 1)
+            return;
+
+        // Counting down under the lock keeps Schedule from parking a job on a counter that is done
+        std::vector<Job*> waiting;
+        {
+            std::lock_guard<std::mutex> lock(counter->m_Mutex);
+            if (counter->m_Count.fetch_sub(1) == 1)
+                waiting.swap(counter->m_Waiting);
+        }
+        for (Job* dependent : waiting)
+            Enqueue(dependent);
+    }
+
+    void JobSystem::PinToCore(std::thread& thread, uint32_t core)
+    {
+#if defined(HZ_PLATFORM_WINDOWS)
+        SetThreadAffinityMask(thread.native_handle(), DWORD_PTR(1) << core);
+#elif defined(HZ_PLATFORM_LINUX)
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(core, &cpus);
+        pthread_setaffinity_np(thread.native_handle(), sizeof(cpus), &cpus);
+#endif
+    }
+}
@@ -0,0 +1,169 @@
+#pragma once
+#include "TitaniumRose/Core/WorkStealingDeque.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Roses
+{
+    class JobCounter;
+
+    struct JobSystemDesc
+    {
+        // 0 takes a worker for every hardware thread but the one of the creating thread
+        uint32_t WorkerCount = 0;
+        // Worker i only runs on core i + 1, which leaves core 0 to the creating thread
+        bool PinWorkers = false;
+    };
+
+    struct JobSystemStats
+    {
+        uint64_t Jobs = 0;
+        // Jobs taken from the deque of another worker
+        uint64_t Steals = 0;
+        // Jobs run by threads waiting on a counter
+        uint64_t HelpedJobs = 0;
+        // Times a worker found nothing to do and went to sleep
+        uint64_t Sleeps = 0;
+    };
+
+    struct Job
+    {
+        std::function<void()> Function;
+        // Counted down once the function returned, may be null
+        JobCounter* Counter;
+    };
+
+    /// <summary>
+    /// Counts the jobs scheduled against it that did not finish yet. Jobs can depend on a
+    /// counter, they are only queued once it reaches zero. A counter has to outlive its jobs and
+    /// is only destroyed or reused once JobSystem::Wait returned for it.
+    /// </summary>
+    class JobCounter
+    {
+    public:
+        JobCounter() = default;
+        JobCounter(const JobCounter&) = delete;
+        JobCounter& operator=(const JobCounter&) = delete;
+
+        inline bool IsDone() const { return m_Count.load(std::memory_order_acquire) == 0; }
+        inline uint32_t GetCount() const { return m_Count.load(std::memory_order_acquire); }
+
+    private:
+        friend class JobSystem;
+
+        std::atomic<uint32_t> m_Count = 0;
+        // Guards m_Waiting against the counter reaching zero while a job is added to it
+        std::mutex m_Mutex;
+        std::vector<Job*> m_Waiting;
+    };
+
+    /// <summary>
+    /// Runs jobs on a fixed set of workers. Every worker owns a work stealing deque: the jobs a
+    /// worker schedules go to its own deque and are run newest first, idle workers steal the
+    /// oldest jobs of the others. Jobs scheduled from other threads go through a shared queue.
+    /// Jobs should be short and must not block on anything but a counter, since a thread that
+    /// waits on a counter runs queued jobs in the meantime.
+    /// </summary>
+    class JobSystem
+    {
+    public:
+        JobSystem(const JobSystemDesc& desc = {});
+        // Runs the jobs still queued before the workers exit
+        ~JobSystem();
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        /// <summary>
+        /// Queues function, or parks it on dependency until that counter reaches zero.
+        /// </summary>
+        /// <param name="counter">Counted up now and down once the function returned, may be null</param>
+        /// <param name="dependency">The counter the job waits for, may be null</param>
+        void Schedule(std::function<void()> function, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+
+        /// <summary>
+        /// Runs queued jobs on the calling thread until the counter reaches zero.
+        /// </summary>
+        void Wait(JobCounter& counter);
+
+        // The number of jobs ParallelFor splits count items into
+        size_t GetJobCount(size_t count, size_t minItemsPerJob) const;
+
+        /// <summary>
+        /// Calls fn(begin, end) over contiguous ranges covering [0, count) in parallel, the
+        /// calling thread takes the first range. Returns once every range is done.
+        /// </summary>
+        /// <param name="minItemsPerJob">Fewer items are not worth a job of their own</param>
+        template<typename Fn>
+        void ParallelFor(size_t count, size_t minItemsPerJob, Fn fn)
+        {
+            size_t numJobs = GetJobCount(count, minItemsPerJob);
+            if (numJobs <= 1)
+            {
+                if (count > 0)
+                    fn(size_t(0), count);
+                return;
+            }
+
+            // The first count % numJobs ranges take one item more
+            size_t perJob = count / numJobs;
+            size_t remainder = count % numJobs;
+            size_t firstEnd = perJob + (remainder > 0 ? 1 : 0);
+
+            JobCounter counter;
+            size_t begin = firstEnd;
+            for (size_t i = 1; i < numJobs; i++)
+            {
+                size_t end = begin + perJob + (i < remainder ? 1 : 0);
+                Schedule([&fn, begin, end]() { fn(begin, end); }, &counter);
+                begin = end;
+            }
+
+            fn(size_t(0), firstEnd);
+            Wait(counter);
+        }
+
+        inline uint32_t GetWorkerCount() const { return static_cast<uint32_t>(m_Workers.size()); }
+        // Whether the calling thread is one of this system's workers
+        bool IsWorkerThread() const;
+        JobSystemStats GetStats() const;
+
+    private:
+        void WorkerMain(uint32_t index);
+        void Enqueue(Job* job);
+        // Takes a job from the own deque, the shared queue or another worker, in that order
+        Job* FindJob();
+        void Run(Job* job);
+
+        static void PinToCore(std::thread& thread, uint32_t core);
+
+        std::vector<std::unique_ptr<WorkStealingDeque<Job*>>> m_Deques;
+        std::vector<std::thread> m_Workers;
+
+        // Jobs scheduled from threads that are not workers
+        std::mutex m_QueueMutex;
+        std::deque<Job*> m_Queue;
+
+        std::mutex m_SleepMutex;
+        std::condition_variable m_WakeUp;
+        // Jobs queued and not taken yet, workers only sleep while it is zero
+        std::atomic<size_t> m_Pending = 0;
+        std::atomic<uint32_t> m_Sleeping = 0;
+        std::atomic<bool> m_Running = true;
+
+        std::atomic<uint64_t> m_Jobs = 0;
+        std::atomic<uint64_t> m_Steals = 0;
+        std::atomic<uint64_t> m_HelpedJobs = 0;
+        std::atomic<uint64_t> m_Sleeps = 0;
+    };
+}
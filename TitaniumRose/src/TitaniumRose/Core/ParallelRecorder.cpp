@@ -0,0 +1,39 @@
+#include "trpch.h"
+#include "TitaniumRose/Core/ParallelRecorder.h"
+
+#include <algorithm>
+
+namespace Roses
+{
+    ParallelRecorder::ParallelRecorder(size_t minItemsPerChunk, size_t maxChunks)
+        : m_MinItemsPerChunk(std::max<size_t>(minItemsPerChunk, 1)), m_MaxChunks(std::max<size_t>(maxChunks, 1))
+    {
+    }
+
+    size_t ParallelRecorder::GetChunkCount(size_t count) const
+    {
+        if (count == 0)
+            return 0;
+
+        return std::clamp<size_t>(count / m_MinItemsPerChunk, 1, m_MaxChunks);
+    }
+
+    std::vector<ParallelRecorder::Chunk> ParallelRecorder::Split(size_t count) const
+    {
+        size_t numChunks = GetChunkCount(count);
+
+        // The first count % numChunks chunks take one item more
+        std::vector<Chunk> chunks;
+        chunks.reserve(numChunks);
+        size_t perChunk = numChunks > 0 ? count / numChunks : 0;
+        size_t remainder = numChunks > 0 ? count % numChunks : 0;
+        size_t begin = 0;
+        for (size_t i = 0; i < numChunks; i++)
+        {
+            size_t size = perChunk + (i < remainder ? 1 : 0);
+            chunks.push_back({ begin, begin + size });
+            begin += size;
+        }
+        return chunks;
+    }
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include "TitaniumRose/Core/JobSystem.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <vector>
+
+namespace Roses
+{
+    struct ParallelRecorderStats
+    {
+        uint64_t Passes = 0;
+        // Passes that were split over more than one chunk
+        uint64_t ParallelPasses = 0;
+        uint64_t Chunks = 0;
+        uint64_t Items = 0;
+    };
+
+    /// <summary>
+    /// Splits the items of a pass into contiguous chunks that are recorded in parallel, each into
+    /// a command list of its own, and submitted in chunk order. A chunk is submitted as soon as it
+    /// and every chunk before it is recorded, so the draws execute in the order of the items no
+    /// matter which thread finished first. The recording itself is left to the callbacks, which
+    /// keeps this independent of the graphics API.
+    /// </summary>
+    class ParallelRecorder
+    {
+    public:
+        struct Chunk
+        {
+            size_t Begin;
+            size_t End;
+        };
+
+        /// <param name="minItemsPerChunk">Fewer items do not pay for a command list of their own</param>
+        /// <param name="maxChunks">Usually the number of hardware threads</param>
+        ParallelRecorder(size_t minItemsPerChunk, size_t maxChunks);
+
+        // The number of chunks count items are split into, 0 without items
+        size_t GetChunkCount(size_t count) const;
+        // Contiguous, ordered and about the same size
+        std::vector<Chunk> Split(size_t count) const;
+
+        /// <summary>
+        /// Records the chunks of count items, the calling thread takes the first one.
+        /// </summary>
+        /// <param name="record">void(size_t chunkIndex, const Chunk& chunk), called from any thread</param>
+        /// <param name="submit">void(size_t chunkIndex), called on the calling thread in chunk order</param>
+        /// <returns>The number of chunks</returns>
+        template<typename RecordFn, typename SubmitFn>
+        size_t Record(size_t count, RecordFn record, SubmitFn submit)
+        {
+            std::vector<Chunk> chunks = Split(count);
+
+            ++m_Stats.Passes;
+            m_Stats.Chunks += chunks.size();
+            m_Stats.Items += count;
+            if (chunks.size() > 1)
+                ++m_Stats.ParallelPasses;
+
+            if (m_JobSystem)
+            {
+                // A counter per chunk, so chunk i is submitted as soon as it is recorded
+                std::vector<JobCounter> counters(chunks.size());
+                for (size_t i = 1; i < chunks.size(); i++)
+                {
+                    m_JobSystem->Schedule([&record, &chunks, i]() { record(i, chunks[i]); }, &counters[i]);
+                }
+
+                if (!chunks.empty())
+                {
+                    record(0, chunks[0]);
+                    submit(0);
+                }
+
+                for (size_t i = 1; i < chunks.size(); i++)
+                {
+                    m_JobSystem->Wait(counters[i]);
+                    submit(i);
+                }
+                return chunks.size();
+            }
+
+            std::vector<std::future<void>> tasks;
+            tasks.reserve(chunks.size());
+            for (size_t i = 1; i < chunks.size(); i++)
+            {
+                tasks.push_back(std::async(std::launch::async, [&record, &chunks, i]() { record(i, chunks[i]); }));
+            }
+
+            if (!chunks.empty())
+            {
+                record(0, chunks[0]);
+                submit(0);
+            }
+
+            for (size_t i = 1; i < chunks.size(); i++)
+            {
+                tasks[i - 1].get();
+                submit(i);
+            }
+            return chunks.size();
+        }
+
+        // The chunks run as jobs when a job system is set, on std::async otherwise
+        inline void SetJobSystem(JobSystem* jobSystem) { m_JobSystem = jobSystem; }
+
+        inline size_t GetMinItemsPerChunk() const { return m_MinItemsPerChunk; }
+        inline size_t GetMaxChunks() const { return m_MaxChunks; }
+        inline const ParallelRecorderStats& GetStats() const { return m_Stats; }
+        inline void ResetStats() { m_Stats = {}; }
+
+    private:
+        size_t m_MinItemsPerChunk;
+        size_t m_MaxChunks;
+        JobSystem* m_JobSystem = nullptr;
+        ParallelRecorderStats m_Stats;
+    };
+}
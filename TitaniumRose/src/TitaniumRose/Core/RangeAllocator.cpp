@@ -0,0 +1,253 @@
+#include "trpch.h"
+#include "TitaniumRose/Core/RangeAllocator.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace Roses
+{
+    static inline uint32_t FindFirstSet(uint32_t word)
+    {
+#ifdef _MSC_VER
+        unsigned long index = 0;
+        _BitScanForward(&index, word);
+        return static_cast<uint32_t>(index);
+#else
+        return static_cast<uint32_t>(__builtin_ctz(word));
+#endif
+    }
+
+    static inline uint32_t FindLastSet(uint64_t word)
+    {
+#ifdef _MSC_VER
+        unsigned long index = 0;
+        _BitScanReverse64(&index, word);
+        return static_cast<uint32_t>(index);
+#else
+        return 63 - static_cast<uint32_t>(__builtin_clzll(word));
+#endif
+    }
+
+    // The bits of word wordIndex that fall in [start, end)
+    static inline uint64_t WordMask(size_t wordIndex, size_t start, size_t end)
+    {
+        size_t low = std::max(start, wordIndex * 64) - wordIndex * 64;
+        size_t high = std::min(end, wordIndex * 64 + 64) - wordIndex * 64;
+        return (high - low == 64 ? ~uint64_t(0) : (uint64_t(1) << (high - low)) - 1) << low;
+    }
+
+    RangeAllocator::RangeAllocator(size_t size)
+    {
+        Reset(size);
+    }
+
+    void RangeAllocator::Reset(size_t size)
+    {
+        HZ_CORE_ASSERT(size < NoSlot, "Too many slots for a range allocator");
+
+        m_Size = size;
+        m_FreeCount = 0;
+        m_FreeRangeCount = 0;
+
+        m_RangeSize.assign(size, 0);
+        m_NextRange.assign(size, NoSlot);
+        m_PreviousRange.assign(size, NoSlot);
+        m_RangeStart.assign(size, NoSlot);
+        m_FreeSlots.assign((size + 63) / 64, 0);
+
+        m_ClassHeads.fill(NoSlot);
+        m_SecondLevelMasks.fill(0);
+        m_FirstLevelMask = 0;
+
+        if (size > 0)
+        {
+            SetSlotsFree(0, static_cast<uint32_t>(size), true);
+            AddRange(0, static_cast<uint32_t>(size));
+        }
+    }
+
+    size_t RangeAllocator::Allocate(size_t count)
+    {
+        if (count == 0 || count > m_FreeCount)
+            return InvalidOffset;
+
+        uint32_t start = FindRange(static_cast<uint32_t>(count));
+        if (start == NoSlot)
+            return InvalidOffset;
+
+        uint32_t size = m_RangeSize[start];
+        RemoveRange(start);
+        if (size > count)
+            AddRange(start + static_cast<uint32_t>(count), size - static_cast<uint32_t>(count));
+
+        SetSlotsFree(start, static_cast<uint32_t>(count), false);
+        return start;
+    }
+
+    bool RangeAllocator::Release(size_t offset, size_t count)
+    {
+        if (count == 0)
+            return true;
+
+        HZ_CORE_ASSERT(offset + count <= m_Size, "Released range is outside of the allocator");
+
+        uint32_t start = static_cast<uint32_t>(offset);
+        uint32_t end = static_cast<uint32_t>(offset + count);
+        if (AnySlotFree(start, end - start))
+            return false;
+
+        SetSlotsFree(start, end - start, true);
+
+        // A free range starting right after us, or ending right before us, is merged in
+        if (end < m_Size && m_RangeSize[end] != 0)
+        {
+            uint32_t next = end;
+            end += m_RangeSize[next];
+            RemoveRange(next);
+        }
+        if (start > 0 && m_RangeStart[start - 1] != NoSlot)
+        {
+            uint32_t previous = m_RangeStart[start - 1];
+            start = previous;
+            RemoveRange(previous);
+        }
+
+        AddRange(start, end - start);
+        return true;
+    }
+
+    size_t RangeAllocator::GetLargestFreeRange() const
+    {
+        if (m_FirstLevelMask == 0)
+            return 0;
+
+        uint32_t firstLevel = FindLastSet(m_FirstLevelMask);
+        uint32_t secondLevel = FindLastSet(m_SecondLevelMasks[firstLevel]);
+
+        uint32_t largest = 0;
+        for (uint32_t slot = m_ClassHeads[firstLevel * SecondLevelCount + secondLevel]; slot != NoSlot; slot = m_NextRange[slot])
+            largest = std::max(largest, m_RangeSize[slot]);
+        return largest;
+    }
+
+    uint32_t RangeAllocator::GetSizeClass(uint64_t size)
+    {
+        if (size < SecondLevelCount)
+            return static_cast<uint32_t>(size);
+
+        uint32_t log2 = FindLastSet(size);
+        uint32_t firstLevel = log2 - SecondLevelBits + 1;
+        uint32_t secondLevel = static_cast<uint32_t>(size >> (log2 - SecondLevelBits)) - SecondLevelCount;
+        return firstLevel * SecondLevelCount + secondLevel;
+    }
+
+    void RangeAllocator::AddRange(uint32_t start, uint32_t count)
+    {
+        uint32_t sizeClass = GetSizeClass(count);
+        uint32_t& head = m_ClassHeads[sizeClass];
+
+        m_RangeSize[start] = count;
+        m_RangeStart[start + count - 1] = start;
+        m_PreviousRange[start] = NoSlot;
+        m_NextRange[start] = head;
+        if (head != NoSlot)
+            m_PreviousRange[head] = start;
+        head = start;
+
+        m_SecondLevelMasks[sizeClass / SecondLevelCount] |= 1u << (sizeClass % SecondLevelCount);
+        m_FirstLevelMask |= 1u << (sizeClass / SecondLevelCount);
+
+        m_FreeCount += count;
+        ++m_FreeRangeCount;
+    }
+
+    void RangeAllocator::RemoveRange(uint32_t start)
+    {
+        uint32_t count = m_RangeSize[start];
+        uint32_t sizeClass = GetSizeClass(count);
+        uint32_t next = m_NextRange[start];
+        uint32_t previous = m_PreviousRange[start];
+
+        if (next != NoSlot)
+            m_PreviousRange[next] = previous;
+        if (previous != NoSlot)
+            m_NextRange[previous] = next;
+        else
+            m_ClassHeads[sizeClass] = next;
+
+        if (m_ClassHeads[sizeClass] == NoSlot)
+        {
+            uint32_t& secondLevelMask = m_SecondLevelMasks[sizeClass / SecondLevelCount];
+            secondLevelMask &= ~(1u << (sizeClass % SecondLevelCount));
+            if (secondLevelMask == 0)
+                m_FirstLevelMask &= ~(1u << (sizeClass / SecondLevelCount));
+        }
+
+        m_RangeSize[start] = 0;
+        m_RangeStart[start + count - 1] = NoSlot;
+        m_NextRange[start] = m_PreviousRange[start] = NoSlot;
+
+        m_FreeCount -= count;
+        --m_FreeRangeCount;
+    }
+
+    uint32_t RangeAllocator::FindRange(uint32_t count) const
+    {
+        // Rounding up to the next class boundary means any range of the class found is large enough
+        uint64_t rounded = count;
+        if (count >= SecondLevelCount)
+            rounded += (uint64_t(1) << (FindLastSet(count) - SecondLevelBits)) - 1;
+
+        uint32_t sizeClass = GetSizeClass(rounded);
+        uint32_t firstLevel = sizeClass / SecondLevelCount;
+        if (firstLevel < FirstLevelCount)
+        {
+            uint32_t secondLevelMask = m_SecondLevelMasks[firstLevel] & (~0u << (sizeClass % SecondLevelCount));
+            if (secondLevelMask == 0)
+            {
+                uint32_t firstLevelMask = m_FirstLevelMask & (~0u << (firstLevel + 1));
+                if (firstLevelMask != 0)
+                {
+                    firstLevel = FindFirstSet(firstLevelMask);
+                    secondLevelMask = m_SecondLevelMasks[firstLevel];
+                }
+            }
+
+            if (secondLevelMask != 0)
+                return m_ClassHeads[firstLevel * SecondLevelCount + FindFirstSet(secondLevelMask)];
+        }
+
+        // The rounding skipped count's own class, it can still hold a range that is large enough
+        for (uint32_t slot = m_ClassHeads[GetSizeClass(count)]; slot != NoSlot; slot = m_NextRange[slot])
+        {
+            if (m_RangeSize[slot] >= count)
+                return slot;
+        }
+
+        return NoSlot;
+    }
+
+    bool RangeAllocator::AnySlotFree(uint32_t start, uint32_t count) const
+    {
+        size_t end = size_t(start) + count;
+        for (size_t word = start / 64; word <= (end - 1) / 64; word++)
+        {
+            if (m_FreeSlots[word] & WordMask(word, start, end))
+                return true;
+        }
+        return false;
+    }
+
+    void RangeAllocator::SetSlotsFree(uint32_t start, uint32_t count, bool free)
+    {
+        size_t end = size_t(start) + count;
+        for (size_t word = start / 64; word <= (end - 1) / 64; word++)
+        {
+            if (free)
+                m_FreeSlots[word] |= WordMask(word, start, end);
+            else
+                m_FreeSlots[word] &= ~WordMask(word, start, end);
+        }
+    }
+}
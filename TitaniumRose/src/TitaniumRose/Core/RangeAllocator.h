@@ -0,0 +1,87 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Roses
+{
+    /// <summary>
+    /// Hands out contiguous ranges of a fixed size space, such as the slots of a descriptor
+    /// heap. This is a two-level segregated fit (TLSF) allocator: free ranges are kept in
+    /// lists by size class, with a bitmask over the lists, and tagged at both ends so a
+    /// released range finds its free neighbours directly. Finding, splitting and merging
+    /// ranges is constant time, except when no class above the one count falls in has a
+    /// range: that class is then walked, O(ranges in the class). Both calls also update a
+    /// bit per slot, O(count / 64), and neither touches the system allocator.
+    /// </summary>
+    class RangeAllocator
+    {
+    public:
+        static constexpr size_t InvalidOffset = size_t(-1);
+
+        RangeAllocator(size_t size = 0);
+
+        /// <summary>
+        /// Forgets every allocation, the whole space becomes a single free range.
+        /// </summary>
+        void Reset(size_t size);
+
+        /// <summary>
+        /// Good-fit, a range from the smallest size class that is sure to hold count slots
+        /// is split, falling back to the first large enough range of count's own class.
+        /// Only fails if no free range is large enough.
+        /// </summary>
+        /// <returns>The first slot of the range, or InvalidOffset if no free range is large enough</returns>
+        size_t Allocate(size_t count);
+
+        /// <summary>
+        /// Gives a range back, merging it with the free ranges on either side.
+        /// </summary>
+        /// <returns>False if part of the range was already free, nothing is changed then</returns>
+        bool Release(size_t offset, size_t count);
+
+        inline size_t GetSize() const { return m_Size; }
+        inline size_t GetFreeCount() const { return m_FreeCount; }
+        inline size_t GetFreeRangeCount() const { return m_FreeRangeCount; }
+
+        /// <summary>
+        /// Walks the largest non-empty size class, meant for diagnostics.
+        /// </summary>
+        size_t GetLargestFreeRange() const;
+
+    private:
+        // Sizes below 2^SecondLevelBits get a class each, larger ones split every power of two
+        // into 2^SecondLevelBits classes
+        static constexpr uint32_t SecondLevelBits = 4;
+        static constexpr uint32_t SecondLevelCount = 1 << SecondLevelBits;
+        static constexpr uint32_t FirstLevelCount = 32 - SecondLevelBits + 1;
+        static constexpr uint32_t NoSlot = UINT32_MAX;
+
+        static uint32_t GetSizeClass(uint64_t size);
+
+        void AddRange(uint32_t start, uint32_t count);
+        void RemoveRange(uint32_t start);
+        uint32_t FindRange(uint32_t count) const;
+
+        bool AnySlotFree(uint32_t start, uint32_t count) const;
+        void SetSlotsFree(uint32_t start, uint32_t count, bool free);
+
+        // Indexed by the first slot of a free range, 0 for any other slot
+        std::vector<uint32_t> m_RangeSize;
+        std::vector<uint32_t> m_NextRange;
+        std::vector<uint32_t> m_PreviousRange;
+        // Indexed by the last slot of a free range, its first slot. NoSlot for any other slot.
+        std::vector<uint32_t> m_RangeStart;
+        // A bit per slot, set when the slot is free, to catch ranges released twice
+        std::vector<uint64_t> m_FreeSlots;
+
+        std::array<uint32_t, FirstLevelCount * SecondLevelCount> m_ClassHeads;
+        std::array<uint32_t, FirstLevelCount> m_SecondLevelMasks;
+        uint32_t m_FirstLevelMask = 0;
+
+        size_t m_Size = 0;
+        size_t m_FreeCount = 0;
+        size_t m_FreeRangeCount = 0;
+    };
+}
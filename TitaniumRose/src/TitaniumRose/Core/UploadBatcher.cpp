@@ -0,0 +1,71 @@
+#include "trpch.h"
+#include "TitaniumRose/Core/UploadBatcher.h"
+
+#include <algorithm>
+
+namespace Roses
+{
+    UploadBatcher::UploadBatcher(size_t stagingBudget, size_t maxBatchBytes, uint32_t maxBatchRequests)
+        : m_Staging(stagingBudget), m_MaxBatchBytes(maxBatchBytes), m_MaxBatchRequests(maxBatchRequests)
+    {
+        HZ_CORE_ASSERT(maxBatchRequests > 0, "A batch has to hold at least one request");
+    }
+
+    UploadBatcher::Reservation UploadBatcher::Reserve(size_t size, size_t alignment)
+    {
+        Reservation reservation;
+
+        UploadRing::Block block = m_Staging.Allocate(size, alignment);
+        if (!block.IsValid())
+        {
+            ++m_Stats.Denied;
+            return reservation;
+        }
+
+        m_OpenBlocks.push_back(block.Id);
+        m_OpenBytes += size;
+
+        reservation.Ticket = m_NextTicket++;
+        reservation.Offset = block.Offset;
+        reservation.Size = size;
+
+        ++m_Stats.Requests;
+        m_Stats.BytesStaged += size;
+        return reservation;
+    }
+
+    uint64_t UploadBatcher::CloseBatch(uint64_t fenceValue)
+    {
+        if (m_OpenBlocks.empty())
+            return 0;
+
+        for (uint64_t blockId : m_OpenBlocks)
+            m_Staging.Close(blockId, fenceValue);
+        m_OpenBlocks.clear();
+        m_OpenBytes = 0;
+
+        Batch batch;
+        batch.LastTicket = m_NextTicket - 1;
+        batch.FenceValue = fenceValue;
+        m_Batches.push_back(batch);
+        m_FirstOpenTicket = m_NextTicket;
+
+        ++m_Stats.Batches;
+        return batch.LastTicket;
+    }
+
+    bool UploadBatcher::GetFence(uint64_t ticket, uint64_t& fenceValue) const
+    {
+        if (IsComplete(ticket) || !IsSubmitted(ticket))
+            return false;
+
+        // The first batch that ends at or after the ticket carries it
+        auto batch = std::lower_bound(m_Batches.begin(), m_Batches.end(), ticket,
+            [](const Batch& b, uint64_t t) { return b.LastTicket < t; });
+        if (batch == m_Batches.end())
+            return false;
+
+        fenceValue = batch->FenceValue;
+        return true;
+    }
+}
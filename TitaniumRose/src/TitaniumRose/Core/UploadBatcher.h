@@ -0,0 +1,123 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "TitaniumRose/Core/UploadRing.h"
+
+namespace Roses
+{
+    struct UploadBatcherStats
+    {
+        uint64_t Requests = 0;
+        uint64_t Batches = 0;
+        uint64_t BytesStaged = 0;
+        // Reservations the staging budget had no room for
+        uint64_t Denied = 0;
+    };
+
+    /// <summary>
+    /// The bookkeeping of uploads that are recorded on a copy queue in batches. Every request
+    /// gets a ticket and its own range of the staging budget, the open batch is closed with
+    /// the fence of the command list that carries it. Batches complete in the order they were
+    /// closed, so a ticket is complete once every batch up to its own is.
+    /// </summary>
+    class UploadBatcher
+    {
+    public:
+        struct Reservation
+        {
+            uint64_t Ticket = 0;
+            size_t Offset = UploadRing::InvalidOffset;
+            size_t Size = 0;
+
+            inline bool IsValid() const { return Offset != UploadRing::InvalidOffset; }
+        };
+
+        /// <param name="stagingBudget">The bytes of staging memory the requests in flight can use</param>
+        /// <param name="maxBatchBytes">A batch is full once its requests staged this many bytes</param>
+        /// <param name="maxBatchRequests">Or once it holds this many requests</param>
+        UploadBatcher(size_t stagingBudget, size_t maxBatchBytes, uint32_t maxBatchRequests);
+
+        /// <summary>
+        /// Adds a request to the open batch and reserves its staging range.
+        /// </summary>
+        /// <returns>An invalid reservation if the staging budget has no room for it</returns>
+        Reservation Reserve(size_t size, size_t alignment = 1);
+
+        /// <summary>
+        /// Closes the open batch, its requests complete once fenceValue did.
+        /// </summary>
+        /// <returns>The last ticket of the batch, 0 if the batch was empty</returns>
+        uint64_t CloseBatch(uint64_t fenceValue);
+
+        /// <summary>
+        /// Completes the oldest batches whose fence completed and releases their staging memory.
+        /// </summary>
+        /// <param name="isComplete">bool(uint64_t fenceValue)</param>
+        /// <returns>The number of batches completed</returns>
+        template<typename IsCompleteFn>
+        uint32_t Retire(IsCompleteFn isComplete)
+        {
+            m_Staging.Retire(isComplete);
+
+            uint32_t retired = 0;
+            while (!m_Batches.empty() && isComplete(m_Batches.front().FenceValue))
+            {
+                m_CompletedTicket = m_Batches.front().LastTicket;
+                m_Batches.pop_front();
+                ++retired;
+            }
+            return retired;
+        }
+
+        inline bool IsComplete(uint64_t ticket) const { return ticket <= m_CompletedTicket; }
+        // False while the ticket's batch is still open
+        inline bool IsSubmitted(uint64_t ticket) const { return ticket < m_FirstOpenTicket; }
+
+        /// <summary>
+        /// The fence a submitted ticket completes with.
+        /// </summary>
+        /// <returns>False if the ticket is complete or its batch is still open</returns>
+        bool GetFence(uint64_t ticket, uint64_t& fenceValue) const;
+
+        /// <summary>
+        /// The fence to wait on before the staging budget frees up.
+        /// </summary>
+        /// <returns>False if nothing is in flight or the oldest staging range is in the open batch</returns>
+        inline bool GetOldestFence(uint64_t& fenceValue) const { return m_Staging.GetOldestFence(fenceValue); }
+
+        inline bool HasOpenBatch() const { return !m_OpenBlocks.empty(); }
+        inline bool IsBatchFull() const { return m_OpenBytes >= m_MaxBatchBytes || m_OpenBlocks.size() >= m_MaxBatchRequests; }
+
+        inline size_t GetStagingBudget() const { return m_Staging.GetCapacity(); }
+        inline size_t GetStagedBytes() const { return m_Staging.GetUsedBytes(); }
+        inline size_t GetPeakStagedBytes() const { return m_Staging.GetStats().HighWater; }
+        inline size_t GetOpenBytes() const { return m_OpenBytes; }
+        inline uint32_t GetOpenRequests() const { return static_cast<uint32_t>(m_OpenBlocks.size()); }
+        inline uint32_t GetBatchesInFlight() const { return static_cast<uint32_t>(m_Batches.size()); }
+        inline const UploadBatcherStats& GetStats() const { return m_Stats; }
+
+    private:
+        struct Batch
+        {
+            uint64_t LastTicket;
+            uint64_t FenceValue;
+        };
+
+        UploadRing m_Staging;
+        size_t m_MaxBatchBytes;
+        uint32_t m_MaxBatchRequests;
+
+        // The staging blocks of the open batch
+        std::vector<uint64_t> m_OpenBlocks;
+        size_t m_OpenBytes = 0;
+
+        std::deque<Batch> m_Batches;
+        uint64_t m_NextTicket = 1;
+        uint64_t m_FirstOpenTicket = 1;
+        uint64_t m_CompletedTicket = 0;
+        UploadBatcherStats m_Stats;
+    };
+}
@@ -0,0 +1,17 @@
+#include "trpch.h"
+#include "TitaniumRose/Core/UploadRing.h"
+
+namespace Roses
+{
+    UploadRing::Block UploadRing::Allocate(size_t size, size_t alignment)
+    {
+        Block block;
+        block.Offset = m_Ring.Allocate(size, alignment);
+        if (!block.IsValid())
+            return block;
+
+        block.Id = m_Ring.Submit();
+        block.Size = size;
+        return block;
+    }
+}
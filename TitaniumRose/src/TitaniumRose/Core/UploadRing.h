@@ -0,0 +1,71 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "TitaniumRose/Core/FenceRing.h"
+
+namespace Roses
+{
+    /// <summary>
+    /// The bookkeeping of a ring of upload memory the CPU writes and the GPU reads. Unlike
+    /// FrameRingAllocator every block is a FenceRing region of its own, closed with the fence
+    /// of the command list that used it, since several contexts take blocks at once and finish
+    /// in any order.
+    /// </summary>
+    class UploadRing
+    {
+    public:
+        static constexpr size_t InvalidOffset = FenceRing::InvalidOffset;
+
+        struct Block
+        {
+            uint64_t Id = 0;
+            size_t Offset = InvalidOffset;
+            size_t Size = 0;
+
+            inline bool IsValid() const { return Offset != InvalidOffset; }
+        };
+
+        UploadRing(size_t capacity = 0) : m_Ring(capacity) {}
+
+        /// <summary>
+        /// Drops every block in flight, see FenceRing::Reset.
+        /// </summary>
+        inline void Reset(size_t capacity) { m_Ring.Reset(capacity); }
+
+        /// <summary>
+        /// Opens a block of size bytes.
+        /// </summary>
+        /// <returns>An invalid block if the blocks in flight leave no room</returns>
+        Block Allocate(size_t size, size_t alignment = 1);
+
+        /// <summary>
+        /// Closes a block, its bytes are reused once fenceValue completed and every block
+        /// opened before it was reclaimed.
+        /// </summary>
+        inline void Close(uint64_t blockId, uint64_t fenceValue) { m_Ring.Close(blockId, fenceValue); }
+
+        /// <summary>
+        /// Reclaims the oldest blocks that are closed and whose fence completed.
+        /// </summary>
+        /// <param name="isComplete">bool(uint64_t fenceValue)</param>
+        /// <returns>The number of blocks retired</returns>
+        template<typename IsCompleteFn>
+        uint32_t Retire(IsCompleteFn isComplete) { return m_Ring.Retire(isComplete); }
+
+        /// <summary>
+        /// The fence to wait on before the oldest block can be retired.
+        /// </summary>
+        /// <returns>False if the ring is empty or its oldest block is still open</returns>
+        inline bool GetOldestFence(uint64_t& fenceValue) const { return m_Ring.GetOldestFence(fenceValue); }
+
+        inline size_t GetCapacity() const { return m_Ring.GetCapacity(); }
+        inline size_t GetUsedBytes() const { return m_Ring.GetUsed(); }
+        inline uint32_t GetBlocksInFlight() const { return m_Ring.GetRegionsInFlight(); }
+        inline bool IsEmpty() const { return m_Ring.IsEmpty(); }
+        inline const FenceRingStats& GetStats() const { return m_Ring.GetStats(); }
+
+    private:
+        FenceRing m_Ring;
+    };
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace Roses
+{
+    /// <summary>
+    /// The Chase-Lev work stealing deque. Its owner pushes and pops at the bottom without a lock,
+    /// any other thread steals from the top. The ring doubles when it is full, the rings it
+    /// outgrew are kept until the deque is destroyed because a thief may still be reading one.
+    /// </summary>
+    template<typename T>
+    class WorkStealingDeque
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "The items are copied with plain atomics");
+
+    public:
+        /// <param name="capacity">Rounded up to a power of two</param>
+        WorkStealingDeque(size_t capacity = 256)
+        {
+            size_t rounded = 1;
+            while (rounded < capacity)
+                rounded <<= 1;
+
+            m_Rings.push_back(std::make_unique<Ring>(static_cast<int64_t>(rounded)));
+            m_Ring.store(m_Rings.back().get(), std::memory_order_relaxed);
+        }
+
+        WorkStealingDeque(const WorkStealingDeque&) = delete;
+        WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+        // Owner only
+        void Push(T item)
+        {
+            int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+            int64_t top = m_Top.load(std::memory_order_acquire);
+            Ring* ring = m_Ring.load(std::memory_order_relaxed);
+
+            if (bottom - top > ring->Capacity - 1)
+                ring = Grow(ring, top, bottom);
+
+            ring->Put(bottom, item);
+            std::atomic_thread_fence(std::memory_order_release);
+            m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        // Owner only, takes the item pushed last
+        bool Pop(T& item)
+        {
+            int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+            Ring* ring = m_Ring.load(std::memory_order_relaxed);
+            m_Bottom.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t top = m_Top.load(std::memory_order_relaxed);
+
+            if (top > bottom)
+            {
+                m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+                return false;
+            }
+
+            item = ring->Get(bottom);
+            if (top == bottom)
+            {
+                // The last item, a thief may be after it as well
+                bool won = m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+                m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+                return won;
+            }
+            return true;
+        }
+
+        // Any thread, takes the oldest item. Fails when the deque is empty or another thread took it first
+        bool Steal(T& item)
+        {
+            int64_t top = m_Top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t bottom = m_Bottom.load(std::memory_order_acquire);
+
+            if (top >= bottom)
+                return false;
+
+            Ring* ring = m_Ring.load(std::memory_order_acquire);
+            item = ring->Get(top);
+            return m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        }
+
+        // Only exact while no other thread touches the deque
+        size_t GetSize() const
+        {
+            int64_t size = m_Bottom.load(std::memory_order_relaxed) - m_Top.load(std::memory_order_relaxed);
+            return size > 0 ? static_cast<size_t>(size) : 0;
+        }
+
+        inline size_t GetCapacity() const { return static_cast<size_t>(m_Ring.load(std::memory_order_relaxed)->Capacity); }
+
+    private:
+        struct Ring
+        {
+            int64_t Capacity;
+            std::unique_ptr<std::atomic<T>[]> Items;
+
+            Ring(int64_t capacity)
+                : Capacity(capacity), Items(new std::atomic<T>[static_cast<size_t>(capacity)])
+            {
+            }
+
+            inline T Get(int64_t index) const { return Items[index & (Capacity - 1)].load(std::memory_order_relaxed); }
+            inline void Put(int64_t index, T item) { Items[index & (Capacity - 1)].store(item, std::memory_order_relaxed); }
+        };
+
+        Ring* Grow(Ring* ring, int64_t top, int64_t bottom)
+        {
+            m_Rings.push_back(std::make_unique<Ring>(ring->Capacity * 2));
+            Ring* grown = m_Rings.back().get();
+            for (int64_t i = top; i < bottom; i++)
+                grown->Put(i, ring->Get(i));
+
+            m_Ring.store(grown, std::memory_order_release);
+            return grown;
+        }
+
+        std::atomic<int64_t> m_Top = 0;
+        std::atomic<int64_t> m_Bottom = 0;
+        std::atomic<Ring*> m_Ring = nullptr;
+        // Every ring the deque had, only the owner adds to it
+        std::vector<std::unique_ptr<Ring>> m_Rings;
+    };
+}
@@ -58,10 +58,9 @@ namespace Roses
         extractMaterials(scene,materials);
 
         aiNode* node = scene->mRootNode->mNumMeshes == 0 ? scene->mRootNode->mChildren[0] : scene->mRootNode;
-        
-        GraphicsContext& context = GraphicsContext::Begin();
-        ModelLoader::processNode(node, scene, rootGO, context, materials);
-        context.Finish(true);
+
+        // The buffers and textures are uploaded on the copy queue, nothing waits for them here
+        ModelLoader::processNode(node, scene, rootGO, materials);
         return rootGO;
     }
 
@@ -91,21 +90,18 @@ namespace Roses
 
 
         extractMaterials(aScene, materials);
-        GraphicsContext& context = GraphicsContext::Begin();
         for (int c = 0; c < aScene->mRootNode->mNumChildren; c++)
         {
             auto child = aScene->mRootNode->mChildren[c];
             auto childGO = CreateRef<HGameObject>();
             scene.AddEntity(childGO);
 
-            processNode(child, aScene, childGO, context, materials);
+            processNode(child, aScene, childGO, materials);
         }
-        context.Finish(true);
     }
 
     void ModelLoader::processNode(aiNode* node, const aiScene* scene,
         Ref<HGameObject> target,
-        CommandContext& context,
         std::vector<Ref<HMaterial>>& materials)
     {
         aiVector3D translation;
@@ -196,10 +192,16 @@ namespace Roses
 #pragma endregion
             }
 
-            hmesh->vertexBuffer = CreateRef<D3D12VertexBuffer>(context, (float*)vertices.data(), vertices.size() * sizeof(Vertex));
+            if (!vertices.empty())
+            {
+                hmesh->TexelDensity = ComputeTexelDensity(&vertices[0].Position.x, &vertices[0].UV.x, sizeof(Vertex),
+                    vertices.size(), indices.data(), indices.size() / 3);
+            }
+
+            hmesh->vertexBuffer = CreateRef<D3D12VertexBuffer>((float*)vertices.data(), vertices.size() * sizeof(Vertex));
             hmesh->vertexBuffer->GetResource()->SetName(L"Vertex buffer");
 
-            hmesh->indexBuffer = CreateRef<D3D12IndexBuffer>(context, indices.data(), indices.size());
+            hmesh->indexBuffer = CreateRef<D3D12IndexBuffer>(indices.data(), indices.size());
             hmesh->indexBuffer->GetResource()->SetName(L"Index buffer");
 
             hmesh->vertices.swap(vertices);
@@ -215,7 +217,7 @@ namespace Roses
             auto childGO = CreateRef<HGameObject>();
             target->AddChild(childGO);
 
-            processNode(child, scene, childGO, context, materials);
+            processNode(child, scene, childGO, materials);
         }
     }
 
@@ -25,7 +25,6 @@ namespace Roses
 
         static void processNode(aiNode* node, const aiScene* scene,
             Ref<HGameObject> target,
-            CommandContext& context,
             std::vector<Ref<HMaterial>>& materials);
     };
 }
@@ -1,6 +1,8 @@
 #include "trpch.h"
 #include "TitaniumRose/Renderer/Material.h"
 
+#include "Platform/D3D12/D3D12Renderer.h"
+
 namespace Roses
 {
     HMaterial::HMaterial() :
@@ -9,4 +11,10 @@ namespace Roses
         IsTransparent(false), AlbedoTexture(nullptr), NormalTexture(nullptr), RoughnessTexture(nullptr), MetallicTexture(nullptr),
         Name("")
     {}
+
+    HMaterial::~HMaterial()
+    {
+        // Frees its slot in the bindless material table
+        D3D12Renderer::ReleaseMaterial(*this);
+    }
 }
\ No newline at end of file
@@ -15,10 +15,7 @@ namespace Roses {
 	{
 	public:
 		HMaterial();
-		
-		~HMaterial() 
-		{
-		}
+		~HMaterial();
 
 		glm::vec3 Color;
 		glm::vec3 EmissiveColor;
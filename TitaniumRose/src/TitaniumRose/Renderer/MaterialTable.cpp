@@ -0,0 +1,86 @@
+#include "trpch.h"
+#include "TitaniumRose/Renderer/MaterialTable.h"
+
+namespace Roses
+{
+    bool GpuMaterial::operator==(const GpuMaterial& other) const
+    {
+        return Color == other.Color && AlbedoTexture == other.AlbedoTexture &&
+            EmissiveColor == other.EmissiveColor && NormalTexture == other.NormalTexture &&
+            Roughness == other.Roughness && Metallic == other.Metallic &&
+            RoughnessTexture == other.RoughnessTexture && MetallicTexture == other.MetallicTexture;
+    }
+
+    MaterialTable::MaterialTable(uint32_t capacity, uint32_t reuseDelay) :
+        m_Materials(capacity), m_Dirty(capacity, false), m_ReuseDelay(reuseDelay)
+    {
+    }
+
+    uint32_t MaterialTable::Register(const void* owner)
+    {
+        auto it = m_Indices.find(owner);
+        if (it != m_Indices.end())
+            return it->second;
+
+        uint32_t index;
+        if (!m_FreeIndices.empty())
+        {
+            index = m_FreeIndices.top();
+            m_FreeIndices.pop();
+        }
+        else if (m_UsedCount < GetCapacity())
+        {
+            index = m_UsedCount++;
+        }
+        else
+        {
+            return InvalidIndex;
+        }
+
+        // Whatever the previous material left there is uploaded with the first Set
+        m_Materials[index] = GpuMaterial();
+        m_Dirty[index] = true;
+        m_Indices[owner] = index;
+        return index;
+    }
+
+    uint32_t MaterialTable::Find(const void* owner) const
+    {
+        auto it = m_Indices.find(owner);
+        return it != m_Indices.end() ? it->second : InvalidIndex;
+    }
+
+    bool MaterialTable::Unregister(const void* owner)
+    {
+        auto it = m_Indices.find(owner);
+        if (it == m_Indices.end())
+            return false;
+
+        m_RetiredIndices.push_back({ it->second, m_Frame });
+        m_Indices.erase(it);
+        return true;
+    }
+
+    bool MaterialTable::Set(uint32_t index, const GpuMaterial& material)
+    {
+        HZ_CORE_ASSERT(index < m_UsedCount, "Material index was never registered");
+
+        if (m_Materials[index] == material)
+            return false;
+
+        m_Materials[index] = material;
+        m_Dirty[index] = true;
+        ++m_Stats.Updates;
+        return true;
+    }
+
+    void MaterialTable::EndFrame()
+    {
+        ++m_Frame;
+        while (!m_RetiredIndices.empty() && m_RetiredIndices.front().Frame + m_ReuseDelay <= m_Frame)
+        {
+            m_FreeIndices.push(m_RetiredIndices.front().Index);
+            m_RetiredIndices.pop_front();
+        }
+    }
+}
@@ -0,0 +1,153 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include "glm/vec3.hpp"
+
+namespace Roses
+{
+    /// <summary>
+    /// A material as the bindless shaders read it, an element of a StructuredBuffer. The
+    /// layout has to match Material in Bindless.common.hlsli. Textures are indices into the
+    /// resource descriptor heap.
+    /// </summary>
+    struct GpuMaterial
+    {
+        static constexpr uint32_t NoTexture = UINT32_MAX;
+
+        glm::vec3 Color = { 1.0f, 1.0f, 1.0f };
+        uint32_t AlbedoTexture = NoTexture;
+        // ----- 16 bytes -----
+        glm::vec3 EmissiveColor = { 0.0f, 0.0f, 0.0f };
+        uint32_t NormalTexture = NoTexture;
+        // ----- 16 bytes -----
+        float Roughness = 0.5f;
+        float Metallic = 0.5f;
+        uint32_t RoughnessTexture = NoTexture;
+        uint32_t MetallicTexture = NoTexture;
+        // ----- 16 bytes -----
+
+        bool operator==(const GpuMaterial& other) const;
+        bool operator!=(const GpuMaterial& other) const { return !(*this == other); }
+    };
+    static_assert(sizeof(GpuMaterial) == 48, "GpuMaterial has to match the HLSL layout");
+
+    struct MaterialTableStats
+    {
+        // Set calls that changed a material
+        uint64_t Updates = 0;
+        uint64_t UploadedMaterials = 0;
+        // Copies made by FlushDirty, neighbouring dirty materials share one
+        uint64_t UploadRuns = 0;
+    };
+
+    /// <summary>
+    /// Gives every registered material a stable index into a global material table, and keeps
+    /// the CPU copy of the table. An index does not change while its material is registered.
+    /// Once unregistered it is only reused reuseDelay frames later, so frames still in flight
+    /// never see another material under it. The lowest free index is reused first to keep the
+    /// table dense. Changes are tracked so only the dirty part of the table is uploaded.
+    /// </summary>
+    class MaterialTable
+    {
+    public:
+        static constexpr uint32_t InvalidIndex = UINT32_MAX;
+        // Clean materials between two dirty ones that are still uploaded with them, fewer but
+        // larger copies
+        static constexpr uint32_t MergeGap = 4;
+
+        MaterialTable(uint32_t capacity, uint32_t reuseDelay);
+
+        /// <returns>The index of owner, registering it if needed. InvalidIndex if the table is full</returns>
+        uint32_t Register(const void* owner);
+
+        /// <returns>The index of owner, or InvalidIndex if it is not registered</returns>
+        uint32_t Find(const void* owner) const;
+
+        /// <returns>False if owner was not registered</returns>
+        bool Unregister(const void* owner);
+
+        /// <summary>
+        /// Updates the material at index, it is only marked dirty if it changed.
+        /// </summary>
+        /// <returns>True if the material changed</returns>
+        bool Set(uint32_t index, const GpuMaterial& material);
+        inline const GpuMaterial& Get(uint32_t index) const { return m_Materials[index]; }
+
+        /// <summary>
+        /// Ends a frame, the indices unregistered reuseDelay frames ago become free.
+        /// </summary>
+        void EndFrame();
+
+        /// <summary>
+        /// Hands the dirty materials out in runs of consecutive indices and marks them clean.
+        /// </summary>
+        /// <param name="write">void(uint32_t firstIndex, uint32_t count, const GpuMaterial* materials)</param>
+        /// <returns>The number of runs</returns>
+        template<typename WriteFn>
+        uint32_t FlushDirty(WriteFn write)
+        {
+            uint32_t runs = 0;
+            uint32_t index = 0;
+            while (index < m_UsedCount)
+            {
+                if (!m_Dirty[index])
+                {
+                    index++;
+                    continue;
+                }
+
+                // Extend the run while the next dirty material is at most MergeGap away
+                uint32_t first = index;
+                uint32_t end = index + 1;
+                for (uint32_t next = end; next < m_UsedCount && next <= end + MergeGap; next++)
+                {
+                    if (m_Dirty[next])
+                        end = next + 1;
+                }
+
+                for (uint32_t i = first; i < end; i++)
+                    m_Dirty[i] = false;
+
+                write(first, end - first, &m_Materials[first]);
+                m_Stats.UploadedMaterials += end - first;
+                ++runs;
+                index = end;
+            }
+
+            m_Stats.UploadRuns += runs;
+            return runs;
+        }
+
+        inline uint32_t GetCapacity() const { return static_cast<uint32_t>(m_Materials.size()); }
+        inline uint32_t GetCount() const { return static_cast<uint32_t>(m_Indices.size()); }
+        // One past the highest index ever handed out, the part of the table the GPU can read
+        inline uint32_t GetUsedCount() const { return m_UsedCount; }
+        inline const MaterialTableStats& GetStats() const { return m_Stats; }
+
+    private:
+        struct RetiredIndex
+        {
+            uint32_t Index;
+            uint64_t Frame;
+        };
+
+        std::vector<GpuMaterial> m_Materials;
+        std::vector<bool> m_Dirty;
+        std::unordered_map<const void*, uint32_t> m_Indices;
+
+        std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>> m_FreeIndices;
+        std::deque<RetiredIndex> m_RetiredIndices;
+        uint32_t m_UsedCount = 0;
+
+        uint32_t m_ReuseDelay;
+        uint64_t m_Frame = 0;
+
+        MaterialTableStats m_Stats;
+    };
+}
@@ -0,0 +1,254 @@
+#include "trpch.h"
+#include "TitaniumRose/Renderer/RenderGraph.h"
+
+#include <algorithm>
+
+namespace Roses
+{
+    RenderGraphResource RenderGraph::ImportResource(const std::string& name, uint32_t initialAccess, uint32_t flags)
+    {
+        m_Resources.push_back({ name, initialAccess, flags });
+        return static_cast<RenderGraphResource>(m_Resources.size() - 1);
+    }
+
+    uint32_t RenderGraph::AddPass(const std::string& name, uint32_t flags)
+    {
+        Pass pass;
+        pass.Name = name;
+        pass.Flags = flags;
+        m_Passes.push_back(std::move(pass));
+        return static_cast<uint32_t>(m_Passes.size() - 1);
+    }
+
+    void RenderGraph::Read(uint32_t pass, RenderGraphResource resource, uint32_t access)
+    {
+        HZ_CORE_ASSERT(resource < m_Resources.size(), "Unknown resource");
+        HZ_CORE_ASSERT((access & ~RenderGraphAccess_AllReads) == 0, "A read has to use a read access");
+        m_Passes[pass].Uses.push_back({ resource, access, false, false });
+    }
+
+    void RenderGraph::Write(uint32_t pass, RenderGraphResource resource, uint32_t access, bool discardsContents)
+    {
+        HZ_CORE_ASSERT(resource < m_Resources.size(), "Unknown resource");
+        m_Passes[pass].Uses.push_back({ resource, access, true, discardsContents });
+    }
+
+    void RenderGraph::Compile()
+    {
+        m_Batches.clear();
+        m_Stats = {};
+        m_Stats.Passes = static_cast<uint32_t>(m_Passes.size());
+
+        Cull();
+        AssignLevels();
+        PlaceBarriers();
+
+        m_Stats.Batches = static_cast<uint32_t>(m_Batches.size());
+    }
+
+    bool RenderGraph::UsesResource(uint32_t pass, RenderGraphResource resource) const
+    {
+        auto& uses = m_Passes[pass].Uses;
+        return std::any_of(uses.begin(), uses.end(), [resource](const Use& use) { return use.Resource == resource; });
+    }
+
+    void RenderGraph::Reset()
+    {
+        m_Passes.clear();
+        m_Resources.clear();
+        m_Batches.clear();
+        m_Stats = {};
+    }
+
+    void RenderGraph::Cull()
+    {
+        // Walks the passes backwards, a pass is kept if it writes something a kept pass after it
+        // still needs. What it reads is needed from then on, and what it overwrites is not
+        std::vector<bool> needed(m_Resources.size());
+        for (size_t r = 0; r < m_Resources.size(); r++)
+            needed[r] = (m_Resources[r].Flags & RenderGraphResourceFlags_Output) != 0;
+
+        for (size_t p = m_Passes.size(); p-- > 0;)
+        {
+            Pass& pass = m_Passes[p];
+
+            bool alive = (pass.Flags & RenderGraphPassFlags_SideEffects) != 0;
+            for (auto& use : pass.Uses)
+                alive |= use.Write && needed[use.Resource];
+
+            pass.Culled = !alive;
+            if (!alive)
+            {
+                m_Stats.CulledPasses++;
+                continue;
+            }
+
+            for (auto& use : pass.Uses)
+            {
+                bool alsoRead = std::any_of(pass.Uses.begin(), pass.Uses.end(),
+                    [&use](const Use& other) { return other.Resource == use.Resource && !other.Write; });
+                if (use.Write && use.Discards && !alsoRead)
+                    needed[use.Resource] = false;
+            }
+            for (auto& use : pass.Uses)
+            {
+                if (!use.Write || !use.Discards)
+                    needed[use.Resource] = true;
+            }
+        }
+    }
+
+    void RenderGraph::AssignLevels()
+    {
+        // A pass comes after the last writer of everything it uses, and a writer also after the
+        // readers since that writer. Its level is one past the deepest of those
+        static constexpr uint32_t NoPass = UINT32_MAX;
+        std::vector<uint32_t> lastWriter(m_Resources.size(), NoPass);
+        std::vector<std::vector<uint32_t>> readers(m_Resources.size());
+
+        uint32_t maxLevel = 0;
+        for (uint32_t p = 0; p < m_Passes.size(); p++)
+        {
+            Pass& pass = m_Passes[p];
+            if (pass.Culled)
+                continue;
+
+            uint32_t level = 0;
+            for (auto& use : pass.Uses)
+            {
+                if (lastWriter[use.Resource] != NoPass)
+                    level = std::max(level, m_Passes[lastWriter[use.Resource]].Level + 1);
+
+                if (use.Write)
+                {
+                    for (uint32_t reader : readers[use.Resource])
+                    {
+                        if (reader != p)
+                            level = std::max(level, m_Passes[reader].Level + 1);
+                    }
+                }
+            }
+            pass.Level = level;
+            maxLevel = std::max(maxLevel, level);
+
+            for (auto& use : pass.Uses)
+            {
+                if (use.Write)
+                {
+                    lastWriter[use.Resource] = p;
+                    readers[use.Resource].clear();
+                }
+            }
+            for (auto& use : pass.Uses)
+            {
+                auto& resourceReaders = readers[use.Resource];
+                if (!use.Write && lastWriter[use.Resource] != p &&
+                    std::find(resourceReaders.begin(), resourceReaders.end(), p) == resourceReaders.end())
+                    resourceReaders.push_back(p);
+            }
+        }
+
+        if (m_Stats.CulledPasses == m_Passes.size())
+            return;
+
+        m_Batches.resize(maxLevel + 1);
+        for (uint32_t p = 0; p < m_Passes.size(); p++)
+        {
+            if (!m_Passes[p].Culled)
+                m_Batches[m_Passes[p].Level].Passes.push_back(p);
+        }
+    }
+
+    void RenderGraph::PlaceBarriers()
+    {
+        // Whether a batch has a pass that ends the command list, a split can not be open across it
+        std::vector<bool> submits(m_Batches.size(), false);
+        for (size_t b = 0; b < m_Batches.size(); b++)
+        {
+            for (uint32_t p : m_Batches[b].Passes)
+                submits[b] = submits[b] || (m_Passes[p].Flags & RenderGraphPassFlags_Submits) != 0;
+        }
+
+        struct BatchUse
+        {
+            uint32_t Batch;
+            // The last batch of a run of reads that share the state
+            uint32_t LastBatch;
+            uint32_t Access;
+            bool Write;
+        };
+
+        for (RenderGraphResource r = 0; r < m_Resources.size(); r++)
+        {
+            const Resource& resource = m_Resources[r];
+            if (resource.Flags & RenderGraphResourceFlags_Untracked)
+                continue;
+
+            // The uses of the resource batch by batch. A batch has a single writer of it or only readers
+            std::vector<BatchUse> uses;
+            for (uint32_t b = 0; b < m_Batches.size(); b++)
+            {
+                uint32_t access = 0;
+                bool write = false;
+                for (uint32_t p : m_Batches[b].Passes)
+                {
+                    for (auto& use : m_Passes[p].Uses)
+                    {
+                        if (use.Resource != r)
+                            continue;
+                        access |= use.Access;
+                        write |= use.Write;
+                    }
+                }
+                if (access == 0 && !write)
+                    continue;
+
+                // Reads following reads share one state, so they need one transition
+                if (!write && !uses.empty() && !uses.back().Write)
+                {
+                    uses.back().Access |= access;
+                    uses.back().LastBatch = b;
+                    continue;
+                }
+                uses.push_back({ b, b, access, write });
+            }
+
+            uint32_t state = resource.InitialAccess;
+            bool known = state != RenderGraphAccess_None;
+            // The batch the transition could begin in, past the previous use
+            uint32_t earliest = 0;
+            bool lastWroteUAV = false;
+            for (auto& use : uses)
+            {
+                if (use.Access != state)
+                {
+                    bool canSplit = known && earliest < use.Batch;
+                    for (uint32_t b = earliest; canSplit && b < use.Batch; b++)
+                        canSplit = !submits[b];
+
+                    if (canSplit)
+                    {
+                        m_Batches[earliest].Barriers.push_back({ r, RenderGraphBarrierType_SplitBegin, state, use.Access });
+                        m_Batches[use.Batch].Barriers.push_back({ r, RenderGraphBarrierType_SplitEnd, state, use.Access });
+                        m_Stats.SplitBarriers++;
+                    }
+                    else
+                    {
+                        m_Batches[use.Batch].Barriers.push_back({ r, RenderGraphBarrierType_Transition, state, use.Access });
+                        m_Stats.Transitions++;
+                    }
+                    state = use.Access;
+                    known = true;
+                }
+                else if (lastWroteUAV && (use.Access & RenderGraphAccess_UnorderedAccess))
+                {
+                    m_Batches[use.Batch].Barriers.push_back({ r, RenderGraphBarrierType_UAV, state, state });
+                    m_Stats.UAVBarriers++;
+                }
+
+                lastWroteUAV = use.Write && (use.Access & RenderGraphAccess_UnorderedAccess);
+                earliest = use.LastBatch + 1;
+            }
+        }
+    }
+}
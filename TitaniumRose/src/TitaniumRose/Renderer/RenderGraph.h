@@ -0,0 +1,163 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Roses
+{
+    // How a pass uses a resource, the graph's view of a resource state. Reads can be combined
+    enum RenderGraphAccess : uint32_t
+    {
+        // Before the first use of a resource: its state is not known, so it is not split
+        RenderGraphAccess_None = 0,
+        RenderGraphAccess_RenderTarget = 1 << 0,
+        RenderGraphAccess_DepthWrite = 1 << 1,
+        RenderGraphAccess_DepthRead = 1 << 2,
+        RenderGraphAccess_PixelShaderRead = 1 << 3,
+        RenderGraphAccess_NonPixelShaderRead = 1 << 4,
+        RenderGraphAccess_UnorderedAccess = 1 << 5,
+        RenderGraphAccess_CopySource = 1 << 6,
+        RenderGraphAccess_CopyDest = 1 << 7,
+        RenderGraphAccess_Present = 1 << 8,
+
+        RenderGraphAccess_AllReads = RenderGraphAccess_DepthRead | RenderGraphAccess_PixelShaderRead |
+            RenderGraphAccess_NonPixelShaderRead | RenderGraphAccess_CopySource | RenderGraphAccess_Present,
+    };
+
+    enum RenderGraphPassFlags : uint32_t
+    {
+        RenderGraphPassFlags_None = 0,
+        // Never culled, for passes whose results leave the graph some other way
+        RenderGraphPassFlags_SideEffects = 1 << 0,
+        // Submits command lists of its own, so a split barrier can not be open across it
+        RenderGraphPassFlags_Submits = 1 << 1,
+    };
+
+    enum RenderGraphResourceFlags : uint32_t
+    {
+        RenderGraphResourceFlags_None = 0,
+        // A result of the graph, the passes that write it are kept
+        RenderGraphResourceFlags_Output = 1 << 0,
+        // Only orders the passes that use it, it gets no barriers
+        RenderGraphResourceFlags_Untracked = 1 << 1,
+    };
+
+    enum RenderGraphBarrierType : uint32_t
+    {
+        RenderGraphBarrierType_Transition,
+        // Starts a transition that a SplitEnd of a later batch finishes
+        RenderGraphBarrierType_SplitBegin,
+        RenderGraphBarrierType_SplitEnd,
+        // Orders unordered access writes against the accesses after them
+        RenderGraphBarrierType_UAV,
+    };
+
+    using RenderGraphResource = uint32_t;
+
+    struct RenderGraphBarrier
+    {
+        RenderGraphResource Resource;
+        RenderGraphBarrierType Type;
+        uint32_t Before;
+        uint32_t After;
+    };
+
+    /// <summary>
+    /// The passes of one dependency level. None of them depends on another, so their barriers
+    /// are issued together before the first of them runs.
+    /// </summary>
+    struct RenderGraphBatch
+    {
+        std::vector<RenderGraphBarrier> Barriers;
+        // In declaration order
+        std::vector<uint32_t> Passes;
+    };
+
+    struct RenderGraphStats
+    {
+        uint32_t Passes = 0;
+        uint32_t CulledPasses = 0;
+        uint32_t Batches = 0;
+        uint32_t Transitions = 0;
+        uint32_t SplitBarriers = 0;
+        uint32_t UAVBarriers = 0;
+    };
+
+    /// <summary>
+    /// Orders the passes of a frame from the resources they declare to read and write, and
+    /// works out the barriers between them. Compile culls the passes nothing uses, groups the
+    /// rest into dependency levels and batches the barriers of a level. A transition begins as
+    /// early as the previous use of its resource allows and ends before the next use, when
+    /// there are batches in between. Consecutive reads share one combined state. Knows nothing
+    /// about the graphics API, resources and passes are only indices.
+    /// </summary>
+    class RenderGraph
+    {
+    public:
+        static constexpr RenderGraphResource InvalidResource = UINT32_MAX;
+
+        /// <param name="initialAccess">The state the resource is in before the graph runs, None if unknown</param>
+        RenderGraphResource ImportResource(const std::string& name, uint32_t initialAccess = RenderGraphAccess_None,
+            uint32_t flags = RenderGraphResourceFlags_None);
+
+        // Returns the index of the pass, passes are declared in the order they would run in
+        uint32_t AddPass(const std::string& name, uint32_t flags = RenderGraphPassFlags_None);
+
+        void Read(uint32_t pass, RenderGraphResource resource, uint32_t access);
+        /// <param name="discardsContents">The pass overwrites all of it, so earlier writers are not needed for it</param>
+        void Write(uint32_t pass, RenderGraphResource resource, uint32_t access, bool discardsContents = false);
+
+        void Compile();
+
+        // Whether the pass reads or writes the resource
+        bool UsesResource(uint32_t pass, RenderGraphResource resource) const;
+
+        // Clears the passes and resources, keeps the allocations for the next frame
+        void Reset();
+
+        inline const std::vector<RenderGraphBatch>& GetBatches() const { return m_Batches; }
+        inline bool IsCulled(uint32_t pass) const { return m_Passes[pass].Culled; }
+        inline uint32_t GetLevel(uint32_t pass) const { return m_Passes[pass].Level; }
+        inline uint32_t GetPassFlags(uint32_t pass) const { return m_Passes[pass].Flags; }
+        inline const std::string& GetPassName(uint32_t pass) const { return m_Passes[pass].Name; }
+        inline const std::string& GetResourceName(RenderGraphResource resource) const { return m_Resources[resource].Name; }
+        inline size_t GetPassCount() const { return m_Passes.size(); }
+        inline size_t GetResourceCount() const { return m_Resources.size(); }
+        inline const RenderGraphStats& GetStats() const { return m_Stats; }
+
+    private:
+        struct Use
+        {
+            RenderGraphResource Resource;
+            uint32_t Access;
+            bool Write;
+            bool Discards;
+        };
+
+        struct Pass
+        {
+            std::string Name;
+            uint32_t Flags;
+            std::vector<Use> Uses;
+            bool Culled = false;
+            uint32_t Level = 0;
+        };
+
+        struct Resource
+        {
+            std::string Name;
+            uint32_t InitialAccess;
+            uint32_t Flags;
+        };
+
+        void Cull();
+        void AssignLevels();
+        void PlaceBarriers();
+
+        std::vector<Pass> m_Passes;
+        std::vector<Resource> m_Resources;
+        std::vector<RenderGraphBatch> m_Batches;
+        RenderGraphStats m_Stats;
+    };
+}
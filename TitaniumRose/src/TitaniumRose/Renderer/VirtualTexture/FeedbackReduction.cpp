@@ -0,0 +1,363 @@
+#include "trpch.h"
+#include "TitaniumRose/Renderer/VirtualTexture/FeedbackReduction.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+    #define TR_FEEDBACK_SIMD
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+        // MSVC lets us use any intrinsic without changing the target of the whole file
+        #define TR_TARGET(isa)
+    #else
+        #define TR_TARGET(isa) __attribute__((target(isa)))
+    #endif
+#endif
+
+namespace Roses
+{
+    template<typename Cell>
+    static void ReduceScalar(const Cell* feedback, size_t count, uint32_t noSampleValue, FeedbackReduction& result)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            uint32_t mip = static_cast<uint32_t>(feedback[i]);
+            if (mip >= noSampleValue)
+                continue;
+
+            result.FinestMip = std::min(result.FinestMip, mip);
+            result.CoarsestMip = std::max(result.CoarsestMip, mip);
+            ++result.SampledCells;
+            if (mip < MaxFeedbackMips)
+                ++result.MipHistogram[mip];
+        }
+    }
+
+#ifdef TR_FEEDBACK_SIMD
+    // The vector loops keep one counter per lane and per mip, comparing every cell against
+    // every mip is still cheaper than scattering into the histogram one cell at a time.
+
+    TR_TARGET("sse4.1")
+    static void ReduceSSE41(const uint32_t* feedback, size_t count, uint32_t noSampleValue, FeedbackReduction& result)
+    {
+        const uint32_t bins = std::min(noSampleValue, MaxFeedbackMips);
+        const __m128i sentinel = _mm_set1_epi32(static_cast<int>(noSampleValue));
+
+        __m128i finest = sentinel;
+        __m128i coarsest = _mm_setzero_si128();
+        __m128i unsampledCells = _mm_setzero_si128();
+        __m128i histogram[MaxFeedbackMips];
+        for (uint32_t mip = 0; mip < bins; mip++)
+            histogram[mip] = _mm_setzero_si128();
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i cells = _mm_loadu_si128(reinterpret_cast<const __m128i*>(feedback + i));
+            // All ones where the cell is at or past the sentinel, compares are signed so go through min
+            __m128i unsampled = _mm_cmpeq_epi32(_mm_min_epu32(cells, sentinel), sentinel);
+
+            finest = _mm_min_epu32(finest, cells);
+            coarsest = _mm_max_epu32(coarsest, _mm_andnot_si128(unsampled, cells));
+            unsampledCells = _mm_sub_epi32(unsampledCells, unsampled);
+
+            for (uint32_t mip = 0; mip < bins; mip++)
+                histogram[mip] = _mm_sub_epi32(histogram[mip], _mm_cmpeq_epi32(cells, _mm_set1_epi32(static_cast<int>(mip))));
+        }
+
+        alignas(16) uint32_t lanes[4];
+        auto sum = [&]() { uint32_t s = 0; for (uint32_t lane : lanes) s += lane; return s; };
+
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), finest);
+        result.FinestMip = std::min(result.FinestMip, *std::min_element(std::begin(lanes), std::end(lanes)));
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), coarsest);
+        result.CoarsestMip = std::max(result.CoarsestMip, *std::max_element(std::begin(lanes), std::end(lanes)));
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), unsampledCells);
+        result.SampledCells += static_cast<uint32_t>(i) - sum();
+        for (uint32_t mip = 0; mip < bins; mip++)
+        {
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), histogram[mip]);
+            result.MipHistogram[mip] += sum();
+        }
+
+        ReduceScalar(feedback + i, count - i, noSampleValue, result);
+    }
+
+    TR_TARGET("avx2")
+    static void ReduceAVX2(const uint32_t* feedback, size_t count, uint32_t noSampleValue, FeedbackReduction& result)
+    {
+        const uint32_t bins = std::min(noSampleValue, MaxFeedbackMips);
+        const __m256i sentinel = _mm256_set1_epi32(static_cast<int>(noSampleValue));
+
+        __m256i finest = sentinel;
+        __m256i coarsest = _mm256_setzero_si256();
+        __m256i unsampledCells = _mm256_setzero_si256();
+        __m256i histogram[MaxFeedbackMips];
+        for (uint32_t mip = 0; mip < bins; mip++)
+            histogram[mip] = _mm256_setzero_si256();
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256i cells = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(feedback + i));
+            __m256i unsampled = _mm256_cmpeq_epi32(_mm256_min_epu32(cells, sentinel), sentinel);
+
+            finest = _mm256_min_epu32(finest, cells);
+            coarsest = _mm256_max_epu32(coarsest, _mm256_andnot_si256(unsampled, cells));
+            unsampledCells = _mm256_sub_epi32(unsampledCells, unsampled);
+
+            for (uint32_t mip = 0; mip < bins; mip++)
+                histogram[mip] = _mm256_sub_epi32(histogram[mip], _mm256_cmpeq_epi32(cells, _mm256_set1_epi32(static_cast<int>(mip))));
+        }
+
+        alignas(32) uint32_t lanes[8];
+        auto sum = [&]() { uint32_t s = 0; for (uint32_t lane : lanes) s += lane; return s; };
+
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), finest);
+        result.FinestMip = std::min(result.FinestMip, *std::min_element(std::begin(lanes), std::end(lanes)));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), coarsest);
+        result.CoarsestMip = std::max(result.CoarsestMip, *std::max_element(std::begin(lanes), std::end(lanes)));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), unsampledCells);
+        result.SampledCells += static_cast<uint32_t>(i) - sum();
+        for (uint32_t mip = 0; mip < bins; mip++)
+        {
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), histogram[mip]);
+            result.MipHistogram[mip] += sum();
+        }
+
+        ReduceScalar(feedback + i, count - i, noSampleValue, result);
+    }
+
+    // The byte loops count in byte lanes, which would wrap after 255 iterations. Every block
+    // of at most that many iterations is summed into 64 bit lanes with a SAD against zero.
+    static constexpr size_t MaxIterationsPerBlock = 255;
+
+    // Lambdas do not inherit the target of the function they are in, so these are functions
+
+    TR_TARGET("sse4.1")
+    static uint32_t SumLanes(__m128i value)
+    {
+        alignas(16) uint64_t sums[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(sums), value);
+        return static_cast<uint32_t>(sums[0] + sums[1]);
+    }
+
+    TR_TARGET("avx2")
+    static uint32_t SumLanes(__m256i value)
+    {
+        alignas(32) uint64_t sums[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(sums), value);
+        return static_cast<uint32_t>(sums[0] + sums[1] + sums[2] + sums[3]);
+    }
+
+    TR_TARGET("sse4.1")
+    static void ReduceSSE41(const uint8_t* feedback, size_t count, uint32_t noSampleValue, FeedbackReduction& result)
+    {
+        const uint32_t bins = std::min(noSampleValue, MaxFeedbackMips);
+        const __m128i sentinel = _mm_set1_epi8(static_cast<char>(noSampleValue));
+        const __m128i zero = _mm_setzero_si128();
+
+        __m128i finest = sentinel;
+        __m128i coarsest = zero;
+        __m128i unsampledTotal = zero;
+        __m128i histogramTotal[MaxFeedbackMips];
+        for (uint32_t mip = 0; mip < bins; mip++)
+            histogramTotal[mip] = zero;
+
+        size_t i = 0;
+        while (i + 16 <= count)
+        {
+            const size_t blockEnd = std::min(i + MaxIterationsPerBlock * 16, count & ~size_t(15));
+
+            __m128i unsampledCells = zero;
+            __m128i histogram[MaxFeedbackMips];
+            for (uint32_t mip = 0; mip < bins; mip++)
+                histogram[mip] = zero;
+
+            for (; i < blockEnd; i += 16)
+            {
+                __m128i cells = _mm_loadu_si128(reinterpret_cast<const __m128i*>(feedback + i));
+                __m128i unsampled = _mm_cmpeq_epi8(_mm_min_epu8(cells, sentinel), sentinel);
+
+                finest = _mm_min_epu8(finest, cells);
+                coarsest = _mm_max_epu8(coarsest, _mm_andnot_si128(unsampled, cells));
+                unsampledCells = _mm_sub_epi8(unsampledCells, unsampled);
+
+                for (uint32_t mip = 0; mip < bins; mip++)
+                    histogram[mip] = _mm_sub_epi8(histogram[mip], _mm_cmpeq_epi8(cells, _mm_set1_epi8(static_cast<char>(mip))));
+            }
+
+            unsampledTotal = _mm_add_epi64(unsampledTotal, _mm_sad_epu8(unsampledCells, zero));
+            for (uint32_t mip = 0; mip < bins; mip++)
+                histogramTotal[mip] = _mm_add_epi64(histogramTotal[mip], _mm_sad_epu8(histogram[mip], zero));
+        }
+
+        alignas(16) uint8_t cells[16];
+
+        _mm_store_si128(reinterpret_cast<__m128i*>(cells), finest);
+        result.FinestMip = std::min<uint32_t>(result.FinestMip, *std::min_element(std::begin(cells), std::end(cells)));
+        _mm_store_si128(reinterpret_cast<__m128i*>(cells), coarsest);
+        result.CoarsestMip = std::max<uint32_t>(result.CoarsestMip, *std::max_element(std::begin(cells), std::end(cells)));
+        result.SampledCells += static_cast<uint32_t>(i) - SumLanes(unsampledTotal);
+        for (uint32_t mip = 0; mip < bins; mip++)
+            result.MipHistogram[mip] += SumLanes(histogramTotal[mip]);
+
+        ReduceScalar(feedback + i, count - i, noSampleValue, result);
+    }
+
+    TR_TARGET("avx2")
+    static void ReduceAVX2(const uint8_t* feedback, size_t count, uint32_t noSampleValue, FeedbackReduction& result)
+    {
+        const uint32_t bins = std::min(noSampleValue, MaxFeedbackMips);
+        const __m256i sentinel = _mm256_set1_epi8(static_cast<char>(noSampleValue));
+        const __m256i zero = _mm256_setzero_si256();
+
+        __m256i finest = sentinel;
+        __m256i coarsest = zero;
+        __m256i unsampledTotal = zero;
+        __m256i histogramTotal[MaxFeedbackMips];
+        for (uint32_t mip = 0; mip < bins; mip++)
+            histogramTotal[mip] = zero;
+
+        size_t i = 0;
+        while (i + 32 <= count)
+        {
+            const size_t blockEnd = std::min(i + MaxIterationsPerBlock * 32, count & ~size_t(31));
+
+            __m256i unsampledCells = zero;
+            __m256i histogram[MaxFeedbackMips];
+            for (uint32_t mip = 0; mip < bins; mip++)
+                histogram[mip] = zero;
+
+            for (; i < blockEnd; i += 32)
+            {
+                __m256i cells = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(feedback + i));
+                __m256i unsampled = _mm256_cmpeq_epi8(_mm256_min_epu8(cells, sentinel), sentinel);
+
+                finest = _mm256_min_epu8(finest, cells);
+                coarsest = _mm256_max_epu8(coarsest, _mm256_andnot_si256(unsampled, cells));
+                unsampledCells = _mm256_sub_epi8(unsampledCells, unsampled);
+
+                for (uint32_t mip = 0; mip < bins; mip++)
+                    histogram[mip] = _mm256_sub_epi8(histogram[mip], _mm256_cmpeq_epi8(cells, _mm256_set1_epi8(static_cast<char>(mip))));
+            }
+
+            unsampledTotal = _mm256_add_epi64(unsampledTotal, _mm256_sad_epu8(unsampledCells, zero));
+            for (uint32_t mip = 0; mip < bins; mip++)
+                histogramTotal[mip] = _mm256_add_epi64(histogramTotal[mip], _mm256_sad_epu8(histogram[mip], zero));
+        }
+
+        alignas(32) uint8_t cells[32];
+
+        _mm256_store_si256(reinterpret_cast<__m256i*>(cells), finest);
+        result.FinestMip = std::min<uint32_t>(result.FinestMip, *std::min_element(std::begin(cells), std::end(cells)));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(cells), coarsest);
+        result.CoarsestMip = std::max<uint32_t>(result.CoarsestMip, *std::max_element(std::begin(cells), std::end(cells)));
+        result.SampledCells += static_cast<uint32_t>(i) - SumLanes(unsampledTotal);
+        for (uint32_t mip = 0; mip < bins; mip++)
+            result.MipHistogram[mip] += SumLanes(histogramTotal[mip]);
+
+        ReduceScalar(feedback + i, count - i, noSampleValue, result);
+    }
+
+    static FeedbackReductionKernel DetectKernel()
+    {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 1);
+        bool sse41 = (info[2] & (1 << 19)) != 0;
+        // AVX also needs the OS to save the upper halves of the registers
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = osxsave && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+
+        __cpuidex(info, 7, 0);
+        bool avx2 = avx && (info[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init();
+        bool sse41 = __builtin_cpu_supports("sse4.1");
+        bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+        if (avx2)
+            return FeedbackReductionKernel::AVX2;
+        if (sse41)
+            return FeedbackReductionKernel::SSE41;
+        return FeedbackReductionKernel::Scalar;
+    }
+#endif
+
+    FeedbackReductionKernel GetBestFeedbackReductionKernel()
+    {
+#ifdef TR_FEEDBACK_SIMD
+        static const FeedbackReductionKernel kernel = DetectKernel();
+        return kernel;
+#else
+        return FeedbackReductionKernel::Scalar;
+#endif
+    }
+
+    const char* GetFeedbackReductionKernelName(FeedbackReductionKernel kernel)
+    {
+        switch (kernel)
+        {
+        case FeedbackReductionKernel::SSE41: return "SSE4.1";
+        case FeedbackReductionKernel::AVX2: return "AVX2";
+        default: return "Scalar";
+        }
+    }
+
+    FeedbackReduction ReduceFeedback(const uint32_t* feedback, size_t count, uint32_t noSampleValue,
+        FeedbackReductionKernel kernel)
+    {
+        HZ_CORE_ASSERT(noSampleValue <= MaxFeedbackMips, "Too many mips for the histogram");
+
+        FeedbackReduction result;
+        result.FinestMip = noSampleValue;
+
+        // The kernels are ordered from narrowest to widest
+        kernel = std::min(kernel, GetBestFeedbackReductionKernel());
+
+        switch (kernel)
+        {
+#ifdef TR_FEEDBACK_SIMD
+        case FeedbackReductionKernel::AVX2:
+            ReduceAVX2(feedback, count, noSampleValue, result);
+            break;
+        case FeedbackReductionKernel::SSE41:
+            ReduceSSE41(feedback, count, noSampleValue, result);
+            break;
+#endif
+        default:
+            ReduceScalar(feedback, count, noSampleValue, result);
+            break;
+        }
+
+        return result;
+    }
+
+    FeedbackReduction ReduceFeedback(const uint8_t* feedback, size_t count, uint32_t noSampleValue,
+        FeedbackReductionKernel kernel)
+    {
+        HZ_CORE_ASSERT(noSampleValue <= MaxFeedbackMips, "Too many mips for the histogram");
+
+        FeedbackReduction result;
+        result.FinestMip = noSampleValue;
+
+        kernel = std::min(kernel, GetBestFeedbackReductionKernel());
+
+        switch (kernel)
+        {
+#ifdef TR_FEEDBACK_SIMD
+        case FeedbackReductionKernel::AVX2:
+            ReduceAVX2(feedback, count, noSampleValue, result);
+            break;
+        case FeedbackReductionKernel::SSE41:
+            ReduceSSE41(feedback, count, noSampleValue, result);
+            break;
+#endif
+        default:
+            ReduceScalar(feedback, count, noSampleValue, result);
+            break;
+        }
+
+        return result;
+    }
+}
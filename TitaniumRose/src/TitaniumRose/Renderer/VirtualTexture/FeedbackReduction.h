@@ -0,0 +1,66 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Roses
+{
+    // Enough for a 32k texture
+    static constexpr uint32_t MaxFeedbackMips = 16;
+
+    /// <summary>
+    /// What a feedback map says about a texture, gathered in a single pass over it.
+    /// </summary>
+    struct FeedbackReduction
+    {
+        // The finest mip sampled, or the no sample value if nothing was sampled
+        uint32_t FinestMip = 0;
+        // The coarsest mip sampled, 0 if nothing was sampled
+        uint32_t CoarsestMip = 0;
+        // How many cells hold a mip rather than the no sample value
+        uint32_t SampledCells = 0;
+        // How many cells asked for each mip
+        std::array<uint32_t, MaxFeedbackMips> MipHistogram = {};
+    };
+
+    enum class FeedbackReductionKernel
+    {
+        Scalar,
+        SSE41,
+        AVX2
+    };
+
+    /// <summary>
+    /// The widest kernel the CPU we are running on supports
+    /// </summary>
+    FeedbackReductionKernel GetBestFeedbackReductionKernel();
+    const char* GetFeedbackReductionKernelName(FeedbackReductionKernel kernel);
+
+    /// <summary>
+    /// Finds the finest and coarsest mip in a feedback map and counts the cells of each mip.
+    /// Cells holding noSampleValue or more were not sampled and are left out.
+    /// </summary>
+    /// <param name="feedback">The feedback cells</param>
+    /// <param name="count">The number of cells</param>
+    /// <param name="noSampleValue">The value the feedback map is cleared to, at most MaxFeedbackMips</param>
+    /// <param name="kernel">Falls back to the best supported kernel if this one is not</param>
+    FeedbackReduction ReduceFeedback(const uint32_t* feedback, size_t count, uint32_t noSampleValue,
+        FeedbackReductionKernel kernel);
+
+    inline FeedbackReduction ReduceFeedback(const uint32_t* feedback, size_t count, uint32_t noSampleValue)
+    {
+        return ReduceFeedback(feedback, count, noSampleValue, GetBestFeedbackReductionKernel());
+    }
+
+    /// <summary>
+    /// The same reduction over compact feedback, one byte per cell. The kernels go through
+    /// four times as many cells per instruction.
+    /// </summary>
+    FeedbackReduction ReduceFeedback(const uint8_t* feedback, size_t count, uint32_t noSampleValue,
+        FeedbackReductionKernel kernel);
+
+    inline FeedbackReduction ReduceFeedback(const uint8_t* feedback, size_t count, uint32_t noSampleValue)
+    {
+        return ReduceFeedback(feedback, count, noSampleValue, GetBestFeedbackReductionKernel());
+    }
+}
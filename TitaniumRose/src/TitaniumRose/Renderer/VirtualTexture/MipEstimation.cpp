@@ -0,0 +1,137 @@
+#include "trpch.h"
+#include "TitaniumRose/Renderer/VirtualTexture/MipEstimation.h"
+
+#include <cfloat>
+#include <cmath>
+
+#include "glm/geometric.hpp"
+#include "glm/mat3x3.hpp"
+#include "glm/matrix.hpp"
+#include "glm/vec2.hpp"
+#include "glm/vec4.hpp"
+
+namespace Roses
+{
+    // Depths closer than this are treated as touching the camera
+    static constexpr float MinDepth = 1e-3f;
+
+    /// <summary>
+    /// The mip whose texels are closest to one per pixel at the given depth. Every mip
+    /// has a quarter of the texels of the one before, so it is half the log2 of the
+    /// texels per pixel area.
+    /// </summary>
+    static uint32_t MipAtDepth(float texelsPerWorldArea, float pixelsPerWorldUnitAtUnitDepth, float depth,
+        uint32_t mipLevels, bool roundUp)
+    {
+        float pixelsPerWorldUnit = pixelsPerWorldUnitAtUnitDepth / std::max(depth, MinDepth);
+        float mip = 0.5f * std::log2(texelsPerWorldArea / (pixelsPerWorldUnit * pixelsPerWorldUnit));
+        mip = roundUp ? std::ceil(mip) : std::floor(mip);
+
+        return static_cast<uint32_t>(std::clamp(mip, 0.0f, float(mipLevels - 1)));
+    }
+
+    MipEstimate EstimateMips(const MipEstimateInput& input, const MipEstimateView& view)
+    {
+        MipEstimate estimate;
+        const uint32_t mipLevels = std::max(input.MipLevels, 1u);
+
+        // Exact for uniform scales, the average stretch otherwise
+        float areaScale = std::pow(std::abs(glm::determinant(glm::mat3(input.LocalToWorld))), 2.0f / 3.0f);
+        float worldArea = input.SurfaceArea * areaScale;
+        estimate.Valid = worldArea > 0.0f && input.UVArea > 0.0f && view.ViewportHeight > 0.0f;
+
+        const glm::mat4 localToClip = view.ViewProjection * input.LocalToWorld;
+
+        glm::vec2 ndcMin(FLT_MAX);
+        glm::vec2 ndcMax(-FLT_MAX);
+        float nearest = FLT_MAX;
+        float farthest = 0.0f;
+        bool behindCamera = false;
+        // A bit per clip plane, it stays set if every corner is outside that plane
+        uint32_t outside = 0x3F;
+
+        for (uint32_t corner = 0; corner < 8; corner++)
+        {
+            glm::vec4 position(
+                (corner & 1) ? input.BoundsMax.x : input.BoundsMin.x,
+                (corner & 2) ? input.BoundsMax.y : input.BoundsMin.y,
+                (corner & 4) ? input.BoundsMax.z : input.BoundsMin.z,
+                1.0f);
+            glm::vec4 clip = localToClip * position;
+
+            uint32_t planes = 0;
+            planes |= clip.x < -clip.w ? 1 : 0;
+            planes |= clip.x > clip.w ? 2 : 0;
+            planes |= clip.y < -clip.w ? 4 : 0;
+            planes |= clip.y > clip.w ? 8 : 0;
+            planes |= clip.w < MinDepth ? 16 : 0;
+            planes |= clip.z > clip.w ? 32 : 0;
+            outside &= planes;
+
+            nearest = std::min(nearest, clip.w);
+            farthest = std::max(farthest, clip.w);
+
+            if (clip.w < MinDepth)
+            {
+                behindCamera = true;
+                continue;
+            }
+
+            glm::vec2 ndc = glm::vec2(clip.x, clip.y) / clip.w;
+            ndcMin = glm::min(ndcMin, ndc);
+            ndcMax = glm::max(ndcMax, ndc);
+        }
+
+        estimate.Visible = outside == 0;
+        if (!estimate.Visible)
+        {
+            estimate.FinestMip = mipLevels - 1;
+            estimate.CoarsestMip = mipLevels - 1;
+            return estimate;
+        }
+
+        // A corner behind the camera can project anywhere, so the bounds cover the whole view
+        if (behindCamera)
+        {
+            ndcMin = glm::vec2(-1.0f);
+            ndcMax = glm::vec2(1.0f);
+        }
+        ndcMin = glm::clamp(ndcMin, glm::vec2(-1.0f), glm::vec2(1.0f));
+        ndcMax = glm::clamp(ndcMax, glm::vec2(-1.0f), glm::vec2(1.0f));
+        estimate.ScreenArea = (ndcMax.x - ndcMin.x) * 0.5f * view.ViewportWidth
+            * (ndcMax.y - ndcMin.y) * 0.5f * view.ViewportHeight;
+
+        if (!estimate.Valid)
+        {
+            estimate.FinestMip = 0;
+            estimate.CoarsestMip = mipLevels - 1;
+            return estimate;
+        }
+
+        // The y row of a perspective view projection is the camera's up axis scaled by the
+        // focal length and the w row is its forward axis, so their ratio is the focal length
+        const glm::mat4& vp = view.ViewProjection;
+        float focalLength = glm::length(glm::vec3(vp[0][1], vp[1][1], vp[2][1]))
+            / glm::length(glm::vec3(vp[0][3], vp[1][3], vp[2][3]));
+        float pixelsPerWorldUnitAtUnitDepth = focalLength * 0.5f * view.ViewportHeight;
+        float texelsPerWorldArea = float(input.TextureWidth) * float(input.TextureHeight) * input.UVArea / worldArea;
+
+        estimate.FinestMip = MipAtDepth(texelsPerWorldArea, pixelsPerWorldUnitAtUnitDepth, nearest, mipLevels, false);
+        estimate.CoarsestMip = std::max(estimate.FinestMip,
+            MipAtDepth(texelsPerWorldArea, pixelsPerWorldUnitAtUnitDepth, farthest, mipLevels, true));
+
+        return estimate;
+    }
+
+    void MipEstimateErrorStats::Add(uint32_t estimatedMip, uint32_t measuredMip)
+    {
+        uint32_t error = estimatedMip > measuredMip ? estimatedMip - measuredMip : measuredMip - estimatedMip;
+
+        ++Samples;
+        AbsoluteErrorSum += error;
+        Exact += error == 0 ? 1 : 0;
+        WithinOne += error <= 1 ? 1 : 0;
+        TooCoarse += estimatedMip > measuredMip ? 1 : 0;
+        TooFine += estimatedMip < measuredMip ? 1 : 0;
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+
+#include "glm/mat4x4.hpp"
+#include "glm/vec3.hpp"
+
+namespace Roses
+{
+    /// <summary>
+    /// What the estimator needs to know about an object and its texture. The areas are
+    /// measured on the mesh in object space, the UV area in [0, 1] units.
+    /// </summary>
+    struct MipEstimateInput
+    {
+        glm::mat4 LocalToWorld = glm::mat4(1.0f);
+        glm::vec3 BoundsMin = glm::vec3(0.0f);
+        glm::vec3 BoundsMax = glm::vec3(0.0f);
+        float SurfaceArea = 0.0f;
+        float UVArea = 0.0f;
+
+        uint32_t TextureWidth = 0;
+        uint32_t TextureHeight = 0;
+        uint32_t MipLevels = 1;
+    };
+
+    struct MipEstimateView
+    {
+        glm::mat4 ViewProjection = glm::mat4(1.0f);
+        float ViewportWidth = 0.0f;
+        float ViewportHeight = 0.0f;
+    };
+
+    struct MipEstimate
+    {
+        // False if the mesh has no surface or UV area to estimate from, the mips are then the finest
+        bool Valid = false;
+        // False if the bounds are entirely outside the view, the mips are then the coarsest
+        bool Visible = false;
+        uint32_t FinestMip = 0;
+        uint32_t CoarsestMip = 0;
+        // The pixels covered by the projected bounds, clipped to the viewport
+        float ScreenArea = 0.0f;
+    };
+
+    /// <summary>
+    /// Picks the mips of an object's texture from its geometry alone, without a feedback
+    /// pass. The mesh's texels per world area are compared to the pixels per world area
+    /// at the nearest and farthest depth of its bounds, as if the surface faced the camera.
+    /// Surfaces seen at an angle would have used a coarser mip, so the finest mip errs on
+    /// the sharp side.
+    /// </summary>
+    MipEstimate EstimateMips(const MipEstimateInput& input, const MipEstimateView& view);
+
+    /// <summary>
+    /// How far the estimated finest mips are from the ones the feedback asked for.
+    /// </summary>
+    struct MipEstimateErrorStats
+    {
+        uint64_t Samples = 0;
+        uint64_t AbsoluteErrorSum = 0;
+        uint64_t Exact = 0;
+        uint64_t WithinOne = 0;
+        // The estimate was coarser than the feedback, the object is shaded blurrier than it should be
+        uint64_t TooCoarse = 0;
+        // The estimate was finer than the feedback, texels are shaded that are never seen
+        uint64_t TooFine = 0;
+
+        void Add(uint32_t estimatedMip, uint32_t measuredMip);
+        inline double MeanAbsoluteError() const { return Samples > 0 ? double(AbsoluteErrorSum) / Samples : 0.0; }
+    };
+}
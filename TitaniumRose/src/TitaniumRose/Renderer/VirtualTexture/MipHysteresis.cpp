@@ -0,0 +1,110 @@
+#include "trpch.h"
+#include "TitaniumRose/Renderer/VirtualTexture/MipHysteresis.h"
+
+#include <climits>
+
+namespace Roses
+{
+    bool MipHysteresis::WasRequestedRecently(uint32_t mip, uint32_t delay) const
+    {
+        // The histogram range is all we track, anything coarser is let go right away
+        if (mip >= MaxFeedbackMips)
+            return false;
+
+        return m_Stats.Updates - m_LastRequested[mip] <= delay;
+    }
+
+    void MipHysteresis::Update(uint32_t finestMip, uint32_t coarsestMip, const MipHysteresisSettings& settings)
+    {
+        coarsestMip = std::max(coarsestMip, finestMip);
+        bool firstUpdate = m_Stats.Updates == 0;
+
+        ++m_Stats.Updates;
+        for (uint32_t mip = finestMip; mip <= coarsestMip && mip < MaxFeedbackMips; mip++)
+        {
+            m_LastRequested[mip] = m_Stats.Updates;
+        }
+
+        if (firstUpdate)
+        {
+            m_FinestMip = m_RequestedFinestMip = finestMip;
+            m_CoarsestMip = m_RequestedCoarsestMip = coarsestMip;
+            return;
+        }
+
+        if (finestMip != m_RequestedFinestMip || coarsestMip != m_RequestedCoarsestMip)
+            ++m_Stats.RequestedChanges;
+        m_RequestedFinestMip = finestMip;
+        m_RequestedCoarsestMip = coarsestMip;
+
+        uint32_t newFinest = finestMip;
+        if (finestMip > m_FinestMip)
+        {
+            // Keep the finest mip that was still asked for lately
+            newFinest = m_FinestMip;
+            while (newFinest < finestMip && !WasRequestedRecently(newFinest, settings.DemoteDelay))
+                ++newFinest;
+        }
+
+        uint32_t newCoarsest = coarsestMip;
+        if (coarsestMip < m_CoarsestMip)
+        {
+            newCoarsest = m_CoarsestMip;
+            while (newCoarsest > coarsestMip && !WasRequestedRecently(newCoarsest, settings.DemoteDelay))
+                --newCoarsest;
+        }
+
+        if (newFinest < finestMip || newCoarsest > coarsestMip)
+            ++m_Stats.DemotionsDelayed;
+
+        if (newFinest != m_FinestMip || newCoarsest != m_CoarsestMip)
+            ++m_Stats.AppliedChanges;
+
+        m_FinestMip = newFinest;
+        m_CoarsestMip = newCoarsest;
+    }
+
+    const std::vector<uint8_t>& FeedbackAccumulator::Accumulate(const uint8_t* feedback, uint32_t width, uint32_t height,
+        uint32_t frames)
+    {
+        size_t count = size_t(width) * height;
+
+        // A resized feedback map has nothing in common with the old one
+        if (width != m_Width || height != m_Height)
+        {
+            m_Width = width;
+            m_Height = height;
+            m_Cells.assign(feedback, feedback + count);
+            m_Age.assign(count, 0);
+            return m_Cells;
+        }
+
+        // The ages never go past the number of frames, which has to fit them
+        frames = std::min<uint32_t>(frames, UINT16_MAX);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            uint8_t mip = feedback[i];
+
+            if (mip <= m_Cells[i] || m_Age[i] >= frames)
+            {
+                m_Cells[i] = mip;
+                m_Age[i] = 0;
+            }
+            else
+            {
+                ++m_Age[i];
+            }
+        }
+
+        return m_Cells;
+    }
+
+    void FeedbackAccumulator::Reset()
+    {
+        m_Width = 0;
+        m_Height = 0;
+        m_Cells.clear();
+        m_Age.clear();
+    }
+}
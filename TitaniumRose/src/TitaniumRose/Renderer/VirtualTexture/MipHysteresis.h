@@ -0,0 +1,87 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "TitaniumRose/Renderer/VirtualTexture/FeedbackReduction.h"
+
+namespace Roses
+{
+    struct MipHysteresisSettings
+    {
+        // Updates a mip has to go unrequested before the texture lets go of it, 0 follows the feedback
+        uint32_t DemoteDelay = 30;
+        // Updates a feedback cell keeps the finest mip it asked for, 0 uses the feedback as is
+        uint32_t AccumulationFrames = 8;
+    };
+
+    struct MipHysteresisStats
+    {
+        uint64_t Updates = 0;
+        // How often the mips coming in differed from the previous update
+        uint64_t RequestedChanges = 0;
+        // How often the mips handed out changed, each of those maps or unmaps tiles
+        uint64_t AppliedChanges = 0;
+        // Updates where a coarser mip was asked for but the finer one was kept
+        uint64_t DemotionsDelayed = 0;
+
+        inline uint64_t ChangesAvoided() const { return RequestedChanges > AppliedChanges ? RequestedChanges - AppliedChanges : 0; }
+    };
+
+    /// <summary>
+    /// Keeps the mips of a texture from flipping between neighbouring levels. A finer
+    /// mip is taken as soon as it is asked for, a mip is only given up once it has not
+    /// been asked for in DemoteDelay updates. The same goes for the coarsest mip.
+    /// </summary>
+    class MipHysteresis
+    {
+    public:
+        /// <summary>
+        /// Feeds the mips this update asked for, GetFinestMip and GetCoarsestMip then hold
+        /// the mips to use.
+        /// </summary>
+        void Update(uint32_t finestMip, uint32_t coarsestMip, const MipHysteresisSettings& settings);
+
+        inline uint32_t GetFinestMip() const { return m_FinestMip; }
+        inline uint32_t GetCoarsestMip() const { return m_CoarsestMip; }
+        inline const MipHysteresisStats& GetStats() const { return m_Stats; }
+
+    private:
+        bool WasRequestedRecently(uint32_t mip, uint32_t delay) const;
+
+    private:
+        uint32_t m_FinestMip = 0;
+        uint32_t m_CoarsestMip = 0;
+        uint32_t m_RequestedFinestMip = 0;
+        uint32_t m_RequestedCoarsestMip = 0;
+
+        // The update each mip was last asked for in
+        std::array<uint64_t, MaxFeedbackMips> m_LastRequested = {};
+        MipHysteresisStats m_Stats;
+    };
+
+    /// <summary>
+    /// Merges the feedback of the last few updates cell by cell. A cell takes a finer mip
+    /// right away and only goes back to a coarser one, or to not sampled, once the finer
+    /// mip has not been seen for the given number of updates. Works on compact feedback,
+    /// one byte per cell.
+    /// </summary>
+    class FeedbackAccumulator
+    {
+    public:
+        /// <returns>The accumulated feedback, the same size as the one passed in</returns>
+        const std::vector<uint8_t>& Accumulate(const uint8_t* feedback, uint32_t width, uint32_t height,
+            uint32_t frames);
+
+        inline const uint8_t* GetData() const { return m_Cells.data(); }
+        inline bool Empty() const { return m_Cells.empty(); }
+        void Reset();
+
+    private:
+        uint32_t m_Width = 0;
+        uint32_t m_Height = 0;
+        std::vector<uint8_t> m_Cells;
+        // Updates since each cell last saw its mip
+        std::vector<uint16_t> m_Age;
+    };
+}
@@ -0,0 +1,88 @@
+#include "trpch.h"
+#include "TitaniumRose/Renderer/VirtualTexture/MipPolicy.h"
+
+#include <cmath>
+
+namespace Roses
+{
+    static uint64_t TexelsInMip(uint32_t width, uint32_t height, uint32_t mip)
+    {
+        return uint64_t(std::max(width >> mip, 1u)) * std::max(height >> mip, 1u);
+    }
+
+    /// <summary>
+    /// Walks from the coarsest mip to the finest and stops once the requested share of
+    /// the weight is covered, every cell is satisfied by its own mip or any finer one.
+    /// </summary>
+    template<typename WeightFn>
+    static uint32_t FindCoveringMip(const FeedbackReduction& reduction, float coverage, WeightFn weight)
+    {
+        double total = 0.0;
+        for (uint32_t mip = reduction.FinestMip; mip <= reduction.CoarsestMip; mip++)
+        {
+            total += weight(mip) * reduction.MipHistogram[mip];
+        }
+
+        // Everything finer than the picked mip is allowed to miss out
+        double allowedMiss = total * (1.0 - std::clamp(coverage, 0.0f, 1.0f));
+        double missed = 0.0;
+        uint32_t picked = reduction.FinestMip;
+        for (uint32_t mip = reduction.FinestMip; mip < reduction.CoarsestMip; mip++)
+        {
+            missed += weight(mip) * reduction.MipHistogram[mip];
+            if (missed > allowedMiss)
+                break;
+            picked = mip + 1;
+        }
+
+        return picked;
+    }
+
+    MipSelection SelectMips(const FeedbackReduction& reduction, const MipPolicy& policy,
+        uint32_t width, uint32_t height, uint32_t mipLevels)
+    {
+        MipSelection selection;
+
+        if (reduction.SampledCells == 0 || reduction.FinestMip >= mipLevels)
+        {
+            selection.FinestMip = mipLevels - 1;
+            selection.CoarsestMip = mipLevels - 1;
+            selection.ShadedTexels = TexelsInMip(width, height, selection.FinestMip);
+            return selection;
+        }
+
+        selection.CoarsestMip = reduction.CoarsestMip;
+
+        // The histogram only counts the first MaxFeedbackMips mips
+        bool histogramComplete = reduction.CoarsestMip < MaxFeedbackMips;
+
+        switch (histogramComplete ? policy.Type : MipPolicyType::Finest)
+        {
+        case MipPolicyType::Coverage:
+            selection.FinestMip = FindCoveringMip(reduction, policy.Coverage, [](uint32_t) { return 1.0; });
+            break;
+        case MipPolicyType::ScreenArea:
+            // A cell sampled at mip m is seen at a quarter of the pixels of one sampled at m - 1
+            selection.FinestMip = FindCoveringMip(reduction, policy.Coverage, [](uint32_t mip) { return std::ldexp(1.0, -2 * int(mip)); });
+            break;
+        default:
+            selection.FinestMip = reduction.FinestMip;
+            break;
+        }
+
+        selection.ShadedTexels = TexelsInMip(width, height, selection.FinestMip);
+        selection.TexelsSaved = TexelsInMip(width, height, reduction.FinestMip) - selection.ShadedTexels;
+
+        return selection;
+    }
+
+    const char* GetMipPolicyName(MipPolicyType type)
+    {
+        switch (type)
+        {
+        case MipPolicyType::Coverage: return "Coverage";
+        case MipPolicyType::ScreenArea: return "Screen area";
+        default: return "Finest";
+        }
+    }
+}
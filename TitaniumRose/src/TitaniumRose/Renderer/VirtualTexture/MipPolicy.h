@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+
+#include "TitaniumRose/Renderer/VirtualTexture/FeedbackReduction.h"
+
+namespace Roses
+{
+    enum class MipPolicyType
+    {
+        // The finest mip any cell sampled, never loses quality
+        Finest,
+        // The finest mip that satisfies Coverage of the sampled cells
+        Coverage,
+        // Like Coverage, but every cell is weighted by the screen area it covers
+        ScreenArea
+    };
+
+    struct MipPolicy
+    {
+        MipPolicyType Type = MipPolicyType::Finest;
+        // The fraction of cells (or screen area) that has to get the mip it asked for or a finer one
+        float Coverage = 0.99f;
+    };
+
+    /// <summary>
+    /// The mips a policy picked for a texture, and what they cost to shade.
+    /// </summary>
+    struct MipSelection
+    {
+        uint32_t FinestMip = 0;
+        uint32_t CoarsestMip = 0;
+        // The texels of the finest mip, the coarser ones are generated from it
+        uint64_t ShadedTexels = 0;
+        // How many less texels are shaded than with MipPolicyType::Finest
+        uint64_t TexelsSaved = 0;
+    };
+
+    /// <summary>
+    /// Picks the finest mip to shade from a feedback reduction. Cells that asked for a
+    /// finer mip than the one picked get magnified texels, the coverage bounds how many.
+    /// If nothing was sampled the coarsest mip is returned.
+    /// </summary>
+    /// <param name="reduction">The reduction of the texture's feedback map</param>
+    /// <param name="width">Width of the texture's finest mip in texels</param>
+    /// <param name="height">Height of the texture's finest mip in texels</param>
+    /// <param name="mipLevels">The number of mips of the texture, also the no sample value</param>
+    MipSelection SelectMips(const FeedbackReduction& reduction, const MipPolicy& policy,
+        uint32_t width, uint32_t height, uint32_t mipLevels);
+
+    const char* GetMipPolicyName(MipPolicyType type);
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace Roses
+{
+    /// <summary>
+    /// A half open range of standard mips [Begin, End) that are resident.
+    /// </summary>
+    struct MipRange
+    {
+        uint32_t Begin = 0;
+        uint32_t End = 0;
+
+        inline bool Empty() const { return Begin >= End; }
+        inline bool Contains(uint32_t mip) const { return mip >= Begin && mip < End; }
+
+        bool operator==(const MipRange& other) const { return Begin == other.Begin && End == other.End; }
+        bool operator!=(const MipRange& other) const { return !(*this == other); }
+    };
+
+    /// <summary>
+    /// The mips that have to change between two residency ranges. Mips that are
+    /// resident in both ranges are left alone.
+    /// </summary>
+    struct MipResidencyDelta
+    {
+        std::vector<uint32_t> MipsToUnmap;
+        std::vector<uint32_t> MipsToMap;
+
+        inline bool Empty() const { return MipsToUnmap.empty() && MipsToMap.empty(); }
+    };
+
+    /// <summary>
+    /// Converts the finest/coarsest mips a texture reported into the range of standard
+    /// mips that need tiles. Mips past numStandardMips live in the packed tail and are
+    /// never part of the range.
+    /// </summary>
+    inline MipRange MakeResidentRange(uint32_t finestMip, uint32_t coarsestMip, uint32_t numStandardMips)
+    {
+        MipRange range;
+        range.Begin = std::min(finestMip, numStandardMips);
+        range.End = std::min(coarsestMip + 1, numStandardMips);
+        if (range.End < range.Begin)
+            range.End = range.Begin;
+        return range;
+    }
+
+    inline MipResidencyDelta DiffMipRanges(const MipRange& previous, const MipRange& next)
+    {
+        MipResidencyDelta delta;
+        if (previous == next)
+            return delta;
+
+        uint32_t begin = std::min(previous.Begin, next.Begin);
+        uint32_t end = std::max(previous.End, next.End);
+
+        for (uint32_t mip = begin; mip < end; mip++)
+        {
+            bool wasResident = previous.Contains(mip);
+            bool isResident = next.Contains(mip);
+
+            if (wasResident && !isResident)
+                delta.MipsToUnmap.push_back(mip);
+            else if (!wasResident && isResident)
+                delta.MipsToMap.push_back(mip);
+        }
+        return delta;
+    }
+}
@@ -0,0 +1,60 @@
+#include "trpch.h"
+#include "TitaniumRose/Renderer/VirtualTexture/ReadbackRing.h"
+
+namespace Roses
+{
+    ReadbackRing::ReadbackRing(uint64_t capacity, uint32_t framesInFlight)
+        : m_Ring(static_cast<size_t>(capacity)), m_MaxFramesInFlight(framesInFlight)
+    {
+        HZ_CORE_ASSERT(capacity > 0, "A readback ring needs some memory");
+        HZ_CORE_ASSERT(framesInFlight > 0, "A readback ring needs at least one frame in flight");
+    }
+
+    bool ReadbackRing::Allocate(void* owner, uint64_t size, uint64_t alignment, ReadbackSlot& slot)
+    {
+        HZ_CORE_ASSERT(m_Ring.GetCapacity() % alignment == 0, "The alignment has to divide the capacity");
+
+        size_t offset = FenceRing::InvalidOffset;
+        if (m_Ring.GetRegionsInFlight() < m_MaxFramesInFlight)
+            offset = m_Ring.Allocate(static_cast<size_t>(size), static_cast<size_t>(alignment));
+
+        if (offset == FenceRing::InvalidOffset)
+        {
+            ++m_Stats.SlotsDenied;
+            return false;
+        }
+
+        slot.Owner = owner;
+        slot.Offset = offset;
+        slot.Size = size;
+
+        m_Recording.push_back(slot);
+        ++m_Stats.SlotsAllocated;
+        return true;
+    }
+
+    void ReadbackRing::EndFrame(uint64_t fenceValue)
+    {
+        if (m_Recording.empty())
+            return;
+
+        m_Ring.Close(m_Ring.Submit(), fenceValue);
+        m_FrameSlots.push_back(std::move(m_Recording));
+        m_Recording = {};
+    }
+
+    void ReadbackRing::Forget(void* owner)
+    {
+        auto forget = [owner](std::vector<ReadbackSlot>& slots) {
+            for (auto& slot : slots)
+            {
+                if (slot.Owner == owner)
+                    slot.Owner = nullptr;
+            }
+        };
+
+        for (auto& slots : m_FrameSlots)
+            forget(slots);
+        forget(m_Recording);
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "TitaniumRose/Core/FenceRing.h"
+
+namespace Roses
+{
+    /// <summary>
+    /// Where one copy was placed in the readback arena
+    /// </summary>
+    struct ReadbackSlot
+    {
+        // Whoever the data is for, nullptr once it was forgotten
+        void*    Owner = nullptr;
+        uint64_t Offset = 0;
+        uint64_t Size = 0;
+    };
+
+    struct ReadbackRingStats
+    {
+        uint64_t SlotsAllocated = 0;
+        uint64_t SlotsDenied = 0;
+        uint64_t SlotsRetired = 0;
+    };
+
+    /// <summary>
+    /// Suballocates the copies of a frame out of a single readback arena and keeps them
+    /// until the fence of that frame completed. The arena is a FenceRing with a region per
+    /// frame, the slots of a frame are handed back when its region retires.
+    /// </summary>
+    class ReadbackRing
+    {
+    public:
+        /// <param name="capacity">Size of the arena in bytes</param>
+        /// <param name="framesInFlight">How many frames can wait on their fence at once</param>
+        ReadbackRing(uint64_t capacity, uint32_t framesInFlight);
+
+        /// <summary>
+        /// Reserves size bytes for the frame being recorded. Fails when the arena is full or
+        /// too many frames are in flight, the caller then skips the copy and keeps its older data.
+        /// </summary>
+        /// <param name="alignment">Has to divide the capacity</param>
+        bool Allocate(void* owner, uint64_t size, uint64_t alignment, ReadbackSlot& slot);
+
+        /// <summary>
+        /// Closes the frame being recorded. Its slots are retired once the fence value is
+        /// complete. A frame without any slot is not tracked.
+        /// </summary>
+        void EndFrame(uint64_t fenceValue);
+
+        /// <summary>
+        /// Retires the oldest frames whose fence completed. Every slot that still has an
+        /// owner is handed to onRetired before its memory can be reused.
+        /// </summary>
+        /// <param name="isComplete">bool(uint64_t fenceValue)</param>
+        /// <param name="onRetired">void(const ReadbackSlot&amp;)</param>
+        /// <returns>The number of frames retired</returns>
+        template<typename IsCompleteFn, typename RetireFn>
+        uint32_t Retire(IsCompleteFn isComplete, RetireFn onRetired)
+        {
+            return m_Ring.Retire(isComplete, [&](uint64_t) {
+                for (auto& slot : m_FrameSlots.front())
+                {
+                    if (slot.Owner == nullptr)
+                        continue;
+
+                    onRetired(slot);
+                    ++m_Stats.SlotsRetired;
+                }
+                m_FrameSlots.pop_front();
+            });
+        }
+
+        /// <summary>
+        /// Makes sure none of the slots of owner are handed out anymore, for owners that go
+        /// away while their copies are in flight.
+        /// </summary>
+        void Forget(void* owner);
+
+        inline uint64_t GetCapacity() const { return m_Ring.GetCapacity(); }
+        inline uint64_t GetUsedBytes() const { return m_Ring.GetUsed(); }
+        inline uint32_t GetFramesInFlight() const { return m_Ring.GetRegionsInFlight(); }
+        inline const ReadbackRingStats& GetStats() const { return m_Stats; }
+        inline const FenceRingStats& GetRingStats() const { return m_Ring.GetStats(); }
+
+    private:
+        FenceRing m_Ring;
+        uint32_t m_MaxFramesInFlight;
+
+        // The slots of every region in flight, oldest first
+        std::deque<std::vector<ReadbackSlot>> m_FrameSlots;
+        std::vector<ReadbackSlot> m_Recording;
+        ReadbackRingStats m_Stats;
+    };
+}
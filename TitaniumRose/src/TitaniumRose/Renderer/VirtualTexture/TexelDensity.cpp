@@ -0,0 +1,356 @@
+#include "trpch.h"
+#include "TitaniumRose/Renderer/VirtualTexture/TexelDensity.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+#if defined(_M_X64) || defined(__x86_64__)
+    #define TR_DENSITY_SIMD
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+        #define TR_TARGET(isa)
+    #else
+        #define TR_TARGET(isa) __attribute__((target(isa)))
+    #endif
+#endif
+
+namespace Roses
+{
+    // Triangles are measured this many at a time, the widest kernel's lane count
+    static constexpr size_t BlockSize = 8;
+
+    /// <summary>
+    /// The edges of a block of triangles from their first vertex, one array per component
+    /// so the kernels can load every lane at once. Lanes past the end of the mesh are zero.
+    /// </summary>
+    struct TriangleBlock
+    {
+        alignas(32) float Edge0[3][BlockSize];
+        alignas(32) float Edge1[3][BlockSize];
+        alignas(32) float UVEdge0[2][BlockSize];
+        alignas(32) float UVEdge1[2][BlockSize];
+    };
+
+    static inline const float* VertexAt(const float* first, size_t stride, uint32_t index)
+    {
+        return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(first) + stride * index);
+    }
+
+    static void GatherBlock(const float* positions, const float* uvs, size_t stride, size_t vertexCount,
+        const uint32_t* indices, size_t count, TriangleBlock& block)
+    {
+        std::memset(&block, 0, sizeof(block));
+
+        for (size_t lane = 0; lane < count; lane++)
+        {
+            const uint32_t* triangle = indices + lane * 3;
+            HZ_CORE_ASSERT(triangle[0] < vertexCount && triangle[1] < vertexCount && triangle[2] < vertexCount,
+                "Triangle index out of range");
+            const float* p0 = VertexAt(positions, stride, triangle[0]);
+            const float* p1 = VertexAt(positions, stride, triangle[1]);
+            const float* p2 = VertexAt(positions, stride, triangle[2]);
+            const float* t0 = VertexAt(uvs, stride, triangle[0]);
+            const float* t1 = VertexAt(uvs, stride, triangle[1]);
+            const float* t2 = VertexAt(uvs, stride, triangle[2]);
+
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                block.Edge0[c][lane] = p1[c] - p0[c];
+                block.Edge1[c][lane] = p2[c] - p0[c];
+            }
+            for (uint32_t c = 0; c < 2; c++)
+            {
+                block.UVEdge0[c][lane] = t1[c] - t0[c];
+                block.UVEdge1[c][lane] = t2[c] - t0[c];
+            }
+        }
+    }
+
+    static void MeasureScalar(const TriangleBlock& block, float* surfaceArea, float* uvArea, float* density)
+    {
+        for (size_t lane = 0; lane < BlockSize; lane++)
+        {
+            float ax = block.Edge0[0][lane], ay = block.Edge0[1][lane], az = block.Edge0[2][lane];
+            float bx = block.Edge1[0][lane], by = block.Edge1[1][lane], bz = block.Edge1[2][lane];
+            float cx = ay * bz - az * by;
+            float cy = az * bx - ax * bz;
+            float cz = ax * by - ay * bx;
+
+            float surface = 0.5f * std::sqrt(cx * cx + cy * cy + cz * cz);
+            float uv = 0.5f * std::abs(block.UVEdge0[0][lane] * block.UVEdge1[1][lane]
+                - block.UVEdge0[1][lane] * block.UVEdge1[0][lane]);
+
+            surfaceArea[lane] = surface;
+            uvArea[lane] = uv;
+            density[lane] = surface > 0.0f ? uv / surface : 0.0f;
+        }
+    }
+
+#ifdef TR_DENSITY_SIMD
+    // SSE2 is part of x64, this one needs no detection
+    static void MeasureSSE(const TriangleBlock& block, float* surfaceArea, float* uvArea, float* density)
+    {
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+
+        for (size_t lane = 0; lane < BlockSize; lane += 4)
+        {
+            __m128 ax = _mm_load_ps(block.Edge0[0] + lane);
+            __m128 ay = _mm_load_ps(block.Edge0[1] + lane);
+            __m128 az = _mm_load_ps(block.Edge0[2] + lane);
+            __m128 bx = _mm_load_ps(block.Edge1[0] + lane);
+            __m128 by = _mm_load_ps(block.Edge1[1] + lane);
+            __m128 bz = _mm_load_ps(block.Edge1[2] + lane);
+
+            __m128 cx = _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by));
+            __m128 cy = _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(ax, bz));
+            __m128 cz = _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(ay, bx));
+            __m128 lengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, cx), _mm_mul_ps(cy, cy)), _mm_mul_ps(cz, cz));
+            __m128 surface = _mm_mul_ps(half, _mm_sqrt_ps(lengthSq));
+
+            __m128 det = _mm_sub_ps(
+                _mm_mul_ps(_mm_load_ps(block.UVEdge0[0] + lane), _mm_load_ps(block.UVEdge1[1] + lane)),
+                _mm_mul_ps(_mm_load_ps(block.UVEdge0[1] + lane), _mm_load_ps(block.UVEdge1[0] + lane)));
+            __m128 uv = _mm_mul_ps(half, _mm_andnot_ps(signMask, det));
+
+            // Degenerate triangles divide by zero, the mask turns their density into zero
+            __m128 valid = _mm_cmpgt_ps(surface, _mm_setzero_ps());
+            __m128 ratio = _mm_and_ps(valid, _mm_div_ps(uv, surface));
+
+            _mm_storeu_ps(surfaceArea + lane, surface);
+            _mm_storeu_ps(uvArea + lane, uv);
+            _mm_storeu_ps(density + lane, ratio);
+        }
+    }
+
+    TR_TARGET("avx")
+    static void MeasureAVX(const TriangleBlock& block, float* surfaceArea, float* uvArea, float* density)
+    {
+        const __m256 half = _mm256_set1_ps(0.5f);
+        const __m256 signMask = _mm256_set1_ps(-0.0f);
+
+        __m256 ax = _mm256_load_ps(block.Edge0[0]);
+        __m256 ay = _mm256_load_ps(block.Edge0[1]);
+        __m256 az = _mm256_load_ps(block.Edge0[2]);
+        __m256 bx = _mm256_load_ps(block.Edge1[0]);
+        __m256 by = _mm256_load_ps(block.Edge1[1]);
+        __m256 bz = _mm256_load_ps(block.Edge1[2]);
+
+        __m256 cx = _mm256_sub_ps(_mm256_mul_ps(ay, bz), _mm256_mul_ps(az, by));
+        __m256 cy = _mm256_sub_ps(_mm256_mul_ps(az, bx), _mm256_mul_ps(ax, bz));
+        __m256 cz = _mm256_sub_ps(_mm256_mul_ps(ax, by), _mm256_mul_ps(ay, bx));
+        __m256 lengthSq = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(cx, cx), _mm256_mul_ps(cy, cy)), _mm256_mul_ps(cz, cz));
+        __m256 surface = _mm256_mul_ps(half, _mm256_sqrt_ps(lengthSq));
+
+        __m256 det = _mm256_sub_ps(
+            _mm256_mul_ps(_mm256_load_ps(block.UVEdge0[0]), _mm256_load_ps(block.UVEdge1[1])),
+            _mm256_mul_ps(_mm256_load_ps(block.UVEdge0[1]), _mm256_load_ps(block.UVEdge1[0])));
+        __m256 uv = _mm256_mul_ps(half, _mm256_andnot_ps(signMask, det));
+
+        __m256 valid = _mm256_cmp_ps(surface, _mm256_setzero_ps(), _CMP_GT_OQ);
+        __m256 ratio = _mm256_and_ps(valid, _mm256_div_ps(uv, surface));
+
+        _mm256_storeu_ps(surfaceArea, surface);
+        _mm256_storeu_ps(uvArea, uv);
+        _mm256_storeu_ps(density, ratio);
+    }
+
+    static TexelDensityKernel DetectKernel()
+    {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 1);
+        // AVX also needs the OS to save the upper halves of the registers
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = osxsave && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+#else
+        __builtin_cpu_init();
+        bool avx = __builtin_cpu_supports("avx");
+#endif
+        return avx ? TexelDensityKernel::AVX : TexelDensityKernel::SSE;
+    }
+#endif
+
+    TexelDensityKernel GetBestTexelDensityKernel()
+    {
+#ifdef TR_DENSITY_SIMD
+        static const TexelDensityKernel kernel = DetectKernel();
+        return kernel;
+#else
+        return TexelDensityKernel::Scalar;
+#endif
+    }
+
+    const char* GetTexelDensityKernelName(TexelDensityKernel kernel)
+    {
+        switch (kernel)
+        {
+        case TexelDensityKernel::SSE: return "SSE";
+        case TexelDensityKernel::AVX: return "AVX";
+        default: return "Scalar";
+        }
+    }
+
+    /// <summary>
+    /// The importer splits vertices that differ in any attribute, a hard edge would split a
+    /// chart in two. Vertices are merged again by position and UV alone before the charts
+    /// are grown, so only UV seams separate them.
+    /// </summary>
+    struct WeldKey
+    {
+        float Values[5];
+
+        bool operator==(const WeldKey& other) const { return std::memcmp(Values, other.Values, sizeof(Values)) == 0; }
+    };
+
+    struct WeldKeyHash
+    {
+        size_t operator()(const WeldKey& key) const
+        {
+            uint32_t bits[5];
+            std::memcpy(bits, key.Values, sizeof(bits));
+
+            size_t hash = 14695981039346656037ull;
+            for (uint32_t value : bits)
+                hash = (hash ^ value) * 1099511628211ull;
+            return hash;
+        }
+    };
+
+    static uint32_t FindRoot(std::vector<uint32_t>& parents, uint32_t node)
+    {
+        while (parents[node] != node)
+        {
+            parents[node] = parents[parents[node]];
+            node = parents[node];
+        }
+        return node;
+    }
+
+    static void AddToStats(TexelDensityStats& stats, float density)
+    {
+        // A triangle without UV area is collapsed, not magnified, it would hide the real minimum
+        if (density > 0.0f)
+            stats.Min = std::min(stats.Min, density);
+        stats.Max = std::max(stats.Max, density);
+    }
+
+    static void FinishStats(TexelDensityStats& stats, float surfaceArea, float uvArea)
+    {
+        if (stats.Min == FLT_MAX)
+            stats.Min = 0.0f;
+        stats.Mean = surfaceArea > 0.0f ? uvArea / surfaceArea : 0.0f;
+    }
+
+    TexelDensityTable ComputeTexelDensity(const float* positions, const float* uvs, size_t vertexStride,
+        size_t vertexCount, const uint32_t* indices, size_t triangleCount, TexelDensityKernel kernel)
+    {
+        TexelDensityTable table;
+        if (triangleCount == 0 || vertexCount == 0)
+            return table;
+
+        // The kernels always write whole blocks
+        const size_t paddedCount = (triangleCount + BlockSize - 1) / BlockSize * BlockSize;
+        std::vector<float> surfaceAreas(paddedCount);
+        std::vector<float> uvAreas(paddedCount);
+        table.TriangleDensity.resize(paddedCount);
+
+        // The kernels are ordered from narrowest to widest
+        kernel = std::min(kernel, GetBestTexelDensityKernel());
+
+        TriangleBlock block;
+        for (size_t first = 0; first < triangleCount; first += BlockSize)
+        {
+            size_t count = std::min(BlockSize, triangleCount - first);
+            GatherBlock(positions, uvs, vertexStride, vertexCount, indices + first * 3, count, block);
+
+            float* surface = surfaceAreas.data() + first;
+            float* uv = uvAreas.data() + first;
+            float* density = table.TriangleDensity.data() + first;
+            switch (kernel)
+            {
+#ifdef TR_DENSITY_SIMD
+            case TexelDensityKernel::AVX:
+                MeasureAVX(block, surface, uv, density);
+                break;
+            case TexelDensityKernel::SSE:
+                MeasureSSE(block, surface, uv, density);
+                break;
+#endif
+            default:
+                MeasureScalar(block, surface, uv, density);
+                break;
+            }
+        }
+        table.TriangleDensity.resize(triangleCount);
+
+        // Weld by position and UV, then join the vertices of every triangle
+        std::unordered_map<WeldKey, uint32_t, WeldKeyHash> welded;
+        welded.reserve(vertexCount);
+        std::vector<uint32_t> weldedIndex(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            const float* p = VertexAt(positions, vertexStride, static_cast<uint32_t>(v));
+            const float* t = VertexAt(uvs, vertexStride, static_cast<uint32_t>(v));
+            WeldKey key = { { p[0], p[1], p[2], t[0], t[1] } };
+            weldedIndex[v] = welded.emplace(key, static_cast<uint32_t>(welded.size())).first->second;
+        }
+
+        std::vector<uint32_t> parents(welded.size());
+        for (uint32_t i = 0; i < parents.size(); i++)
+            parents[i] = i;
+
+        for (size_t t = 0; t < triangleCount; t++)
+        {
+            const uint32_t* triangle = indices + t * 3;
+            uint32_t root = FindRoot(parents, weldedIndex[triangle[0]]);
+            for (uint32_t corner = 1; corner < 3; corner++)
+            {
+                uint32_t other = FindRoot(parents, weldedIndex[triangle[corner]]);
+                if (other != root)
+                    parents[other] = root;
+            }
+        }
+
+        // Number the charts in the order their first triangle appears
+        std::vector<uint32_t> rootChart(parents.size(), UINT32_MAX);
+        table.TriangleChart.resize(triangleCount);
+        table.Density.Min = FLT_MAX;
+
+        for (size_t t = 0; t < triangleCount; t++)
+        {
+            uint32_t root = FindRoot(parents, weldedIndex[indices[t * 3]]);
+            if (rootChart[root] == UINT32_MAX)
+            {
+                rootChart[root] = static_cast<uint32_t>(table.Charts.size());
+                table.Charts.emplace_back().Density.Min = FLT_MAX;
+            }
+
+            uint32_t chartIndex = rootChart[root];
+            table.TriangleChart[t] = chartIndex;
+
+            UVChartDensity& chart = table.Charts[chartIndex];
+            ++chart.TriangleCount;
+            chart.SurfaceArea += surfaceAreas[t];
+            chart.UVArea += uvAreas[t];
+            table.SurfaceArea += surfaceAreas[t];
+            table.UVArea += uvAreas[t];
+
+            // Degenerate triangles cover no surface, they have no density to speak of
+            if (surfaceAreas[t] > 0.0f)
+            {
+                AddToStats(chart.Density, table.TriangleDensity[t]);
+                AddToStats(table.Density, table.TriangleDensity[t]);
+            }
+        }
+
+        for (UVChartDensity& chart : table.Charts)
+            FinishStats(chart.Density, chart.SurfaceArea, chart.UVArea);
+        FinishStats(table.Density, table.SurfaceArea, table.UVArea);
+
+        return table;
+    }
+}
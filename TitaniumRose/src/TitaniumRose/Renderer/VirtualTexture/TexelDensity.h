@@ -0,0 +1,85 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Roses
+{
+    /// <summary>
+    /// The spread of texel densities over a set of triangles. A density is the UV area, in
+    /// [0, 1] units, a triangle covers per unit of its object-space surface area, multiply it
+    /// by the texture's width and height to get texels per unit of surface.
+    /// </summary>
+    struct TexelDensityStats
+    {
+        float Min = 0.0f;
+        // Weighted by surface area, the total UV area over the total surface area
+        float Mean = 0.0f;
+        float Max = 0.0f;
+
+        // How much more the densest triangle is magnified than the sparsest one, 1 for a
+        // mapping without distortion. Triangles without UV area are left out of the minimum.
+        inline float Distortion() const { return Min > 0.0f ? Max / Min : 0.0f; }
+    };
+
+    /// <summary>
+    /// A set of triangles connected through vertices that share both position and UV.
+    /// </summary>
+    struct UVChartDensity
+    {
+        uint32_t TriangleCount = 0;
+        float SurfaceArea = 0.0f;
+        float UVArea = 0.0f;
+        TexelDensityStats Density;
+    };
+
+    struct TexelDensityTable
+    {
+        // One entry per triangle, in index buffer order
+        std::vector<float> TriangleDensity;
+        std::vector<uint32_t> TriangleChart;
+
+        std::vector<UVChartDensity> Charts;
+        TexelDensityStats Density;
+        float SurfaceArea = 0.0f;
+        float UVArea = 0.0f;
+
+        inline float TexelsPerUnitArea(uint32_t textureWidth, uint32_t textureHeight) const
+        {
+            return Density.Mean * float(textureWidth) * float(textureHeight);
+        }
+    };
+
+    enum class TexelDensityKernel
+    {
+        Scalar,
+        SSE,
+        AVX
+    };
+
+    /// <summary>
+    /// The widest kernel the CPU we are running on supports
+    /// </summary>
+    TexelDensityKernel GetBestTexelDensityKernel();
+    const char* GetTexelDensityKernelName(TexelDensityKernel kernel);
+
+    /// <summary>
+    /// Measures every triangle of a mesh and groups them into UV charts. The areas are
+    /// computed eight or four triangles at a time when the CPU allows.
+    /// </summary>
+    /// <param name="positions">The first vertex's position, three floats</param>
+    /// <param name="uvs">The first vertex's UV, two floats</param>
+    /// <param name="vertexStride">The distance between two vertices in bytes</param>
+    /// <param name="vertexCount">The number of vertices</param>
+    /// <param name="indices">Three indices per triangle</param>
+    /// <param name="triangleCount">The number of triangles</param>
+    /// <param name="kernel">Falls back to the best supported kernel if this one is not</param>
+    TexelDensityTable ComputeTexelDensity(const float* positions, const float* uvs, size_t vertexStride,
+        size_t vertexCount, const uint32_t* indices, size_t triangleCount, TexelDensityKernel kernel);
+
+    inline TexelDensityTable ComputeTexelDensity(const float* positions, const float* uvs, size_t vertexStride,
+        size_t vertexCount, const uint32_t* indices, size_t triangleCount)
+    {
+        return ComputeTexelDensity(positions, uvs, vertexStride, vertexCount, indices, triangleCount, GetBestTexelDensityKernel());
+    }
+}
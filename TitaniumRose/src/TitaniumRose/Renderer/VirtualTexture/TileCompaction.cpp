@@ -0,0 +1,127 @@
+#include "trpch.h"
+#include "TitaniumRose/Renderer/VirtualTexture/TileCompaction.h"
+
+namespace Roses
+{
+    FragmentationStats MeasureFragmentation(const std::vector<CompactionPage>& pages)
+    {
+        FragmentationStats stats;
+        uint32_t tilesInUsedPages = 0;
+        uint32_t largestPage = 0;
+
+        for (auto& page : pages)
+        {
+            uint32_t used = page.Allocator->Size() - page.Allocator->NumFreeTiles();
+            largestPage = std::max(largestPage, page.Allocator->Size());
+
+            if (used == 0)
+                continue;
+
+            stats.UsedTiles += used;
+            tilesInUsedPages += page.Allocator->Size();
+            ++stats.PagesInUse;
+        }
+
+        if (largestPage > 0)
+            stats.MinimumPages = (stats.UsedTiles + largestPage - 1) / largestPage;
+
+        if (tilesInUsedPages > 0)
+            stats.Fragmentation = 1.0f - static_cast<float>(stats.UsedTiles) / tilesInUsedPages;
+
+        return stats;
+    }
+
+    CompactionPlan PlanTileCompaction(const std::vector<CompactionPage>& pages, uint32_t maxMoves)
+    {
+        CompactionPlan plan;
+        plan.Before = MeasureFragmentation(pages);
+
+        if (maxMoves == 0 || plan.Before.PagesInUse <= plan.Before.MinimumPages)
+        {
+            plan.After = plan.Before;
+            return plan;
+        }
+
+        // Work on copies so the plan can be made without touching the pool
+        std::vector<TilePageAllocator> allocators;
+        allocators.reserve(pages.size());
+        for (auto& page : pages)
+        {
+            allocators.push_back(*page.Allocator);
+        }
+
+        auto used = [&](size_t p) { return allocators[p].Size() - allocators[p].NumFreeTiles(); };
+
+        // Sparsest pages first, those are the ones we want to empty. Empty pages are
+        // left out, they have nothing to move and should not receive tiles either.
+        std::vector<size_t> order;
+        for (size_t p = 0; p < pages.size(); p++)
+        {
+            if (used(p) > 0)
+                order.push_back(p);
+        }
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return used(a) < used(b); });
+
+        size_t source = 0;
+        size_t destination = order.size() - 1;
+        uint32_t sourceCursor = 0;
+        bool sourceChecked = false;
+
+        while (plan.Moves.size() < maxMoves && source < destination)
+        {
+            auto& src = allocators[order[source]];
+            auto& dst = allocators[order[destination]];
+
+            if (dst.NumFreeTiles() == 0)
+            {
+                --destination;
+                continue;
+            }
+
+            if (!sourceChecked)
+            {
+                uint32_t freeInDenserPages = 0;
+                for (size_t d = source + 1; d <= destination; d++)
+                {
+                    freeInDenserPages += allocators[order[d]].NumFreeTiles();
+                }
+
+                // If the sparsest page does not fit, no denser one will
+                if (freeInDenserPages < used(order[source]))
+                    break;
+
+                sourceChecked = true;
+            }
+
+            while (!src.IsAllocated(sourceCursor))
+            {
+                ++sourceCursor;
+            }
+
+            uint32_t destinationTile = dst.Allocate();
+            src.Release(sourceCursor);
+
+            plan.Moves.push_back({
+                pages[order[source]].Index, sourceCursor,
+                pages[order[destination]].Index, destinationTile
+            });
+
+            if (used(order[source]) == 0)
+            {
+                plan.PagesEmptied.push_back(pages[order[source]].Index);
+                ++source;
+                sourceCursor = 0;
+                sourceChecked = false;
+            }
+        }
+
+        std::vector<CompactionPage> after = pages;
+        for (size_t p = 0; p < after.size(); p++)
+        {
+            after[p].Allocator = &allocators[p];
+        }
+        plan.After = MeasureFragmentation(after);
+
+        return plan;
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "TitaniumRose/Renderer/VirtualTexture/TilePageAllocator.h"
+
+namespace Roses
+{
+    /// <summary>
+    /// A page as seen by the compaction planner. Index is whatever the caller uses to
+    /// identify the page, it is only copied into the moves.
+    /// </summary>
+    struct CompactionPage
+    {
+        uint16_t Index;
+        const TilePageAllocator* Allocator;
+    };
+
+    struct TileMove
+    {
+        uint16_t SourcePage;
+        uint32_t SourceTile;
+        uint16_t DestinationPage;
+        uint32_t DestinationTile;
+    };
+
+    struct FragmentationStats
+    {
+        uint32_t UsedTiles = 0;
+        // Pages with at least one tile in use
+        uint32_t PagesInUse = 0;
+        // The pages that would be needed if every page was packed
+        uint32_t MinimumPages = 0;
+        // Fraction of the tiles of the pages in use that are free, 0 means perfectly packed
+        float Fragmentation = 0.0f;
+    };
+
+    struct CompactionPlan
+    {
+        std::vector<TileMove> Moves;
+        // Pages that are empty once all the moves are done
+        std::vector<uint16_t> PagesEmptied;
+        FragmentationStats Before;
+        FragmentationStats After;
+    };
+
+    FragmentationStats MeasureFragmentation(const std::vector<CompactionPage>& pages);
+
+    /// <summary>
+    /// Plans up to maxMoves tile moves that empty the sparsest pages into the densest
+    /// ones. A page is only evacuated if all of its tiles fit in denser pages, so tiles
+    /// never move back and forth between frames. If the budget runs out halfway through
+    /// a page, planning again next frame picks up the same page.
+    /// </summary>
+    /// <param name="pages">The pages of the pool, they are not modified</param>
+    /// <param name="maxMoves">The maximum number of tiles to move</param>
+    /// <returns>The moves in the order they should be applied</returns>
+    CompactionPlan PlanTileCompaction(const std::vector<CompactionPage>& pages, uint32_t maxMoves);
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "TitaniumRose/Renderer/VirtualTexture/TileMappingBuilder.h"
+
+namespace Roses
+{
+    /// <summary>
+    /// Identifies a virtual texture to the tile pool. The pool never looks inside it, it
+    /// is only handed back to the backend, which knows what it actually points to.
+    /// </summary>
+    using VirtualTextureHandle = void*;
+
+    /// <summary>
+    /// A tile of a texture that moves to a different place in the pool, with its contents.
+    /// </summary>
+    struct TileRelocation
+    {
+        VirtualTextureHandle Texture;
+        uint32_t X;
+        uint32_t Y;
+        uint32_t Subresource;
+        bool     Packed;
+        uint16_t DestinationPage;
+        uint32_t DestinationTile;
+    };
+
+    /// <summary>
+    /// Everything the tile pool needs from the graphics API. The pool decides which tile
+    /// goes where, the backend owns the memory behind the pages and applies the mappings.
+    /// </summary>
+    class TileMappingBackend
+    {
+    public:
+        virtual ~TileMappingBackend() = default;
+
+        virtual void CreatePage(uint16_t pageIndex, uint32_t numTiles) = 0;
+        virtual void DestroyPage(uint16_t pageIndex) = 0;
+
+        /// <summary>
+        /// Applies the regions of one texture, in the order TileMappingBuilder::Build
+        /// returns them.
+        /// </summary>
+        /// <returns>The number of API calls it took</returns>
+        virtual uint32_t UpdateMappings(VirtualTextureHandle texture, const std::vector<TileMappingRegion>& regions) = 0;
+
+        /// <summary>
+        /// Null maps every tile of the texture
+        /// </summary>
+        virtual void UnmapAll(VirtualTextureHandle texture) = 0;
+
+        /// <summary>
+        /// Saves the contents of the tiles before they are remapped. CopyTilesIn is called
+        /// with the same list once the new mappings were submitted.
+        /// </summary>
+        virtual void CopyTilesOut(const std::vector<TileRelocation>& tiles) = 0;
+        virtual void CopyTilesIn(const std::vector<TileRelocation>& tiles) = 0;
+    };
+}
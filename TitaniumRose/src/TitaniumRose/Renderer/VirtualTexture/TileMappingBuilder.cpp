@@ -0,0 +1,130 @@
+#include "trpch.h"
+#include "TitaniumRose/Renderer/VirtualTexture/TileMappingBuilder.h"
+
+namespace Roses
+{
+    void TileMappingBuilder::Map(uint32_t x, uint32_t y, uint32_t subresource, uint16_t page, uint32_t heapOffset)
+    {
+        Request request;
+        request.Region = { x, y, subresource, 1, 1, heapOffset, page, false, false };
+        request.Sequence = static_cast<uint32_t>(m_Requests.size());
+        m_Requests.push_back(request);
+    }
+
+    void TileMappingBuilder::Unmap(uint32_t x, uint32_t y, uint32_t subresource)
+    {
+        Request request;
+        request.Region = { x, y, subresource, 1, 1, 0, 0, true, false };
+        request.Sequence = static_cast<uint32_t>(m_Requests.size());
+        m_Requests.push_back(request);
+    }
+
+    void TileMappingBuilder::MapPacked(uint32_t subresource, uint32_t numTiles, uint16_t page, uint32_t heapOffset)
+    {
+        Request request;
+        request.Region = { 0, 0, subresource, numTiles, 1, heapOffset, page, false, true };
+        request.Sequence = static_cast<uint32_t>(m_Requests.size());
+        m_Requests.push_back(request);
+    }
+
+    const std::vector<TileMappingRegion>& TileMappingBuilder::Build()
+    {
+        m_Regions.clear();
+
+        // Order by coordinate, with later requests for the same tile after earlier ones
+        std::sort(m_Requests.begin(), m_Requests.end(), [](const Request& a, const Request& b) {
+            if (a.Region.Packed != b.Region.Packed) return a.Region.Packed;
+            if (a.Region.Subresource != b.Region.Subresource) return a.Region.Subresource < b.Region.Subresource;
+            if (a.Region.Y != b.Region.Y) return a.Region.Y < b.Region.Y;
+            if (a.Region.X != b.Region.X) return a.Region.X < b.Region.X;
+            return a.Sequence < b.Sequence;
+        });
+
+        // =================== MERGE ALONG ROWS =====================================
+        std::vector<TileMappingRegion> rows;
+        rows.reserve(m_Requests.size());
+
+        for (size_t r = 0; r < m_Requests.size(); r++)
+        {
+            auto& current = m_Requests[r].Region;
+
+            // A later request for the same tile overrides this one
+            if (r + 1 < m_Requests.size())
+            {
+                auto& next = m_Requests[r + 1].Region;
+                if (next.Packed == current.Packed && next.Subresource == current.Subresource
+                    && next.X == current.X && next.Y == current.Y)
+                    continue;
+            }
+
+            if (current.Packed) {
+                m_Regions.push_back(current);
+                continue;
+            }
+
+            if (!rows.empty())
+            {
+                auto& row = rows.back();
+                bool adjacent = row.Subresource == current.Subresource
+                    && row.Y == current.Y
+                    && row.X + row.Width == current.X
+                    && row.Null == current.Null;
+                bool contiguous = current.Null
+                    || (row.Page == current.Page && row.HeapOffset + row.Width == current.HeapOffset);
+
+                if (adjacent && contiguous) {
+                    ++row.Width;
+                    continue;
+                }
+            }
+            rows.push_back(current);
+        }
+
+        // =================== STACK ROWS INTO BOXES ================================
+        // Rows are ordered by y, so a box can only grow from the row right below it
+        std::unordered_map<uint64_t, size_t> openBoxes;
+        uint32_t currentSubresource = uint32_t(-1);
+
+        for (auto& row : rows)
+        {
+            if (row.Subresource != currentSubresource) {
+                openBoxes.clear();
+                currentSubresource = row.Subresource;
+            }
+
+            uint64_t key = (uint64_t(row.X) << 32) | row.Width;
+            auto search = openBoxes.find(key);
+
+            if (search != openBoxes.end())
+            {
+                auto& box = m_Regions[search->second];
+                bool stacks = box.Y + box.Height == row.Y && box.Null == row.Null;
+                bool contiguous = row.Null
+                    || (box.Page == row.Page && box.HeapOffset + box.NumTiles() == row.HeapOffset);
+
+                if (stacks && contiguous) {
+                    ++box.Height;
+                    continue;
+                }
+            }
+
+            openBoxes[key] = m_Regions.size();
+            m_Regions.push_back(row);
+        }
+
+        // Null regions do not need a heap so they all go in the first submission, the rest
+        // are grouped per page. Keep the spatial order inside each group.
+        std::stable_sort(m_Regions.begin(), m_Regions.end(), [](const TileMappingRegion& a, const TileMappingRegion& b) {
+            if (a.Null != b.Null) return a.Null;
+            return !a.Null && a.Page < b.Page;
+        });
+
+        return m_Regions;
+    }
+
+    void TileMappingBuilder::Clear()
+    {
+        m_Requests.clear();
+        m_Regions.clear();
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace Roses
+{
+    /// <summary>
+    /// One coalesced update for a tiled resource. Standard regions are boxes of
+    /// Width x Height tiles, walked x first, mapped to NumTiles() consecutive tiles of
+    /// the heap starting at HeapOffset. Packed regions cover the packed mips, which
+    /// have no coordinates inside the subresource.
+    /// </summary>
+    struct TileMappingRegion
+    {
+        uint32_t X;
+        uint32_t Y;
+        uint32_t Subresource;
+        uint32_t Width;
+        uint32_t Height;
+        uint32_t HeapOffset;
+        uint16_t Page;
+        bool     Null;
+        bool     Packed;
+
+        inline uint32_t NumTiles() const { return Width * Height; }
+    };
+
+    /// <summary>
+    /// Collects per-tile map/unmap requests for one resource and merges them into as
+    /// few regions as possible. Tiles are merged along rows first, and rows with the
+    /// same extent are then stacked into boxes. Mapped tiles are only merged if their
+    /// heap offsets follow the same order, null mappings only need to be adjacent.
+    /// If the same tile is requested more than once, the last request wins.
+    /// </summary>
+    class TileMappingBuilder
+    {
+    public:
+        void Map(uint32_t x, uint32_t y, uint32_t subresource, uint16_t page, uint32_t heapOffset);
+        void Unmap(uint32_t x, uint32_t y, uint32_t subresource);
+        void MapPacked(uint32_t subresource, uint32_t numTiles, uint16_t page, uint32_t heapOffset);
+
+        /// <summary>
+        /// Coalesces everything requested since the last Clear. Null regions come first,
+        /// followed by the mapped regions grouped by page, which is the order they have
+        /// to be submitted in since every submission can only reference one heap.
+        /// </summary>
+        const std::vector<TileMappingRegion>& Build();
+
+        void Clear();
+
+        inline bool Empty() const { return m_Requests.empty(); }
+        inline size_t NumRequests() const { return m_Requests.size(); }
+
+    private:
+        struct Request
+        {
+            TileMappingRegion Region;
+            uint32_t Sequence;
+        };
+
+        std::vector<Request> m_Requests;
+        std::vector<TileMappingRegion> m_Regions;
+    };
+}
@@ -0,0 +1,242 @@
+#include "trpch.h"
+#include "TitaniumRose/Renderer/VirtualTexture/TilePageAllocator.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace Roses
+{
+    static constexpr uint64_t AllBits = ~uint64_t(0);
+
+    TilePageAllocator::TilePageAllocator(uint32_t numTiles)
+        : m_NumTiles(numTiles), m_FreeTiles(numTiles)
+    {
+        HZ_CORE_ASSERT(numTiles > 0, "Cannot have a page with 0 tiles");
+
+        // Build the levels bottom up, until a single word can summarize the level below it
+        uint32_t bits = numTiles;
+        do
+        {
+            uint32_t words = (bits + 63) / 64;
+            std::vector<uint64_t> level(words, AllBits);
+
+            // Bits past the end must never look free, or we would hand out tiles the heap does not have
+            if (bits % 64 != 0) {
+                level.back() = (uint64_t(1) << (bits % 64)) - 1;
+            }
+
+            m_Levels.emplace_back(std::move(level));
+            bits = words;
+        } while (bits > 1);
+    }
+
+    uint32_t TilePageAllocator::Allocate()
+    {
+        if (m_FreeTiles == 0)
+            return InvalidTile;
+
+        uint32_t index = 0;
+        for (size_t level = m_Levels.size(); level-- > 0;)
+        {
+            uint64_t word = m_Levels[level][index];
+            HZ_CORE_ASSERT(word != 0, "Summary bits are out of sync with the tiles");
+            index = index * 64 + FindFirstSet(word);
+        }
+
+        MarkUsed(index);
+        return index;
+    }
+
+    uint32_t TilePageAllocator::AllocateRun(uint32_t count)
+    {
+        if (count == 0 || count > m_FreeTiles)
+            return InvalidTile;
+
+        if (count == 1)
+            return Allocate();
+
+        auto& tiles = m_Levels[0];
+        const bool hasSummary = m_Levels.size() > 1;
+
+        uint32_t runStart = 0;
+        uint32_t runLength = 0;
+
+        for (uint32_t w = 0; w < tiles.size(); w++)
+        {
+            // A zero summary word means the next 64 words are full, no run can go through them
+            if (hasSummary && (w % 64) == 0 && m_Levels[1][w / 64] == 0) {
+                runLength = 0;
+                w += 63;
+                continue;
+            }
+
+            uint64_t word = tiles[w];
+            uint32_t base = w * 64;
+
+            if (word == 0) {
+                runLength = 0;
+                continue;
+            }
+
+            if (word == AllBits) {
+                if (runLength == 0)
+                    runStart = base;
+                runLength += 64;
+            }
+            else {
+                uint32_t bit = 0;
+                while (bit < 64)
+                {
+                    uint64_t remaining = word >> bit;
+
+                    if (remaining == 0) {
+                        runLength = 0;
+                        break;
+                    }
+
+                    if ((remaining & 1) == 0) {
+                        runLength = 0;
+                        bit += FindFirstSet(remaining);
+                        continue;
+                    }
+
+                    uint64_t used = ~remaining;
+                    uint32_t length = (used == 0) ? 64 - bit : FindFirstSet(used);
+
+                    // Only a run that starts at bit 0 can continue the one from the previous word
+                    if (bit != 0 || runLength == 0) {
+                        runStart = base + bit;
+                        runLength = 0;
+                    }
+
+                    runLength += length;
+                    if (runLength >= count)
+                        break;
+
+                    bit += length;
+                }
+            }
+
+            if (runLength >= count)
+            {
+                uint32_t tile = runStart;
+                uint32_t remainingTiles = count;
+                while (remainingTiles > 0)
+                {
+                    uint32_t wordIndex = tile / 64;
+                    uint32_t bit = tile % 64;
+                    uint32_t span = std::min(64 - bit, remainingTiles);
+                    uint64_t mask = (span == 64) ? AllBits : ((uint64_t(1) << span) - 1) << bit;
+
+                    HZ_CORE_ASSERT((tiles[wordIndex] & mask) == mask, "Run contains tiles that are in use");
+                    tiles[wordIndex] &= ~mask;
+                    UpdateSummary(wordIndex);
+
+                    tile += span;
+                    remainingTiles -= span;
+                }
+                m_FreeTiles -= count;
+                return runStart;
+            }
+        }
+
+        return InvalidTile;
+    }
+
+    bool TilePageAllocator::AllocateAt(uint32_t tile)
+    {
+        HZ_CORE_ASSERT(tile < m_NumTiles, "Tile is outside the available tile range");
+        if (IsAllocated(tile))
+            return false;
+
+        MarkUsed(tile);
+        return true;
+    }
+
+    void TilePageAllocator::Release(uint32_t tile)
+    {
+        HZ_CORE_ASSERT(tile < m_NumTiles, "Tile is outside the available tile range");
+        if (!IsAllocated(tile))
+            return;
+
+        MarkFree(tile);
+    }
+
+    void TilePageAllocator::ReleaseRun(uint32_t firstTile, uint32_t count)
+    {
+        HZ_CORE_ASSERT(firstTile + count <= m_NumTiles, "Run is outside the available tile range");
+        for (uint32_t t = firstTile; t < firstTile + count; t++)
+        {
+            Release(t);
+        }
+    }
+
+    bool TilePageAllocator::IsAllocated(uint32_t tile) const
+    {
+        HZ_CORE_ASSERT(tile < m_NumTiles, "Tile is outside the available tile range");
+        return (m_Levels[0][tile / 64] & (uint64_t(1) << (tile % 64))) == 0;
+    }
+
+    uint32_t TilePageAllocator::LargestFreeRun() const
+    {
+        uint32_t largest = 0;
+        uint32_t current = 0;
+        for (uint32_t t = 0; t < m_NumTiles; t++)
+        {
+            if (IsAllocated(t)) {
+                current = 0;
+                continue;
+            }
+            largest = std::max(largest, ++current);
+        }
+        return largest;
+    }
+
+    uint32_t TilePageAllocator::FindFirstSet(uint64_t word)
+    {
+        HZ_CORE_ASSERT(word != 0, "No bit is set");
+#ifdef _MSC_VER
+        unsigned long index = 0;
+        _BitScanForward64(&index, word);
+        return static_cast<uint32_t>(index);
+#else
+        return static_cast<uint32_t>(__builtin_ctzll(word));
+#endif
+    }
+
+    void TilePageAllocator::MarkUsed(uint32_t tile)
+    {
+        uint32_t wordIndex = tile / 64;
+        m_Levels[0][wordIndex] &= ~(uint64_t(1) << (tile % 64));
+        --m_FreeTiles;
+        UpdateSummary(wordIndex);
+    }
+
+    void TilePageAllocator::MarkFree(uint32_t tile)
+    {
+        uint32_t wordIndex = tile / 64;
+        m_Levels[0][wordIndex] |= uint64_t(1) << (tile % 64);
+        ++m_FreeTiles;
+        UpdateSummary(wordIndex);
+    }
+
+    void TilePageAllocator::UpdateSummary(uint32_t wordIndex)
+    {
+        for (size_t level = 1; level < m_Levels.size(); level++)
+        {
+            bool hasFree = m_Levels[level - 1][wordIndex] != 0;
+            uint64_t& summary = m_Levels[level][wordIndex / 64];
+            uint64_t bit = uint64_t(1) << (wordIndex % 64);
+
+            bool wasEmpty = summary == 0;
+            summary = hasFree ? (summary | bit) : (summary & ~bit);
+
+            // The level above only cares whether this word is empty or not
+            if (wasEmpty == (summary == 0))
+                break;
+
+            wordIndex /= 64;
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace Roses
+{
+    /// <summary>
+    /// Tracks which tiles of a single heap page are in use. Free tiles are kept as
+    /// set bits in 64-bit words, and every word is summarized by one bit in the level
+    /// above it, so finding a free tile is a find-first-set per level instead of a scan
+    /// over the whole page.
+    /// </summary>
+    class TilePageAllocator
+    {
+    public:
+        static constexpr uint32_t InvalidTile = uint32_t(-1);
+
+        TilePageAllocator(uint32_t numTiles);
+
+        /// <summary>
+        /// Allocates the lowest free tile of the page.
+        /// </summary>
+        /// <returns>The tile index, or InvalidTile if the page is full</returns>
+        uint32_t Allocate();
+
+        /// <summary>
+        /// Allocates count contiguous tiles, so that neighbouring texture tiles end up
+        /// in neighbouring heap offsets. This is first-fit, so it will not try to find
+        /// the tightest hole.
+        /// </summary>
+        /// <param name="count">The number of tiles in the run</param>
+        /// <returns>The first tile of the run, or InvalidTile if no run fits</returns>
+        uint32_t AllocateRun(uint32_t count);
+
+        /// <summary>
+        /// Allocates a specific tile, used when tiles are moved between pages.
+        /// </summary>
+        /// <returns>False if the tile was already in use</returns>
+        bool AllocateAt(uint32_t tile);
+
+        void Release(uint32_t tile);
+        void ReleaseRun(uint32_t firstTile, uint32_t count);
+
+        bool IsAllocated(uint32_t tile) const;
+
+        /// <summary>
+        /// Length of the longest run of free tiles. This walks the whole page, so it is
+        /// meant for diagnostics rather than the allocation path.
+        /// </summary>
+        uint32_t LargestFreeRun() const;
+
+        inline uint32_t NumFreeTiles() const { return m_FreeTiles; }
+        inline uint32_t Size() const { return m_NumTiles; }
+
+    private:
+        static uint32_t FindFirstSet(uint64_t word);
+
+        void MarkUsed(uint32_t tile);
+        void MarkFree(uint32_t tile);
+        void UpdateSummary(uint32_t wordIndex);
+
+        // m_Levels[0] holds one bit per tile, m_Levels[n] holds one bit per word of m_Levels[n - 1].
+        // The last level always fits in a single word.
+        std::vector<std::vector<uint64_t>> m_Levels;
+        uint32_t m_NumTiles;
+        uint32_t m_FreeTiles;
+    };
+}
@@ -0,0 +1,707 @@
+#include "trpch.h"
+#include "TitaniumRose/Renderer/VirtualTexture/TilePoolCore.h"
+
+namespace Roses
+{
+    TilePoolCore::TilePoolCore(TileMappingBackend& backend, uint32_t tilesPerPage)
+        : m_Backend(backend), m_TilesPerPage(tilesPerPage)
+    {
+    }
+
+    void TilePoolCore::MapTexture(VirtualTextureHandle texture, const VirtualTextureLayout& layout, const TextureResidencyRequest& request)
+    {
+        HZ_CORE_ASSERT(layout.NumPackedTiles <= 1, "Currently we only support packed mips on 1 tile");
+
+        TextureAllocationInfo& allocInfo = GetTextureInfo(texture, layout);
+        allocInfo.LastUsedFrame = m_FrameCounter;
+
+        if (m_ResidencyMode == TileResidencyMode::FeedbackTiles && request.Feedback != nullptr)
+        {
+            MapTextureTiles(texture, allocInfo, request);
+            return;
+        }
+
+        const uint32_t numStandardMips = static_cast<uint32_t>(allocInfo.MipAllocations.size());
+        MipRange residentMips = MakeResidentRange(request.FinestMip, request.CoarsestMip, numStandardMips);
+
+        bool needsPackedMips = !allocInfo.PackedMipsMapped && allocInfo.Layout.NumPackedTiles > 0;
+        bool modeChanged = allocInfo.Mode != TileResidencyMode::MipRange;
+        bool retry = allocInfo.Incomplete;
+
+        // Steady state, nothing changed since the last time we mapped this texture
+        if (!needsPackedMips && !modeChanged && !retry && residentMips == allocInfo.ResidentMips)
+        {
+            ++m_CurrentStats.TexturesUnchanged;
+            return;
+        }
+
+        TileMappingBuilder& updates = m_PendingUpdates[texture];
+        Ref<TilePage> currentPage = FindAvailablePage(1);
+        allocInfo.Incomplete = false;
+
+        if (needsPackedMips)
+        {
+            MapPackedMips(allocInfo, updates, currentPage);
+        }
+
+        // Only touch the mips that entered or left the resident range
+        MipResidencyDelta delta = DiffMipRanges(allocInfo.ResidentMips, residentMips);
+
+        // Coming from per-tile residency any tile of any mip might be mapped, and after
+        // running out of budget some resident mips have holes, so every mip has to be
+        // visited. Mapped tiles are skipped and unmapped ones ignored.
+        if (modeChanged || retry)
+        {
+            delta = DiffMipRanges({ 0, numStandardMips }, residentMips);
+            for (uint32_t mip = residentMips.Begin; mip < residentMips.End; mip++)
+            {
+                delta.MipsToMap.push_back(mip);
+            }
+            allocInfo.ResidentTiles = {};
+            allocInfo.Mode = TileResidencyMode::MipRange;
+        }
+
+        // =================== NULL MAP THE MIPS WE NO LONGER USE =====================
+        for (uint32_t mip : delta.MipsToUnmap)
+        {
+            UnmapMipLevel(allocInfo, updates, mip);
+        }
+
+        // =================== MAP THE NEWLY USED MIPS TO THE POOL ====================
+        for (uint32_t mip : delta.MipsToMap)
+        {
+            MapMipLevel(allocInfo, updates, mip, currentPage);
+        }
+
+        allocInfo.ResidentMips = residentMips;
+        ++m_CurrentStats.TexturesUpdated;
+        // The updates are applied in FlushUpdates, once per frame for all the textures
+    }
+
+    void TilePoolCore::MapTextureTiles(VirtualTextureHandle texture, TextureAllocationInfo& allocInfo, const TextureResidencyRequest& request)
+    {
+        // Decoupled shading only writes the finest mip used and generates the coarser ones
+        // from it, so every sampled region needs its tiles from that mip down
+        TileResidencySet residentTiles = BuildTileResidency(request.Feedback, request.FeedbackWidth, request.FeedbackHeight,
+            allocInfo.Layout.MipLevels, allocInfo.Layout.MipGrids, m_ResidencyBorder, request.FinestMip);
+
+        bool needsPackedMips = !allocInfo.PackedMipsMapped && allocInfo.Layout.NumPackedTiles > 0;
+        bool modeChanged = allocInfo.Mode != TileResidencyMode::FeedbackTiles;
+
+        if (!needsPackedMips && !modeChanged && !allocInfo.Incomplete && residentTiles == allocInfo.ResidentTiles)
+        {
+            ++m_CurrentStats.TexturesUnchanged;
+            return;
+        }
+
+        TileMappingBuilder& updates = m_PendingUpdates[texture];
+        Ref<TilePage> currentPage = FindAvailablePage(1);
+        allocInfo.Incomplete = false;
+
+        if (needsPackedMips)
+        {
+            MapPackedMips(allocInfo, updates, currentPage);
+        }
+
+        std::vector<uint32_t> tilesToMap;
+        for (uint32_t mip = 0; mip < residentTiles.NumMips(); mip++)
+        {
+            const TileGridSize& grid = residentTiles.GetGrid(mip);
+            auto& tileAllocations = allocInfo.MipAllocations[mip].TileAllocations;
+            tilesToMap.clear();
+
+            for (uint32_t y = 0; y < grid.Height; y++)
+            {
+                for (uint32_t x = 0; x < grid.Width; x++)
+                {
+                    uint32_t index = y * grid.Width + x;
+                    auto& tileAllocation = tileAllocations[index];
+                    bool resident = residentTiles.IsResident(mip, x, y);
+
+                    if (tileAllocation.Mapped && !resident)
+                    {
+                        updates.Unmap(x, y, mip);
+                        ReleaseTile(tileAllocation.TileAddress);
+                        tileAllocation.Mapped = false;
+                        ++m_CurrentStats.TilesUnmapped;
+                    }
+                    else if (!tileAllocation.Mapped && resident)
+                    {
+                        tilesToMap.push_back(index);
+                    }
+                }
+            }
+
+            MapTiles(allocInfo, updates, mip, tilesToMap, currentPage);
+        }
+
+        allocInfo.ResidentTiles = std::move(residentTiles);
+        allocInfo.ResidentMips = {};
+        allocInfo.Mode = TileResidencyMode::FeedbackTiles;
+        ++m_CurrentStats.TexturesUpdated;
+    }
+
+    void TilePoolCore::MapPackedMips(TextureAllocationInfo& allocInfo, TileMappingBuilder& updates, Ref<TilePage>& currentPage)
+    {
+        if (currentPage == nullptr || currentPage->NumFreeTiles() == 0) {
+            currentPage = AcquirePage(allocInfo, 1);
+            if (currentPage == nullptr) {
+                allocInfo.Incomplete = true;
+                ++m_CurrentStats.TilesDenied;
+                return;
+            }
+        }
+
+        allocInfo.PackedMipsAddress.Page = currentPage->PageIndex;
+        allocInfo.PackedMipsAddress.Tile = currentPage->AllocateTile();
+
+        updates.MapPacked(allocInfo.Layout.PackedSubresource, allocInfo.Layout.NumPackedTiles,
+            allocInfo.PackedMipsAddress.Page, allocInfo.PackedMipsAddress.Tile);
+
+        allocInfo.PackedMipsMapped = true;
+    }
+
+    void TilePoolCore::MapMipLevel(TextureAllocationInfo& allocInfo, TileMappingBuilder& updates, uint32_t mip, Ref<TilePage>& currentPage)
+    {
+        auto& tileAllocations = allocInfo.MipAllocations[mip].TileAllocations;
+
+        std::vector<uint32_t> tilesToMap;
+        tilesToMap.reserve(tileAllocations.size());
+        for (uint32_t i = 0; i < tileAllocations.size(); i++)
+        {
+            // Is already mapped, let's skip
+            if (!tileAllocations[i].Mapped)
+                tilesToMap.push_back(i);
+        }
+
+        MapTiles(allocInfo, updates, mip, tilesToMap, currentPage);
+    }
+
+    void TilePoolCore::MapTiles(TextureAllocationInfo& allocInfo, TileMappingBuilder& updates, uint32_t mip,
+        const std::vector<uint32_t>& tiles, Ref<TilePage>& currentPage)
+    {
+        auto& tileAllocations = allocInfo.MipAllocations[mip].TileAllocations;
+        const uint32_t width = allocInfo.Layout.MipGrids[mip].Width;
+
+        // Place the tiles in runs as long as the pages allow, so neighbouring tiles of the
+        // texture are also neighbours in the heap. A run that fits nowhere is halved, and
+        // the shorter runs are kept for the rest of the tiles since nothing longer fits.
+        uint32_t runLength = static_cast<uint32_t>(tiles.size());
+        size_t i = 0;
+        while (i < tiles.size())
+        {
+            uint32_t remaining = static_cast<uint32_t>(tiles.size() - i);
+            runLength = std::min(runLength, remaining);
+
+            uint32_t runStart = TilePageAllocator::InvalidTile;
+            Ref<TilePage> page = AllocateRunOnAnyPage(runLength, runStart);
+            if (page == nullptr)
+            {
+                if (runLength > 1)
+                {
+                    runLength = (runLength + 1) / 2;
+                    continue;
+                }
+
+                // Every page is full
+                if (AcquirePage(allocInfo, remaining) == nullptr) {
+                    // Out of budget, the rest is retried the next time we see this texture
+                    allocInfo.Incomplete = true;
+                    m_CurrentStats.TilesDenied += remaining;
+                    return;
+                }
+                runLength = remaining;
+                continue;
+            }
+
+            currentPage = page;
+            for (uint32_t offset = 0; offset < runLength; offset++, i++)
+            {
+                uint32_t index = tiles[i];
+                auto& tileAllocation = tileAllocations[index];
+                HZ_CORE_ASSERT(!tileAllocation.Mapped, "Tile is already mapped");
+
+                tileAllocation.TileAddress.Page = page->PageIndex;
+                tileAllocation.TileAddress.Tile = runStart + offset;
+
+                updates.Map(index % width, index / width, mip, tileAllocation.TileAddress.Page, tileAllocation.TileAddress.Tile);
+                tileAllocation.Mapped = true;
+                ++m_CurrentStats.TilesMapped;
+            }
+        }
+    }
+
+    void TilePoolCore::UnmapMipLevel(TextureAllocationInfo& allocInfo, TileMappingBuilder& updates, uint32_t mip)
+    {
+        const TileGridSize& grid = allocInfo.Layout.MipGrids[mip];
+        auto& tileAllocations = allocInfo.MipAllocations[mip].TileAllocations;
+
+        for (uint32_t y = 0; y < grid.Height; y++)
+        {
+            for (uint32_t x = 0; x < grid.Width; x++)
+            {
+                auto& tileAllocation = tileAllocations[y * grid.Width + x];
+
+                if (tileAllocation.Mapped)
+                {
+                    updates.Unmap(x, y, mip);
+                    ReleaseTile(tileAllocation.TileAddress);
+                    tileAllocation.Mapped = false;
+                    ++m_CurrentStats.TilesUnmapped;
+                }
+            }
+        }
+    }
+
+    void TilePoolCore::FlushUpdates()
+    {
+        for (auto& [texture, builder] : m_PendingUpdates)
+        {
+            if (builder.Empty())
+                continue;
+
+            SubmitUpdates(texture, builder);
+        }
+
+        ReleaseEmptyPages();
+        ++m_FrameCounter;
+
+        m_LastFlushStats = m_CurrentStats;
+        m_CurrentStats = {};
+    }
+
+    void TilePoolCore::SubmitUpdates(VirtualTextureHandle texture, TileMappingBuilder& builder)
+    {
+        m_CurrentStats.TilesRequested += static_cast<uint32_t>(builder.NumRequests());
+        auto& regions = builder.Build();
+
+        m_CurrentStats.Calls += m_Backend.UpdateMappings(texture, regions);
+        m_CurrentStats.RegionsSubmitted += static_cast<uint32_t>(regions.size());
+
+        builder.Clear();
+    }
+
+    void TilePoolCore::Compact()
+    {
+        m_LastCompactionStats = {};
+        if (m_CompactionBudget == 0)
+            return;
+
+        CompactionPlan plan = PlanTileCompaction(GetCompactionPages(), m_CompactionBudget);
+        m_LastCompactionStats.Before = plan.Before;
+        m_LastCompactionStats.After = plan.Before;
+
+        if (plan.Moves.empty())
+            return;
+
+        // =================== FIND WHO OWNS THE TILES WE MOVE ======================
+        std::unordered_map<uint32_t, std::pair<TileRelocation, TileAddress*>> owners;
+        for (auto& move : plan.Moves)
+        {
+            TileAddress source;
+            source.Page = move.SourcePage;
+            source.Tile = static_cast<uint16_t>(move.SourceTile);
+            owners[source.Address] = { {}, nullptr };
+        }
+
+        for (auto& [texture, info] : m_AllocationMap)
+        {
+            if (info.PackedMipsMapped)
+            {
+                auto search = owners.find(info.PackedMipsAddress.Address);
+                if (search != owners.end())
+                    search->second = { { texture, 0, 0, info.Layout.PackedSubresource, true, 0, 0 }, &info.PackedMipsAddress };
+            }
+
+            for (uint32_t mip = 0; mip < info.MipAllocations.size(); mip++)
+            {
+                auto& tileAllocations = info.MipAllocations[mip].TileAllocations;
+                uint32_t width = info.Layout.MipGrids[mip].Width;
+
+                for (uint32_t i = 0; i < tileAllocations.size(); i++)
+                {
+                    if (!tileAllocations[i].Mapped)
+                        continue;
+
+                    auto search = owners.find(tileAllocations[i].TileAddress.Address);
+                    if (search != owners.end())
+                        search->second = { { texture, i % width, i / width, mip, false, 0, 0 }, &tileAllocations[i].TileAddress };
+                }
+            }
+        }
+
+        std::vector<TileRelocation> relocations;
+        std::vector<std::pair<TileMove, TileAddress*>> moves;
+        for (auto& move : plan.Moves)
+        {
+            TileAddress source;
+            source.Page = move.SourcePage;
+            source.Tile = static_cast<uint16_t>(move.SourceTile);
+            auto& [relocation, address] = owners[source.Address];
+
+            HZ_CORE_ASSERT(address != nullptr, "An allocated tile has no owner");
+            if (address == nullptr)
+                continue;
+
+            relocation.DestinationPage = move.DestinationPage;
+            relocation.DestinationTile = move.DestinationTile;
+            relocations.push_back(relocation);
+            moves.emplace_back(move, address);
+        }
+
+        if (relocations.empty())
+            return;
+
+        m_Backend.CopyTilesOut(relocations);
+
+        // =================== REMAP TO THE NEW PAGES ===============================
+        std::unordered_map<VirtualTextureHandle, TileMappingBuilder> remaps;
+        for (size_t i = 0; i < moves.size(); i++)
+        {
+            auto& [move, address] = moves[i];
+            auto& relocation = relocations[i];
+
+            [[maybe_unused]] bool allocated = m_Pages[move.DestinationPage]->AllocateTileAt(move.DestinationTile);
+            HZ_CORE_ASSERT(allocated, "The compaction plan is out of date");
+            m_Pages[move.SourcePage]->ReleaseTile(move.SourceTile);
+
+            address->Page = move.DestinationPage;
+            address->Tile = static_cast<uint16_t>(move.DestinationTile);
+
+            if (relocation.Packed)
+                remaps[relocation.Texture].MapPacked(relocation.Subresource, 1, move.DestinationPage, move.DestinationTile);
+            else
+                remaps[relocation.Texture].Map(relocation.X, relocation.Y, relocation.Subresource, move.DestinationPage, move.DestinationTile);
+        }
+
+        for (auto& [texture, builder] : remaps)
+        {
+            SubmitUpdates(texture, builder);
+        }
+
+        m_Backend.CopyTilesIn(relocations);
+
+        // The emptied pages are destroyed by ReleaseEmptyPages once they stayed empty long enough
+        m_LastCompactionStats.TilesMoved = static_cast<uint32_t>(relocations.size());
+        m_LastCompactionStats.PagesEmptied = static_cast<uint32_t>(plan.PagesEmptied.size());
+        m_LastCompactionStats.After = GetFragmentation();
+    }
+
+    void TilePoolCore::ReleaseTexture(VirtualTextureHandle texture)
+    {
+        // The whole resource is null mapped below, anything still queued for it is stale
+        m_PendingUpdates.erase(texture);
+
+        auto search = m_AllocationMap.find(texture);
+        if (search != m_AllocationMap.end())
+        {
+            TextureAllocationInfo& allocInfo = search->second;
+
+            //======= Release Packed Mips =======
+            if (allocInfo.PackedMipsMapped) {
+                this->ReleaseTile(allocInfo.PackedMipsAddress);
+                allocInfo.PackedMipsMapped = false;
+            }
+            allocInfo.ResidentMips = {};
+            allocInfo.ResidentTiles = {};
+
+            for (auto& allocation : allocInfo.MipAllocations)
+            {
+                for (auto& tile : allocation.TileAllocations)
+                {
+                    if (!tile.Mapped)
+                        continue;
+
+                    this->ReleaseTile(tile.TileAddress);
+                    tile.Mapped = false;
+                }
+            }
+        }
+
+        m_Backend.UnmapAll(texture);
+    }
+
+    void TilePoolCore::RemoveTexture(VirtualTextureHandle texture)
+    {
+        m_PendingUpdates.erase(texture);
+        m_AllocationMap.erase(texture);
+    }
+
+    std::vector<TilePoolStats> TilePoolCore::GetStats() const
+    {
+        std::vector<TilePoolStats> ret;
+
+        for (auto page : m_Pages)
+        {
+            if (page == nullptr)
+                continue;
+
+            TilePoolStats stats;
+            stats.MaxTiles = page->Size();
+            stats.FreeTiles = page->NumFreeTiles();
+            stats.TilesEvicted = page->TilesEvicted;
+            ret.push_back(stats);
+        }
+        return ret;
+    }
+
+    FragmentationStats TilePoolCore::GetFragmentation() const
+    {
+        return MeasureFragmentation(GetCompactionPages());
+    }
+
+    uint32_t TilePoolCore::GetPageCount() const
+    {
+        return static_cast<uint32_t>(std::count_if(m_Pages.begin(), m_Pages.end(), [](const Ref<TilePage>& page) { return page != nullptr; }));
+    }
+
+    uint64_t TilePoolCore::GetTilesUsed(VirtualTextureHandle texture) const
+    {
+        auto search = m_AllocationMap.find(texture);
+        if (search == m_AllocationMap.end())
+            return 0;
+
+        const TextureAllocationInfo& textureInfo = search->second;
+        uint64_t tilesUsed = 0;
+
+        for (auto& mip : textureInfo.MipAllocations) {
+            for (auto tile : mip.TileAllocations) {
+                if (tile.Mapped) {
+                    tilesUsed++;
+                }
+            }
+        }
+
+        if (textureInfo.PackedMipsMapped) {
+            tilesUsed++;
+        }
+
+        return tilesUsed;
+    }
+
+    Ref<TilePage> TilePoolCore::FindAvailablePage(uint32_t tiles)
+    {
+        Ref<TilePage> ret = nullptr;
+        for (auto p : m_Pages)
+        {
+            if (p != nullptr && p->NumFreeTiles() >= tiles)
+            {
+                if (ret == nullptr || p->NumFreeTiles() < ret->NumFreeTiles())
+                    ret = p;
+            }
+        }
+        return ret;
+    }
+
+    Ref<TilePage> TilePoolCore::AllocateRunOnAnyPage(uint32_t count, uint32_t& runStart)
+    {
+        std::vector<Ref<TilePage>> candidates;
+        for (auto& page : m_Pages)
+        {
+            if (page != nullptr && page->NumFreeTiles() >= count)
+                candidates.push_back(page);
+        }
+
+        // Fullest first like FindAvailablePage, a page with enough free tiles can still be too fragmented
+        std::sort(candidates.begin(), candidates.end(), [](const Ref<TilePage>& a, const Ref<TilePage>& b) {
+            return a->NumFreeTiles() < b->NumFreeTiles();
+        });
+
+        for (auto& page : candidates)
+        {
+            runStart = page->AllocateRun(count);
+            if (runStart != TilePageAllocator::InvalidTile)
+                return page;
+        }
+        return nullptr;
+    }
+
+    Ref<TilePage> TilePoolCore::AddPage()
+    {
+        // Reuse the slot of a released page if there is one
+        auto slot = std::find(m_Pages.begin(), m_Pages.end(), nullptr);
+        uint16_t pageIndex = static_cast<uint16_t>(slot - m_Pages.begin());
+
+        m_Backend.CreatePage(pageIndex, m_TilesPerPage);
+
+        Ref<TilePage> newPage = CreateRef<TilePage>(m_TilesPerPage, pageIndex);
+        if (slot == m_Pages.end())
+            m_Pages.push_back(newPage);
+        else
+            *slot = newPage;
+        return newPage;
+    }
+
+    Ref<TilePage> TilePoolCore::AcquirePage(const TextureAllocationInfo& requester, uint32_t tilesNeeded)
+    {
+        Ref<TilePage> page = FindAvailablePage(1);
+        if (page != nullptr)
+            return page;
+
+        if (m_TileBudget == 0 || GetTileCapacity() + m_TilesPerPage <= m_TileBudget)
+            return AddPage();
+
+        if (EvictTiles(requester, tilesNeeded) > 0)
+            return FindAvailablePage(1);
+
+        return nullptr;
+    }
+
+    uint32_t TilePoolCore::EvictTiles(const TextureAllocationInfo& requester, uint32_t tilesNeeded)
+    {
+        // Only textures that were not mapped this frame can give tiles away, oldest first
+        std::vector<std::pair<VirtualTextureHandle, TextureAllocationInfo*>> victims;
+        for (auto& [texture, info] : m_AllocationMap)
+        {
+            if (&info != &requester && info.LastUsedFrame < m_FrameCounter)
+                victims.emplace_back(texture, &info);
+        }
+
+        std::sort(victims.begin(), victims.end(), [](const auto& a, const auto& b) {
+            return a.second->LastUsedFrame < b.second->LastUsedFrame;
+        });
+
+        uint32_t tilesFreed = 0;
+        for (auto& [texture, info] : victims)
+        {
+            uint32_t tilesFreedFromTexture = 0;
+
+            // The finest mips are the largest and the first ones to stop mattering as an
+            // object gets further away, so they go first. Whole mips are evicted so the
+            // resident range of the texture stays contiguous.
+            for (uint32_t mip = 0; mip < info->MipAllocations.size() && tilesFreed < tilesNeeded; mip++)
+            {
+                auto& tileAllocations = info->MipAllocations[mip].TileAllocations;
+                uint32_t width = info->Layout.MipGrids[mip].Width;
+
+                for (uint32_t i = 0; i < tileAllocations.size(); i++)
+                {
+                    auto& tileAllocation = tileAllocations[i];
+                    if (!tileAllocation.Mapped)
+                        continue;
+
+                    m_PendingUpdates[texture].Unmap(i % width, i / width, mip);
+                    m_Pages[tileAllocation.TileAddress.Page]->TilesEvicted++;
+                    ReleaseTile(tileAllocation.TileAddress);
+                    tileAllocation.Mapped = false;
+                    ++tilesFreedFromTexture;
+                    ++tilesFreed;
+                }
+
+                if (info->ResidentMips.Contains(mip))
+                {
+                    info->ResidentMips.Begin = mip + 1;
+                    info->ResidentMips.End = std::max(info->ResidentMips.End, info->ResidentMips.Begin);
+                }
+            }
+
+            if (tilesFreedFromTexture > 0)
+            {
+                // The tile set no longer matches what is mapped, force a new diff next time
+                info->ResidentTiles = {};
+                m_CurrentStats.TilesEvicted += tilesFreedFromTexture;
+                ++m_CurrentStats.TexturesEvicted;
+            }
+
+            if (tilesFreed >= tilesNeeded)
+                break;
+        }
+
+        return tilesFreed;
+    }
+
+    void TilePoolCore::ReleaseEmptyPages()
+    {
+        for (auto& page : m_Pages)
+        {
+            if (page == nullptr)
+                continue;
+
+            if (page->NumFreeTiles() != page->Size())
+            {
+                page->EmptySinceFrame = TilePage::NotEmpty;
+                continue;
+            }
+
+            if (page->EmptySinceFrame == TilePage::NotEmpty)
+            {
+                page->EmptySinceFrame = m_FrameCounter;
+            }
+            else if (m_FrameCounter - page->EmptySinceFrame >= m_PageReleaseDelay)
+            {
+                // Nothing has been mapped to the page for longer than the GPU can lag behind
+                m_Backend.DestroyPage(page->PageIndex);
+                page = nullptr;
+                ++m_CurrentStats.PagesReleased;
+            }
+        }
+    }
+
+    uint64_t TilePoolCore::GetTileCapacity() const
+    {
+        uint64_t capacity = 0;
+        for (auto& page : m_Pages)
+        {
+            if (page != nullptr)
+                capacity += page->Size();
+        }
+        return capacity;
+    }
+
+    std::vector<CompactionPage> TilePoolCore::GetCompactionPages() const
+    {
+        std::vector<CompactionPage> pages;
+        for (auto& page : m_Pages)
+        {
+            if (page != nullptr)
+                pages.push_back({ page->PageIndex, &page->GetAllocator() });
+        }
+        return pages;
+    }
+
+    TilePoolCore::TextureAllocationInfo& TilePoolCore::GetTextureInfo(VirtualTextureHandle texture, const VirtualTextureLayout& layout)
+    {
+        auto search = m_AllocationMap.find(texture);
+
+        if (search != m_AllocationMap.end())
+            return search->second;
+
+        // We do not know about this texture, lets add it
+        TextureAllocationInfo& allocInfo = m_AllocationMap[texture];
+        allocInfo.Layout = layout;
+        allocInfo.PackedMipsMapped = false;
+        allocInfo.MipAllocations.resize(layout.MipGrids.size());
+        for (uint32_t i = 0; i < allocInfo.MipAllocations.size(); i++)
+        {
+            auto& grid = layout.MipGrids[i];
+            allocInfo.MipAllocations[i].TileAllocations.resize(size_t(grid.Width) * grid.Height);
+        }
+
+        return allocInfo;
+    }
+
+    uint32_t TilePage::AllocateTile()
+    {
+        HZ_CORE_ASSERT(m_Allocator.NumFreeTiles() > 0, "There are no free tiles on this page");
+
+        uint32_t tile = m_Allocator.Allocate();
+        HZ_CORE_ASSERT(tile != TilePageAllocator::InvalidTile, "Should never reach this");
+        return tile;
+    }
+
+    uint32_t TilePage::AllocateRun(uint32_t count)
+    {
+        return m_Allocator.AllocateRun(count);
+    }
+
+    bool TilePage::AllocateTileAt(uint32_t tile)
+    {
+        return m_Allocator.AllocateAt(tile);
+    }
+
+    void TilePage::ReleaseTile(uint32_t tile)
+    {
+        HZ_CORE_ASSERT(tile < m_Allocator.Size(), "Tile is outside the available tile range");
+        m_Allocator.Release(tile);
+    }
+}
@@ -0,0 +1,311 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "TitaniumRose/Core/Core.h"
+#include "TitaniumRose/Renderer/VirtualTexture/MipResidency.h"
+#include "TitaniumRose/Renderer/VirtualTexture/TileCompaction.h"
+#include "TitaniumRose/Renderer/VirtualTexture/TileMappingBackend.h"
+#include "TitaniumRose/Renderer/VirtualTexture/TileMappingBuilder.h"
+#include "TitaniumRose/Renderer/VirtualTexture/TilePageAllocator.h"
+#include "TitaniumRose/Renderer/VirtualTexture/TileResidency.h"
+
+namespace Roses
+{
+	union TileAddress
+	{
+		uint32_t Address;
+		struct {
+			uint16_t Page;
+			uint16_t Tile;
+		};
+
+		bool operator== (const TileAddress& other) const { return this->Address == other.Address; }
+	};
+
+	static constexpr TileAddress InvalidTileAddress = { uint32_t(-1) };
+
+	enum class TileResidencyMode
+	{
+		// Every tile of the mips between the finest and coarsest mip used is mapped
+		MipRange,
+		// Only the tiles the feedback map asked for are mapped
+		FeedbackTiles
+	};
+
+	struct TilePoolStats
+	{
+		uint32_t MaxTiles;
+		uint32_t FreeTiles;
+		// Tiles of this page that were taken away from other textures to stay in budget
+		uint32_t TilesEvicted;
+	};
+
+	struct TileMappingFlushStats
+	{
+		uint32_t TilesRequested = 0;
+		uint32_t RegionsSubmitted = 0;
+		uint32_t Calls = 0;
+
+		uint32_t TilesMapped = 0;
+		uint32_t TilesUnmapped = 0;
+		uint32_t TexturesUpdated = 0;
+		uint32_t TexturesUnchanged = 0;
+
+		uint32_t TilesEvicted = 0;
+		uint32_t TexturesEvicted = 0;
+		uint32_t TilesDenied = 0;
+		uint32_t PagesReleased = 0;
+	};
+
+	struct TileCompactionStats
+	{
+		uint32_t TilesMoved = 0;
+		uint32_t PagesEmptied = 0;
+		FragmentationStats Before;
+		FragmentationStats After;
+	};
+
+	struct TilePage {
+
+		TilePage(uint32_t maxTiles, uint16_t pageIndex)
+			: PageIndex(pageIndex),
+			m_Allocator(maxTiles)
+		{
+		}
+
+		uint32_t AllocateTile();
+		uint32_t AllocateRun(uint32_t count);
+		bool AllocateTileAt(uint32_t tileNumber);
+		inline const TilePageAllocator& GetAllocator() const { return m_Allocator; }
+		inline uint32_t NumFreeTiles() const { return m_Allocator.NumFreeTiles(); }
+		inline uint32_t Size() const { return m_Allocator.Size(); }
+		void ReleaseTile(uint32_t tileNumber);
+
+		uint16_t PageIndex = 0;
+
+		uint32_t TilesEvicted = 0;
+		// The pool frame this page became fully empty, or NotEmpty
+		static constexpr uint64_t NotEmpty = uint64_t(-1);
+		uint64_t EmptySinceFrame = NotEmpty;
+	private:
+		TilePageAllocator m_Allocator;
+	};
+
+	/// <summary>
+	/// How a virtual texture is split into tiles, as reported by the graphics API.
+	/// </summary>
+	struct VirtualTextureLayout
+	{
+		// The tile grid of every standard mip, finest first
+		std::vector<TileGridSize> MipGrids;
+		uint32_t NumPackedTiles = 0;
+		// The first subresource of the packed mips
+		uint32_t PackedSubresource = 0;
+		// The total number of mips, which is also what unused feedback cells hold
+		uint32_t MipLevels = 0;
+	};
+
+	/// <summary>
+	/// What a texture needs this frame. The feedback is compact, one byte per cell, and
+	/// is only read with TileResidencyMode::FeedbackTiles and may be null otherwise.
+	/// </summary>
+	struct TextureResidencyRequest
+	{
+		uint32_t FinestMip = 0;
+		uint32_t CoarsestMip = 0;
+		const uint8_t* Feedback = nullptr;
+		uint32_t FeedbackWidth = 0;
+		uint32_t FeedbackHeight = 0;
+	};
+
+	/// <summary>
+	/// The allocation and residency logic of the tile pool, without any graphics API in
+	/// it. It decides which tiles of which texture live where, and tells the backend what
+	/// to create, map and copy.
+	/// </summary>
+	class TilePoolCore
+	{
+	public:
+		TilePoolCore(TileMappingBackend& backend, uint32_t tilesPerPage);
+
+		void MapTexture(VirtualTextureHandle texture, const VirtualTextureLayout& layout, const TextureResidencyRequest& request);
+		void ReleaseTexture(VirtualTextureHandle texture);
+		void RemoveTexture(VirtualTextureHandle texture);
+		uint64_t GetTilesUsed(VirtualTextureHandle texture) const;
+
+		/// <summary>
+		/// Submits all the tile mapping updates queued by MapTexture since the last flush.
+		/// Should be called once per frame, after all the textures have been mapped and
+		/// before anything samples them.
+		/// </summary>
+		void FlushUpdates();
+
+		/// <summary>
+		/// Moves up to the compaction budget of tiles out of the sparsest pages into the
+		/// densest ones, so the emptied pages can be released. Should be called after
+		/// FlushUpdates.
+		/// </summary>
+		void Compact();
+
+		std::vector<TilePoolStats> GetStats() const;
+		FragmentationStats GetFragmentation() const;
+		inline const TileMappingFlushStats& GetLastFlushStats() const { return m_LastFlushStats; }
+		inline const TileCompactionStats& GetLastCompactionStats() const { return m_LastCompactionStats; }
+
+		inline uint32_t GetTilesPerPage() const { return m_TilesPerPage; }
+		uint32_t GetPageCount() const;
+
+		inline void SetResidencyMode(TileResidencyMode mode) { m_ResidencyMode = mode; }
+		inline TileResidencyMode GetResidencyMode() const { return m_ResidencyMode; }
+
+		/// <summary>
+		/// How many tiles around every requested tile are kept resident when using
+		/// TileResidencyMode::FeedbackTiles, to hide the latency of the feedback.
+		/// </summary>
+		inline void SetResidencyBorder(uint32_t border) { m_ResidencyBorder = border; }
+		inline uint32_t GetResidencyBorder() const { return m_ResidencyBorder; }
+
+		/// <summary>
+		/// Limits the number of tiles the pages of the pool can hold. Once the budget is
+		/// reached, tiles of the least recently seen textures are evicted instead of adding
+		/// a page, starting with their finest mips. A budget of 0 lets the pool grow
+		/// without limit.
+		/// </summary>
+		inline void SetTileBudget(uint64_t tiles) { m_TileBudget = tiles; }
+		inline uint64_t GetTileBudget() const { return m_TileBudget; }
+		uint64_t GetTileCapacity() const;
+
+		/// <summary>
+		/// How many frames a page has to stay empty before it is destroyed. Should be
+		/// longer than the number of frames in flight.
+		/// </summary>
+		inline void SetPageReleaseDelay(uint32_t frames) { m_PageReleaseDelay = frames; }
+		inline uint32_t GetPageReleaseDelay() const { return m_PageReleaseDelay; }
+
+		/// <summary>
+		/// The maximum number of tiles Compact moves per call, 0 disables compaction
+		/// </summary>
+		inline void SetCompactionBudget(uint32_t tilesPerFrame) { m_CompactionBudget = tilesPerFrame; }
+		inline uint32_t GetCompactionBudget() const { return m_CompactionBudget; }
+
+	private:
+		struct TileAllocation
+		{
+			bool Mapped = false;
+			Roses::TileAddress TileAddress;
+		};
+
+		struct MipAllocationInfo
+		{
+			std::vector<TileAllocation> TileAllocations;
+		};
+
+		struct TextureAllocationInfo
+		{
+			VirtualTextureLayout Layout;
+			std::vector<MipAllocationInfo> MipAllocations;
+			bool			PackedMipsMapped = false;
+			TileAddress		PackedMipsAddress;
+			// The standard mips that were mapped the last time we saw this texture
+			MipRange		ResidentMips;
+			// The tiles that were requested the last time we saw this texture, only
+			// used with TileResidencyMode::FeedbackTiles
+			TileResidencySet ResidentTiles;
+			TileResidencyMode Mode = TileResidencyMode::MipRange;
+			// The pool frame this texture was last mapped, used to pick eviction victims
+			uint64_t		LastUsedFrame = 0;
+			// Some tiles could not be mapped because the pool was out of budget
+			bool			Incomplete = false;
+		};
+
+	private:
+		/// <summary>
+		/// Will search for a page that can fit the requested number of tiles. The fullest
+		/// page that fits is picked, so sparse pages can drain and be released. If
+		/// no page was found, it returns nullptr
+		/// </summary>
+		/// <param name="tiles">The number of tiles that are required out of the page</param>
+		Ref<TilePage> FindAvailablePage(uint32_t tiles);
+
+		/// <summary>
+		/// Allocates count contiguous tiles on the fullest page that has a free run that
+		/// long. Pages are not added and nothing is evicted.
+		/// </summary>
+		/// <param name="runStart">Gets the first tile of the run</param>
+		/// <returns>The page holding the run, or nullptr if no page has one</returns>
+		Ref<TilePage> AllocateRunOnAnyPage(uint32_t count, uint32_t& runStart);
+
+		/// <summary>
+		/// Adds a new page, reusing the slot of a released one if there is any
+		/// </summary>
+		/// <returns>A reference to the newly added page</returns>
+		Ref<TilePage> AddPage();
+
+		/// <summary>
+		/// Finds a page with at least one free tile. If there is none, a page is added if
+		/// the budget allows it, otherwise tiles are evicted from other textures.
+		/// </summary>
+		/// <param name="requester">The texture the tile is for, it is never evicted</param>
+		/// <param name="tilesNeeded">How many tiles the caller is about to allocate</param>
+		/// <returns>A page with a free tile, or nullptr if the budget is exhausted</returns>
+		Ref<TilePage> AcquirePage(const TextureAllocationInfo& requester, uint32_t tilesNeeded);
+
+		/// <summary>
+		/// Unmaps the finest mips of the least recently seen textures until at least
+		/// tilesNeeded tiles were freed or there is nothing left to evict. Packed mips
+		/// are never evicted.
+		/// </summary>
+		/// <returns>The number of tiles freed</returns>
+		uint32_t EvictTiles(const TextureAllocationInfo& requester, uint32_t tilesNeeded);
+
+		/// <summary>
+		/// Destroys the pages that have been empty for longer than the release delay
+		/// </summary>
+		void ReleaseEmptyPages();
+
+		TextureAllocationInfo& GetTextureInfo(VirtualTextureHandle texture, const VirtualTextureLayout& layout);
+
+		void SubmitUpdates(VirtualTextureHandle texture, TileMappingBuilder& builder);
+
+		void MapPackedMips(TextureAllocationInfo& allocInfo, TileMappingBuilder& updates, Ref<TilePage>& currentPage);
+		void MapTextureTiles(VirtualTextureHandle texture, TextureAllocationInfo& allocInfo, const TextureResidencyRequest& request);
+		void MapMipLevel(TextureAllocationInfo& allocInfo, TileMappingBuilder& updates, uint32_t mip, Ref<TilePage>& currentPage);
+		/// <summary>
+		/// Maps the given tiles of a mip, tiles are indexed y * width + x
+		/// </summary>
+		void MapTiles(TextureAllocationInfo& allocInfo, TileMappingBuilder& updates, uint32_t mip,
+			const std::vector<uint32_t>& tiles, Ref<TilePage>& currentPage);
+		void UnmapMipLevel(TextureAllocationInfo& allocInfo, TileMappingBuilder& updates, uint32_t mip);
+
+		std::vector<CompactionPage> GetCompactionPages() const;
+
+		inline void ReleaseTile(TileAddress& address)
+		{
+			m_Pages[address.Page]->ReleaseTile(address.Tile);
+		}
+
+	private:
+		TileMappingBackend& m_Backend;
+		uint32_t m_TilesPerPage;
+		uint64_t m_FrameCounter = 0;
+
+		std::unordered_map<VirtualTextureHandle, TextureAllocationInfo> m_AllocationMap;
+		// Released pages leave a nullptr behind so the page indices stored in tile addresses stay valid
+		std::vector<Ref<TilePage>> m_Pages;
+
+		std::unordered_map<VirtualTextureHandle, TileMappingBuilder> m_PendingUpdates;
+		TileMappingFlushStats m_CurrentStats;
+		TileMappingFlushStats m_LastFlushStats;
+
+		TileResidencyMode m_ResidencyMode = TileResidencyMode::MipRange;
+		uint32_t m_ResidencyBorder = 1;
+
+		uint64_t m_TileBudget = 0;
+		uint32_t m_PageReleaseDelay = 120;
+
+		uint32_t m_CompactionBudget = 0;
+		TileCompactionStats m_LastCompactionStats;
+	};
+}
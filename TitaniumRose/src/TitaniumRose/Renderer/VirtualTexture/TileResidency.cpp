@@ -0,0 +1,126 @@
+#include "trpch.h"
+#include "TitaniumRose/Renderer/VirtualTexture/TileResidency.h"
+
+namespace Roses
+{
+    TileResidencySet::TileResidencySet(const std::vector<TileGridSize>& mipGrids)
+        : m_Grids(mipGrids)
+    {
+        m_Tiles.resize(m_Grids.size());
+        for (size_t mip = 0; mip < m_Grids.size(); mip++)
+        {
+            m_Tiles[mip].assign(size_t(m_Grids[mip].Width) * m_Grids[mip].Height, 0);
+        }
+    }
+
+    uint32_t TileResidencySet::CountResident(uint32_t mip) const
+    {
+        uint32_t count = 0;
+        for (auto tile : m_Tiles[mip])
+        {
+            count += tile;
+        }
+        return count;
+    }
+
+    uint32_t TileResidencySet::CountResident() const
+    {
+        uint32_t count = 0;
+        for (uint32_t mip = 0; mip < NumMips(); mip++)
+        {
+            count += CountResident(mip);
+        }
+        return count;
+    }
+
+    void TileResidencySet::Dilate(uint32_t border)
+    {
+        if (border == 0)
+            return;
+
+        for (uint32_t mip = 0; mip < NumMips(); mip++)
+        {
+            const auto& grid = m_Grids[mip];
+            const auto source = m_Tiles[mip];
+            auto& target = m_Tiles[mip];
+
+            for (uint32_t y = 0; y < grid.Height; y++)
+            {
+                for (uint32_t x = 0; x < grid.Width; x++)
+                {
+                    if (source[y * grid.Width + x] == 0)
+                        continue;
+
+                    uint32_t x0 = x > border ? x - border : 0;
+                    uint32_t y0 = y > border ? y - border : 0;
+                    uint32_t x1 = std::min(x + border, grid.Width - 1);
+                    uint32_t y1 = std::min(y + border, grid.Height - 1);
+
+                    for (uint32_t yy = y0; yy <= y1; yy++)
+                    {
+                        std::fill(target.begin() + yy * grid.Width + x0, target.begin() + yy * grid.Width + x1 + 1, uint8_t(1));
+                    }
+                }
+            }
+        }
+    }
+
+    bool TileResidencySet::operator==(const TileResidencySet& other) const
+    {
+        return m_Tiles == other.m_Tiles;
+    }
+
+    template<typename Cell>
+    static TileResidencySet BuildTileResidencyFrom(const Cell* feedback, uint32_t feedbackWidth, uint32_t feedbackHeight,
+        uint32_t noSampleValue, const std::vector<TileGridSize>& mipGrids, uint32_t border, uint32_t generatedFromMip)
+    {
+        TileResidencySet residency(mipGrids);
+        const uint32_t numMips = static_cast<uint32_t>(mipGrids.size());
+
+        if (feedback == nullptr || numMips == 0)
+            return residency;
+
+        for (uint32_t y = 0; y < feedbackHeight; y++)
+        {
+            for (uint32_t x = 0; x < feedbackWidth; x++)
+            {
+                uint32_t requested = static_cast<uint32_t>(feedback[y * feedbackWidth + x]);
+
+                if (requested == noSampleValue)
+                    continue;
+
+                // A cell that only sampled the packed tail still needs the mip the chain is generated from
+                requested = std::min(requested, generatedFromMip);
+                if (requested >= numMips)
+                    continue;
+
+                // Walk the chain down to the coarsest mip. A resident tile does not mean its
+                // chain is marked, grids that do not halve exactly map the cells of one tile
+                // to different coarser tiles.
+                for (uint32_t mip = requested; mip < numMips; mip++)
+                {
+                    const auto& grid = mipGrids[mip];
+                    uint32_t tx = static_cast<uint32_t>((uint64_t(x) * grid.Width) / feedbackWidth);
+                    uint32_t ty = static_cast<uint32_t>((uint64_t(y) * grid.Height) / feedbackHeight);
+
+                    residency.Set(mip, tx, ty);
+                }
+            }
+        }
+
+        residency.Dilate(border);
+        return residency;
+    }
+
+    TileResidencySet BuildTileResidency(const uint32_t* feedback, uint32_t feedbackWidth, uint32_t feedbackHeight,
+        uint32_t noSampleValue, const std::vector<TileGridSize>& mipGrids, uint32_t border, uint32_t generatedFromMip)
+    {
+        return BuildTileResidencyFrom(feedback, feedbackWidth, feedbackHeight, noSampleValue, mipGrids, border, generatedFromMip);
+    }
+
+    TileResidencySet BuildTileResidency(const uint8_t* feedback, uint32_t feedbackWidth, uint32_t feedbackHeight,
+        uint32_t noSampleValue, const std::vector<TileGridSize>& mipGrids, uint32_t border, uint32_t generatedFromMip)
+    {
+        return BuildTileResidencyFrom(feedback, feedbackWidth, feedbackHeight, noSampleValue, mipGrids, border, generatedFromMip);
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace Roses
+{
+    struct TileGridSize
+    {
+        uint32_t Width;
+        uint32_t Height;
+    };
+
+    /// <summary>
+    /// One residency flag per tile, for every standard mip of a texture.
+    /// </summary>
+    class TileResidencySet
+    {
+    public:
+        TileResidencySet() = default;
+        explicit TileResidencySet(const std::vector<TileGridSize>& mipGrids);
+
+        inline void Set(uint32_t mip, uint32_t x, uint32_t y) { m_Tiles[mip][y * m_Grids[mip].Width + x] = 1; }
+        inline bool IsResident(uint32_t mip, uint32_t x, uint32_t y) const { return m_Tiles[mip][y * m_Grids[mip].Width + x] != 0; }
+
+        inline uint32_t NumMips() const { return static_cast<uint32_t>(m_Grids.size()); }
+        inline const TileGridSize& GetGrid(uint32_t mip) const { return m_Grids[mip]; }
+
+        uint32_t CountResident(uint32_t mip) const;
+        uint32_t CountResident() const;
+
+        /// <summary>
+        /// Marks every tile within border tiles (in x and y) of a resident tile as resident.
+        /// </summary>
+        void Dilate(uint32_t border);
+
+        bool operator==(const TileResidencySet& other) const;
+        bool operator!=(const TileResidencySet& other) const { return !(*this == other); }
+
+    private:
+        std::vector<TileGridSize> m_Grids;
+        std::vector<std::vector<uint8_t>> m_Tiles;
+    };
+
+    /// <summary>
+    /// Converts a feedback map into the set of tiles that have to be resident. Every
+    /// feedback cell holds the finest mip sampled inside it, or noSampleValue if nothing
+    /// sampled it. The tile covering the cell at that mip is made resident, and so are
+    /// the tiles covering it at every coarser standard mip, since those are generated from
+    /// the finer one. Mips past the last grid live in the packed tail and need no tiles.
+    /// If the coarser mips are generated from one finer mip rather than written directly,
+    /// pass it as generatedFromMip so every sampled cell keeps its tiles from that mip down.
+    /// </summary>
+    /// <param name="feedback">The feedback cells, row major</param>
+    /// <param name="feedbackWidth">Width of the feedback map in cells</param>
+    /// <param name="feedbackHeight">Height of the feedback map in cells</param>
+    /// <param name="noSampleValue">The value the feedback map is cleared to</param>
+    /// <param name="mipGrids">The tile grid of each standard mip, finest first</param>
+    /// <param name="border">Extra tiles to keep resident around every requested tile</param>
+    /// <param name="generatedFromMip">The mip the rest of the chain is generated from, if any</param>
+    /// <returns>The tiles that should be mapped</returns>
+    TileResidencySet BuildTileResidency(const uint32_t* feedback, uint32_t feedbackWidth, uint32_t feedbackHeight,
+        uint32_t noSampleValue, const std::vector<TileGridSize>& mipGrids, uint32_t border = 0, uint32_t generatedFromMip = uint32_t(-1));
+
+    /// <summary>
+    /// The same over compact feedback, one byte per cell
+    /// </summary>
+    TileResidencySet BuildTileResidency(const uint8_t* feedback, uint32_t feedbackWidth, uint32_t feedbackHeight,
+        uint32_t noSampleValue, const std::vector<TileGridSize>& mipGrids, uint32_t border = 0, uint32_t generatedFromMip = uint32_t(-1));
+}
@@ -180,6 +180,36 @@ void ImGui::DecoupledTextureControl(Roses::DecoupledTextureComponent& component)
     
     component.OverwriteRefreshRate = overwrite;
 
+    Property("Analytic mips", component.AnalyticMips);
+
+    {
+        static const char* policyNames[] = {
+            Roses::GetMipPolicyName(Roses::MipPolicyType::Finest),
+            Roses::GetMipPolicyName(Roses::MipPolicyType::Coverage),
+            Roses::GetMipPolicyName(Roses::MipPolicyType::ScreenArea)
+        };
+        int policy = static_cast<int>(component.MipPolicy.Type);
+        ImGui::Text("Mip policy");
+        ImGui::NextColumn();
+        ImGui::PushItemWidth(-1);
+        ImGui::Combo("##mippolicy", &policy, policyNames, IM_ARRAYSIZE(policyNames));
+        ImGui::PopItemWidth();
+        ImGui::NextColumn();
+        component.MipPolicy.Type = static_cast<Roses::MipPolicyType>(policy);
+
+        if (component.MipPolicy.Type != Roses::MipPolicyType::Finest) {
+            Property("Coverage", component.MipPolicy.Coverage, 0.5f, 1.0f);
+        }
+
+        int demoteDelay = static_cast<int>(component.MipHysteresis.DemoteDelay);
+        Property("Mip demote delay", demoteDelay, 0, 240, PropertyFlag::InputProperty);
+        component.MipHysteresis.DemoteDelay = static_cast<uint32_t>(std::max(demoteDelay, 0));
+
+        int accumulationFrames = static_cast<int>(component.MipHysteresis.AccumulationFrames);
+        Property("Feedback accumulation", accumulationFrames, 0, 60, PropertyFlag::InputProperty);
+        component.MipHysteresis.AccumulationFrames = static_cast<uint32_t>(std::max(accumulationFrames, 0));
+    }
+
     // TODO: We could notify somehow here that the texture is no longer used
     if (!useTexture)
     {
@@ -204,6 +234,12 @@ void ImGui::DecoupledTextureControl(Roses::DecoupledTextureComponent& component)
     ImGui::NextColumn();
     ImGui::Text("Low-res mip: %d", mips.CoarsestMip);
     ImGui::NextColumn();
+    auto& selection = component.VirtualTexture->GetMipSelection();
+    ImGui::Text("Shaded texels: %llu (%llu saved)", selection.ShadedTexels, selection.TexelsSaved);
+    ImGui::NextColumn();
+    auto& hysteresisStats = component.VirtualTexture->GetMipHysteresisStats();
+    ImGui::Text("Mip changes: %llu of %llu applied", hysteresisStats.AppliedChanges, hysteresisStats.RequestedChanges);
+    ImGui::NextColumn();
     float factor = 1.0f / 1024.0f;
     auto sizeInBytes = component.VirtualTexture->GetGPUSizeInBytes();
 
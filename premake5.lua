@@ -221,3 +221,73 @@ project "RoseGarden"
 		defines "HZ_DIST"
 		runtime "Release"
 		optimize "on"
+
+project "TileSimulator"
+	location "TileSimulator"
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++17"
+	staticruntime "on"
+
+	targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+	objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
+
+	-- Only the platform-neutral tile pool is built, so the simulator also runs on Linux
+	files
+	{
+		"%{prj.name}/src/**.h",
+		"%{prj.name}/src/**.cpp",
+		"TitaniumRose/src/TitaniumRose/Core/ConcurrentRangeAllocator.h",
+		"TitaniumRose/src/TitaniumRose/Core/ConcurrentRangeAllocator.cpp",
+		"TitaniumRose/src/TitaniumRose/Core/DescriptorViewCache.h",
+		"TitaniumRose/src/TitaniumRose/Core/DescriptorViewCache.cpp",
+		"TitaniumRose/src/TitaniumRose/Core/FenceRing.h",
+		"TitaniumRose/src/TitaniumRose/Core/FenceRing.cpp",
+		"TitaniumRose/src/TitaniumRose/Core/FramePipeline.h",
+		"TitaniumRose/src/TitaniumRose/Core/FramePipeline.cpp",
+		"TitaniumRose/src/TitaniumRose/Core/JobSystem.h",
+		"TitaniumRose/src/TitaniumRose/Core/JobSystem.cpp",
+		"TitaniumRose/src/TitaniumRose/Core/ParallelRecorder.h",
+		"TitaniumRose/src/TitaniumRose/Core/ParallelRecorder.cpp",
+		"TitaniumRose/src/TitaniumRose/Core/RangeAllocator.h",
+		"TitaniumRose/src/TitaniumRose/Core/RangeAllocator.cpp",
+		"TitaniumRose/src/TitaniumRose/Core/UploadBatcher.h",
+		"TitaniumRose/src/TitaniumRose/Core/UploadBatcher.cpp",
+		"TitaniumRose/src/TitaniumRose/Core/UploadRing.h",
+		"TitaniumRose/src/TitaniumRose/Core/UploadRing.cpp",
+		"TitaniumRose/src/TitaniumRose/Core/WorkStealingDeque.h",
+		"TitaniumRose/src/TitaniumRose/Renderer/MaterialTable.h",
+		"TitaniumRose/src/TitaniumRose/Renderer/MaterialTable.cpp",
+		"TitaniumRose/src/TitaniumRose/Renderer/RenderGraph.h",
+		"TitaniumRose/src/TitaniumRose/Renderer/RenderGraph.cpp",
+		"TitaniumRose/src/TitaniumRose/Renderer/VirtualTexture/**.h",
+		"TitaniumRose/src/TitaniumRose/Renderer/VirtualTexture/**.cpp"
+	}
+
+	includedirs
+	{
+		"%{prj.name}/src",
+		"TitaniumRose/src",
+		"TitaniumRose/vendor",
+		"%{IncludeDir.spdlog}",
+		"%{IncludeDir.glm}",
+		"%{IncludeDir.cxxopts}"
+	}
+
+	defines
+	{
+		"HZ_HEADLESS",
+		"GLM_FORCE_DEPTH_ZERO_TO_ONE"
+	}
+
+	filter "configurations:Debug"
+		runtime "Debug"
+		symbols "on"
+
+	filter "configurations:Release"
+		runtime "Release"
+		optimize "on"
+
+	filter "configurations:Dist"
+		runtime "Release"
+		optimize "on"